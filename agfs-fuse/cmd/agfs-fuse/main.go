@@ -102,6 +102,9 @@ func main() {
 		log.Fatalf("Mount failed: %v", err)
 	}
 
+	// Invalidate cached metadata as the server reports changes
+	root.StartChangeWatcher()
+
 	log.Infof("AGFS mounted at %s", *mountpoint)
 	log.Infof("Server: %s", *serverURL)
 	log.Infof("Cache TTL: %v", *cacheTTL)
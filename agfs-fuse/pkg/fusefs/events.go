@@ -0,0 +1,142 @@
+package fusefs
+
+import (
+	"errors"
+	"strings"
+	"time"
+
+	agfs "github.com/c4pt0r/agfs/agfs-sdk/go"
+	"github.com/hanwen/go-fuse/v2/fs"
+	log "github.com/sirupsen/logrus"
+)
+
+const (
+	// eventsPollTimeout is how long one events request waits for a change
+	eventsPollTimeout = 30 * time.Second
+
+	// eventsMaxBackoff caps the retry delay after a failed events request
+	eventsMaxBackoff = 30 * time.Second
+)
+
+// StartChangeWatcher follows the server's change log and invalidates the
+// metadata and directory caches, and the kernel's attributes, entries and
+// page cache, of every path that changes. Servers without a change log
+// leave the caches to expire by TTL. Call it once the filesystem is
+// mounted; Close stops it.
+func (root *AGFSFS) StartChangeWatcher() {
+	root.mu.Lock()
+	defer root.mu.Unlock()
+	if root.stopWatch != nil {
+		return
+	}
+	root.stopWatch = make(chan struct{})
+	go root.watchChanges(root.stopWatch)
+}
+
+func (root *AGFSFS) stopChangeWatcher() {
+	root.mu.Lock()
+	defer root.mu.Unlock()
+	if root.stopWatch != nil {
+		close(root.stopWatch)
+		root.stopWatch = nil
+	}
+}
+
+func (root *AGFSFS) watchChanges(stop <-chan struct{}) {
+	var since int64
+	backoff := time.Second
+
+	for {
+		select {
+		case <-stop:
+			return
+		default:
+		}
+
+		resp, err := root.client.Events(since, eventsPollTimeout)
+		if errors.Is(err, agfs.ErrNotSupported) {
+			log.Infof("[events] Server has no change log, caches expire by TTL only")
+			return
+		}
+		if err != nil {
+			log.Debugf("[events] Events request failed: %v", err)
+			select {
+			case <-stop:
+				return
+			case <-time.After(backoff):
+			}
+			if backoff *= 2; backoff > eventsMaxBackoff {
+				backoff = eventsMaxBackoff
+			}
+			continue
+		}
+		backoff = time.Second
+
+		if resp.Reset {
+			log.Debugf("[events] Missed changes, dropping all cached metadata")
+			root.invalidateAll()
+		}
+		for _, change := range resp.Events {
+			root.applyChange(change)
+		}
+		since = resp.Next
+	}
+}
+
+// applyChange invalidates what a change makes stale
+func (root *AGFSFS) applyChange(change agfs.Change) {
+	path := change.Path
+	log.Debugf("[events] %s %s", change.Kind, path)
+
+	// A removed (or renamed) directory takes its cached children with it
+	if change.Kind == "tree" || change.Kind == "removed" {
+		root.metaCache.InvalidatePrefix(path)
+		root.dirCache.InvalidatePrefix(path)
+	} else {
+		root.metaCache.Invalidate(path)
+		root.dirCache.Invalidate(path)
+	}
+	parent := getParentPath(path)
+	if parent != "" {
+		root.dirCache.Invalidate(parent)
+	}
+
+	// Kernel caches: only inodes the kernel has looked up exist here
+	if node := root.findInode(path); node != nil {
+		node.NotifyContent(0, 0)
+	}
+	switch change.Kind {
+	case "created", "removed", "tree":
+		if parentNode := root.findInode(parent); parentNode != nil {
+			parentNode.NotifyEntry(path[strings.LastIndex(path, "/")+1:])
+		}
+	}
+}
+
+// invalidateAll drops the user-space caches and the kernel's entries of
+// the top-level names, so lookups go back to the server
+func (root *AGFSFS) invalidateAll() {
+	root.metaCache.Clear()
+	root.dirCache.Clear()
+
+	for name := range root.EmbeddedInode().Children() {
+		root.EmbeddedInode().NotifyEntry(name)
+	}
+}
+
+// findInode returns the inode of path if the kernel has looked it up
+func (root *AGFSFS) findInode(path string) *fs.Inode {
+	if path == "" {
+		return nil
+	}
+	node := root.EmbeddedInode()
+	for _, name := range strings.Split(strings.Trim(path, "/"), "/") {
+		if name == "" {
+			continue
+		}
+		if node = node.GetChild(name); node == nil {
+			return nil
+		}
+	}
+	return node
+}
@@ -22,6 +22,7 @@ type AGFSFS struct {
 	metaCache *cache.MetadataCache
 	dirCache  *cache.DirectoryCache
 	cacheTTL  time.Duration
+	stopWatch chan struct{} // Closes to stop the change watcher
 	mu        sync.RWMutex
 }
 
@@ -51,6 +52,8 @@ func NewAGFSFS(config Config) *AGFSFS {
 
 // Close closes the filesystem and releases resources
 func (root *AGFSFS) Close() error {
+	root.stopChangeWatcher()
+
 	// Close all open handles
 	if err := root.handles.CloseAll(); err != nil {
 		return err
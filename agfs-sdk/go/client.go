@@ -7,6 +7,7 @@ import (
 	"io"
 	"net/http"
 	"net/url"
+	"strconv"
 	"strings"
 	"time"
 )
@@ -688,6 +689,68 @@ func (c *Client) Digest(path, algorithm string) (*DigestResponse, error) {
 	return &digestResp, nil
 }
 
+// Change is one entry of the server's change log
+type Change struct {
+	Seq  int64  `json:"seq"`
+	Path string `json:"path"`
+	Kind string `json:"kind"` // created, modified, removed, attrib, or tree (everything at or below path)
+}
+
+// EventsResponse represents a page of the server's change log
+type EventsResponse struct {
+	Events []Change `json:"events"`
+	Next   int64    `json:"next"`  // since of the next Events call
+	Reset  bool     `json:"reset"` // changes were missed; drop all cached state
+}
+
+// Events returns the changes with seq >= since, waiting up to timeout for
+// one if there are none yet (the server caps the wait at 60s). Pass
+// since=0 to get the current position, then the Next of each response.
+// Returns ErrNotSupported if the server has no change log.
+func (c *Client) Events(since int64, timeout time.Duration) (*EventsResponse, error) {
+	query := url.Values{}
+	query.Set("since", strconv.FormatInt(since, 10))
+	query.Set("timeout", strconv.FormatFloat(timeout.Seconds(), 'f', -1, 64))
+
+	// The request outlives the client timeout while the server waits
+	pollClient := c.httpClient
+	if pollClient.Timeout != 0 && pollClient.Timeout < timeout+10*time.Second {
+		pollClient = &http.Client{
+			Transport: c.httpClient.Transport,
+			Timeout:   timeout + 10*time.Second,
+		}
+	}
+
+	reqURL := fmt.Sprintf("%s/events?%s", c.baseURL, query.Encode())
+	req, err := http.NewRequest(http.MethodGet, reqURL, nil)
+	if err != nil {
+		return nil, fmt.Errorf("failed to create request: %w", err)
+	}
+
+	resp, err := pollClient.Do(req)
+	if err != nil {
+		return nil, fmt.Errorf("failed to execute request: %w", err)
+	}
+
+	// Older servers have no events endpoint (404); servers whose filesystem
+	// keeps no change log answer 501
+	if resp.StatusCode == http.StatusNotFound || resp.StatusCode == http.StatusNotImplemented {
+		resp.Body.Close()
+		return nil, ErrNotSupported
+	}
+	if resp.StatusCode != http.StatusOK {
+		return nil, c.handleErrorResponse(resp)
+	}
+	defer resp.Body.Close()
+
+	var eventsResp EventsResponse
+	if err := json.NewDecoder(resp.Body).Decode(&eventsResp); err != nil {
+		return nil, fmt.Errorf("failed to decode response: %w", err)
+	}
+
+	return &eventsResp, nil
+}
+
 // OpenHandle opens a file and returns a handle ID
 func (c *Client) OpenHandle(path string, flags OpenFlag, mode uint32) (int64, error) {
 	query := url.Values{}
@@ -6,6 +6,7 @@ import (
 	"net/http/httptest"
 	"strconv"
 	"testing"
+	"time"
 )
 
 func TestClient_Create(t *testing.T) {
@@ -262,3 +263,43 @@ func TestNormalizeBaseURL(t *testing.T) {
 		})
 	}
 }
+
+func TestClient_Events(t *testing.T) {
+	server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+		if r.URL.Path != "/api/v1/events" {
+			t.Errorf("expected /api/v1/events, got %s", r.URL.Path)
+		}
+		if r.URL.Query().Get("since") != "5" || r.URL.Query().Get("timeout") != "1.5" {
+			t.Errorf("unexpected query %s", r.URL.RawQuery)
+		}
+		json.NewEncoder(w).Encode(EventsResponse{
+			Events: []Change{{Seq: 5, Path: "/memfs/a", Kind: "modified"}},
+			Next:   6,
+		})
+	}))
+	defer server.Close()
+
+	client := NewClient(server.URL)
+	resp, err := client.Events(5, 1500*time.Millisecond)
+	if err != nil {
+		t.Fatalf("Events failed: %v", err)
+	}
+	if resp.Next != 6 || resp.Reset || len(resp.Events) != 1 || resp.Events[0].Path != "/memfs/a" {
+		t.Errorf("unexpected response %+v", resp)
+	}
+}
+
+func TestClient_EventsNotSupported(t *testing.T) {
+	for _, status := range []int{http.StatusNotFound, http.StatusNotImplemented} {
+		server := httptest.NewServer(http.HandlerFunc(func(w http.ResponseWriter, r *http.Request) {
+			w.WriteHeader(status)
+			json.NewEncoder(w).Encode(ErrorResponse{Error: "filesystem does not record changes"})
+		}))
+
+		client := NewClient(server.URL)
+		if _, err := client.Events(0, 0); err != ErrNotSupported {
+			t.Errorf("HTTP %d: expected ErrNotSupported, got %v", status, err)
+		}
+		server.Close()
+	}
+}
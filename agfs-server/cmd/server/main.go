@@ -221,6 +221,9 @@ func main() {
 		InstanceMaxRequests: int64(wasmConfig.InstanceMaxRequests),
 		HealthCheckInterval: time.Duration(wasmConfig.HealthCheckInterval) * time.Second,
 		EnableStatistics:    wasmConfig.EnablePoolStatistics,
+		InstanceMaxMemory:   uint64(wasmConfig.InstanceMaxMemoryMB) << 20,
+		TrimMemoryGrowth:    uint64(wasmConfig.TrimMemoryGrowthMB) << 20,
+		InstanceMaxThreads:  wasmConfig.InstanceMaxThreads,
 	}
 
 	// Create mountable file system
@@ -263,10 +266,11 @@ func main() {
 			}
 		}
 
-		// Special handling for serverinfofs: inject traffic monitor
+		// Special handling for serverinfofs: inject traffic monitor and plugin stats
 		if pluginName == "serverinfofs" {
 			if serverInfoPlugin, ok := p.(*serverinfofs.ServerInfoFSPlugin); ok {
 				serverInfoPlugin.SetTrafficMonitor(trafficMonitor)
+				serverInfoPlugin.SetPluginStatsProvider(mfs)
 			}
 		}
 
@@ -84,8 +84,7 @@ impl HostFS {
 
             // Check for error
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
 
             if json_ptr == 0 {
@@ -111,8 +110,7 @@ impl HostFS {
 
             // Check for error
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
 
             if json_ptr == 0 {
@@ -132,8 +130,7 @@ impl HostFS {
         unsafe {
             let err_ptr = host_fs_create(path_c.as_ptr() as *const u8);
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
@@ -146,8 +143,7 @@ impl HostFS {
         unsafe {
             let err_ptr = host_fs_mkdir(path_c.as_ptr() as *const u8, perm);
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
@@ -160,8 +156,7 @@ impl HostFS {
         unsafe {
             let err_ptr = host_fs_remove(path_c.as_ptr() as *const u8);
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
@@ -174,8 +169,7 @@ impl HostFS {
         unsafe {
             let err_ptr = host_fs_remove_all(path_c.as_ptr() as *const u8);
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
@@ -192,8 +186,7 @@ impl HostFS {
                 new_path_c.as_ptr() as *const u8,
             );
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
@@ -206,14 +199,32 @@ impl HostFS {
         unsafe {
             let err_ptr = host_fs_chmod(path_c.as_ptr() as *const u8, mode);
             if err_ptr != 0 {
-                let err_str = read_string_from_ptr(err_ptr);
-                return Err(Error::Other(err_str));
+                return Err(host_error(err_ptr));
             }
             Ok(())
         }
     }
 }
 
+/// Decode a host error string: the host prefixes the message with the code
+/// byte (kind + 1) of its error kind; text without one is kept as Other
+unsafe fn host_error(ptr: u32) -> Error {
+    let text = read_string_from_ptr(ptr);
+    let msg = || text[1..].to_string();
+    match text.as_bytes().first() {
+        Some(1) => Error::NotFound,
+        Some(2) => Error::PermissionDenied,
+        Some(3) => Error::AlreadyExists,
+        Some(4) => Error::IsDirectory,
+        Some(5) => Error::NotDirectory,
+        Some(6) => Error::ReadOnly,
+        Some(7) => Error::InvalidInput(msg()),
+        Some(8) => Error::Io(msg()),
+        Some(9) => Error::Other(msg()),
+        _ => Error::Other(text.clone()),
+    }
+}
+
 /// Read a null-terminated string from a pointer
 unsafe fn read_string_from_ptr(ptr: u32) -> String {
     if ptr == 0 {
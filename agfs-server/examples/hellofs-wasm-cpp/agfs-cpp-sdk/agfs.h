@@ -10,6 +10,14 @@
 // - Type-safe C++ API
 // - Easy-to-use FileSystem base class
 // - Host filesystem access via HostFS
+// - Opt-in TTL caches for host calls (CachedHostFS, CachedHttp)
+// - Read-ahead and write coalescing (BufferedFileSystem)
+// - Deduplicating, LZ4-compressed chunk store on HostFS (ChunkedStore)
+// - Change notifications for host-side cache invalidation (notify_changed)
+// - Path routing with {param} and * segments (Router)
+// - Heap statistics and fixed-size block pools (BlockPool, PoolAllocator)
+// - simd128 base64 / strlen / JSON-escape kernels with scalar fallbacks
+// - spawn / parallel_for on wasi-threads workers (inline without threads)
 // - Automatic FFI handling
 // - Simple export macro
 //
@@ -52,9 +60,18 @@
 
 #include "agfs_types.h"
 #include "agfs_ffi.h"
+#include "agfs_metrics.h"
+#include "agfs_threads.h"
+#include "agfs_memory.h"
 #include "agfs_hostfs.h"
+#include "agfs_notify.h"
 #include "agfs_http.h"
+#include "agfs_cache.h"
+#include "agfs_chunked.h"
 #include "agfs_filesystem.h"
+#include "agfs_buffered.h"
+#include "agfs_router.h"
+#include "agfs_intern.h"
 #include "agfs_export.h"
 
 #endif // AGFS_H
@@ -0,0 +1,227 @@
+#ifndef AGFS_ARENA_H
+#define AGFS_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace agfs {
+
+// Bump allocator for per-call scratch memory
+//
+// Allocation is a pointer bump inside a chunk; individual frees are no-ops
+// (except for the most recent allocation). Memory is reclaimed all at once
+// by rewinding to a Scope mark. Chunks are kept after a rewind, so a pooled
+// instance reaches a steady state where exports do not call malloc for
+// temporaries at all, and linear memory stops fragmenting.
+class Arena {
+private:
+    // Aligned so that data() starts on a max_align_t boundary like malloc
+    struct alignas(std::max_align_t) Chunk {
+        Chunk* next;
+        size_t size;
+        size_t offset; // bytes in all chunks before this one
+        uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 16 * 1024;
+
+    explicit Arena(size_t chunk_size = DEFAULT_CHUNK_SIZE)
+        : chunk_size_(chunk_size), head_(nullptr), current_(nullptr),
+          used_(0), in_use_(0), high_water_(0) {}
+
+    ~Arena() {
+        release(head_);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // The per-instance arena used by the export wrappers
+    static Arena& scratch() {
+        static Arena arena;
+        return arena;
+    }
+
+    void* alloc(size_t size, size_t align = alignof(std::max_align_t)) {
+        if (size == 0) {
+            size = 1;
+        }
+        while (true) {
+            if (current_ != nullptr) {
+                // Align the address itself; chunks only guarantee max_align_t
+                uintptr_t addr = reinterpret_cast<uintptr_t>(current_->data() + used_);
+                size_t start = used_ + ((align - (addr & (align - 1))) & (align - 1));
+                if (start + size <= current_->size) {
+                    used_ = start + size;
+                    in_use_ = current_->offset + used_;
+                    if (in_use_ > high_water_) {
+                        high_water_ = in_use_;
+                    }
+                    return current_->data() + start;
+                }
+            }
+            if (!next_chunk(size + align)) {
+                return nullptr;
+            }
+        }
+    }
+
+    // Give back the most recent allocation; anything else waits for a rewind
+    void free(void* ptr, size_t size) {
+        if (current_ == nullptr || ptr == nullptr) {
+            return;
+        }
+        uint8_t* p = static_cast<uint8_t*>(ptr);
+        if (p + size == current_->data() + used_ && p >= current_->data()) {
+            used_ = p - current_->data();
+            in_use_ = current_->offset + used_;
+        }
+    }
+
+    // Position in the arena that a Scope can rewind to
+    struct Mark {
+        Chunk* chunk;
+        size_t used;
+    };
+
+    Mark mark() const { return Mark{current_, used_}; }
+
+    void rewind(const Mark& m) {
+        current_ = m.chunk;
+        used_ = m.used;
+        in_use_ = current_ ? current_->offset + used_ : 0;
+    }
+
+    // Drop every allocation but keep the chunks for reuse
+    void reset() {
+        current_ = head_;
+        used_ = 0;
+        in_use_ = 0;
+    }
+
+    // Return all chunks but the first to malloc; only valid when nothing
+    // is live (outside any Scope)
+    void trim() {
+        if (head_ != nullptr) {
+            release(head_->next);
+            head_->next = nullptr;
+        }
+        reset();
+    }
+
+    // Bytes handed out since the last reset (including alignment padding)
+    size_t bytes_in_use() const { return in_use_; }
+    // Largest bytes_in_use() seen over the arena's lifetime
+    size_t high_water() const { return high_water_; }
+    // Total bytes held in chunks
+    size_t capacity() const {
+        size_t total = 0;
+        for (Chunk* c = head_; c != nullptr; c = c->next) {
+            total += c->size;
+        }
+        return total;
+    }
+
+    // Rewinds the arena to where it was at construction
+    class Scope {
+    public:
+        explicit Scope(Arena& arena) : arena_(arena), mark_(arena.mark()) {}
+        ~Scope() { arena_.rewind(mark_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena& arena_;
+        Mark mark_;
+    };
+
+private:
+    size_t chunk_size_;
+    Chunk* head_;
+    Chunk* current_;
+    size_t used_;
+    size_t in_use_;
+    size_t high_water_;
+
+    // Advance to the next retained chunk that fits, or allocate one
+    bool next_chunk(size_t min_size) {
+        Chunk* prev = current_;
+        Chunk* c = current_ ? current_->next : head_;
+        while (c != nullptr && c->size < min_size) {
+            prev = c;
+            c = c->next;
+        }
+        if (c == nullptr) {
+            size_t size = min_size > chunk_size_ ? min_size : chunk_size_;
+            c = static_cast<Chunk*>(std::malloc(sizeof(Chunk) + size));
+            if (c == nullptr) {
+                return false;
+            }
+            c->next = nullptr;
+            c->size = size;
+            if (prev == nullptr) {
+                head_ = c;
+            } else {
+                prev->next = c;
+            }
+        }
+        c->offset = prev ? prev->offset + prev->size : 0;
+        current_ = c;
+        used_ = 0;
+        return true;
+    }
+
+    static void release(Chunk* c) {
+        while (c != nullptr) {
+            Chunk* next = c->next;
+            std::free(c);
+            c = next;
+        }
+    }
+};
+
+// STL allocator backed by the scratch arena
+// Containers using it must not outlive the Scope they were filled in.
+template<typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    ArenaAllocator() : arena_(&Arena::scratch()) {}
+    explicit ArenaAllocator(Arena& arena) : arena_(&arena) {}
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->alloc(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        arena_->free(p, n * sizeof(T));
+    }
+
+    Arena* arena() const { return arena_; }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.arena(); }
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.arena(); }
+
+private:
+    Arena* arena_;
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template<typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+} // namespace agfs
+
+#endif // AGFS_ARENA_H
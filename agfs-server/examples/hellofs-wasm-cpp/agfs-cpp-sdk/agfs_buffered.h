@@ -0,0 +1,616 @@
+#ifndef AGFS_BUFFERED_H
+#define AGFS_BUFFERED_H
+
+#include "agfs_types.h"
+#include "agfs_filesystem.h"
+#include "agfs_cache.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace agfs {
+
+namespace internal {
+
+// Whether name lookup of T::write finds the span / vector overload: a plugin
+// that overrides only one of them hides the other
+template<typename T, typename = void>
+struct has_span_write : std::false_type {};
+
+template<typename T>
+struct has_span_write<T, std::void_t<decltype(static_cast<Result<int64_t> (T::*)(
+    const std::string&, ConstByteSpan, int64_t, WriteFlag)>(&T::write))>> : std::true_type {};
+
+template<typename T, typename = void>
+struct has_vector_write : std::false_type {};
+
+template<typename T>
+struct has_vector_write<T, std::void_t<decltype(static_cast<Result<int64_t> (T::*)(
+    const std::string&, const std::vector<uint8_t>&, int64_t, WriteFlag)>(&T::write))>> : std::true_type {};
+
+} // namespace internal
+
+// Read-ahead and write coalescing for plugins that proxy a remote store
+//
+// Wrap the plugin class when exporting it:
+//
+//   AGFS_EXPORT_PLUGIN(agfs::BufferedFileSystem<MyFS>)
+//
+// Reads: each path keeps the offset its last read ended at. A read there
+// (or at 0 on a fresh path) is treated as sequential and the next
+// readahead_bytes are fetched with one Inner::read_into, so a cat of a large
+// file costs one host round trip per window instead of per fs_read. Other
+// reads go straight to Inner. A window is dropped when this instance
+// changes the path and is refetched once it is readahead_ttl_ms old, which
+// bounds how stale changes made elsewhere can be.
+//
+// Writes: the first write to a path goes to Inner as is; small writes
+// continuing it are held in a per-instance buffer and sent as one
+// Inner::write once write_buffer_bytes are pending, on a SYNC write, handle
+// sync/close, trim, shutdown, or before any other call that may observe the
+// file.
+// A deferred write that fails is kept as an error of its path: a read or
+// stat that flushed it returns it, and the next write, sync or close of
+// the path (or shutdown) returns it and clears it, so the writer always
+// learns about lost data. Calls on other paths never see it.
+//
+// Config keys (read in initialize, before Inner::initialize):
+//   readahead_bytes    - read-ahead window per path (default 256KB, 0 disables)
+//   readahead_streams  - paths tracked at once (default 4)
+//   readahead_ttl_ms   - window lifetime (default 1000, 0 keeps windows until invalidated)
+//   write_buffer_bytes - flush threshold (default 256KB, 0 disables coalescing)
+//
+// Buffers live in one instance; with a pooled plugin, another instance
+// only sees coalesced writes once they are flushed, so use it where
+// writers sync or close before others read (the FUSE write pattern).
+template<typename Inner>
+class BufferedFileSystem : public Inner {
+public:
+    static constexpr size_t DEFAULT_READAHEAD_BYTES = 256 * 1024;
+    static constexpr size_t DEFAULT_READAHEAD_STREAMS = 4;
+    static constexpr int64_t DEFAULT_READAHEAD_TTL_MS = 1000;
+    static constexpr size_t DEFAULT_WRITE_BUFFER_BYTES = 256 * 1024;
+
+    using Inner::Inner;
+
+    Result<void> initialize(const Config& config) override {
+        readahead_bytes_ = (size_t)config.get_i64("readahead_bytes", (int64_t)DEFAULT_READAHEAD_BYTES);
+        size_t streams = (size_t)config.get_i64("readahead_streams", (int64_t)DEFAULT_READAHEAD_STREAMS);
+        streams_.assign(streams, Stream());
+        readahead_ttl_ms_ = config.get_i64("readahead_ttl_ms", DEFAULT_READAHEAD_TTL_MS);
+        write_buffer_bytes_ = (size_t)config.get_i64("write_buffer_bytes", (int64_t)DEFAULT_WRITE_BUFFER_BYTES);
+        return Inner::initialize(config);
+    }
+
+    Result<void> shutdown() override {
+        auto flushed = flush();  // including errors nobody has collected yet
+        auto result = Inner::shutdown();
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return result;
+    }
+
+    // Read-ahead windows are refetched on the next sequential read. Pending
+    // writes are sent now, as an idle instance may be destroyed before its
+    // next call; a failure stays recorded for the next write, sync or close
+    // of the path.
+    void trim() override {
+        drop_streams();
+        send_pending();
+        Inner::trim();
+    }
+
+    Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) override {
+        auto flushed = flush_path(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        return Inner::read(path, offset, size);
+    }
+
+    Result<int64_t> read_into(const std::string& path, int64_t offset, ByteSpan out) override {
+        auto flushed = flush_path(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        if (in_readv_ || readahead_bytes_ == 0 || streams_.empty() || out.empty() || offset < 0) {
+            return Inner::read_into(path, offset, out);
+        }
+
+        Stream& s = stream_for(path);
+        if (s.len > 0 && readahead_ttl_ms_ > 0 && monotonic_ms() - s.fetched_at >= readahead_ttl_ms_) {
+            s.len = 0;
+        }
+        size_t done = 0;
+        while (done < out.size()) {
+            int64_t pos = offset + (int64_t)done;
+            ByteSpan rest(out.data() + done, out.size() - done);
+
+            if (pos >= s.start && pos < s.start + (int64_t)s.len) {
+                size_t n = std::min(rest.size(), (size_t)(s.start + (int64_t)s.len - pos));
+                std::memcpy(rest.data(), s.buf.data() + (pos - s.start), n);
+                done += n;
+                continue;
+            }
+
+            if (pos != s.next) {
+                // Random access: no read-ahead
+                auto result = Inner::read_into(path, pos, rest);
+                if (result.is_err()) {
+                    return done > 0 ? Result<int64_t>((int64_t)done) : result;
+                }
+                done += (size_t)result.unwrap();
+                break;
+            }
+
+            size_t want = std::max(readahead_bytes_, rest.size());
+            s.buf.resize(want);
+            auto result = Inner::read_into(path, pos, ByteSpan(s.buf.data(), want));
+            if (result.is_err()) {
+                s.len = 0;
+                return done > 0 ? Result<int64_t>((int64_t)done) : result;
+            }
+            s.start = pos;
+            s.len = (size_t)result.unwrap();
+            s.fetched_at = monotonic_ms();
+            size_t n = std::min(rest.size(), s.len);
+            std::memcpy(rest.data(), s.buf.data(), n);
+            done += n;
+            if (s.len < want) {
+                break; // end of file
+            }
+        }
+        s.next = offset + (int64_t)done;
+        return (int64_t)done;
+    }
+
+    // While in_inner_write_ is set the call comes from inner_write, possibly
+    // through the FileSystem default bridging one overload to the other
+    Result<int64_t> write(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) override {
+        if (in_inner_write_) {
+            if constexpr (internal::has_span_write<Inner>::value) {
+                return Inner::write(path, data, offset, flags);
+            } else {
+                return FileSystem::write(path, data, offset, flags);
+            }
+        }
+        return buffered_write(path, data, offset, flags);
+    }
+
+    Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data, int64_t offset, WriteFlag flags) override {
+        if (in_inner_write_) {
+            if constexpr (internal::has_vector_write<Inner>::value) {
+                return Inner::write(path, data, offset, flags);
+            } else {
+                return FileSystem::write(path, data, offset, flags);
+            }
+        }
+        return buffered_write(path, ConstByteSpan(data), offset, flags);
+    }
+
+    Result<FileInfo> stat(const std::string& path) override {
+        auto flushed = flush_path(path);
+        if (flushed.is_err()) {
+            return flushed.unwrap_err();
+        }
+        return Inner::stat(path);
+    }
+
+    // Listings only need the pending write if it is below the directory;
+    // its errors are left to the writer
+    Result<std::vector<FileInfo>> readdir(const std::string& path) override {
+        if (pending_.active && below(path, pending_.path)) {
+            send_pending();
+        }
+        return Inner::readdir(path);
+    }
+
+    Result<std::string> readdir_page(const std::string& path, const std::string& cursor, DirSink& sink) override {
+        if (pending_.active && below(path, pending_.path)) {
+            send_pending();
+        }
+        return Inner::readdir_page(path, cursor, sink);
+    }
+
+    // The view overloads must reach the buffered paths above even when Inner
+    // overrides them, and the per-path state keeps owned strings anyway
+    Result<FileInfo> stat(std::string_view path) override {
+        return stat(std::string(path));
+    }
+
+    Result<std::vector<FileInfo>> readdir(std::string_view path) override {
+        return readdir(std::string(path));
+    }
+
+    Result<std::vector<uint8_t>> read(std::string_view path, int64_t offset, int64_t size) override {
+        return read(std::string(path), offset, size);
+    }
+
+    Result<int64_t> read_into(std::string_view path, int64_t offset, ByteSpan out) override {
+        return read_into(std::string(path), offset, out);
+    }
+
+    Result<int64_t> write(std::string_view path, ConstByteSpan data, int64_t offset, WriteFlag flags) override {
+        return write(std::string(path), data, offset, flags);
+    }
+
+    // Ranges are random access: only pending writes are flushed. The default
+    // FileSystem::readv comes back through read_into above, which then reads
+    // straight from Inner without touching the read-ahead windows.
+    Result<void> readv(std::string_view path, Span<const ReadRange> ranges, ByteSpan out, Span<int64_t> lengths) override {
+        auto flushed = flush_path(std::string(path));
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        in_readv_ = true;
+        auto result = Inner::readv(path, ranges, out, lengths);
+        in_readv_ = false;
+        return result;
+    }
+
+    Result<void> create(const std::string& path) override {
+        auto flushed = before_change(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Inner::create(path);
+    }
+
+    Result<void> mkdir(const std::string& path, uint32_t perm) override {
+        auto flushed = before_change(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Inner::mkdir(path, perm);
+    }
+
+    Result<void> remove(const std::string& path) override {
+        auto flushed = before_change(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Inner::remove(path);
+    }
+
+    Result<void> remove_all(const std::string& path) override {
+        auto flushed = before_change(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        drop_streams(); // anything below path
+        return Inner::remove_all(path);
+    }
+
+    Result<void> rename(const std::string& old_path, const std::string& new_path) override {
+        auto flushed = before_change(old_path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        drop_streams();
+        return Inner::rename(old_path, new_path);
+    }
+
+    Result<void> chmod(const std::string& path, uint32_t mode) override {
+        auto flushed = flush_path(path);
+        if (flushed.is_err()) {
+            return flushed;
+        }
+        return Inner::chmod(path, mode);
+    }
+
+    // Handles flush pending writes on sync and close. A failed earlier write
+    // of the path is left for the handle's sync or close to report.
+    Result<FileHandle*> open(const std::string& path, OpenFlag flags, uint32_t mode) override {
+        if (pending_.active && pending_.path == path) {
+            send_pending();
+        }
+        auto result = Inner::open(path, flags, mode);
+        if (result.is_err()) {
+            return result;
+        }
+        return static_cast<FileHandle*>(new Handle(*this, result.unwrap()));
+    }
+
+    // Send the pending coalesced write, if any, to Inner, and return (and
+    // clear) the recorded errors of every path
+    Result<void> flush() {
+        send_pending();
+        if (failed_.empty()) {
+            return Result<void>();
+        }
+        Error first = failed_.front().second;
+        failed_.clear();
+        return first;
+    }
+
+private:
+    // Read-ahead state of one path
+    struct Stream {
+        std::string path;
+        int64_t next = 0;  // where the last read ended
+        int64_t start = 0; // file offset of buf
+        size_t len = 0;    // valid bytes in buf
+        int64_t fetched_at = 0; // monotonic_ms() when buf was read
+        uint64_t last_use = 0;
+        std::vector<uint8_t> buf;
+    };
+
+    // A sequence of contiguous writes to one path ending at end
+    // (end < 0 for appends)
+    struct Run {
+        bool active = false;
+        std::string path;
+        int64_t end = 0;
+        WriteFlag flags;
+    };
+
+    // Coalesced writes not yet sent to Inner
+    struct Pending : Run {
+        int64_t offset = 0;
+        std::vector<uint8_t> data;
+    };
+
+    // Delegates to the wrapped handle; sync and close flush the filesystem
+    // first, and writes drop the path's read-ahead window
+    class Handle : public FileHandle {
+    public:
+        Handle(BufferedFileSystem& fs, FileHandle* inner)
+            : FileHandle(inner->path(), inner->flags()), fs_(fs), inner_(inner) {}
+
+        ~Handle() override {
+            delete inner_;
+        }
+
+        Result<int64_t> read_at(ByteSpan buf, int64_t offset) override {
+            return inner_->read_at(buf, offset);
+        }
+
+        Result<int64_t> write_at(ConstByteSpan data, int64_t offset) override {
+            fs_.drop_stream(path());
+            return inner_->write_at(data, offset);
+        }
+
+        Result<FileInfo> stat() override {
+            return inner_->stat();
+        }
+
+        Result<int64_t> read(ByteSpan buf) override {
+            auto result = inner_->read(buf);
+            position_ = inner_->position();
+            return result;
+        }
+
+        Result<int64_t> write(ConstByteSpan data) override {
+            fs_.drop_stream(path());
+            auto result = inner_->write(data);
+            position_ = inner_->position();
+            return result;
+        }
+
+        Result<int64_t> seek(int64_t offset, int whence) override {
+            auto result = inner_->seek(offset, whence);
+            position_ = inner_->position();
+            return result;
+        }
+
+        Result<void> sync() override {
+            auto flushed = fs_.flush_path(path(), true);
+            auto result = inner_->sync();
+            return flushed.is_err() ? flushed : result;
+        }
+
+        Result<void> close() override {
+            auto flushed = fs_.flush_path(path(), true);
+            auto result = inner_->close();
+            return flushed.is_err() ? flushed : result;
+        }
+
+    private:
+        BufferedFileSystem& fs_;
+        FileHandle* inner_;
+    };
+
+    // The first write of a run goes to Inner directly, so errors such as
+    // permission_denied are reported by the write that caused them; the
+    // writes continuing it are buffered
+    Result<int64_t> buffered_write(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        drop_stream(path);
+        auto earlier = take_error(path);
+        if (earlier.is_err()) {
+            last_ = Run();
+            return earlier.unwrap_err();
+        }
+
+        bool bypass = write_buffer_bytes_ == 0 || data.size() >= write_buffer_bytes_ ||
+                      flags.contains(WriteFlag::SYNC);
+        bool buffered = !bypass && (pending_.active ? extends(pending_, path, offset, flags)
+                                                    : extends(last_, path, offset, flags));
+        if (pending_.active && !buffered) {
+            bool same = pending_.path == path;
+            send_pending();
+            auto flushed = same ? take_error(path) : Result<void>();
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        if (!buffered) {
+            auto result = inner_write(path, data, offset, flags);
+            if (result.is_ok()) {
+                last_ = Run{true, path, offset + result.unwrap(), flags};
+            } else {
+                last_ = Run();
+            }
+            return result;
+        }
+
+        if (!pending_.active) {
+            pending_.active = true;
+            pending_.path = path;
+            pending_.offset = offset;
+            pending_.flags = flags;
+            pending_.data.reserve(write_buffer_bytes_);
+        }
+        pending_.data.insert(pending_.data.end(), data.begin(), data.end());
+        pending_.end = appends(offset, flags) ? -1 : pending_.offset + (int64_t)pending_.data.size();
+        if (pending_.data.size() >= write_buffer_bytes_) {
+            auto flushed = flush_path(path, true);
+            if (flushed.is_err()) {
+                return flushed.unwrap_err();
+            }
+        }
+        return (int64_t)data.size();
+    }
+
+    static bool appends(int64_t offset, WriteFlag flags) {
+        return flags.contains(WriteFlag::APPEND) || offset < 0;
+    }
+
+    // Whether a write can follow a run without changing the result: it
+    // continues where the run ends (or both append) and carries no flag
+    // that acts on the file as a whole
+    static bool extends(const Run& run, const std::string& path, int64_t offset, WriteFlag flags) {
+        if (!run.active || path != run.path) {
+            return false;
+        }
+        if (flags.value != 0) {
+            if (flags.value != run.flags.value ||
+                flags.contains(WriteFlag::TRUNCATE) || flags.contains(WriteFlag::EXCLUSIVE)) {
+                return false;
+            }
+        }
+        if (appends(run.end, run.flags) || appends(offset, flags)) {
+            return appends(run.end, run.flags) && appends(offset, flags);
+        }
+        return offset == run.end;
+    }
+
+    Result<int64_t> inner_write(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        in_inner_write_ = true;
+        auto result = write(path, data, offset, flags);
+        in_inner_write_ = false;
+        return result;
+    }
+
+    // Send the pending write; a failure is recorded for its path and
+    // replaces an older one, which the writer has not collected either
+    void send_pending() {
+        if (!pending_.active) {
+            return;
+        }
+        Pending p = std::move(pending_);
+        pending_ = Pending();
+
+        auto result = inner_write(p.path, ConstByteSpan(p.data), p.offset, p.flags);
+        if (result.is_ok() && (size_t)result.unwrap() == p.data.size()) {
+            last_ = p; // later writes continuing it are buffered again
+            return;
+        }
+        last_ = Run();
+        Error error = result.is_err() ? result.unwrap_err() : Error::io("short write while flushing " + p.path);
+        (void)take_error(p.path);
+        failed_.emplace_back(p.path, error);
+    }
+
+    // The recorded error of path, if any; take clears it
+    Result<void> take_error(const std::string& path) {
+        for (auto it = failed_.begin(); it != failed_.end(); ++it) {
+            if (it->first == path) {
+                Error error = it->second;
+                failed_.erase(it);
+                return error;
+            }
+        }
+        return Result<void>();
+    }
+
+    Result<void> peek_error(const std::string& path) const {
+        for (const auto& f : failed_) {
+            if (f.first == path) {
+                return f.second;
+            }
+        }
+        return Result<void>();
+    }
+
+    // Flush path's pending write. A reader gets the error of a flush it
+    // caused and leaves it recorded; a writer (take) gets any recorded
+    // error of the path and clears it.
+    Result<void> flush_path(const std::string& path, bool take = false) {
+        if (!pending_.active || pending_.path != path) {
+            return take ? take_error(path) : Result<void>();
+        }
+        send_pending();
+        return take ? take_error(path) : peek_error(path);
+    }
+
+    // Changes to other paths may move or remove the pending one, so it is
+    // sent first; only an error recorded for path itself is returned (and
+    // cleared, like for a write)
+    Result<void> before_change(const std::string& path) {
+        drop_stream(path);
+        send_pending();
+        last_ = Run();
+        return take_error(path);
+    }
+
+    // "/a" holds "/a/b" and "/a/b/c", not "/ab"
+    static bool below(const std::string& dir, const std::string& path) {
+        size_t n = dir.size();
+        while (n > 0 && dir[n - 1] == '/') {
+            n--;
+        }
+        return path.size() > n && path.compare(0, n, dir, 0, n) == 0 && path[n] == '/';
+    }
+
+    Stream& stream_for(const std::string& path) {
+        Stream* victim = &streams_[0];
+        for (auto& s : streams_) {
+            if (s.path == path) {
+                s.last_use = ++tick_;
+                return s;
+            }
+            if (s.last_use < victim->last_use) {
+                victim = &s;
+            }
+        }
+        victim->path = path;
+        victim->next = 0;
+        victim->start = 0;
+        victim->len = 0;
+        victim->last_use = ++tick_;
+        return *victim;
+    }
+
+    void drop_stream(const std::string& path) {
+        for (auto& s : streams_) {
+            if (s.path == path) {
+                s = Stream();
+            }
+        }
+    }
+
+    void drop_streams() {
+        for (auto& s : streams_) {
+            s = Stream();
+        }
+    }
+
+    size_t readahead_bytes_ = DEFAULT_READAHEAD_BYTES;
+    int64_t readahead_ttl_ms_ = DEFAULT_READAHEAD_TTL_MS;
+    size_t write_buffer_bytes_ = DEFAULT_WRITE_BUFFER_BYTES;
+    std::vector<Stream> streams_ = std::vector<Stream>(DEFAULT_READAHEAD_STREAMS);
+    uint64_t tick_ = 0;
+    Run last_; // the last write sent to Inner
+    Pending pending_;
+    std::vector<std::pair<std::string, Error>> failed_; // deferred write errors by path
+    bool in_inner_write_ = false;
+    bool in_readv_ = false;
+};
+
+} // namespace agfs
+
+#endif // AGFS_BUFFERED_H
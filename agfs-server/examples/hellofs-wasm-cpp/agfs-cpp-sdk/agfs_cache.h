@@ -0,0 +1,504 @@
+#ifndef AGFS_CACHE_H
+#define AGFS_CACHE_H
+
+#include "agfs_types.h"
+#include "agfs_hostfs.h"
+#include "agfs_http.h"
+#include <chrono>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace agfs {
+
+// Monotonic time in milliseconds (WASI clock_time_get)
+inline int64_t monotonic_ms() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Cache settings, usually read from the plugin config in initialize()
+//
+//   cache_enabled          - turns the cache on (default false, or true when
+//                            cache_ttl_ms is set); off it is a pass-through
+//   cache_ttl_ms           - lifetime of a cached result (default 1000)
+//   cache_negative_ttl_ms  - lifetime of a cached not_found (default cache_ttl_ms)
+//   cache_max_entries      - LRU bound on the number of entries (default 4096)
+//   cache_max_bytes        - LRU bound on cached HTTP bodies (default 8MB)
+//
+// The cache is opt-in: each pooled instance keeps its own, so another
+// instance may serve results up to ttl_ms old.
+struct CacheOptions {
+    bool enabled = false;
+    int64_t ttl_ms = 1000;
+    int64_t negative_ttl_ms = 1000;
+    size_t max_entries = 4096;
+    size_t max_bytes = 8 * 1024 * 1024;
+
+    static CacheOptions from_config(const Config& config) {
+        CacheOptions opts;
+        opts.enabled = config.get_bool("cache_enabled", config.contains("cache_ttl_ms"));
+        opts.ttl_ms = config.get_i64("cache_ttl_ms", opts.ttl_ms);
+        opts.negative_ttl_ms = config.get_i64("cache_negative_ttl_ms", opts.ttl_ms);
+        opts.max_entries = (size_t)config.get_i64("cache_max_entries", (int64_t)opts.max_entries);
+        opts.max_bytes = (size_t)config.get_i64("cache_max_bytes", (int64_t)opts.max_bytes);
+        if (opts.ttl_ms <= 0 || opts.max_entries == 0) {
+            opts.enabled = false;
+        }
+        return opts;
+    }
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Size-bounded LRU map whose entries expire after a per-entry TTL
+// Each entry carries a cost (e.g. body bytes); the least recently used
+// entries are evicted once either max_entries or max_cost is exceeded.
+// max_cost = 0 bounds the entry count only.
+template<typename V>
+class TtlCache {
+private:
+    struct Entry {
+        std::string key;
+        V value;
+        int64_t expires_ms;
+        size_t cost;
+    };
+    using List = std::list<Entry>;
+
+public:
+    explicit TtlCache(size_t max_entries = 4096, size_t max_cost = 0)
+        : max_entries_(max_entries), max_cost_(max_cost) {}
+
+    void set_limits(size_t max_entries, size_t max_cost) {
+        max_entries_ = max_entries;
+        max_cost_ = max_cost;
+        evict();
+    }
+
+    // Fresh value for key, or nullptr; expired entries are dropped
+    V* get(const std::string& key) {
+        bool fresh = false;
+        V* value = get_stale(key, &fresh);
+        if (value != nullptr && !fresh) {
+            erase(key);
+            stats_.hits--;
+            stats_.misses++;
+            return nullptr;
+        }
+        return value;
+    }
+
+    // Value for key even when expired, so it can be revalidated
+    V* get_stale(const std::string& key, bool* fresh) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            stats_.misses++;
+            *fresh = false;
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, it->second);
+        stats_.hits++;
+        *fresh = monotonic_ms() < it->second->expires_ms;
+        return &it->second->value;
+    }
+
+    void put(const std::string& key, V value, int64_t ttl_ms, size_t cost = 0) {
+        erase(key);
+        if (max_entries_ == 0 || (max_cost_ != 0 && cost > max_cost_)) {
+            return;
+        }
+        lru_.push_front(Entry{key, std::move(value), monotonic_ms() + ttl_ms, cost});
+        index_[key] = lru_.begin();
+        stats_.bytes += cost;
+        evict();
+    }
+
+    // Give an existing entry a new lifetime
+    void refresh(const std::string& key, int64_t ttl_ms) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->expires_ms = monotonic_ms() + ttl_ms;
+        }
+    }
+
+    void erase(const std::string& key) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            stats_.bytes -= it->second->cost;
+            lru_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    // Drop every key starting with prefix
+    void erase_prefix(const std::string& prefix) {
+        for (auto it = lru_.begin(); it != lru_.end();) {
+            if (it->key.compare(0, prefix.size(), prefix) == 0) {
+                stats_.bytes -= it->cost;
+                index_.erase(it->key);
+                it = lru_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void clear() {
+        lru_.clear();
+        index_.clear();
+        stats_.bytes = 0;
+    }
+
+    size_t size() const {
+        return index_.size();
+    }
+
+    CacheStats stats() const {
+        CacheStats s = stats_;
+        s.entries = index_.size();
+        return s;
+    }
+
+private:
+    void evict() {
+        while (!lru_.empty() &&
+               (lru_.size() > max_entries_ || (max_cost_ != 0 && stats_.bytes > max_cost_))) {
+            stats_.bytes -= lru_.back().cost;
+            index_.erase(lru_.back().key);
+            lru_.pop_back();
+            stats_.evictions++;
+        }
+    }
+
+    size_t max_entries_;
+    size_t max_cost_;
+    List lru_;
+    std::unordered_map<std::string, typename List::iterator> index_;
+    CacheStats stats_;
+};
+
+// HostFS with a TTL cache in front of stat and readdir
+//
+// FUSE clients stat the same paths over and over (getattr storms, ls -l,
+// find), and each stat is a host call. Results, including not_found, are
+// kept for ttl_ms; readdir also fills the stat cache for every entry.
+// Writes, removes and renames made through this object invalidate the
+// affected paths. Changes made elsewhere (by the host, or by another pooled
+// instance of the plugin, which has its own cache) are seen once the TTL
+// runs out, so keep it short when the host tree changes underneath.
+class CachedHostFS {
+private:
+    // A cached stat: the info, or a negative entry for not_found
+    struct StatEntry {
+        bool found;
+        FileInfo info;
+    };
+
+public:
+    explicit CachedHostFS(const CacheOptions& opts = CacheOptions()) {
+        configure(opts);
+    }
+
+    void configure(const CacheOptions& opts) {
+        opts_ = opts;
+        stats_.set_limits(opts.max_entries, 0);
+        dirs_.set_limits(opts.max_entries, 0);
+        if (!opts.enabled) {
+            clear();
+        }
+    }
+
+    Result<FileInfo> stat(const std::string& path) {
+        if (!opts_.enabled) {
+            return HostFS::stat(path);
+        }
+        if (StatEntry* entry = stats_.get(path)) {
+            if (!entry->found) {
+                return Error::not_found();
+            }
+            return entry->info;
+        }
+
+        auto result = HostFS::stat(path);
+        if (result.is_ok()) {
+            stats_.put(path, StatEntry{true, result.unwrap()}, opts_.ttl_ms);
+        } else if (result.unwrap_err().kind == ErrorKind::NotFound) {
+            stats_.put(path, StatEntry{false, FileInfo()}, opts_.negative_ttl_ms);
+        }
+        return result;
+    }
+
+    Result<std::vector<FileInfo>> readdir(const std::string& path) {
+        if (!opts_.enabled) {
+            return HostFS::readdir(path);
+        }
+        if (std::vector<FileInfo>* entries = dirs_.get(path)) {
+            return *entries;
+        }
+
+        auto result = HostFS::readdir(path);
+        if (result.is_ok()) {
+            // ls -l stats each entry right after listing the directory
+            std::string prefix = path == "/" ? path : path + "/";
+            for (const auto& info : result.unwrap()) {
+                stats_.put(prefix + info.name, StatEntry{true, info}, opts_.ttl_ms);
+            }
+            dirs_.put(path, result.unwrap(), opts_.ttl_ms);
+        }
+        return result;
+    }
+
+    // Data is not cached; reads go straight to the host
+    Result<HostBuffer> read(const std::string& path, int64_t offset, int64_t size) {
+        return HostFS::read(path, offset, size);
+    }
+
+    Result<int64_t> read_into(const std::string& path, int64_t offset, ByteSpan out) {
+        return HostFS::read_into(path, offset, out);
+    }
+
+    Result<int64_t> write(const std::string& path, ConstByteSpan data) {
+        invalidate(path);
+        return HostFS::write(path, data);
+    }
+
+    Result<int64_t> write_at(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        invalidate(path);
+        return HostFS::write_at(path, data, offset, flags);
+    }
+
+    Result<void> create(const std::string& path) {
+        invalidate(path);
+        return HostFS::create(path);
+    }
+
+    Result<void> mkdir(const std::string& path, uint32_t perm) {
+        invalidate(path);
+        return HostFS::mkdir(path, perm);
+    }
+
+    Result<void> remove(const std::string& path) {
+        invalidate_tree(path);
+        return HostFS::remove(path);
+    }
+
+    Result<void> remove_all(const std::string& path) {
+        invalidate_tree(path);
+        return HostFS::remove_all(path);
+    }
+
+    Result<void> rename(const std::string& old_path, const std::string& new_path) {
+        invalidate_tree(old_path);
+        invalidate_tree(new_path);
+        return HostFS::rename(old_path, new_path);
+    }
+
+    Result<void> chmod(const std::string& path, uint32_t mode) {
+        invalidate(path);
+        return HostFS::chmod(path, mode);
+    }
+
+    // Forget path and the listing of its parent directory
+    void invalidate(const std::string& path) {
+        stats_.erase(path);
+        dirs_.erase(path);
+        dirs_.erase(parent_of(path));
+    }
+
+    // Forget path, everything below it and the listing of its parent
+    void invalidate_tree(const std::string& path) {
+        invalidate(path);
+        std::string prefix = path == "/" ? path : path + "/";
+        stats_.erase_prefix(prefix);
+        dirs_.erase_prefix(prefix);
+    }
+
+    void clear() {
+        stats_.clear();
+        dirs_.clear();
+    }
+
+    // Combined counters of the stat and readdir caches
+    CacheStats stats() const {
+        CacheStats s = stats_.stats();
+        CacheStats d = dirs_.stats();
+        s.hits += d.hits;
+        s.misses += d.misses;
+        s.evictions += d.evictions;
+        s.entries += d.entries;
+        return s;
+    }
+
+private:
+    static std::string parent_of(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        if (slash == std::string::npos || slash == 0) {
+            return "/";
+        }
+        return path.substr(0, slash);
+    }
+
+    CacheOptions opts_;
+    TtlCache<StatEntry> stats_;
+    TtlCache<std::vector<FileInfo>> dirs_;
+};
+
+// Http with a TTL cache for GET requests
+//
+// Successful GET responses are kept for ttl_ms and 404s for
+// negative_ttl_ms, keyed by URL and request headers and bounded by
+// max_entries and max_bytes of body. An expired response with an ETag or
+// Last-Modified header is revalidated with a conditional request, so an
+// unchanged object costs a 304 rather than the body. Any other method sent
+// through request() invalidates the cached responses for its URL.
+class CachedHttp {
+public:
+    explicit CachedHttp(const CacheOptions& opts = CacheOptions()) {
+        configure(opts);
+    }
+
+    void configure(const CacheOptions& opts) {
+        opts_ = opts;
+        cache_.set_limits(opts.max_entries, opts.max_bytes);
+        if (!opts.enabled) {
+            cache_.clear();
+        }
+    }
+
+    Result<HttpResponse> get(const std::string& url) {
+        return request(HttpRequest::get(url));
+    }
+
+    Result<HttpResponse> request(const HttpRequest& req) {
+        if (!opts_.enabled) {
+            return Http::request(req);
+        }
+        if (req.method != "GET" || !req.body.empty()) {
+            invalidate(req.url);
+            return Http::request(req);
+        }
+        // The caller is revalidating its own copy
+        if (!req.if_none_match.empty() || req.if_modified_since != 0) {
+            return Http::request(req);
+        }
+
+        std::string key = cache_key(req);
+        bool fresh = false;
+        HttpResponse* cached = cache_.get_stale(key, &fresh);
+        if (cached != nullptr && fresh) {
+            return *cached;
+        }
+
+        HttpRequest conditional = req;
+        if (cached != nullptr) {
+            auto etag = cached->headers.find("Etag");
+            if (etag != cached->headers.end()) {
+                conditional.if_none_match = etag->second;
+            }
+            auto modified = cached->headers.find("Last-Modified");
+            if (modified != cached->headers.end()) {
+                conditional.if_modified_since = parse_http_date(modified->second);
+            }
+        }
+
+        auto result = Http::request(conditional);
+        if (!result.is_ok()) {
+            return result;
+        }
+        const HttpResponse& resp = result.unwrap();
+        if (resp.is_not_modified() && cached != nullptr) {
+            cache_.refresh(key, opts_.ttl_ms);
+            return *cached;
+        }
+        if (resp.is_success()) {
+            cache_.put(key, resp, opts_.ttl_ms, resp.body.size());
+        } else if (resp.status_code == 404) {
+            cache_.put(key, resp, opts_.negative_ttl_ms, resp.body.size());
+        } else {
+            cache_.erase(key);
+        }
+        return result;
+    }
+
+    // Forget every cached response for url
+    void invalidate(const std::string& url) {
+        cache_.erase_prefix(url + '\n');
+    }
+
+    void clear() {
+        cache_.clear();
+    }
+
+    CacheStats stats() const {
+        return cache_.stats();
+    }
+
+private:
+    // Responses may depend on any request header (Authorization, Accept, ...)
+    static std::string cache_key(const HttpRequest& req) {
+        std::string key = req.url;
+        key += '\n';
+        for (const auto& [name, value] : req.headers) {
+            key += name;
+            key += ':';
+            key += value;
+            key += '\n';
+        }
+        return key;
+    }
+
+    // Parse an IMF-fixdate ("Sun, 06 Nov 1994 08:49:37 GMT") to unix
+    // seconds, or 0 when the date is in any other form
+    static int64_t parse_http_date(const std::string& date) {
+        static const char* months[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        if (date.size() != 29 || date[3] != ',' || date.compare(26, 3, "GMT") != 0) {
+            return 0;
+        }
+        int month = -1;
+        for (int i = 0; i < 12; i++) {
+            if (date.compare(8, 3, months[i]) == 0) {
+                month = i + 1;
+            }
+        }
+        auto num = [&](size_t pos, size_t len) {
+            int v = 0;
+            for (size_t i = pos; i < pos + len; i++) {
+                if (date[i] < '0' || date[i] > '9') {
+                    return -1;
+                }
+                v = v * 10 + (date[i] - '0');
+            }
+            return v;
+        };
+        int day = num(5, 2), year = num(12, 4);
+        int hour = num(17, 2), minute = num(20, 2), second = num(23, 2);
+        if (month < 0 || day < 0 || year < 0 || hour < 0 || minute < 0 || second < 0) {
+            return 0;
+        }
+
+        // Days since the epoch of a proleptic Gregorian date
+        int y = year - (month <= 2);
+        int era = y / 400;
+        int yoe = y - era * 400;
+        int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        int64_t days = (int64_t)era * 146097 + doe - 719468;
+        return days * 86400 + hour * 3600 + minute * 60 + second;
+    }
+
+    CacheOptions opts_;
+    TtlCache<HttpResponse> cache_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_CACHE_H
@@ -0,0 +1,794 @@
+#ifndef AGFS_CHUNKED_H
+#define AGFS_CHUNKED_H
+
+#include "agfs_types.h"
+#include "agfs_hostfs.h"
+#include "agfs_lz4.h"
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace agfs {
+
+// SHA-256, used to name chunks by their content
+class Sha256 {
+public:
+    static constexpr size_t DIGEST_SIZE = 32;
+    using Digest = std::array<uint8_t, DIGEST_SIZE>;
+
+    Sha256() { reset(); }
+
+    void reset() {
+        static const uint32_t init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        std::memcpy(h_, init, sizeof(h_));
+        block_len_ = 0;
+        total_ = 0;
+    }
+
+    void update(const uint8_t* data, size_t size) {
+        total_ += size;
+        if (block_len_ > 0) {
+            size_t n = std::min(size, sizeof(block_) - block_len_);
+            std::memcpy(block_ + block_len_, data, n);
+            block_len_ += n;
+            data += n;
+            size -= n;
+            if (block_len_ < sizeof(block_)) {
+                return;
+            }
+            compress(block_);
+            block_len_ = 0;
+        }
+        for (; size >= sizeof(block_); data += sizeof(block_), size -= sizeof(block_)) {
+            compress(data);
+        }
+        std::memcpy(block_, data, size);
+        block_len_ = size;
+    }
+
+    Digest finish() {
+        uint64_t bits = total_ * 8;
+        uint8_t pad[72] = {0x80};
+        size_t pad_len = (block_len_ < 56 ? 56 : 120) - block_len_;
+        for (int i = 0; i < 8; i++) {
+            pad[pad_len + i] = (uint8_t)(bits >> (56 - 8 * i));
+        }
+        update(pad, pad_len + 8);
+
+        Digest out;
+        for (int i = 0; i < 8; i++) {
+            out[4 * i] = (uint8_t)(h_[i] >> 24);
+            out[4 * i + 1] = (uint8_t)(h_[i] >> 16);
+            out[4 * i + 2] = (uint8_t)(h_[i] >> 8);
+            out[4 * i + 3] = (uint8_t)h_[i];
+        }
+        reset();
+        return out;
+    }
+
+    static Digest hash(ConstByteSpan data) {
+        Sha256 sha;
+        sha.update(data.data(), data.size());
+        return sha.finish();
+    }
+
+private:
+    uint32_t h_[8];
+    uint8_t block_[64];
+    size_t block_len_;
+    uint64_t total_;
+
+    static uint32_t rotr(uint32_t x, int n) {
+        return (x >> n) | (x << (32 - n));
+    }
+
+    void compress(const uint8_t* p) {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = ((uint32_t)p[4 * i] << 24) | ((uint32_t)p[4 * i + 1] << 16) |
+                   ((uint32_t)p[4 * i + 2] << 8) | (uint32_t)p[4 * i + 3];
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+
+        uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3];
+        uint32_t e = h_[4], f = h_[5], g = h_[6], h = h_[7];
+        for (int i = 0; i < 64; i++) {
+            uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = b;
+            b = a;
+            a = t1 + t2;
+        }
+        h_[0] += a;
+        h_[1] += b;
+        h_[2] += c;
+        h_[3] += d;
+        h_[4] += e;
+        h_[5] += f;
+        h_[6] += g;
+        h_[7] += h;
+    }
+};
+
+// Chunking and compression settings, usually read from the plugin config
+//
+//   chunk_min_bytes     - smallest chunk, except at the end of a file (default 16KB)
+//   chunk_avg_bytes     - target chunk size, rounded down to a power of two (default 64KB)
+//   chunk_max_bytes     - largest chunk (default 256KB)
+//   chunk_compress      - LZ4-compress chunks that shrink (default true)
+//   chunk_index_entries - chunk digests remembered between writes (default 65536)
+struct ChunkOptions {
+    size_t min_bytes = 16 * 1024;
+    size_t avg_bytes = 64 * 1024;
+    size_t max_bytes = 256 * 1024;
+    bool compress = true;
+    size_t index_entries = 65536;
+
+    static ChunkOptions from_config(const Config& config) {
+        ChunkOptions opts;
+        opts.min_bytes = (size_t)config.get_i64("chunk_min_bytes", (int64_t)opts.min_bytes);
+        opts.avg_bytes = (size_t)config.get_i64("chunk_avg_bytes", (int64_t)opts.avg_bytes);
+        opts.max_bytes = (size_t)config.get_i64("chunk_max_bytes", (int64_t)opts.max_bytes);
+        opts.compress = config.get_bool("chunk_compress", opts.compress);
+        opts.index_entries = (size_t)config.get_i64("chunk_index_entries", (int64_t)opts.index_entries);
+        return opts;
+    }
+};
+
+struct ChunkStats {
+    uint64_t chunks_written = 0; // new chunks sent to the host
+    uint64_t chunks_deduped = 0; // chunks the store already had
+    uint64_t bytes_in = 0;       // file bytes passed to write()
+    uint64_t bytes_stored = 0;   // chunk bytes written, after compression
+};
+
+namespace internal {
+
+// Gear table for the rolling hash: 256 splitmix64 outputs
+struct GearTable {
+    uint64_t v[256];
+
+    constexpr GearTable() : v() {
+        uint64_t s = 0;
+        for (int i = 0; i < 256; i++) {
+            s += 0x9E3779B97F4A7C15ull;
+            uint64_t z = s;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            v[i] = z ^ (z >> 31);
+        }
+    }
+};
+
+inline constexpr GearTable GEAR{};
+
+struct DigestHash {
+    size_t operator()(const Sha256::Digest& d) const {
+        size_t h;
+        std::memcpy(&h, d.data(), sizeof(h));
+        return h;
+    }
+};
+
+} // namespace internal
+
+// Content-addressed storage of whole files on the host, for plugins that
+// persist snapshots with HostFS::write and rewrite them nearly unchanged
+//
+//   agfs::ChunkedStore store_;
+//
+//   Result<void> initialize(const Config& config) override {
+//       store_.configure("/local/.chunks", agfs::ChunkOptions::from_config(config));
+//       return store_.open();
+//   }
+//   ... store_.write("/local/ws/state.bin", data)   instead of HostFS::write
+//   ... store_.read_into("/local/ws/state.bin", offset, out)
+//
+// write() splits the data at content-defined boundaries (gear rolling
+// hash, FastCDC-style normalized cut points), so an insert or edit only
+// changes the chunks around it. Chunks are named by SHA-256 and kept under
+// root as <root>/<2 hex>/<64 hex>. Digests not seen before are looked up
+// with one HostBatch stat; only chunks the host does not have are written,
+// LZ4-compressed when that makes them smaller. The file itself becomes a
+// manifest listing its chunks, so a rewrite of a multi-MB file that changed
+// in one place sends a few chunks plus the manifest instead of the whole
+// buffer. read_into() fetches the chunks covering a range in one HostBatch.
+//
+// Chunks and manifests are written to a temp name unique to the instance
+// (<name>.<token>.<n>.tmp) and renamed into place, so readers never see a
+// partial one and pooled instances writing the same name do not collide. Chunks are immutable and shared:
+// overwriting or removing a manifest does not free its chunks; collect()
+// does, given every live manifest, and must not race with writers.
+//
+// Chunk file (little-endian): u8 codec (0 raw, 1 LZ4 block), u8 reserved[3],
+// u32 raw_len, payload.
+// Manifest: u32 magic "AGCM", u16 version, u16 reserved, u32 count,
+// u32 reserved, i64 size, then per chunk: digest[32], u32 raw_len,
+// u32 stored_len (payload bytes).
+class ChunkedStore {
+public:
+    static constexpr uint32_t MANIFEST_MAGIC = 0x4D434741; // "AGCM"
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t MANIFEST_HEADER_SIZE = 24;
+    static constexpr size_t MANIFEST_ENTRY_SIZE = 40;
+    static constexpr size_t CHUNK_HEADER_SIZE = 8;
+    static constexpr uint8_t CODEC_RAW = 0;
+    static constexpr uint8_t CODEC_LZ4 = 1;
+    static constexpr size_t MAX_CHUNK_BYTES = 64 * 1024 * 1024;
+
+    ChunkedStore() { configure(std::string(), ChunkOptions()); }
+
+    explicit ChunkedStore(const std::string& root, const ChunkOptions& opts = ChunkOptions()) {
+        configure(root, opts);
+    }
+
+    void configure(const std::string& root, const ChunkOptions& opts) {
+        root_ = root;
+        while (root_.size() > 1 && root_.back() == '/') {
+            root_.pop_back();
+        }
+        opts_ = opts;
+        // Clamped so the mask below stays in range on 32-bit size_t
+        opts_.min_bytes = std::clamp<size_t>(opts_.min_bytes, 64, MAX_CHUNK_BYTES);
+        opts_.avg_bytes = std::clamp(opts_.avg_bytes, opts_.min_bytes, MAX_CHUNK_BYTES);
+        opts_.max_bytes = std::clamp(opts_.max_bytes, opts_.avg_bytes, MAX_CHUNK_BYTES);
+
+        int bits = 0;
+        while (((size_t)2 << bits) <= opts_.avg_bytes) {
+            bits++;
+        }
+        // Harder to cut before the target size, easier after it
+        mask_small_ = ~0ull << (63 - bits);
+        mask_large_ = ~0ull << (65 - bits);
+        known_.clear();
+        dirs_.reset();
+    }
+
+    // Create the root directory if it does not exist yet
+    Result<void> open() {
+        if (root_.empty()) {
+            return Error::invalid_input("chunk store has no root");
+        }
+        auto info = HostFS::stat(root_);
+        if (info.is_ok()) {
+            return info.unwrap().is_dir ? Result<void>() : Error::not_directory();
+        }
+        if (info.unwrap_err().kind != ErrorKind::NotFound) {
+            return info.unwrap_err();
+        }
+        return HostFS::mkdir(root_, 0755);
+    }
+
+    // Store data as the whole content of path (create or replace)
+    // Returns: Number of bytes written, as HostFS::write
+    Result<int64_t> write(const std::string& path, ConstByteSpan data) {
+        if (root_.empty()) {
+            return Error::invalid_input("chunk store has no root");
+        }
+
+        Manifest manifest;
+        manifest.size = (int64_t)data.size();
+        std::vector<size_t> starts;
+        for (size_t pos = 0; pos < data.size();) {
+            size_t n = cut(data.data() + pos, data.size() - pos);
+            ChunkRef ref;
+            ref.digest = Sha256::hash(ConstByteSpan(data.data() + pos, n));
+            ref.raw_len = (uint32_t)n;
+            auto it = known_.find(ref.digest);
+            ref.stored_len = it != known_.end() ? it->second : 0;
+            manifest.chunks.push_back(ref);
+            starts.push_back(pos);
+            pos += n;
+        }
+
+        // Digests this instance has not seen: one stat batch for all of them
+        uint64_t written = stats_.chunks_written;
+        std::unordered_map<Sha256::Digest, uint32_t, internal::DigestHash> resolved;
+        std::vector<size_t> lookups;
+        for (size_t i = 0; i < manifest.chunks.size(); i++) {
+            const ChunkRef& ref = manifest.chunks[i];
+            if (ref.stored_len == 0 && resolved.emplace(ref.digest, 0).second) {
+                lookups.push_back(i);
+            }
+        }
+        if (!lookups.empty()) {
+            HostBatch batch;
+            for (size_t i : lookups) {
+                batch.stat(chunk_path(manifest.chunks[i].digest));
+            }
+            auto response = batch.submit();
+            if (response.is_err()) {
+                return response.unwrap_err();
+            }
+            const BatchResponse& results = response.unwrap();
+            for (size_t k = 0; k < lookups.size(); k++) {
+                const ChunkRef& ref = manifest.chunks[lookups[k]];
+                const BatchResult& r = results[k];
+                if (r.ok && !r.info.is_dir && r.info.size > (int64_t)CHUNK_HEADER_SIZE) {
+                    resolved[ref.digest] = (uint32_t)(r.info.size - (int64_t)CHUNK_HEADER_SIZE);
+                    continue;
+                }
+                auto stored = store_chunk(ref.digest, ConstByteSpan(data.data() + starts[lookups[k]], ref.raw_len));
+                if (stored.is_err()) {
+                    return stored.unwrap_err();
+                }
+                resolved[ref.digest] = stored.unwrap();
+            }
+        }
+
+        for (ChunkRef& ref : manifest.chunks) {
+            if (ref.stored_len == 0) {
+                ref.stored_len = resolved[ref.digest];
+                remember(ref.digest, ref.stored_len);
+            }
+        }
+        stats_.chunks_deduped += manifest.chunks.size() - (stats_.chunks_written - written);
+        stats_.bytes_in += data.size();
+
+        auto saved = put_file(path, encode(manifest));
+        if (saved.is_err()) {
+            return saved.unwrap_err();
+        }
+        return (int64_t)data.size();
+    }
+
+    // Read up to out.size() bytes of path at offset
+    // Returns: Number of bytes read (0 at end of file)
+    Result<int64_t> read_into(const std::string& path, int64_t offset, ByteSpan out) {
+        if (offset < 0) {
+            return Error::invalid_input("negative offset");
+        }
+        auto loaded = load(path);
+        if (loaded.is_err()) {
+            return loaded.unwrap_err();
+        }
+        const Manifest& manifest = loaded.unwrap();
+        if (offset >= manifest.size || out.empty()) {
+            return (int64_t)0;
+        }
+        int64_t want = std::min((int64_t)out.size(), manifest.size - offset);
+
+        // The pieces of each chunk that fall in [offset, offset + want)
+        struct Piece {
+            const ChunkRef* ref;
+            size_t skip;
+            size_t len;
+            size_t dst;
+        };
+        std::vector<Piece> pieces;
+        HostBatch batch;
+        int64_t start = 0;
+        size_t done = 0;
+        for (const ChunkRef& ref : manifest.chunks) {
+            int64_t end = start + ref.raw_len;
+            if (end > offset) {
+                if (start >= offset + want) {
+                    break;
+                }
+                size_t skip = (size_t)std::max<int64_t>(offset - start, 0);
+                size_t len = (size_t)(std::min(end, offset + want) - start) - skip;
+                pieces.push_back(Piece{&ref, skip, len, done});
+                batch.read(chunk_path(ref.digest), 0, (int64_t)(CHUNK_HEADER_SIZE + ref.stored_len));
+                done += len;
+            }
+            start = end;
+        }
+
+        auto response = batch.submit();
+        if (response.is_err()) {
+            return response.unwrap_err();
+        }
+        const BatchResponse& results = response.unwrap();
+        for (size_t k = 0; k < pieces.size(); k++) {
+            const Piece& piece = pieces[k];
+            const BatchResult& r = results[k];
+            if (!r.ok) {
+                return Error::io("missing chunk " + hex(piece.ref->digest) + ": " + r.error.message);
+            }
+            auto copied = copy_out(*piece.ref, r.data, ByteSpan(out.data() + piece.dst, piece.len), piece.skip);
+            if (copied.is_err()) {
+                return copied.unwrap_err();
+            }
+        }
+        return want;
+    }
+
+    Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) {
+        if (size < 0) {
+            auto total = this->size(path);
+            if (total.is_err()) {
+                return total.unwrap_err();
+            }
+            size = std::max<int64_t>(total.unwrap() - offset, 0);
+        }
+        std::vector<uint8_t> data((size_t)size);
+        auto result = read_into(path, offset, ByteSpan(data));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        data.resize((size_t)result.unwrap());
+        return data;
+    }
+
+    // File size recorded in the manifest at path
+    Result<int64_t> size(const std::string& path) {
+        uint8_t header[MANIFEST_HEADER_SIZE];
+        auto result = HostFS::read_into(path, 0, ByteSpan(header, sizeof(header)));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        if (result.unwrap() != (int64_t)sizeof(header) || get<uint32_t>(header) != MANIFEST_MAGIC) {
+            return Error::io("not a chunk manifest: " + path);
+        }
+        return get<int64_t>(header + 16);
+    }
+
+    // Remove the manifest at path; its chunks stay until collect()
+    Result<void> remove(const std::string& path) {
+        return HostFS::remove(path);
+    }
+
+    // Delete every chunk not referenced by one of manifests
+    // Missing manifests are skipped. Other instances or plugins must not
+    // write to the store meanwhile: a chunk one of them just deduplicated
+    // against could be removed under it.
+    // Returns: Number of chunks removed
+    Result<size_t> collect(Span<const std::string> manifests) {
+        std::unordered_set<Sha256::Digest, internal::DigestHash> live;
+        for (const std::string& path : manifests) {
+            auto loaded = load(path);
+            if (loaded.is_err()) {
+                if (loaded.unwrap_err().kind == ErrorKind::NotFound) {
+                    continue;
+                }
+                return loaded.unwrap_err();
+            }
+            for (const ChunkRef& ref : loaded.unwrap().chunks) {
+                live.insert(ref.digest);
+            }
+        }
+
+        auto top = HostFS::readdir(root_);
+        if (top.is_err()) {
+            return top.unwrap_err();
+        }
+        HostBatch batch;
+        std::vector<std::string> dirs;
+        for (const FileInfo& entry : top.unwrap()) {
+            if (entry.is_dir && entry.name.size() == 2) {
+                dirs.push_back(root_ + "/" + entry.name);
+                batch.readdir(dirs.back());
+            }
+        }
+        auto response = batch.submit();
+        if (response.is_err()) {
+            return response.unwrap_err();
+        }
+
+        size_t removed = 0;
+        const BatchResponse& results = response.unwrap();
+        for (size_t k = 0; k < dirs.size(); k++) {
+            if (!results[k].ok) {
+                continue;
+            }
+            for (const FileInfo& entry : results[k].entries) {
+                Sha256::Digest digest;
+                if (entry.is_dir || !parse_hex(entry.name, digest) || live.count(digest) != 0) {
+                    continue; // .tmp files belong to writes in flight
+                }
+                auto result = HostFS::remove(dirs[k] + "/" + entry.name);
+                if (result.is_err() && result.unwrap_err().kind != ErrorKind::NotFound) {
+                    return result.unwrap_err();
+                }
+                removed++;
+            }
+        }
+        known_.clear();
+        return removed;
+    }
+
+    const ChunkStats& stats() const { return stats_; }
+
+    // Drop the remembered digests, e.g. after the store was changed
+    // behind this instance's back; the next writes stat them again
+    void forget() { known_.clear(); }
+
+private:
+    struct ChunkRef {
+        Sha256::Digest digest;
+        uint32_t raw_len;
+        uint32_t stored_len;
+    };
+
+    struct Manifest {
+        int64_t size = 0;
+        std::vector<ChunkRef> chunks;
+    };
+
+    std::string root_;
+    ChunkOptions opts_;
+    uint64_t mask_small_ = 0;
+    uint64_t mask_large_ = 0;
+    // Digest -> stored_len of chunks known to be on the host
+    std::unordered_map<Sha256::Digest, uint32_t, internal::DigestHash> known_;
+    std::bitset<256> dirs_; // fan-out directories created by this instance
+    uint64_t tmp_seq_ = 0;  // temp names used by this store
+    std::vector<uint8_t> scratch_;
+    ChunkStats stats_;
+
+    // Length of the next chunk of [data, data + size)
+    size_t cut(const uint8_t* data, size_t size) const {
+        if (size <= opts_.min_bytes) {
+            return size;
+        }
+        size_t end = std::min(size, opts_.max_bytes);
+        size_t normal = std::min(end, opts_.avg_bytes);
+        uint64_t h = 0;
+        size_t i = opts_.min_bytes;
+        for (; i < normal; i++) {
+            h = (h << 1) + internal::GEAR.v[data[i]];
+            if ((h & mask_small_) == 0) {
+                return i + 1;
+            }
+        }
+        for (; i < end; i++) {
+            h = (h << 1) + internal::GEAR.v[data[i]];
+            if ((h & mask_large_) == 0) {
+                return i + 1;
+            }
+        }
+        return end;
+    }
+
+    void remember(const Sha256::Digest& digest, uint32_t stored_len) {
+        if (opts_.index_entries == 0) {
+            return;
+        }
+        if (known_.size() >= opts_.index_entries) {
+            known_.clear();
+        }
+        known_.emplace(digest, stored_len);
+    }
+
+    // Write one chunk, compressed if that saves space
+    // Returns: Payload bytes stored
+    Result<uint32_t> store_chunk(const Sha256::Digest& digest, ConstByteSpan raw) {
+        scratch_.resize(CHUNK_HEADER_SIZE + raw.size());
+        uint8_t* payload = scratch_.data() + CHUNK_HEADER_SIZE;
+        size_t stored = 0;
+        uint8_t codec = CODEC_RAW;
+        if (opts_.compress && raw.size() > 1) {
+            stored = lz4::compress(raw.data(), raw.size(), payload, raw.size() - 1);
+            codec = stored != 0 ? CODEC_LZ4 : CODEC_RAW;
+        }
+        if (codec == CODEC_RAW) {
+            std::memcpy(payload, raw.data(), raw.size());
+            stored = raw.size();
+        }
+        std::memset(scratch_.data(), 0, CHUNK_HEADER_SIZE);
+        scratch_[0] = codec;
+        put<uint32_t>(scratch_.data() + 4, (uint32_t)raw.size());
+
+        if (!dirs_[digest[0]]) {
+            // Fails harmlessly when the directory already exists
+            HostFS::mkdir(root_ + "/" + hex(digest).substr(0, 2), 0755);
+            dirs_.set(digest[0]);
+        }
+        std::string path = chunk_path(digest);
+        auto saved = put_file(path, ConstByteSpan(scratch_.data(), CHUNK_HEADER_SIZE + stored));
+        if (saved.is_err()) {
+            // Chunks are content-addressed: a copy another instance stored is as good
+            auto existing = HostFS::stat(path);
+            if (existing.is_err() || existing.unwrap().is_dir) {
+                return saved.unwrap_err();
+            }
+        }
+        stats_.chunks_written++;
+        stats_.bytes_stored += CHUNK_HEADER_SIZE + stored;
+        return (uint32_t)stored;
+    }
+
+    // Copy [skip, skip + out.size()) of a chunk's content into out
+    Result<void> copy_out(const ChunkRef& ref, ConstByteSpan file, ByteSpan out, size_t skip) {
+        if (file.size() != CHUNK_HEADER_SIZE + ref.stored_len ||
+            get<uint32_t>(file.data() + 4) != ref.raw_len) {
+            return Error::io("corrupt chunk " + hex(ref.digest));
+        }
+        const uint8_t* payload = file.data() + CHUNK_HEADER_SIZE;
+        if (file[0] == CODEC_RAW) {
+            if (ref.stored_len != ref.raw_len) {
+                return Error::io("corrupt chunk " + hex(ref.digest));
+            }
+            std::memcpy(out.data(), payload + skip, out.size());
+            return Result<void>();
+        }
+        if (file[0] != CODEC_LZ4) {
+            return Error::io("unknown codec in chunk " + hex(ref.digest));
+        }
+
+        // Whole chunks decompress in place; partial ones through scratch
+        bool whole = skip == 0 && out.size() == ref.raw_len;
+        if (!whole) {
+            scratch_.resize(ref.raw_len);
+        }
+        uint8_t* dst = whole ? out.data() : scratch_.data();
+        if (!lz4::decompress(payload, ref.stored_len, dst, ref.raw_len)) {
+            return Error::io("corrupt chunk " + hex(ref.digest));
+        }
+        if (!whole) {
+            std::memcpy(out.data(), scratch_.data() + skip, out.size());
+        }
+        return Result<void>();
+    }
+
+    // Write a file through a temp name so it appears complete or not at all
+    Result<void> put_file(const std::string& path, ConstByteSpan data) {
+        std::string tmp = path + "." + tmp_token() + "." + std::to_string(++tmp_seq_) + ".tmp";
+        auto written = HostFS::write(tmp, data);
+        if (written.is_err()) {
+            HostFS::remove(tmp);
+            return written.unwrap_err();
+        }
+        auto renamed = HostFS::rename(tmp, path);
+        if (renamed.is_err()) {
+            HostFS::remove(tmp);
+        }
+        return renamed;
+    }
+
+    // Random per-instance part of temp names; instances of a pool share the
+    // host directory but not their counters
+    static const std::string& tmp_token() {
+        static const std::string token = [] {
+            std::random_device rd;
+            uint64_t v = ((uint64_t)rd() << 32) | rd();
+            char buf[17];
+            for (int i = 15; i >= 0; i--, v >>= 4) {
+                buf[i] = "0123456789abcdef"[v & 0xF];
+            }
+            buf[16] = 0;
+            return std::string(buf);
+        }();
+        return token;
+    }
+
+    Result<Manifest> load(const std::string& path) {
+        // One read covers manifests of up to ~100 chunks; larger ones take a second
+        std::vector<uint8_t> buf(4096);
+        auto result = HostFS::read_into(path, 0, ByteSpan(buf));
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        size_t got = (size_t)result.unwrap();
+        if (got < MANIFEST_HEADER_SIZE || get<uint32_t>(buf.data()) != MANIFEST_MAGIC ||
+            get<uint16_t>(buf.data() + 4) != VERSION) {
+            return Error::io("not a chunk manifest: " + path);
+        }
+        size_t count = get<uint32_t>(buf.data() + 8);
+        size_t total = MANIFEST_HEADER_SIZE + count * MANIFEST_ENTRY_SIZE;
+        if (total > got && got == buf.size()) {
+            buf.resize(total);
+            auto rest = HostFS::read_into(path, (int64_t)got, ByteSpan(buf.data() + got, total - got));
+            if (rest.is_err()) {
+                return rest.unwrap_err();
+            }
+            got += (size_t)rest.unwrap();
+        }
+        if (got != total) {
+            return Error::io("truncated chunk manifest: " + path);
+        }
+
+        Manifest manifest;
+        manifest.size = get<int64_t>(buf.data() + 16);
+        manifest.chunks.resize(count);
+        int64_t sum = 0;
+        const uint8_t* p = buf.data() + MANIFEST_HEADER_SIZE;
+        for (ChunkRef& ref : manifest.chunks) {
+            std::memcpy(ref.digest.data(), p, Sha256::DIGEST_SIZE);
+            ref.raw_len = get<uint32_t>(p + 32);
+            ref.stored_len = get<uint32_t>(p + 36);
+            sum += ref.raw_len;
+            p += MANIFEST_ENTRY_SIZE;
+        }
+        if (sum != manifest.size) {
+            return Error::io("corrupt chunk manifest: " + path);
+        }
+        return manifest;
+    }
+
+    static std::vector<uint8_t> encode(const Manifest& manifest) {
+        std::vector<uint8_t> buf(MANIFEST_HEADER_SIZE + manifest.chunks.size() * MANIFEST_ENTRY_SIZE, 0);
+        put<uint32_t>(&buf[0], MANIFEST_MAGIC);
+        put<uint16_t>(&buf[4], VERSION);
+        put<uint32_t>(&buf[8], (uint32_t)manifest.chunks.size());
+        put<int64_t>(&buf[16], manifest.size);
+        uint8_t* p = buf.data() + MANIFEST_HEADER_SIZE;
+        for (const ChunkRef& ref : manifest.chunks) {
+            std::memcpy(p, ref.digest.data(), Sha256::DIGEST_SIZE);
+            put<uint32_t>(p + 32, ref.raw_len);
+            put<uint32_t>(p + 36, ref.stored_len);
+            p += MANIFEST_ENTRY_SIZE;
+        }
+        return buf;
+    }
+
+    std::string chunk_path(const Sha256::Digest& digest) const {
+        std::string name = hex(digest);
+        return root_ + "/" + name.substr(0, 2) + "/" + name;
+    }
+
+    static std::string hex(const Sha256::Digest& digest) {
+        static const char digits[] = "0123456789abcdef";
+        std::string out(Sha256::DIGEST_SIZE * 2, '0');
+        for (size_t i = 0; i < Sha256::DIGEST_SIZE; i++) {
+            out[2 * i] = digits[digest[i] >> 4];
+            out[2 * i + 1] = digits[digest[i] & 15];
+        }
+        return out;
+    }
+
+    static bool parse_hex(const std::string& name, Sha256::Digest& digest) {
+        if (name.size() != Sha256::DIGEST_SIZE * 2) {
+            return false;
+        }
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        };
+        for (size_t i = 0; i < Sha256::DIGEST_SIZE; i++) {
+            int hi = nibble(name[2 * i]);
+            int lo = nibble(name[2 * i + 1]);
+            if (hi < 0 || lo < 0) {
+                return false;
+            }
+            digest[i] = (uint8_t)(hi << 4 | lo);
+        }
+        return true;
+    }
+
+    template<typename T>
+    static void put(uint8_t* p, T v) {
+        std::memcpy(p, &v, sizeof(T));
+    }
+
+    template<typename T>
+    static T get(const uint8_t* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+};
+
+} // namespace agfs
+
+#endif // AGFS_CHUNKED_H
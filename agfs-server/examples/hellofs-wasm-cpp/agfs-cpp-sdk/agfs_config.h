@@ -0,0 +1,195 @@
+#ifndef AGFS_CONFIG_H
+#define AGFS_CONFIG_H
+
+#include "agfs_types.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace agfs {
+
+// Typed configuration parameters declared once by a plugin
+//
+// Each parameter is bound to a plugin member, whose value when add() is
+// called is the default:
+//
+//   class MyFS : public agfs::FileSystem {
+//       std::string root;
+//       int64_t ttl_ms = 1000;
+//       bool verbose = false;
+//       agfs::ConfigSchema schema;
+//   public:
+//       MyFS() {
+//           schema.add("root", &root, "Directory to serve", true)
+//                 .add("ttl_ms", &ttl_ms, "Metadata TTL in ms").range(0, 60000)
+//                 .add("verbose", &verbose, "Log every request");
+//       }
+//       const agfs::ConfigSchema* config_schema() const override { return &schema; }
+//   };
+//
+// The SDK then exports the parameters through plugin_get_config_params,
+// checks them in plugin_validate before FileSystem::validate, and stores
+// the converted values in the members before FileSystem::initialize, so
+// the plugin reads plain fields instead of looking keys up.
+//
+// Keys the schema does not declare are left alone (the host adds some,
+// such as mount_path) and stay readable through Config.
+class ConfigSchema {
+public:
+    using Type = ConfigValue::Type;
+
+    struct Param {
+        std::string name;
+        Type type;
+        bool required;
+        std::string description;
+        ConfigValue default_value;
+        void* target;
+        bool has_range = false;
+        double min = 0;
+        double max = 0;
+    };
+
+    ConfigSchema& add(const char* name, std::string* target, const char* description, bool required = false) {
+        return add_param(name, Type::String, target, ConfigValue::of_string(*target), description, required);
+    }
+
+    ConfigSchema& add(const char* name, int64_t* target, const char* description, bool required = false) {
+        return add_param(name, Type::Int, target, ConfigValue::of_int(*target), description, required);
+    }
+
+    ConfigSchema& add(const char* name, double* target, const char* description, bool required = false) {
+        return add_param(name, Type::Float, target,
+                         ConfigValue::of_float(*target, format_double(*target)), description, required);
+    }
+
+    ConfigSchema& add(const char* name, bool* target, const char* description, bool required = false) {
+        return add_param(name, Type::Bool, target, ConfigValue::of_bool(*target), description, required);
+    }
+
+    // Limit the last added int or float parameter to [min, max]
+    ConfigSchema& range(double min, double max) {
+        if (!params_.empty()) {
+            Param& p = params_.back();
+            p.has_range = true;
+            p.min = min;
+            p.max = max;
+        }
+        return *this;
+    }
+
+    const std::vector<Param>& params() const {
+        return params_;
+    }
+
+    // Check that required parameters are present and every declared one
+    // converts to its type and range
+    Result<void> validate(const Config& config) const {
+        for (const auto& p : params_) {
+            const ConfigValue* v = config.find(p.name);
+            if (v == nullptr) {
+                if (p.required) {
+                    return Error::invalid_input("missing required config parameter " + p.name);
+                }
+                continue;
+            }
+            if (!convertible(p, *v)) {
+                return Error::invalid_input("config parameter " + p.name + ": expected " +
+                                            type_name(p.type) + ", got \"" + v->str + "\"");
+            }
+            if (p.has_range && (v->f64 < p.min || v->f64 > p.max)) {
+                return Error::invalid_input("config parameter " + p.name + ": " + v->str +
+                                            " is out of range [" + format_double(p.min) + ", " +
+                                            format_double(p.max) + "]");
+            }
+        }
+        return Result<void>();
+    }
+
+    // Store each parameter in its member; missing or unconvertible values
+    // (only possible when validate was skipped) restore the default
+    void apply(const Config& config) const {
+        for (const auto& p : params_) {
+            const ConfigValue* v = config.find(p.name);
+            if (v == nullptr || !convertible(p, *v)) {
+                v = &p.default_value;
+            }
+            switch (p.type) {
+                case Type::String:
+                    *static_cast<std::string*>(p.target) = v->str;
+                    break;
+                case Type::Int:
+                    *static_cast<int64_t*>(p.target) = v->i64;
+                    break;
+                case Type::Float:
+                    *static_cast<double*>(p.target) = v->f64;
+                    break;
+                case Type::Bool:
+                    *static_cast<bool*>(p.target) = v->boolean;
+                    break;
+            }
+        }
+    }
+
+    // Type names used by plugin.ConfigParameter on the host
+    static const char* type_name(Type type) {
+        switch (type) {
+            case Type::String: return "string";
+            case Type::Int: return "int";
+            case Type::Float: return "float";
+            case Type::Bool: return "bool";
+        }
+        return "string";
+    }
+
+private:
+    ConfigSchema& add_param(const char* name, Type type, void* target, ConfigValue default_value,
+                            const char* description, bool required) {
+        Param p;
+        p.name = name;
+        p.type = type;
+        p.required = required;
+        p.description = description != nullptr ? description : "";
+        p.default_value = std::move(default_value);
+        p.target = target;
+        params_.push_back(std::move(p));
+        return *this;
+    }
+
+    static bool convertible(const Param& p, const ConfigValue& v) {
+        switch (p.type) {
+            case Type::String:
+                return true;
+            case Type::Int:
+                return v.is_number && (double)v.i64 == v.f64;
+            case Type::Float:
+                return v.is_number;
+            case Type::Bool:
+                if (v.type == Type::Bool) {
+                    return true;
+                }
+                return v.str == "true" || v.str == "false" || v.str == "1" || v.str == "0";
+        }
+        return false;
+    }
+
+    // Shortest decimal form that reads back as value
+    static std::string format_double(double value) {
+        char buf[32];
+        for (int precision = 1; precision <= 17; precision++) {
+            std::snprintf(buf, sizeof(buf), "%.*g", precision, value);
+            if (std::strtod(buf, nullptr) == value) {
+                break;
+            }
+        }
+        return buf;
+    }
+
+    std::vector<Param> params_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_CONFIG_H
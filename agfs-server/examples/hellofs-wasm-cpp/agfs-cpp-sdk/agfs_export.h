@@ -4,6 +4,16 @@
 #include "agfs_types.h"
 #include "agfs_ffi.h"
 #include "agfs_filesystem.h"
+#include "agfs_metrics.h"
+#include "agfs_memory.h"
+#include "agfs_notify.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <optional>
+#include <type_traits>
 
 namespace agfs {
 namespace internal {
@@ -17,21 +27,281 @@ struct PluginInstance {
 template<typename T>
 T* PluginInstance<T>::instance = nullptr;
 
+// Open handles of a plugin instance, keyed by the id returned to the host
+// Ids start at 1 because the host treats 0 as "no handle"
+class HandleTable {
+public:
+    int64_t insert(FileHandle* handle) {
+        int64_t id = next_id_++;
+        handles_[id] = std::unique_ptr<FileHandle>(handle);
+        return id;
+    }
+
+    FileHandle* get(int64_t id) const {
+        auto it = handles_.find(id);
+        if (it == handles_.end()) {
+            return nullptr;
+        }
+        return it->second.get();
+    }
+
+    Result<void> close(int64_t id) {
+        auto it = handles_.find(id);
+        if (it == handles_.end()) {
+            return Error::invalid_input("handle not found");
+        }
+        auto result = it->second->close();
+        handles_.erase(it);
+        return result;
+    }
+
+    void clear() {
+        for (auto& entry : handles_) {
+            entry.second->close();
+        }
+        handles_.clear();
+    }
+
+private:
+    std::map<int64_t, std::unique_ptr<FileHandle>> handles_;
+    int64_t next_id_ = 1;
+};
+
+// DirSink that encodes a readdir page in the BinaryFileInfo layout
+// The page is followed by a u32 length-prefixed resume cursor.
+class BinaryPageSink : public DirSink {
+public:
+    BinaryPageSink(size_t max_entries, size_t max_bytes)
+        : max_entries_(max_entries), max_bytes_(max_bytes), count_(0),
+          buf_(ffi::BinaryFileInfo::HEADER_SIZE) {}
+
+    bool emit(const FileInfo& info) override {
+        if (count_ > 0 && max_entries_ > 0 && count_ >= max_entries_) {
+            return false;
+        }
+        if (!ffi::BinaryFileInfo::fits(info)) {
+            error_ = ffi::BinaryFileInfo::check(&info, 1).unwrap_err();
+            return false;
+        }
+        size_t n = ffi::BinaryFileInfo::entry_size(info);
+        if (count_ > 0 && buf_.size() + n > max_bytes_) {
+            return false;
+        }
+        size_t off = buf_.size();
+        buf_.resize(off + n);
+        ffi::BinaryFileInfo::encode_entry(info, buf_.data() + off);
+        count_++;
+        return true;
+    }
+
+    // Set when an entry too large to encode ended the page
+    const std::optional<Error>& error() const { return error_; }
+
+    // Copy the page into out_buf if it fits, otherwise into a malloc'd buffer
+    uint8_t* finish(const std::string& cursor, uint8_t* out_buf, size_t out_cap) {
+        size_t block = buf_.size();
+        ffi::BinaryFileInfo::encode_header(buf_.data(), block, count_);
+        size_t total = block + 4 + cursor.size();
+        uint8_t* out = out_buf;
+        if (total > out_cap) {
+            out = (uint8_t*)ffi::wasm_malloc(total);
+            if (out == nullptr) {
+                return nullptr;
+            }
+        }
+        uint32_t cursor_len = (uint32_t)cursor.size();
+        std::memcpy(out, buf_.data(), block);
+        std::memcpy(out + block, &cursor_len, 4);
+        std::memcpy(out + block + 4, cursor.data(), cursor.size());
+        return out;
+    }
+
+private:
+    size_t max_entries_;
+    size_t max_bytes_;
+    size_t count_;
+    ArenaVector<uint8_t> buf_;
+    std::optional<Error> error_;
+};
+
+// fs_readv: runs fs.readv over the ranges at ranges_ptr (count records of
+// i64 offset, i64 size) and returns the export's packed result
+// The result is a u32 length per range followed by the ranges' bytes back to
+// back; the slots fs.readv filled are compacted in place to get there. It is
+// written to out_buf when it fits, otherwise to a malloc'd buffer.
+inline uint64_t readv_export(FileSystem& fs, std::string_view path, const uint8_t* ranges_ptr, uint32_t count,
+                             uint8_t* out_buf, size_t out_cap, metrics::ExportScope& metrics) {
+    ArenaVector<ReadRange> ranges(count);
+    size_t header = (size_t)count * 4;
+    uint64_t total = header;
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(&ranges[i].offset, ranges_ptr + (size_t)i * 16, 8);
+        std::memcpy(&ranges[i].size, ranges_ptr + (size_t)i * 16 + 8, 8);
+        if (ranges[i].size < 0) {
+            return ffi::pack_u64(0, ffi::export_error(Error::invalid_input("negative range size")));
+        }
+        total += (uint64_t)ranges[i].size;
+        if (total > UINT32_MAX) {
+            return ffi::pack_u64(0, ffi::export_error(Error::invalid_input("ranges too large")));
+        }
+    }
+
+    uint8_t* buf = out_buf;
+    if (total > out_cap) {
+        buf = (uint8_t*)ffi::wasm_malloc(total);
+        if (buf == nullptr) {
+            return ffi::pack_u64(0, ffi::error_code(ErrorKind::Io));
+        }
+    }
+    ArenaVector<int64_t> lengths(count, 0);
+    auto result = metrics.user([&] {
+        return fs.readv(path, Span<const ReadRange>(ranges.data(), count),
+                        ByteSpan(buf + header, (size_t)(total - header)), Span<int64_t>(lengths.data(), count));
+    });
+    if (result.is_err()) {
+        if (buf != out_buf) {
+            ffi::wasm_free(buf);
+        }
+        return ffi::pack_u64(0, ffi::export_error(result.unwrap_err()));
+    }
+
+    size_t src = header;
+    size_t dst = header;
+    for (uint32_t i = 0; i < count; i++) {
+        int64_t n = lengths[i] < 0 ? 0 : std::min(lengths[i], ranges[i].size);
+        uint32_t len = (uint32_t)n;
+        std::memcpy(buf + (size_t)i * 4, &len, 4);
+        if (dst != src && len > 0) {
+            std::memmove(buf + dst, buf + src, len);
+        }
+        dst += len;
+        src += (size_t)ranges[i].size;
+    }
+    metrics.bytes_out(dst - header);
+    return ffi::pack_u64((uint32_t)(uintptr_t)buf, (uint32_t)dst);
+}
+
+// fs_poll_events: hands the host up to max_events (0 = all) queued change
+// events in the ChangeQueue format, in out_buf when they fit
+// Returns 0 when nothing is queued.
+inline uint64_t poll_events_export(uint8_t* out_buf, size_t out_cap, uint32_t max_events,
+                                   metrics::ExportScope& metrics) {
+    ChangeQueue& queue = ChangeQueue::get();
+    if (queue.empty()) {
+        return 0;
+    }
+    size_t total = queue.encoded_size(max_events);
+    uint8_t* buf = out_buf;
+    if (total > out_cap) {
+        buf = (uint8_t*)ffi::wasm_malloc(total);
+        if (buf == nullptr) {
+            queue.rearm();
+            return 0;
+        }
+    }
+    queue.encode(buf, total, max_events);
+    metrics.bytes_out(total);
+    return ffi::pack_u64((uint32_t)(uintptr_t)buf, (uint32_t)total);
+}
+
+// True if T provides its own readdir_page rather than the readdir() bridge
+template<typename T>
+constexpr bool overrides_readdir_page() {
+    return !std::is_same<decltype(&T::readdir_page), decltype(&FileSystem::readdir_page)>::value;
+}
+
 } // namespace internal
 } // namespace agfs
 
+#ifndef AGFS_SDK_NO_METRICS
+#define AGFS_EXPORT_METRICS \
+    __attribute__((export_name("plugin_get_metrics"))) \
+    char* plugin_get_metrics() { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        return agfs::ffi::copy_string(agfs::metrics::serialize()); \
+    }
+#else
+#define AGFS_EXPORT_METRICS
+#endif
+
+// Pre-initialized snapshots (build with -DAGFS_SDK_SNAPSHOT, then run wizer)
+//
+// wizer calls wizer.initialize once, at build or deploy time: it creates
+// the plugin, validates and initializes it with the JSON config in the
+// AGFS_SNAPSHOT_CONFIG environment variable ("{}" when unset), and wizer
+// then saves the resulting linear memory into the module. Instances of
+// the snapshot start with the plugin constructed and initialized, report
+// it through plugin_snapshot_ready, and skip FileSystem::initialize when
+// the host's config equals the snapshot's (same keys and values, in any
+// order; include mount_path to match a given mount). A different config
+// initializes the instance as usual.
+//
+// A config the plugin rejects aborts the wizer run.
+#ifdef AGFS_SDK_SNAPSHOT
+#define AGFS_EXPORT_SNAPSHOT \
+    __attribute__((export_name("wizer.initialize"))) \
+    void agfs_snapshot_initialize() { \
+        const char* json = std::getenv("AGFS_SNAPSHOT_CONFIG"); \
+        if (json == nullptr) json = "{}"; \
+        plugin_new(); \
+        char* err = plugin_validate(json); \
+        if (err == nullptr) err = plugin_initialize(json); \
+        if (err != nullptr) { \
+            std::fprintf(stderr, "agfs snapshot: %s\n", err); \
+            std::abort(); \
+        } \
+        { \
+            agfs::ffi::ScratchScope scratch_scope; \
+            g_snapshot_config = g_config_cache.parse(json); \
+            g_config_cache.clear(); \
+        } \
+        g_snapshot_ready = true; \
+        /* Counters start at zero in every instance */ \
+        agfs::metrics::registry() = agfs::metrics::Registry(); \
+    }
+#else
+#define AGFS_EXPORT_SNAPSHOT
+#endif
+
 // Export a FileSystem implementation as a WASM plugin
 #define AGFS_EXPORT_PLUGIN(PluginType) \
+    AGFS_EXPORT_HEAP_TRACKING \
+    \
     static PluginType* g_plugin_instance = nullptr; \
+    static agfs::ffi::ConfigCache g_config_cache; \
+    static agfs::internal::HandleTable g_handle_table; \
+    /* Config baked in by wizer.initialize (AGFS_SDK_SNAPSHOT) */ \
+    static agfs::Config g_snapshot_config; \
+    static bool g_snapshot_ready = false; \
+    \
+    /* Transient allocations made while an export runs (parsed config, JSON */ \
+    /* DOMs, serialized strings) come from the scratch arena and are dropped */ \
+    /* by ScratchScope on return; only buffers the host frees use malloc */ \
+    \
+    /* Shared memory buffers for zero-copy optimization */ \
+    /* The host writes small arguments to input_buffer and never frees */ \
+    /* results that point into output_buffer */ \
+    static constexpr size_t SHARED_BUFFER_SIZE = 65536; /* 64KB */ \
+    static uint8_t input_buffer[SHARED_BUFFER_SIZE]; \
+    static uint8_t output_buffer[SHARED_BUFFER_SIZE]; \
     \
     extern "C" { \
     \
     __attribute__((export_name("plugin_new"))) \
     int plugin_new() { \
+        /* A snapshot already holds the initialized plugin */ \
+        if (g_plugin_instance) return 1; \
         g_plugin_instance = new PluginType(); \
         return 1; \
     } \
     \
+    /* 1 when the memory came from a snapshot: the plugin is constructed */ \
+    /* and initialized, so the host can skip plugin_new */ \
+    __attribute__((export_name("plugin_snapshot_ready"))) \
+    uint32_t plugin_snapshot_ready() { \
+        return g_snapshot_ready ? 1 : 0; \
+    } \
+    \
     __attribute__((export_name("plugin_name"))) \
     char* plugin_name() { \
         if (!g_plugin_instance) return nullptr; \
@@ -44,172 +314,512 @@ T* PluginInstance<T>::instance = nullptr;
         return agfs::ffi::copy_string(g_plugin_instance->readme()); \
     } \
     \
+    /* JSON array of plugin.ConfigParameter from config_schema() */ \
+    __attribute__((export_name("plugin_get_config_params"))) \
+    char* plugin_get_config_params() { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        if (!g_plugin_instance) return nullptr; \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        return agfs::ffi::copy_string(agfs::ffi::JsonParser::serialize_config_params(fs.config_schema())); \
+    } \
+    \
     __attribute__((export_name("plugin_validate"))) \
     char* plugin_validate(const char* config_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        agfs::Config config = agfs::ffi::JsonParser::parse_config(config_ptr); \
-        auto result = g_plugin_instance->validate(config); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        const agfs::Config& config = g_config_cache.parse(config_ptr); \
+        if (const agfs::ConfigSchema* schema = fs.config_schema()) { \
+            auto checked = schema->validate(config); \
+            if (checked.is_err()) { \
+                return agfs::ffi::copy_error(checked.unwrap_err()); \
+            } \
+        } \
+        auto result = fs.validate(config); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::copy_error(result.unwrap_err()); \
         } \
         return nullptr; \
     } \
     \
     __attribute__((export_name("plugin_initialize"))) \
     char* plugin_initialize(const char* config_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
-        agfs::Config config = agfs::ffi::JsonParser::parse_config(config_ptr); \
-        auto result = g_plugin_instance->initialize(config); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        const agfs::Config& config = g_config_cache.parse(config_ptr); \
+        if (g_snapshot_ready && config == g_snapshot_config) { \
+            g_config_cache.clear(); \
+            return nullptr; \
+        } \
+        g_snapshot_ready = false; \
+        if (const agfs::ConfigSchema* schema = fs.config_schema()) { \
+            schema->apply(config); \
+        } \
+        auto result = fs.initialize(config); \
+        g_config_cache.clear(); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::copy_error(result.unwrap_err()); \
         } \
         return nullptr; \
     } \
     \
     __attribute__((export_name("plugin_shutdown"))) \
     char* plugin_shutdown() { \
+        agfs::ffi::ScratchScope scratch_scope; \
         if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+        g_handle_table.clear(); \
         auto result = g_plugin_instance->shutdown(); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::copy_error(result.unwrap_err()); \
         } \
         return nullptr; \
     } \
     \
+    /* Per-export counters (agfs_metrics.h) as JSON; freed by the host */ \
+    AGFS_EXPORT_METRICS \
+    \
+    /* Heap usage (agfs_memory.h) as JSON; freed by the host */ \
+    __attribute__((export_name("plugin_memory_stats"))) \
+    char* plugin_memory_stats() { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        return agfs::ffi::copy_string(agfs::memory::serialize(agfs::memory::stats())); \
+    } \
+    \
+    /* Release rebuildable memory while idle; returns the bytes the SDK's */ \
+    /* allocators no longer hold */ \
+    __attribute__((export_name("plugin_trim"))) \
+    uint64_t plugin_trim() { \
+        uint64_t before = agfs::memory::held_bytes(); \
+        if (g_plugin_instance) { \
+            agfs::ffi::ScratchScope scratch_scope; \
+            agfs::FileSystem& fs = *g_plugin_instance; \
+            fs.trim(); \
+        } \
+        /* Outside any ScratchScope, so nothing in the arena is live */ \
+        agfs::Arena::scratch().trim(); \
+        agfs::SmallPools::global().trim(); \
+        uint64_t after = agfs::memory::held_bytes(); \
+        return before > after ? before - after : 0; \
+    } \
+    \
+    /* Build-time initializer run by wizer (AGFS_SDK_SNAPSHOT) */ \
+    AGFS_EXPORT_SNAPSHOT \
+    \
+    /* Optional ABI features the host may use with this module */ \
+    __attribute__((export_name("plugin_abi_caps"))) \
+    uint32_t plugin_abi_caps() { \
+        uint32_t caps = agfs::ffi::ABI_CAP_BINARY_FILEINFO | agfs::ffi::ABI_CAP_ERROR_CODES; \
+        if (agfs::internal::overrides_readdir_page<PluginType>()) { \
+            caps |= agfs::ffi::ABI_CAP_READDIR_PAGE; \
+        } \
+        return caps; \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = data ptr, high 32 bits = size, or */ \
+    /* on error 0 and the export_error value (an empty read is a non-null ptr) */ \
     __attribute__((export_name("fs_read"))) \
     uint64_t fs_read(const char* path_ptr, int64_t offset, int64_t size) { \
-        if (!g_plugin_instance) return 0; \
-        std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->read(path, offset, size); \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsRead); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        /* Bounded reads that fit are filled in place */ \
+        if (size >= 0 && (uint64_t)size <= SHARED_BUFFER_SIZE) { \
+            auto result = metrics.user([&] { return fs.read_into(path, offset, agfs::ByteSpan(output_buffer, (size_t)size)); }); \
+            if (result.is_err()) { \
+                return agfs::ffi::pack_u64(0, agfs::ffi::export_error(result.unwrap_err())); \
+            } \
+            metrics.bytes_out((uint64_t)result.unwrap()); \
+            return agfs::ffi::pack_u64((uint32_t)output_buffer, (uint32_t)result.unwrap()); \
+        } \
+        auto result = metrics.user([&] { return fs.read(path, offset, size); }); \
         if (result.is_err()) { \
-            return 0; \
+            return agfs::ffi::pack_u64(0, agfs::ffi::export_error(result.unwrap_err())); \
         } \
         auto& data = result.unwrap(); \
         uint32_t len = data.size(); \
-        uint8_t* buf = (uint8_t*)agfs::ffi::wasm_malloc(len); \
-        std::memcpy(buf, data.data(), len); \
+        metrics.bytes_out(len); \
+        /* Small reads go through output_buffer; only large ones are heap-allocated */ \
+        uint8_t* buf = output_buffer; \
+        if (len > SHARED_BUFFER_SIZE) { \
+            buf = (uint8_t*)agfs::ffi::wasm_malloc(len); \
+            if (!buf) return agfs::ffi::pack_u64(0, agfs::ffi::error_code(agfs::ErrorKind::Io)); \
+        } \
+        if (len > 0) { \
+            std::memcpy(buf, data.data(), len); \
+        } \
         return agfs::ffi::pack_u64((uint32_t)buf, len); \
     } \
     \
+    /* Vectored read of count {i64 offset, i64 size} ranges at ranges_ptr */ \
+    /* Returns packed u64 like fs_read; the data is a u32 length per range */ \
+    /* followed by the ranges' bytes back to back (see readv_export) */ \
+    __attribute__((export_name("fs_readv"))) \
+    uint64_t fs_readv(const char* path_ptr, const uint8_t* ranges_ptr, uint32_t count) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsReadv); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        return agfs::internal::readv_export(*g_plugin_instance, path, ranges_ptr, count, output_buffer, SHARED_BUFFER_SIZE, metrics); \
+    } \
+    \
+    /* Change notification: the host watches a path, then fetches the */ \
+    /* events notify_changed queued under it (see agfs::ChangeQueue) */ \
+    __attribute__((export_name("fs_watch"))) \
+    uint32_t fs_watch(const char* path_ptr) { \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsWatch); \
+        agfs::ChangeQueue::get().watch(agfs::ffi::read_string_view(path_ptr)); \
+        return 0; \
+    } \
+    \
+    /* Returns packed u64 like fs_read, or 0 when no event is queued */ \
+    __attribute__((export_name("fs_poll_events"))) \
+    uint64_t fs_poll_events(uint32_t max_events) { \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsPollEvents); \
+        return agfs::internal::poll_events_export(output_buffer, SHARED_BUFFER_SIZE, max_events, metrics); \
+    } \
+    \
+    /* JSON fs_stat / fs_readdir: streamed into output_buffer when it fits */ \
     __attribute__((export_name("fs_stat"))) \
     uint64_t fs_stat(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, (uint32_t)agfs::ffi::copy_string("not initialized")); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->stat(path); \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsStat); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        auto result = metrics.user([&] { return fs.stat(path); }); \
         if (result.is_err()) { \
-            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
         } \
-        std::string json = agfs::ffi::JsonParser::serialize_fileinfo(result.unwrap()); \
-        char* json_ptr = agfs::ffi::copy_string(json); \
+        char* json_ptr = agfs::ffi::JsonParser::fileinfo_for_host(result.unwrap(), output_buffer, SHARED_BUFFER_SIZE); \
         return agfs::ffi::pack_u64((uint32_t)json_ptr, 0); \
     } \
     \
     __attribute__((export_name("fs_readdir"))) \
     uint64_t fs_readdir(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, (uint32_t)agfs::ffi::copy_string("not initialized")); \
-        std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->readdir(path); \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsReaddir); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        auto result = metrics.user([&] { return fs.readdir(path); }); \
         if (result.is_err()) { \
-            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
         } \
-        std::string json = agfs::ffi::JsonParser::serialize_fileinfo_array(result.unwrap()); \
-        char* json_ptr = agfs::ffi::copy_string(json); \
+        char* json_ptr = agfs::ffi::JsonParser::fileinfo_array_for_host(result.unwrap(), output_buffer, SHARED_BUFFER_SIZE); \
         return agfs::ffi::pack_u64((uint32_t)json_ptr, 0); \
     } \
     \
+    /* Binary FileInfo variants of fs_stat / fs_readdir (ABI_CAP_BINARY_FILEINFO) */ \
+    /* Returns packed u64: low 32 bits = buffer ptr, high 32 bits = error (export_error) */ \
+    /* Results that fit are written to output_buffer, which the host never frees */ \
+    __attribute__((export_name("fs_stat_bin"))) \
+    uint64_t fs_stat_bin(const char* path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsStatBin); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        auto result = metrics.user([&] { return fs.stat(path); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        auto fits = agfs::ffi::BinaryFileInfo::check(&result.unwrap(), 1); \
+        if (fits.is_err()) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::export_error(fits.unwrap_err())); \
+        } \
+        uint8_t* buf = agfs::ffi::BinaryFileInfo::encode_for_host(&result.unwrap(), 1, output_buffer, SHARED_BUFFER_SIZE); \
+        return agfs::ffi::pack_u64((uint32_t)buf, 0); \
+    } \
+    \
+    __attribute__((export_name("fs_readdir_bin"))) \
+    uint64_t fs_readdir_bin(const char* path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsReaddirBin); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        auto result = metrics.user([&] { return fs.readdir(path); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        auto& entries = result.unwrap(); \
+        auto fits = agfs::ffi::BinaryFileInfo::check(entries.data(), entries.size()); \
+        if (fits.is_err()) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::export_error(fits.unwrap_err())); \
+        } \
+        uint8_t* buf = agfs::ffi::BinaryFileInfo::encode_for_host(entries.data(), entries.size(), output_buffer, SHARED_BUFFER_SIZE); \
+        return agfs::ffi::pack_u64((uint32_t)buf, 0); \
+    } \
+    \
+    /* Paginated readdir: up to max_entries entries (0 = no limit) starting at cursor */ \
+    /* Returns packed u64: low 32 bits = page ptr, high 32 bits = error (export_error) */ \
+    /* The page is a BinaryFileInfo block followed by u32 cursor_len + cursor ("" = done) */ \
+    __attribute__((export_name("fs_readdir_page"))) \
+    uint64_t fs_readdir_page(const char* path_ptr, const char* cursor_ptr, uint32_t max_entries) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsReaddirPage); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::other("not initialized"))); \
+        std::string path = agfs::ffi::read_string(path_ptr); \
+        std::string cursor = agfs::ffi::read_string(cursor_ptr); \
+        /* Leave room for the cursor so typical pages fit in output_buffer */ \
+        agfs::internal::BinaryPageSink sink(max_entries, SHARED_BUFFER_SIZE - 1024); \
+        auto result = metrics.user([&] { return g_plugin_instance->readdir_page(path, cursor, sink); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        if (sink.error()) { \
+            return agfs::ffi::pack_u64(0, agfs::ffi::export_error(*sink.error())); \
+        } \
+        uint8_t* buf = sink.finish(result.unwrap(), output_buffer, SHARED_BUFFER_SIZE); \
+        return agfs::ffi::pack_u64((uint32_t)buf, 0); \
+    } \
+    \
     /* fs_write with offset and flags */ \
-    /* Returns packed u64: high 32 bits = bytes written, low 32 bits = error ptr (0 = success) */ \
+    /* Returns packed u64: high 32 bits = bytes written, low 32 bits = error (export_error, 0 = success) */ \
     __attribute__((export_name("fs_write"))) \
     uint64_t fs_write(const char* path_ptr, const uint8_t* data_ptr, size_t size, int64_t offset, uint32_t flags) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsWrite); \
         if (!g_plugin_instance) { \
-            char* err_ptr = agfs::ffi::copy_string("not initialized"); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            uint32_t err = agfs::ffi::export_error(agfs::Error::other("not initialized")); \
+            return agfs::ffi::pack_u64(err, 0); \
         } \
-        std::string path = agfs::ffi::read_string(path_ptr); \
-        std::vector<uint8_t> data(data_ptr, data_ptr + size); \
-        auto result = g_plugin_instance->write(path, data, offset, agfs::WriteFlag(flags)); \
+        std::string_view path = agfs::ffi::read_string_view(path_ptr); \
+        agfs::FileSystem& fs = *g_plugin_instance; \
+        auto result = metrics.user([&] { return fs.write(path, agfs::ConstByteSpan(data_ptr, size), offset, agfs::WriteFlag(flags)); }); \
         if (result.is_err()) { \
-            char* err_ptr = agfs::ffi::copy_string(result.unwrap_err().to_string()); \
-            return agfs::ffi::pack_u64(0, (uint32_t)err_ptr); \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(err, 0); \
         } \
+        metrics.bytes_in((uint64_t)result.unwrap()); \
         /* Pack bytes_written in high 32 bits, 0 (success) in low 32 bits */ \
-        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+        return agfs::ffi::pack_u64(0, (uint32_t)result.unwrap()); \
     } \
     \
     __attribute__((export_name("fs_create"))) \
-    char* fs_create(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_create(const char* path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsCreate); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->create(path); \
+        auto result = metrics.user([&] { return g_plugin_instance->create(path); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
     __attribute__((export_name("fs_mkdir"))) \
-    char* fs_mkdir(const char* path_ptr, uint32_t perm) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_mkdir(const char* path_ptr, uint32_t perm) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsMkdir); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->mkdir(path, perm); \
+        auto result = metrics.user([&] { return g_plugin_instance->mkdir(path, perm); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
     __attribute__((export_name("fs_remove"))) \
-    char* fs_remove(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_remove(const char* path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsRemove); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->remove(path); \
+        auto result = metrics.user([&] { return g_plugin_instance->remove(path); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
     __attribute__((export_name("fs_remove_all"))) \
-    char* fs_remove_all(const char* path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_remove_all(const char* path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsRemoveAll); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->remove_all(path); \
+        auto result = metrics.user([&] { return g_plugin_instance->remove_all(path); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
     __attribute__((export_name("fs_rename"))) \
-    char* fs_rename(const char* old_path_ptr, const char* new_path_ptr) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_rename(const char* old_path_ptr, const char* new_path_ptr) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsRename); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string old_path = agfs::ffi::read_string(old_path_ptr); \
         std::string new_path = agfs::ffi::read_string(new_path_ptr); \
-        auto result = g_plugin_instance->rename(old_path, new_path); \
+        auto result = metrics.user([&] { return g_plugin_instance->rename(old_path, new_path); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
     __attribute__((export_name("fs_chmod"))) \
-    char* fs_chmod(const char* path_ptr, uint32_t mode) { \
-        if (!g_plugin_instance) return agfs::ffi::copy_string("not initialized"); \
+    uint32_t fs_chmod(const char* path_ptr, uint32_t mode) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::FsChmod); \
+        if (!g_plugin_instance) return agfs::ffi::export_error(agfs::Error::other("not initialized")); \
         std::string path = agfs::ffi::read_string(path_ptr); \
-        auto result = g_plugin_instance->chmod(path, mode); \
+        auto result = metrics.user([&] { return g_plugin_instance->chmod(path, mode); }); \
         if (result.is_err()) { \
-            return agfs::ffi::copy_string(result.unwrap_err().to_string()); \
+            return agfs::ffi::export_error(result.unwrap_err()); \
         } \
-        return nullptr; \
+        return 0; \
     } \
     \
-    /* Shared memory buffers for zero-copy optimization */ \
-    static constexpr size_t SHARED_BUFFER_SIZE = 65536; /* 64KB */ \
-    static uint8_t input_buffer[SHARED_BUFFER_SIZE]; \
-    static uint8_t output_buffer[SHARED_BUFFER_SIZE]; \
+    /* Stateful file handles */ \
+    /* Returns packed u64: high 32 bits = handle id, low 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_open"))) \
+    uint64_t handle_open(const char* path_ptr, uint32_t flags, uint32_t mode) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleOpen); \
+        if (!g_plugin_instance) return agfs::ffi::pack_u64(agfs::ffi::export_error(agfs::Error::other("not initialized")), 0); \
+        std::string path = agfs::ffi::read_string(path_ptr); \
+        auto result = metrics.user([&] { return g_plugin_instance->open(path, agfs::OpenFlag(flags), mode); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(err, 0); \
+        } \
+        int64_t id = g_handle_table.insert(result.unwrap()); \
+        return agfs::ffi::pack_u64(0, (uint32_t)id); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes read, high 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_read"))) \
+    uint64_t handle_read(int64_t id, uint8_t* buf_ptr, size_t size) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleRead); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->read(agfs::ByteSpan(buf_ptr, size)); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        metrics.bytes_out((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
     \
+    /* Returns packed u64: low 32 bits = bytes read, high 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_read_at"))) \
+    uint64_t handle_read_at(int64_t id, uint8_t* buf_ptr, size_t size, int64_t offset) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleReadAt); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->read_at(agfs::ByteSpan(buf_ptr, size), offset); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        metrics.bytes_out((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes written, high 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_write"))) \
+    uint64_t handle_write(int64_t id, const uint8_t* data_ptr, size_t size) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleWrite); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->write(agfs::ConstByteSpan(data_ptr, size)); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        metrics.bytes_in((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = bytes written, high 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_write_at"))) \
+    uint64_t handle_write_at(int64_t id, const uint8_t* data_ptr, size_t size, int64_t offset) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleWriteAt); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->write_at(agfs::ConstByteSpan(data_ptr, size), offset); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        metrics.bytes_in((uint64_t)result.unwrap()); \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = new position, high 32 bits = error (export_error, 0 = success) */ \
+    __attribute__((export_name("handle_seek"))) \
+    uint64_t handle_seek(int64_t id, int64_t offset, int32_t whence) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleSeek); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->seek(offset, whence); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        return agfs::ffi::pack_u64((uint32_t)result.unwrap(), 0); \
+    } \
+    \
+    __attribute__((export_name("handle_sync"))) \
+    uint32_t handle_sync(int64_t id) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleSync); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::export_error(agfs::Error::invalid_input("handle not found")); \
+        auto result = metrics.user([&] { return handle->sync(); }); \
+        if (result.is_err()) { \
+            return agfs::ffi::export_error(result.unwrap_err()); \
+        } \
+        return 0; \
+    } \
+    \
+    /* Returns packed u64: low 32 bits = json ptr, high 32 bits = error (export_error) */ \
+    __attribute__((export_name("handle_stat"))) \
+    uint64_t handle_stat(int64_t id) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleStat); \
+        agfs::FileHandle* handle = g_handle_table.get(id); \
+        if (!handle) return agfs::ffi::pack_u64(0, agfs::ffi::export_error(agfs::Error::invalid_input("handle not found"))); \
+        auto result = metrics.user([&] { return handle->stat(); }); \
+        if (result.is_err()) { \
+            uint32_t err = agfs::ffi::export_error(result.unwrap_err()); \
+            return agfs::ffi::pack_u64(0, err); \
+        } \
+        char* json_ptr = agfs::ffi::JsonParser::fileinfo_for_host(result.unwrap(), output_buffer, SHARED_BUFFER_SIZE); \
+        return agfs::ffi::pack_u64((uint32_t)json_ptr, 0); \
+    } \
+    \
+    __attribute__((export_name("handle_close"))) \
+    uint32_t handle_close(int64_t id) { \
+        agfs::ffi::ScratchScope scratch_scope; \
+        agfs::metrics::ExportScope metrics(agfs::metrics::Op::HandleClose); \
+        auto result = metrics.user([&] { return g_handle_table.close(id); }); \
+        if (result.is_err()) { \
+            return agfs::ffi::export_error(result.unwrap_err()); \
+        } \
+        return 0; \
+    } \
+    \
+    /* Shared memory buffers for zero-copy optimization */ \
     __attribute__((export_name("get_input_buffer_ptr"))) \
     uint8_t* get_input_buffer_ptr() { \
         return input_buffer; \
@@ -2,15 +2,40 @@
 #define AGFS_FFI_H
 
 #include "agfs_types.h"
-#include "json.hpp"
+#include "agfs_config.h"
+#include "agfs_arena.h"
+#include "agfs_simd.h"
+#include "agfs_json.h"
 #include <cstring>
 #include <cstdlib>
+#include <string_view>
+
+// The SDK itself reads and writes JSON with agfs_json.h, so nlohmann/json
+// and its 24k lines are left out of every translation unit and of the
+// module unless a plugin that uses it builds with -DAGFS_SDK_WITH_NLOHMANN.
+#ifdef AGFS_SDK_WITH_NLOHMANN
+#include "json.hpp"
 
 using json = nlohmann::json;
+#endif
 
 namespace agfs {
 namespace ffi {
 
+#ifdef AGFS_SDK_WITH_NLOHMANN
+// JSON DOM whose nodes and strings live in the scratch arena
+using ScratchJson = nlohmann::basic_json<std::map, std::vector, ArenaString, bool,
+                                         std::int64_t, std::uint64_t, double, ArenaAllocator>;
+#endif
+
+// Rewinds the scratch arena when an export returns
+// Every export opens one of these before touching plugin code; anything that
+// must outlive the call (buffers handed to the host) goes through wasm_malloc.
+class ScratchScope : public Arena::Scope {
+public:
+    ScratchScope() : Arena::Scope(Arena::scratch()) {}
+};
+
 // Memory management functions
 inline void* wasm_malloc(size_t size) {
     return malloc(size);
@@ -21,21 +46,87 @@ inline void wasm_free(void* ptr) {
 }
 
 // String helpers
-inline char* copy_string(const std::string& str) {
-    if (str.empty()) {
+inline char* copy_string(const char* data, size_t len) {
+    if (len == 0) {
         return nullptr;
     }
-    char* buf = (char*)wasm_malloc(str.length() + 1);
-    std::memcpy(buf, str.c_str(), str.length());
-    buf[str.length()] = '\0';
+    char* buf = (char*)wasm_malloc(len + 1);
+    if (buf == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(buf, data, len);
+    buf[len] = '\0';
     return buf;
 }
 
+inline char* copy_string(const std::string& str) {
+    return copy_string(str.data(), str.length());
+}
+
+inline char* copy_string(const ArenaString& str) {
+    return copy_string(str.data(), str.length());
+}
+
+inline char* copy_string(const char* str) {
+    if (str == nullptr) {
+        return nullptr;
+    }
+    return copy_string(str, simd::strlen(str));
+}
+
+// Copy an error message into a host-owned buffer without a temporary string
+inline char* copy_error(const Error& err) {
+    if (!err.message.empty()) {
+        return copy_string(err.message);
+    }
+    return copy_string(Error::default_message(err.kind));
+}
+
+// Error slot of the fs_* and handle_* exports (ABI_CAP_ERROR_CODES)
+//
+// An error with its kind's default message is sent as the bare code
+// kind + 1, below ERROR_CODE_LIMIT and so never a pointer (the first 1KB
+// of linear memory holds no data), and costs no allocation; common misses
+// such as Error::not_found() take this path. Any other message is a
+// malloc'd string of that code byte followed by the message. Either way
+// the host gets the ErrorKind. 0 is success.
+constexpr uint32_t ERROR_CODE_LIMIT = 256;
+
+inline uint32_t error_code(ErrorKind kind) {
+    return (uint32_t)kind + 1;
+}
+
+inline uint32_t export_error(const Error& err) {
+    uint32_t code = error_code(err.kind);
+    const char* fallback = Error::default_message(err.kind);
+    if (err.message.empty() || err.message == fallback) {
+        return code;
+    }
+    size_t len = err.message.size();
+    char* buf = (char*)wasm_malloc(len + 2);
+    if (buf == nullptr) {
+        return code;
+    }
+    buf[0] = (char)code;
+    std::memcpy(buf + 1, err.message.data(), len);
+    buf[len + 1] = '\0';
+    return (uint32_t)(uintptr_t)buf;
+}
+
 inline std::string read_string(const char* ptr) {
     if (ptr == nullptr) {
         return "";
     }
-    return std::string(ptr);
+    return std::string(ptr, simd::strlen(ptr));
+}
+
+// View a NUL-terminated host string in place, without copying it
+// Valid until the export returns.
+inline std::string_view read_string_view(const char* ptr) {
+    if (ptr == nullptr) {
+        return std::string_view();
+    }
+    return std::string_view(ptr, simd::strlen(ptr));
 }
 
 // Pack two u32 into u64
@@ -49,104 +140,448 @@ inline void unpack_u64(uint64_t packed, uint32_t& low, uint32_t& high) {
     high = (uint32_t)((packed >> 32) & 0xFFFFFFFF);
 }
 
-// JSON parsing helpers using nlohmann/json
+// JSON helpers for the exports and HostFS replies
 class JsonParser {
 public:
+    // Top-level string, number and bool members; anything else is skipped.
+    // Malformed JSON gives an empty config.
     static Config parse_config(const char* json_str) {
         Config config;
         if (json_str == nullptr) {
             return config;
         }
 
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_object()) {
+        JsonReader r(read_string_view(json_str));
+        std::string key;
+        if (!r.begin_object()) {
             return config;
         }
-
-        for (auto& [key, value] : j.items()) {
-            if (value.is_string()) {
-                config.values[key] = value.get<std::string>();
-            } else if (value.is_number()) {
-                config.values[key] = std::to_string(value.get<double>());
-            } else if (value.is_boolean()) {
-                config.values[key] = value.get<bool>() ? "true" : "false";
+        while (r.next_member(key)) {
+            switch (r.peek()) {
+                case JsonReader::Type::String: {
+                    std::string value;
+                    if (r.read_string(value)) {
+                        config.set(std::move(key), ConfigValue::of_string(std::move(value)));
+                    }
+                    break;
+                }
+                case JsonReader::Type::Number: {
+                    JsonReader::Number num;
+                    if (!r.read_number(num)) {
+                        break;
+                    }
+                    if (num.is_integer) {
+                        config.set(std::move(key), ConfigValue::of_int(num.i64));
+                    } else {
+                        config.set(std::move(key), ConfigValue::of_float(
+                            num.f64, std::string(num.text.data(), num.text.size())));
+                    }
+                    break;
+                }
+                case JsonReader::Type::Bool: {
+                    bool value;
+                    if (r.read_bool(value)) {
+                        config.set(std::move(key), ConfigValue::of_bool(value));
+                    }
+                    break;
+                }
+                default:
+                    r.skip_value();
+                    break;
             }
         }
-
+        if (r.failed() || !r.at_end()) {
+            return Config();
+        }
         return config;
     }
 
-    static std::string serialize_fileinfo(const FileInfo& info) {
-        json j = {
-            {"Name", info.name},
-            {"Size", info.size},
-            {"Mode", info.mode},
-            {"ModTime", "0001-01-01T00:00:00Z"},
-            {"IsDir", info.is_dir}
-        };
+    // plugin.ConfigParameter array for plugin_get_config_params
+    // The returned string lives in the scratch arena.
+    static ArenaString serialize_config_params(const ConfigSchema* schema) {
+        return write_json([&](JsonWriter& w) {
+            w.begin_array();
+            if (schema != nullptr) {
+                for (const auto& p : schema->params()) {
+                    w.begin_object();
+                    w.key("name").string(p.name);
+                    w.key("type").string(ConfigSchema::type_name(p.type));
+                    w.key("required").boolean(p.required);
+                    w.key("default").string(p.required ? std::string_view() : p.default_value.str);
+                    w.key("description").string(p.description);
+                    w.end_object();
+                }
+            }
+            w.end_array();
+        });
+    }
 
+    // filesystem.FileInfo JSON ({"Name":...,"ModTime":"<RFC3339>",...,"Meta":{...}})
+    static void write_fileinfo(JsonWriter& w, const FileInfo& info) {
+        w.begin_object();
+        w.key("Name").string(info.name);
+        w.key("Size").number(info.size);
+        w.key("Mode").number((uint64_t)info.mode);
+        w.key("ModTime").time(info.mod_time);
+        w.key("IsDir").boolean(info.is_dir);
         if (info.meta.has_value()) {
-            auto meta_content = json::parse(info.meta->content, nullptr, false);
-            j["Meta"] = {
-                {"Name", info.meta->name},
-                {"Type", info.meta->type},
-                {"Content", meta_content.is_discarded() ? json{} : meta_content}
-            };
+            const MetaData& m = *info.meta;
+            w.key("Meta").begin_object();
+            w.key("Name").string(m.name);
+            w.key("Type").string(m.type);
+            // Content is passed through when it is valid JSON
+            w.key("Content");
+            if (JsonReader::accept(m.content)) {
+                w.raw_value(m.content);
+            } else {
+                w.null();
+            }
+            w.end_object();
         }
+        w.end_object();
+    }
 
-        return j.dump();
+    static void write_fileinfo_array(JsonWriter& w, const FileInfo* infos, size_t count) {
+        w.begin_array();
+        for (size_t i = 0; i < count; i++) {
+            write_fileinfo(w, infos[i]);
+        }
+        w.end_array();
     }
 
-    static std::string serialize_fileinfo_array(const std::vector<FileInfo>& infos) {
-        json j = json::array();
-        for (const auto& info : infos) {
-            j.push_back({
-                {"Name", info.name},
-                {"Size", info.size},
-                {"Mode", info.mode},
-                {"ModTime", "0001-01-01T00:00:00Z"},
-                {"IsDir", info.is_dir}
-            });
+    // NUL-terminated JSON for the host, written by write(JsonWriter&) into
+    // out_buf when it fits (the host never frees that) and into a
+    // wasm_malloc'd buffer otherwise
+    template <typename Write>
+    static char* write_for_host(Write&& write, uint8_t* out_buf, size_t out_cap) {
+        JsonWriter w((char*)out_buf, out_cap > 0 ? out_cap - 1 : 0);
+        write(w);
+        if (!w.overflow()) {
+            out_buf[w.size()] = '\0';
+            return (char*)out_buf;
+        }
+        size_t size = w.size();
+        char* buf = (char*)wasm_malloc(size + 1);
+        if (buf == nullptr) {
+            return nullptr;
         }
-        return j.dump();
+        JsonWriter exact(buf, size);
+        write(exact);
+        buf[size] = '\0';
+        return buf;
     }
 
-    static FileInfo parse_fileinfo(const std::string& json_str) {
-        FileInfo info;
+    static char* fileinfo_for_host(const FileInfo& info, uint8_t* out_buf, size_t out_cap) {
+        return write_for_host([&](JsonWriter& w) { write_fileinfo(w, info); }, out_buf, out_cap);
+    }
 
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_object()) {
-            return info;
-        }
+    static char* fileinfo_array_for_host(const std::vector<FileInfo>& infos,
+                                         uint8_t* out_buf, size_t out_cap) {
+        return write_for_host([&](JsonWriter& w) { write_fileinfo_array(w, infos.data(), infos.size()); },
+                              out_buf, out_cap);
+    }
+
+    // The returned string lives in the scratch arena; copy it out before the
+    // enclosing ScratchScope ends
+    static ArenaString serialize_fileinfo(const FileInfo& info) {
+        return write_json([&](JsonWriter& w) { write_fileinfo(w, info); });
+    }
 
-        info.name = j.value("Name", "");
-        info.size = j.value("Size", 0);
-        info.mode = j.value("Mode", 0);
-        info.is_dir = j.value("IsDir", false);
+    static ArenaString serialize_fileinfo_array(const std::vector<FileInfo>& infos) {
+        return write_json([&](JsonWriter& w) { write_fileinfo_array(w, infos.data(), infos.size()); });
+    }
 
+    static FileInfo parse_fileinfo(const std::string& json_str) {
+        FileInfo info;
+        JsonReader r(json_str);
+        if (!read_fileinfo(r, info) || !r.at_end()) {
+            return FileInfo();
+        }
         return info;
     }
 
     static std::vector<FileInfo> parse_fileinfo_array(const std::string& json_str) {
         std::vector<FileInfo> infos;
-
-        auto j = json::parse(json_str, nullptr, false);
-        if (j.is_discarded() || !j.is_array()) {
+        JsonReader r(json_str);
+        if (!r.begin_array()) {
             return infos;
         }
+        while (r.next_element()) {
+            if (r.peek() != JsonReader::Type::Object) {
+                r.skip_value();
+                continue;
+            }
+            FileInfo info;
+            if (read_fileinfo(r, info)) {
+                infos.push_back(std::move(info));
+            }
+        }
+        if (r.failed() || !r.at_end()) {
+            return std::vector<FileInfo>();
+        }
+        return infos;
+    }
 
-        for (const auto& item : j) {
-            if (!item.is_object()) continue;
+private:
+    // One filesystem.FileInfo object; unknown members, Meta and members of
+    // the wrong type are skipped
+    static bool read_fileinfo(JsonReader& r, FileInfo& info) {
+        std::string key;
+        if (!r.begin_object()) {
+            return false;
+        }
+        while (r.next_member(key)) {
+            JsonReader::Type type = r.peek();
+            JsonReader::Number num;
+            if (key == "Name" && type == JsonReader::Type::String) {
+                r.read_string(info.name);
+            } else if (key == "ModTime" && type == JsonReader::Type::String) {
+                std::string text;
+                if (r.read_string(text)) {
+                    parse_rfc3339(text, info.mod_time);
+                }
+            } else if (key == "IsDir" && type == JsonReader::Type::Bool) {
+                r.read_bool(info.is_dir);
+            } else if ((key == "Size" || key == "Mode") && type == JsonReader::Type::Number) {
+                if (r.read_number(num) && num.is_integer) {
+                    if (key == "Size") {
+                        info.size = num.i64;
+                    } else {
+                        info.mode = (uint32_t)num.i64;
+                    }
+                }
+            } else {
+                r.skip_value();
+            }
+        }
+        return !r.failed();
+    }
+};
+
+// The host sends the same config JSON to plugin_validate and then to
+// plugin_initialize; the config parsed by the first is reused by the second
+class ConfigCache {
+public:
+    const Config& parse(const char* json_str) {
+        std::string_view text = read_string_view(json_str);
+        if (!valid_ || text != json_) {
+            config_ = JsonParser::parse_config(json_str);
+            json_.assign(text.data(), text.size());
+            valid_ = true;
+        }
+        return config_;
+    }
+
+    void clear() {
+        valid_ = false;
+        json_ = std::string();
+        config_ = Config();
+    }
+
+private:
+    bool valid_ = false;
+    std::string json_;
+    Config config_;
+};
+
+// ABI capabilities reported to the host by the plugin_abi_caps export
+constexpr uint32_t ABI_CAP_BINARY_FILEINFO = 1u << 0; // fs_stat_bin / fs_readdir_bin
+constexpr uint32_t ABI_CAP_READDIR_PAGE = 1u << 1;    // fs_readdir_page is lazy (readdir_page overridden)
+constexpr uint32_t ABI_CAP_ERROR_CODES = 1u << 2;     // error slots hold export_error values
+
+// Compact binary FileInfo encoding (version 1, little-endian)
+// Must stay in sync with pkg/plugin/api/fileinfo_codec.go:
+//   header: u32 total_len (including header), u16 version, u16 reserved, u32 count
+//   entry:  i64 size, i64 mod_time, u32 mode, u8 is_dir, u8 flags, u16 name_len, name
+//           if flags & HAS_META: u16 len + meta name, u16 len + meta type,
+//                                u32 len + meta content (JSON)
+class BinaryFileInfo {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t ENTRY_FIXED_SIZE = 8 + 8 + 4 + 1 + 1 + 2;
+    static constexpr uint8_t FLAG_HAS_META = 1 << 0;
+
+    static size_t entry_size(const FileInfo& info) {
+        size_t size = ENTRY_FIXED_SIZE + info.name.size();
+        if (info.meta.has_value()) {
+            const MetaData& m = *info.meta;
+            size += 2 + m.name.size() + 2 + m.type.size() + 4 + m.content.size();
+        }
+        return size;
+    }
+
+    // Whether the lengths of info fit their u16 / u32 fields
+    static bool fits(const FileInfo& info) {
+        if (info.name.size() > 0xFFFF) {
+            return false;
+        }
+        if (info.meta.has_value()) {
+            const MetaData& m = *info.meta;
+            return m.name.size() <= 0xFFFF && m.type.size() <= 0xFFFF && (uint64_t)m.content.size() <= 0xFFFFFFFF;
+        }
+        return true;
+    }
+
+    // Error for an entry that does not fit, or success
+    static Result<void> check(const FileInfo* infos, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            if (!fits(infos[i])) {
+                return Error::invalid_input("file info too large to encode: " + infos[i].name.substr(0, 256));
+            }
+        }
+        return Result<void>();
+    }
+
+    static size_t encoded_size(const FileInfo* infos, size_t count) {
+        size_t size = HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            size += entry_size(infos[i]);
+        }
+        return size;
+    }
+
+    static void encode_header(uint8_t* out, size_t total, size_t count) {
+        put<uint32_t>(out, (uint32_t)total);
+        put<uint16_t>(out + 4, VERSION);
+        put<uint16_t>(out + 6, 0);
+        put<uint32_t>(out + 8, (uint32_t)count);
+    }
+
+    // Encode one entry at p (entry_size(info) bytes); returns the end of it
+    // info must fit (see fits()), or its lengths are truncated
+    static uint8_t* encode_entry(const FileInfo& info, uint8_t* p) {
+        put<int64_t>(p, info.size);
+        put<int64_t>(p + 8, info.mod_time);
+        put<uint32_t>(p + 16, info.mode);
+        p[20] = info.is_dir ? 1 : 0;
+        p[21] = info.meta.has_value() ? FLAG_HAS_META : 0;
+        put<uint16_t>(p + 22, (uint16_t)info.name.size());
+        p += ENTRY_FIXED_SIZE;
+        p = put_bytes(p, info.name);
 
+        if (info.meta.has_value()) {
+            const MetaData& m = *info.meta;
+            put<uint16_t>(p, (uint16_t)m.name.size());
+            p = put_bytes(p + 2, m.name);
+            put<uint16_t>(p, (uint16_t)m.type.size());
+            p = put_bytes(p + 2, m.type);
+            put<uint32_t>(p, (uint32_t)m.content.size());
+            p = put_bytes(p + 4, m.content);
+        }
+        return p;
+    }
+
+    // Encode into out, which must hold encoded_size(infos, count) bytes
+    static void encode(const FileInfo* infos, size_t count, uint8_t* out, size_t total) {
+        encode_header(out, total, count);
+        uint8_t* p = out + HEADER_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            p = encode_entry(infos[i], p);
+        }
+    }
+
+    // Encode into a host-owned buffer; uses out_buf when the result fits
+    // Callers check() the entries first.
+    static uint8_t* encode_for_host(const FileInfo* infos, size_t count,
+                                    uint8_t* out_buf, size_t out_cap) {
+        size_t total = encoded_size(infos, count);
+        uint8_t* buf = out_buf;
+        if (total > out_cap) {
+            buf = (uint8_t*)wasm_malloc(total);
+            if (buf == nullptr) {
+                return nullptr;
+            }
+        }
+        encode(infos, count, buf, total);
+        return buf;
+    }
+
+    // Decode a buffer produced by the host; returns false if it is malformed
+    static bool decode(const uint8_t* data, std::vector<FileInfo>& out) {
+        if (data == nullptr) {
+            return false;
+        }
+        uint32_t total = get<uint32_t>(data);
+        if (total < HEADER_SIZE || get<uint16_t>(data + 4) != VERSION) {
+            return false;
+        }
+        uint32_t count = get<uint32_t>(data + 8);
+        if ((uint64_t)count * ENTRY_FIXED_SIZE > total) {
+            return false;
+        }
+
+        const uint8_t* p = data + HEADER_SIZE;
+        const uint8_t* end = data + total;
+        out.clear();
+        out.reserve(count);
+        for (uint32_t i = 0; i < count; i++) {
+            if (end - p < (ptrdiff_t)ENTRY_FIXED_SIZE) {
+                return false;
+            }
             FileInfo info;
-            info.name = item.value("Name", "");
-            info.size = item.value("Size", 0);
-            info.mode = item.value("Mode", 0);
-            info.is_dir = item.value("IsDir", false);
-            infos.push_back(info);
+            info.size = get<int64_t>(p);
+            info.mod_time = get<int64_t>(p + 8);
+            info.mode = get<uint32_t>(p + 16);
+            info.is_dir = p[20] != 0;
+            uint8_t flags = p[21];
+            uint16_t name_len = get<uint16_t>(p + 22);
+            p += ENTRY_FIXED_SIZE;
+            if (!get_bytes(p, end, name_len, info.name)) {
+                return false;
+            }
+
+            if (flags & FLAG_HAS_META) {
+                MetaData m;
+                if (!get_prefixed<uint16_t>(p, end, m.name) ||
+                    !get_prefixed<uint16_t>(p, end, m.type) ||
+                    !get_prefixed<uint32_t>(p, end, m.content)) {
+                    return false;
+                }
+                info.meta = std::move(m);
+            }
+            out.push_back(std::move(info));
         }
+        return true;
+    }
 
-        return infos;
+private:
+    template<typename T>
+    static void put(uint8_t* p, T v) {
+        std::memcpy(p, &v, sizeof(T));
+    }
+
+    template<typename T>
+    static T get(const uint8_t* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+
+    static uint8_t* put_bytes(uint8_t* p, const std::string& s) {
+        std::memcpy(p, s.data(), s.size());
+        return p + s.size();
+    }
+
+    // Read len bytes at p into s and advance p
+    static bool get_bytes(const uint8_t*& p, const uint8_t* end, size_t len, std::string& s) {
+        if ((size_t)(end - p) < len) {
+            return false;
+        }
+        s.assign(reinterpret_cast<const char*>(p), len);
+        p += len;
+        return true;
+    }
+
+    // Read a LenT length prefix followed by that many bytes
+    template<typename LenT>
+    static bool get_prefixed(const uint8_t*& p, const uint8_t* end, std::string& s) {
+        if ((size_t)(end - p) < sizeof(LenT)) {
+            return false;
+        }
+        LenT len = get<LenT>(p);
+        p += sizeof(LenT);
+        return get_bytes(p, end, len, s);
     }
 };
 
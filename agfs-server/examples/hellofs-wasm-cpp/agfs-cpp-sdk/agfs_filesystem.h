@@ -2,9 +2,121 @@
 #define AGFS_FILESYSTEM_H
 
 #include "agfs_types.h"
+#include "agfs_config.h"
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string_view>
 
 namespace agfs {
 
+// FileHandle represents an open file with state kept across calls
+// (cursor position, cached host resources, decoded headers, ...).
+// Handles are created by FileSystem::open and owned by the SDK, which
+// deletes them on handle_close or plugin shutdown.
+class FileHandle {
+public:
+    FileHandle(const std::string& path, OpenFlag flags)
+        : path_(path), flags_(flags), position_(0) {}
+    virtual ~FileHandle() = default;
+
+    const std::string& path() const { return path_; }
+    OpenFlag flags() const { return flags_; }
+    int64_t position() const { return position_; }
+
+    // Read up to buf.size() bytes at the given offset (pread)
+    // Returns: Number of bytes read (0 at end of file)
+    virtual Result<int64_t> read_at(ByteSpan buf, int64_t offset) = 0;
+
+    // Write data at the given offset (pwrite)
+    // Returns: Number of bytes written
+    virtual Result<int64_t> write_at(ConstByteSpan data, int64_t offset) {
+        (void)data; (void)offset; // unused
+        return Error::read_only();
+    }
+
+    // Get file information for the open file
+    virtual Result<FileInfo> stat() = 0;
+
+    // Read from the current position and advance it
+    virtual Result<int64_t> read(ByteSpan buf) {
+        auto result = read_at(buf, position_);
+        if (result.is_ok()) {
+            position_ += result.unwrap();
+        }
+        return result;
+    }
+
+    // Write at the current position (end of file in APPEND mode) and advance it
+    virtual Result<int64_t> write(ConstByteSpan data) {
+        int64_t offset = position_;
+        if (flags_.contains(OpenFlag::APPEND)) {
+            auto info = stat();
+            if (info.is_err()) {
+                return info.unwrap_err();
+            }
+            offset = info.unwrap().size;
+        }
+        auto result = write_at(data, offset);
+        if (result.is_ok()) {
+            position_ = offset + result.unwrap();
+        }
+        return result;
+    }
+
+    // Move the read/write position
+    // whence: 0 = SEEK_SET, 1 = SEEK_CUR, 2 = SEEK_END
+    // Returns: The new position
+    virtual Result<int64_t> seek(int64_t offset, int whence) {
+        int64_t base = 0;
+        switch (whence) {
+            case 0: base = 0; break;
+            case 1: base = position_; break;
+            case 2: {
+                auto info = stat();
+                if (info.is_err()) {
+                    return info.unwrap_err();
+                }
+                base = info.unwrap().size;
+                break;
+            }
+            default:
+                return Error::invalid_input("invalid whence");
+        }
+        if (base + offset < 0) {
+            return Error::invalid_input("negative position");
+        }
+        position_ = base + offset;
+        return position_;
+    }
+
+    // Flush buffered data to storage
+    virtual Result<void> sync() {
+        return Result<void>(); // Default: no-op
+    }
+
+    // Release resources held by the handle; called once before deletion
+    virtual Result<void> close() {
+        return Result<void>(); // Default: no-op
+    }
+
+protected:
+    std::string path_;
+    OpenFlag flags_;
+    int64_t position_;
+};
+
+// Receives the entries of one readdir_page() call
+class DirSink {
+public:
+    virtual ~DirSink() = default;
+
+    // Append an entry to the page
+    // Returns false, without taking the entry, once the page is full.
+    // The first entry of a page is always accepted.
+    virtual bool emit(const FileInfo& info) = 0;
+};
+
 // FileSystem base class that plugin developers should implement
 class FileSystem {
 public:
@@ -18,6 +130,13 @@ public:
         return "No documentation available";
     }
 
+    // Returns the typed configuration parameters, or nullptr for none
+    // When set, the SDK reports them to the host, validates them before
+    // validate() and stores them in their bound members before initialize().
+    virtual const ConfigSchema* config_schema() const {
+        return nullptr;
+    }
+
     // Validate the configuration before initialization
     virtual Result<void> validate(const Config& config) {
         (void)config; // unused
@@ -35,12 +154,42 @@ public:
         return Result<void>();
     }
 
+    // Drop memory the plugin can rebuild (caches, read buffers, pools)
+    // Called through plugin_trim while the instance is idle, when the host
+    // sees it growing; the SDK then trims its own arena and pools.
+    // Overrides should call FileSystem::trim(), which drops the listing
+    // kept by the default readdir_page.
+    virtual void trim() {
+        dir_snapshot_ = DirSnapshot();
+    }
+
     // Read data from a file
     virtual Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) {
         (void)path; (void)offset; (void)size; // unused
         return Error::read_only();
     }
 
+    // Read data from a file directly into a caller-provided buffer
+    // Arguments:
+    //   path - The file path
+    //   offset - Position to read from
+    //   out - Destination; at most out.size() bytes are read
+    // Returns: Number of bytes written to out
+    // fs_read passes the shared output buffer here, so overriding this avoids
+    // the intermediate vector. The default bridges to read().
+    virtual Result<int64_t> read_into(const std::string& path, int64_t offset, ByteSpan out) {
+        auto result = read(path, offset, (int64_t)out.size());
+        if (result.is_err()) {
+            return result.unwrap_err();
+        }
+        auto& data = result.unwrap();
+        size_t n = data.size() < out.size() ? data.size() : out.size();
+        if (n > 0) {
+            std::memcpy(out.data(), data.data(), n);
+        }
+        return (int64_t)n;
+    }
+
     // Write data to a file
     // Arguments:
     //   path - The file path
@@ -53,6 +202,15 @@ public:
         return Error::read_only();
     }
 
+    // Write data to a file from a non-owning view
+    // fs_write passes the host's buffer here without copying. The default
+    // bridges to the vector overload above.
+    // Note: overriding only one write overload hides the other in the derived
+    // class; add `using agfs::FileSystem::write;` to call both from it.
+    virtual Result<int64_t> write(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        return write(path, std::vector<uint8_t>(data.begin(), data.end()), offset, flags);
+    }
+
     // Create a new empty file
     virtual Result<void> create(const std::string& path) {
         (void)path; // unused
@@ -83,6 +241,97 @@ public:
     // List directory contents
     virtual Result<std::vector<FileInfo>> readdir(const std::string& path) = 0;
 
+    // Non-owning path overloads of the per-request calls
+    // The exports pass the host's path buffer here without copying it. The
+    // defaults build a std::string and call the overloads above, so only
+    // plugins that can answer from a view (route matching, interned ids,
+    // fixed files) gain anything by overriding them.
+    // Note: through a FileSystem reference a string literal matches both
+    // overloads; pass std::string or std::string_view explicitly.
+    virtual Result<FileInfo> stat(std::string_view path) {
+        return stat(std::string(path));
+    }
+
+    virtual Result<std::vector<FileInfo>> readdir(std::string_view path) {
+        return readdir(std::string(path));
+    }
+
+    virtual Result<std::vector<uint8_t>> read(std::string_view path, int64_t offset, int64_t size) {
+        return read(std::string(path), offset, size);
+    }
+
+    virtual Result<int64_t> read_into(std::string_view path, int64_t offset, ByteSpan out) {
+        return read_into(std::string(path), offset, out);
+    }
+
+    virtual Result<int64_t> write(std::string_view path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        return write(std::string(path), data, offset, flags);
+    }
+
+    // Read several ranges of one file in one call
+    // Arguments:
+    //   path - The file path
+    //   ranges - Ranges to read; sizes are non-negative
+    //   out - The ranges back to back, each in a slot of its requested size
+    //   lengths - Receives the bytes read into each slot (short at end of file)
+    // fs_readv passes the shared output buffer here, so a Parquet footer or
+    // a zip central directory costs one call instead of one per range. The
+    // default reads the ranges one by one with read_into(); override it to
+    // fetch them together, e.g. with HostFS::readv when proxying.
+    virtual Result<void> readv(std::string_view path, Span<const ReadRange> ranges, ByteSpan out, Span<int64_t> lengths) {
+        size_t pos = 0;
+        for (size_t i = 0; i < ranges.size(); i++) {
+            ByteSpan slot = out.subspan(pos, (size_t)ranges[i].size);
+            auto result = read_into(path, ranges[i].offset, slot);
+            if (result.is_err()) {
+                return result.unwrap_err();
+            }
+            lengths[i] = result.unwrap();
+            pos += slot.size();
+        }
+        return Result<void>();
+    }
+
+    // List directory contents one page at a time
+    // Arguments:
+    //   path - The directory path
+    //   cursor - Where to resume, as returned by the previous call ("" = start)
+    //   sink - Receives entries until it refuses one
+    // Returns: The cursor of the first entry not emitted, or "" when done
+    // Override this to produce entries lazily (e.g. one object-store list
+    // request per page); the host then pages through fs_readdir_page instead
+    // of materializing the directory with readdir(). The default pages over
+    // one readdir() listing kept until the last page, with "<snapshot>.<index>"
+    // cursors; a cursor of another snapshot (e.g. from another pool
+    // instance) lists the directory again and resumes at its index.
+    virtual Result<std::string> readdir_page(const std::string& path, const std::string& cursor, DirSink& sink) {
+        char* rest = nullptr;
+        uint64_t id = cursor.empty() ? 0 : std::strtoull(cursor.c_str(), &rest, 10);
+        size_t start = rest != nullptr && *rest == '.' ? (size_t)std::strtoull(rest + 1, nullptr, 10) : 0;
+        if (cursor.empty() || id != dir_snapshot_.id || path != dir_snapshot_.path) {
+            auto result = readdir(path);
+            if (result.is_err()) {
+                return result.unwrap_err();
+            }
+            if (dir_snapshot_seq_ == 0) {
+                std::random_device rd;
+                dir_snapshot_seq_ = ((uint64_t)rd() << 20) | 1; // differs between instances
+            }
+            dir_snapshot_.path = path;
+            dir_snapshot_.id = dir_snapshot_seq_++;
+            dir_snapshot_.entries = std::move(result.unwrap());
+        }
+
+        const std::vector<FileInfo>& entries = dir_snapshot_.entries;
+        for (size_t i = start; i < entries.size(); i++) {
+            if (!sink.emit(entries[i])) {
+                return std::to_string(dir_snapshot_.id) + "." + std::to_string(i);
+            }
+        }
+        dir_snapshot_ = DirSnapshot();
+        return std::string();
+    }
+
     // Rename/move a file or directory
     virtual Result<void> rename(const std::string& old_path, const std::string& new_path) {
         (void)old_path; (void)new_path; // unused
@@ -94,8 +343,80 @@ public:
         (void)path; (void)mode; // unused
         return Result<void>(); // Default: no-op
     }
+
+    // Open a stateful file handle
+    // Arguments:
+    //   path - The file path
+    //   flags - Open flags (RDONLY, WRONLY, RDWR, CREATE, TRUNCATE, ...)
+    //   mode - Permission bits used when the file is created
+    // Returns: A newly allocated handle; the SDK takes ownership
+    // The default implementation returns a PathFileHandle that forwards
+    // to read/write/stat, so plugins only override this to keep state.
+    virtual Result<FileHandle*> open(const std::string& path, OpenFlag flags, uint32_t mode);
+
+private:
+    // Listing the default readdir_page is paging through
+    struct DirSnapshot {
+        std::string path;
+        uint64_t id = 0;
+        std::vector<FileInfo> entries;
+    };
+
+    DirSnapshot dir_snapshot_;
+    uint64_t dir_snapshot_seq_ = 0;
+};
+
+// PathFileHandle bridges the handle API to the path-based FileSystem
+// methods. It tracks the cursor but otherwise holds no state.
+class PathFileHandle : public FileHandle {
+public:
+    PathFileHandle(FileSystem& fs, const std::string& path, OpenFlag flags)
+        : FileHandle(path, flags), fs_(fs) {}
+
+    Result<int64_t> read_at(ByteSpan buf, int64_t offset) override {
+        return fs_.read_into(path_, offset, buf);
+    }
+
+    Result<int64_t> write_at(ConstByteSpan data, int64_t offset) override {
+        return fs_.write(path_, data, offset, WriteFlag::NONE);
+    }
+
+    Result<FileInfo> stat() override {
+        return fs_.stat(path_);
+    }
+
+private:
+    FileSystem& fs_;
 };
 
+inline Result<FileHandle*> FileSystem::open(const std::string& path, OpenFlag flags, uint32_t mode) {
+    (void)mode; // create() carries no mode
+    auto info = stat(path);
+    if (info.is_err()) {
+        if (info.unwrap_err().kind != ErrorKind::NotFound || !flags.contains(OpenFlag::CREATE)) {
+            return info.unwrap_err();
+        }
+        auto created = create(path);
+        if (created.is_err()) {
+            return created.unwrap_err();
+        }
+    } else {
+        if (flags.contains(OpenFlag::CREATE) && flags.contains(OpenFlag::EXCLUSIVE)) {
+            return Error::already_exists();
+        }
+        if (info.unwrap().is_dir && flags.is_writable()) {
+            return Error::is_directory();
+        }
+        if (flags.contains(OpenFlag::TRUNCATE) && flags.is_writable()) {
+            auto truncated = write(path, std::vector<uint8_t>(), 0, WriteFlag::TRUNCATE);
+            if (truncated.is_err()) {
+                return truncated.unwrap_err();
+            }
+        }
+    }
+    return static_cast<FileHandle*>(new PathFileHandle(*this, path, flags));
+}
+
 } // namespace agfs
 
 #endif // AGFS_FILESYSTEM_H
@@ -3,7 +3,11 @@
 
 #include "agfs_types.h"
 #include "agfs_ffi.h"
+#include "agfs_metrics.h"
+#include <algorithm>
 #include <cstring>
+#include <string_view>
+#include <vector>
 
 namespace agfs {
 
@@ -15,12 +19,27 @@ extern "C" {
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_write")))
     uint64_t host_fs_write(const char* path, const uint8_t* data, uint32_t len);
 
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_write_at")))
+    uint64_t host_fs_write_at(const char* path, const uint8_t* data, uint32_t len, int64_t offset, uint32_t flags);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_read_into")))
+    uint64_t host_fs_read_into(const char* path, int64_t offset, uint8_t* dst, uint32_t cap);
+
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_stat")))
     uint64_t host_fs_stat(const char* path);
 
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_readdir")))
     uint64_t host_fs_readdir(const char* path);
 
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_stat_bin")))
+    uint64_t host_fs_stat_bin(const char* path);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_readdir_bin")))
+    uint64_t host_fs_readdir_bin(const char* path);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_batch")))
+    uint64_t host_fs_batch(const uint8_t* request, uint32_t len);
+
     __attribute__((import_module("env"))) __attribute__((import_name("host_fs_create")))
     uint32_t host_fs_create(const char* path);
 
@@ -45,159 +64,522 @@ inline std::string read_string_from_ptr(uint32_t ptr) {
     if (ptr == 0) {
         return "";
     }
+    const char* str = reinterpret_cast<const char*>(ptr);
+    return std::string(str, simd::strlen(str));
+}
+
+// HostBuffer owns memory the host allocated in linear memory (through the
+// module's malloc export) to return a result. The bytes are borrowed in
+// place, never copied, and freed when the HostBuffer is destroyed.
+class HostBuffer {
+public:
+    HostBuffer() : data_(nullptr), size_(0) {}
+    HostBuffer(uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    // Take ownership of a NUL-terminated string returned by the host
+    static HostBuffer from_string(uint32_t ptr) {
+        if (ptr == 0) {
+            return HostBuffer();
+        }
+        char* str = reinterpret_cast<char*>(ptr);
+        return HostBuffer(reinterpret_cast<uint8_t*>(str), simd::strlen(str));
+    }
 
-    // Find null terminator
-    const char* start_ptr = reinterpret_cast<const char*>(ptr);
-    size_t len = 0;
-    while (start_ptr[len] != '\0') {
-        len++;
+    ~HostBuffer() { reset(); }
+
+    HostBuffer(const HostBuffer&) = delete;
+    HostBuffer& operator=(const HostBuffer&) = delete;
+
+    HostBuffer(HostBuffer&& other) noexcept : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+
+    HostBuffer& operator=(HostBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            size_ = other.size_;
+            other.data_ = nullptr;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    ConstByteSpan span() const { return ConstByteSpan(data_, size_); }
+
+    // Copies, for callers that have to keep the data past this buffer
+    std::vector<uint8_t> to_vector() const {
+        return std::vector<uint8_t>(data_, data_ + size_);
+    }
+
+    std::string to_string() const {
+        return std::string(reinterpret_cast<const char*>(data_), size_);
+    }
+
+    // Give up ownership, e.g. to hand the allocation back to the host as an
+    // fs_read result (the host frees that with the same allocator)
+    uint8_t* release() {
+        uint8_t* data = data_;
+        data_ = nullptr;
+        size_ = 0;
+        return data;
+    }
+
+    void reset() {
+        if (data_ != nullptr) {
+            ffi::wasm_free(data_);
+            data_ = nullptr;
+        }
+        size_ = 0;
     }
 
-    return std::string(start_ptr, len);
+private:
+    uint8_t* data_;
+    size_t size_;
+};
+
+namespace internal {
+
+// Error of a host_fs_* error string: the host prefixes the message with the
+// code byte (kind + 1) of its ErrorKind, the layout of export_error strings.
+// Text without a valid code byte is kept whole as Other.
+inline Error host_error(std::string_view text) {
+    if (!text.empty()) {
+        uint8_t code = (uint8_t)text[0];
+        if (code >= 1 && code <= (uint8_t)ErrorKind::Other + 1) {
+            ErrorKind kind = (ErrorKind)(code - 1);
+            text.remove_prefix(1);
+            return Error(kind, text.empty() ? Error::default_message(kind) : std::string(text));
+        }
+    }
+    return Error::other(std::string(text));
 }
 
+// Take a host-allocated error string, decode it and free it
+inline Error host_error(uint32_t err_ptr) {
+    HostBuffer msg = HostBuffer::from_string(err_ptr);
+    return host_error(std::string_view(reinterpret_cast<const char*>(msg.data()), msg.size()));
+}
+
+} // namespace internal
+
+// Operation kinds understood by host_fs_batch
+enum class BatchOp : uint8_t {
+    Stat = 1,
+    Read = 2,
+    ReadDir = 3
+};
+
+// Outcome of one operation in a HostBatch
+// data borrows from the BatchResponse it came from.
+struct BatchResult {
+    BatchOp op;
+    bool ok;
+    Error error;
+    FileInfo info;                 // Stat
+    std::vector<FileInfo> entries; // ReadDir
+    ConstByteSpan data;            // Read
+
+    BatchResult() : op(BatchOp::Stat), ok(false), error(ErrorKind::Other) {}
+};
+
+// Results of HostBatch::submit(), in the order the operations were queued
+// Owns the host response buffer that Read results point into.
+class BatchResponse {
+public:
+    BatchResponse() = default;
+    BatchResponse(HostBuffer buf, std::vector<BatchResult> results)
+        : buf_(std::move(buf)), results_(std::move(results)) {}
+
+    size_t size() const { return results_.size(); }
+    bool empty() const { return results_.empty(); }
+    const BatchResult& operator[](size_t i) const { return results_[i]; }
+
+    std::vector<BatchResult>::const_iterator begin() const { return results_.begin(); }
+    std::vector<BatchResult>::const_iterator end() const { return results_.end(); }
+
+private:
+    HostBuffer buf_;
+    std::vector<BatchResult> results_;
+};
+
+// HostBatch queues stat/read/readdir calls and sends them to the host in a
+// single host_fs_batch call, which runs them concurrently. Use it when a
+// plugin needs many small host operations (e.g. stat of every entry of a
+// directory) to pay the WASM boundary crossing once instead of per call.
+//
+// Wire format (little-endian, version 1):
+//   header: u32 total_len, u16 version, u16 reserved, u32 count
+//   op:     u8 kind, u8 reserved[3], i64 offset, i64 size, u32 path_len, path
+//   result: u8 kind, u8 status (0 = ok, else ErrorKind + 1), u16 reserved,
+//           u32 payload_len, payload
+class HostBatch {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t OP_FIXED_SIZE = 24;
+    static constexpr size_t RESULT_FIXED_SIZE = 8;
+
+    HostBatch() : request_(HEADER_SIZE, 0), count_(0) {}
+
+    // Each call returns the index of its result in the response
+    size_t stat(const std::string& path) {
+        return add(BatchOp::Stat, path, 0, 0);
+    }
+
+    size_t read(const std::string& path, int64_t offset, int64_t size) {
+        return add(BatchOp::Read, path, offset, size);
+    }
+
+    size_t readdir(const std::string& path) {
+        return add(BatchOp::ReadDir, path, 0, 0);
+    }
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // Run every queued operation; the batch is cleared afterwards
+    // Per-operation failures are reported in the results, not here.
+    Result<BatchResponse> submit() {
+        if (count_ == 0) {
+            return BatchResponse();
+        }
+
+        put<uint32_t>(&request_[0], (uint32_t)request_.size());
+        put<uint16_t>(&request_[4], VERSION);
+        put<uint32_t>(&request_[8], count_);
+
+        uint64_t result = metrics::host([&] { return host_fs_batch(request_.data(), (uint32_t)request_.size()); });
+        size_t expected = count_;
+        clear();
+
+        // Unpack: lower 32 bits = response pointer, upper 32 bits = error pointer
+        uint32_t resp_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+
+        if (err_ptr != 0) {
+            return internal::host_error(err_ptr);
+        }
+        if (resp_ptr == 0) {
+            return Error::io("batch failed");
+        }
+
+        HostBuffer buf(reinterpret_cast<uint8_t*>(resp_ptr), 0);
+        std::vector<BatchResult> results;
+        if (!decode(buf.data(), expected, results)) {
+            return Error::io("malformed batch response");
+        }
+        return BatchResponse(std::move(buf), std::move(results));
+    }
+
+    void clear() {
+        request_.assign(HEADER_SIZE, 0);
+        count_ = 0;
+    }
+
+private:
+    std::vector<uint8_t> request_;
+    uint32_t count_;
+
+    size_t add(BatchOp op, const std::string& path, int64_t offset, int64_t size) {
+        size_t pos = request_.size();
+        request_.resize(pos + OP_FIXED_SIZE + path.size(), 0);
+        uint8_t* p = &request_[pos];
+        p[0] = (uint8_t)op;
+        put<int64_t>(p + 4, offset);
+        put<int64_t>(p + 12, size);
+        put<uint32_t>(p + 20, (uint32_t)path.size());
+        std::memcpy(p + OP_FIXED_SIZE, path.data(), path.size());
+        return count_++;
+    }
+
+    static bool decode(const uint8_t* data, size_t expected, std::vector<BatchResult>& out) {
+        uint32_t total = get<uint32_t>(data);
+        if (total < HEADER_SIZE || get<uint16_t>(data + 4) != VERSION ||
+            get<uint32_t>(data + 8) != expected) {
+            return false;
+        }
+        const uint8_t* p = data + HEADER_SIZE;
+        const uint8_t* end = data + total;
+
+        out.resize(expected);
+        for (BatchResult& r : out) {
+            if ((size_t)(end - p) < RESULT_FIXED_SIZE) {
+                return false;
+            }
+            r.op = (BatchOp)p[0];
+            uint8_t status = p[1];
+            r.ok = status == 0;
+            uint32_t len = get<uint32_t>(p + 4);
+            p += RESULT_FIXED_SIZE;
+            if ((size_t)(end - p) < len) {
+                return false;
+            }
+
+            if (!r.ok) {
+                std::string msg(reinterpret_cast<const char*>(p), len);
+                if (status <= (uint8_t)ErrorKind::Other + 1) {
+                    ErrorKind kind = (ErrorKind)(status - 1);
+                    r.error = Error(kind, msg.empty() ? Error::default_message(kind) : msg);
+                } else {
+                    r.error = Error::other(msg);
+                }
+            } else if (r.op == BatchOp::Read) {
+                r.data = ConstByteSpan(p, len);
+            } else if (len < ffi::BinaryFileInfo::HEADER_SIZE || get<uint32_t>(p) > len) {
+                return false;
+            } else if (r.op == BatchOp::Stat) {
+                std::vector<FileInfo> infos;
+                if (!ffi::BinaryFileInfo::decode(p, infos) || infos.size() != 1) {
+                    return false;
+                }
+                r.info = std::move(infos[0]);
+            } else if (!ffi::BinaryFileInfo::decode(p, r.entries)) {
+                return false;
+            }
+            p += len;
+        }
+        return true;
+    }
+
+    template<typename T>
+    static void put(uint8_t* p, T v) {
+        std::memcpy(p, &v, sizeof(T));
+    }
+
+    template<typename T>
+    static T get(const uint8_t* p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T));
+        return v;
+    }
+};
+
 // HostFS provides access to the host filesystem from WASM
+// Every buffer the host returns is owned by a HostBuffer and freed after use.
 class HostFS {
 public:
-    // Read data from a file on the host filesystem
-    static Result<std::vector<uint8_t>> read(const std::string& path, int64_t offset, int64_t size) {
-        uint64_t result = host_fs_read(path.c_str(), offset, size);
-
-        // Unpack: lower 32 bits = pointer, upper 32 bits = size
-        uint32_t data_ptr = (uint32_t)(result & 0xFFFFFFFF);
-        uint32_t data_size = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+    // Read data from a file on the host filesystem (size < 0 reads to the end)
+    // The data is borrowed in place; copy it with to_vector() to keep it.
+    // Goes through read_into (and stat for size < 0), which report the host
+    // error kind; the older host_fs_read only signals failure.
+    static Result<HostBuffer> read(const std::string& path, int64_t offset, int64_t size) {
+        if (size < 0) {
+            auto info = stat(path);
+            if (info.is_err()) {
+                return info.unwrap_err();
+            }
+            if (info.unwrap().is_dir) {
+                return Error::is_directory();
+            }
+            size = std::max<int64_t>(0, info.unwrap().size - std::max<int64_t>(0, offset));
+        }
+        if (size > (int64_t)UINT32_MAX) {
+            return Error::invalid_input("read size too large");
+        }
 
-        if (data_ptr == 0) {
-            return Error::io("read failed");
+        HostBuffer buf(static_cast<uint8_t*>(ffi::wasm_malloc(size > 0 ? (size_t)size : 1)), 0);
+        if (buf.data() == nullptr) {
+            return Error::io("out of memory");
         }
+        auto n = read_into(path, offset, ByteSpan(const_cast<uint8_t*>(buf.data()), (size_t)size));
+        if (n.is_err()) {
+            return n.unwrap_err();
+        }
+        return HostBuffer(buf.release(), (size_t)n.unwrap());
+    }
 
-        // Read data from memory
-        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(data_ptr);
-        std::vector<uint8_t> data(ptr, ptr + data_size);
-        return data;
+    // Write data to a file on the host filesystem (create or truncate)
+    // Returns: Number of bytes written
+    static Result<int64_t> write(const std::string& path, ConstByteSpan data) {
+        // write_at reports the host error kind, host_fs_write only a 0 count
+        return write_at(path, data, -1, WriteFlag::CREATE | WriteFlag::TRUNCATE);
     }
 
-    // Write data to a file on the host filesystem
-    static Result<std::vector<uint8_t>> write(const std::string& path, const std::vector<uint8_t>& data) {
-        uint64_t result = host_fs_write(path.c_str(), data.data(), data.size());
+    // Read up to out.size() bytes at offset directly into out
+    // Nothing is allocated on either side; this is the path to use for
+    // chunked proxying of large files.
+    // Returns: Number of bytes read (0 at end of file)
+    static Result<int64_t> read_into(const std::string& path, int64_t offset, ByteSpan out) {
+        uint64_t result = metrics::host([&] { return host_fs_read_into(path.c_str(), offset, out.data(), (uint32_t)out.size()); });
 
-        // Unpack: lower 32 bits = pointer, upper 32 bits = size
-        uint32_t response_ptr = (uint32_t)(result & 0xFFFFFFFF);
-        uint32_t response_size = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+        // Unpack: lower 32 bits = bytes read, upper 32 bits = error pointer
+        uint32_t bytes_read = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
-        if (response_ptr == 0) {
-            return Error::io("write failed");
+        if (err_ptr != 0) {
+            return host_error(err_ptr);
         }
+        return (int64_t)bytes_read;
+    }
 
-        // Read response from memory
-        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(response_ptr);
-        std::vector<uint8_t> response(ptr, ptr + response_size);
-        return response;
+    // Write data at offset with the given flags
+    // Arguments:
+    //   path - The host file path
+    //   data - Data to write
+    //   offset - Position to write at (-1 for append/default behavior)
+    //   flags - Write flags (CREATE, TRUNCATE, APPEND, etc.)
+    // Returns: Number of bytes written
+    static Result<int64_t> write_at(const std::string& path, ConstByteSpan data, int64_t offset, WriteFlag flags) {
+        uint64_t result = metrics::host([&] { return host_fs_write_at(path.c_str(), data.data(), (uint32_t)data.size(), offset, flags.value); });
+
+        // Unpack: lower 32 bits = error pointer, upper 32 bits = bytes written
+        uint32_t err_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t bytes_written = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+
+        if (err_ptr != 0) {
+            return host_error(err_ptr);
+        }
+        return (int64_t)bytes_written;
     }
 
     // Get file information
     static Result<FileInfo> stat(const std::string& path) {
-        uint64_t result = host_fs_stat(path.c_str());
+        uint64_t result = metrics::host([&] { return host_fs_stat_bin(path.c_str()); });
 
-        // Unpack: lower 32 bits = json pointer, upper 32 bits = error pointer
-        uint32_t json_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        // Unpack: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+        uint32_t buf_ptr = (uint32_t)(result & 0xFFFFFFFF);
         uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
         // Check for error
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
 
-        if (json_ptr == 0) {
+        if (buf_ptr == 0) {
             return Error::not_found();
         }
 
-        std::string json_str = read_string_from_ptr(json_ptr);
-        return ffi::JsonParser::parse_fileinfo(json_str);
+        HostBuffer buf(reinterpret_cast<uint8_t*>(buf_ptr), 0);
+        std::vector<FileInfo> infos;
+        if (!ffi::BinaryFileInfo::decode(buf.data(), infos) ||
+            infos.size() != 1) {
+            return Error::io("malformed stat response");
+        }
+        return std::move(infos[0]);
     }
 
     // Read directory contents
     static Result<std::vector<FileInfo>> readdir(const std::string& path) {
-        uint64_t result = host_fs_readdir(path.c_str());
+        uint64_t result = metrics::host([&] { return host_fs_readdir_bin(path.c_str()); });
 
-        // Unpack: lower 32 bits = json pointer, upper 32 bits = error pointer
-        uint32_t json_ptr = (uint32_t)(result & 0xFFFFFFFF);
+        // Unpack: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+        uint32_t buf_ptr = (uint32_t)(result & 0xFFFFFFFF);
         uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
 
         // Check for error
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
 
-        if (json_ptr == 0) {
+        if (buf_ptr == 0) {
             return std::vector<FileInfo>();
         }
 
-        std::string json_str = read_string_from_ptr(json_ptr);
-        return ffi::JsonParser::parse_fileinfo_array(json_str);
+        HostBuffer buf(reinterpret_cast<uint8_t*>(buf_ptr), 0);
+        std::vector<FileInfo> infos;
+        if (!ffi::BinaryFileInfo::decode(buf.data(), infos)) {
+            return Error::io("malformed readdir response");
+        }
+        return infos;
+    }
+
+    // Start a batch of stat/read/readdir calls sent in one host call
+    static HostBatch batch() {
+        return HostBatch();
+    }
+
+    // Read several ranges of a file with one host_fs_batch call
+    // Same layout as FileSystem::readv, so a proxying plugin can forward its
+    // readv here; the host runs the reads concurrently.
+    static Result<void> readv(const std::string& path, Span<const ReadRange> ranges, ByteSpan out, Span<int64_t> lengths) {
+        HostBatch batch;
+        for (const ReadRange& r : ranges) {
+            batch.read(path, r.offset, r.size);
+        }
+        auto response = batch.submit();
+        if (response.is_err()) {
+            return response.unwrap_err();
+        }
+        const BatchResponse& results = response.unwrap();
+        size_t pos = 0;
+        for (size_t i = 0; i < ranges.size(); i++) {
+            if (!results[i].ok) {
+                return results[i].error;
+            }
+            ByteSpan slot = out.subspan(pos, (size_t)ranges[i].size);
+            size_t n = std::min(results[i].data.size(), slot.size());
+            if (n > 0) {
+                std::memcpy(slot.data(), results[i].data.data(), n);
+            }
+            lengths[i] = (int64_t)n;
+            pos += slot.size();
+        }
+        return Result<void>();
     }
 
     // Create a new file
     static Result<void> create(const std::string& path) {
-        uint32_t err_ptr = host_fs_create(path.c_str());
+        uint32_t err_ptr = metrics::host([&] { return host_fs_create(path.c_str()); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
 
     // Create a directory
     static Result<void> mkdir(const std::string& path, uint32_t perm) {
-        uint32_t err_ptr = host_fs_mkdir(path.c_str(), perm);
+        uint32_t err_ptr = metrics::host([&] { return host_fs_mkdir(path.c_str(), perm); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
 
     // Remove a file or empty directory
     static Result<void> remove(const std::string& path) {
-        uint32_t err_ptr = host_fs_remove(path.c_str());
+        uint32_t err_ptr = metrics::host([&] { return host_fs_remove(path.c_str()); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
 
     // Remove a file or directory recursively
     static Result<void> remove_all(const std::string& path) {
-        uint32_t err_ptr = host_fs_remove_all(path.c_str());
+        uint32_t err_ptr = metrics::host([&] { return host_fs_remove_all(path.c_str()); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
 
     // Rename a file or directory
     static Result<void> rename(const std::string& old_path, const std::string& new_path) {
-        uint32_t err_ptr = host_fs_rename(old_path.c_str(), new_path.c_str());
+        uint32_t err_ptr = metrics::host([&] { return host_fs_rename(old_path.c_str(), new_path.c_str()); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
 
     // Change file permissions
     static Result<void> chmod(const std::string& path, uint32_t mode) {
-        uint32_t err_ptr = host_fs_chmod(path.c_str(), mode);
+        uint32_t err_ptr = metrics::host([&] { return host_fs_chmod(path.c_str(), mode); });
         if (err_ptr != 0) {
-            std::string err_str = read_string_from_ptr(err_ptr);
-            return Error::other(err_str);
+            return host_error(err_ptr);
         }
         return Result<void>();
     }
+
+private:
+    static Error host_error(uint32_t err_ptr) {
+        return internal::host_error(err_ptr);
+    }
 };
 
 } // namespace agfs
@@ -2,27 +2,140 @@
 #define AGFS_HTTP_H
 
 #include "agfs_types.h"
+#include "agfs_hostfs.h"
 #include <string>
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 
 namespace agfs {
 
-// Forward declarations for FFI functions
+// Import host functions from the "env" module
 extern "C" {
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_request")))
     uint64_t host_http_request(const char* request_json);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_request_v2")))
+    uint64_t host_http_request_v2(const uint8_t* header, uint32_t header_len,
+                                  const uint8_t* body, uint32_t body_len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_open")))
+    uint64_t host_http_open(const uint8_t* header, uint32_t header_len,
+                            const uint8_t* body, uint32_t body_len, uint32_t flags);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_write")))
+    uint32_t host_http_write(uint32_t stream_id, const uint8_t* data, uint32_t len);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_response")))
+    uint64_t host_http_response(uint32_t stream_id);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_read")))
+    uint64_t host_http_read(uint32_t stream_id, uint8_t* dst, uint32_t cap);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_close")))
+    void host_http_close(uint32_t stream_id);
+
+    __attribute__((import_module("env"))) __attribute__((import_name("host_http_wait_any")))
+    uint64_t host_http_wait_any(const uint32_t* stream_ids, uint32_t count, int32_t timeout_ms);
+}
+
+// Length-prefixed HTTP wire format used by host_http_request_v2
+// The request body is passed as its own pointer+length and the response
+// body is the raw tail of the response buffer, so neither is encoded.
+//
+// Request header block (little-endian; version 1 blocks end before the options):
+//   header: u32 total_len, u16 version, u16 reserved, u32 timeout_secs, u32 header_count
+//           u16 method_len, method, u32 url_len, url
+//           per header: u16 key_len, key, u32 value_len, value
+//   options (version 2):
+//           u32 flags (bits 0-1 = HTTP/2 mode, bit 2 = disable keep-alive),
+//           i64 max_response_bytes, i64 if_modified_since,
+//           u16 pool_key_len, pool_key, u16 if_none_match_len, if_none_match
+//
+// Response:
+//   header: u32 total_len, u16 version, u16 reserved, u32 status_code,
+//           u32 header_count, u32 error_len, u32 body_len
+//           error, then per header: u16 key_len, key, u32 value_len, value
+//           body (the last body_len bytes)
+namespace http_wire {
+
+constexpr uint16_t REQUEST_VERSION = 2;
+constexpr uint16_t RESPONSE_VERSION = 1;
+constexpr size_t REQUEST_HEADER_SIZE = 16;
+constexpr size_t RESPONSE_HEADER_SIZE = 24;
+constexpr size_t REQUEST_OPTIONS_SIZE = 4 + 8 + 8;
+constexpr uint32_t FLAG_DISABLE_KEEP_ALIVE = 1u << 2;
+
+template<typename T>
+inline void put(uint8_t* p, T v) {
+    std::memcpy(p, &v, sizeof(T));
 }
 
+template<typename T>
+inline T get(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+// Append a LenT length prefix followed by s
+template<typename LenT>
+inline void append_prefixed(std::vector<uint8_t>& out, const std::string& s) {
+    size_t pos = out.size();
+    out.resize(pos + sizeof(LenT) + s.size());
+    put<LenT>(&out[pos], (LenT)s.size());
+    std::memcpy(&out[pos + sizeof(LenT)], s.data(), s.size());
+}
+
+// Read a LenT length prefix followed by that many bytes and advance p
+template<typename LenT>
+inline bool get_prefixed(const uint8_t*& p, const uint8_t* end, std::string& s) {
+    if ((size_t)(end - p) < sizeof(LenT)) {
+        return false;
+    }
+    LenT len = get<LenT>(p);
+    p += sizeof(LenT);
+    if ((size_t)(end - p) < len) {
+        return false;
+    }
+    s.assign(reinterpret_cast<const char*>(p), len);
+    p += len;
+    return true;
+}
+
+} // namespace http_wire
+
 // HTTP request builder
 class HttpRequest {
 public:
+    // HTTP/2 preference of the host connection
+    enum class Http2 : uint32_t {
+        Auto = 0,    // HTTP/2 when the server negotiates it over TLS
+        Prefer = 1,  // Always attempt HTTP/2
+        Disable = 2, // HTTP/1.1 only
+    };
+
     std::string method = "GET";
     std::string url;
     std::map<std::string, std::string> headers;
     std::vector<uint8_t> body;
     int timeout = 30; // seconds
 
+    // Connection hints: requests with the same pool key and HTTP/2 mode
+    // share the host's idle connections ("" = the shared pool)
+    std::string pool_key;
+    Http2 http2 = Http2::Auto;
+    bool keep_alive = true;
+
+    // Conditional request validators; a 304 response has an empty body
+    std::string if_none_match;
+    int64_t if_modified_since = 0; // unix seconds, 0 = unset
+
+    // Fail the request once the body exceeds this many bytes (0 = unlimited)
+    int64_t max_response_bytes = 0;
+
     HttpRequest() = default;
 
     static HttpRequest get(const std::string& url) {
@@ -78,16 +191,90 @@ public:
         return *this;
     }
 
-    // Convert to JSON for FFI
+    HttpRequest& set_pool(const std::string& key) {
+        pool_key = key;
+        return *this;
+    }
+
+    HttpRequest& set_http2(Http2 mode) {
+        http2 = mode;
+        return *this;
+    }
+
+    HttpRequest& set_keep_alive(bool enabled) {
+        keep_alive = enabled;
+        return *this;
+    }
+
+    HttpRequest& set_if_none_match(const std::string& etag) {
+        if_none_match = etag;
+        return *this;
+    }
+
+    HttpRequest& set_if_modified_since(int64_t unix_seconds) {
+        if_modified_since = unix_seconds;
+        return *this;
+    }
+
+    HttpRequest& set_max_response_bytes(int64_t limit) {
+        max_response_bytes = limit;
+        return *this;
+    }
+
+    // Encode method, URL, headers, timeout and connection options in the
+    // wire format
+    // The body is not part of the block; it is passed to the host as is.
+    std::vector<uint8_t> encode_header() const {
+        size_t size = http_wire::REQUEST_HEADER_SIZE + 2 + method.size() + 4 + url.size() +
+                      http_wire::REQUEST_OPTIONS_SIZE + 2 + pool_key.size() + 2 + if_none_match.size();
+        for (const auto& [key, value] : headers) {
+            size += 2 + key.size() + 4 + value.size();
+        }
+
+        std::vector<uint8_t> out(http_wire::REQUEST_HEADER_SIZE, 0);
+        out.reserve(size);
+        http_wire::append_prefixed<uint16_t>(out, method);
+        http_wire::append_prefixed<uint32_t>(out, url);
+        for (const auto& [key, value] : headers) {
+            http_wire::append_prefixed<uint16_t>(out, key);
+            http_wire::append_prefixed<uint32_t>(out, value);
+        }
+
+        uint32_t flags = (uint32_t)http2;
+        if (!keep_alive) {
+            flags |= http_wire::FLAG_DISABLE_KEEP_ALIVE;
+        }
+        size_t pos = out.size();
+        out.resize(pos + http_wire::REQUEST_OPTIONS_SIZE);
+        http_wire::put<uint32_t>(&out[pos], flags);
+        http_wire::put<int64_t>(&out[pos + 4], max_response_bytes);
+        http_wire::put<int64_t>(&out[pos + 12], if_modified_since);
+        http_wire::append_prefixed<uint16_t>(out, pool_key);
+        http_wire::append_prefixed<uint16_t>(out, if_none_match);
+
+        http_wire::put<uint32_t>(&out[0], (uint32_t)out.size());
+        http_wire::put<uint16_t>(&out[4], http_wire::REQUEST_VERSION);
+        http_wire::put<uint32_t>(&out[8], (uint32_t)timeout);
+        http_wire::put<uint32_t>(&out[12], (uint32_t)headers.size());
+        return out;
+    }
+
+    // Convert to JSON for FFI (host_http_request fallback)
     std::string to_json() const {
         std::string json = "{";
-        json += "\"method\":\"" + method + "\",";
-        json += "\"url\":\"" + url + "\",";
-        json += "\"headers\":{";
+        json += "\"method\":\"";
+        simd::json_escape_append(json, method);
+        json += "\",\"url\":\"";
+        simd::json_escape_append(json, url);
+        json += "\",\"headers\":{";
         bool first = true;
         for (const auto& [key, value] : headers) {
             if (!first) json += ",";
-            json += "\"" + key + "\":\"" + value + "\"";
+            json += "\"";
+            simd::json_escape_append(json, key);
+            json += "\":\"";
+            simd::json_escape_append(json, value);
+            json += "\"";
             first = false;
         }
         json += "},";
@@ -98,6 +285,25 @@ public:
         }
         json += "],";
         json += "\"timeout\":" + std::to_string(timeout);
+        if (!pool_key.empty()) {
+            json += ",\"pool_key\":\"";
+            simd::json_escape_append(json, pool_key);
+            json += "\"";
+        }
+        if (http2 != Http2::Auto) json += ",\"http2\":" + std::to_string((uint32_t)http2);
+        if (!keep_alive) json += ",\"disable_keep_alive\":true";
+        if (!if_none_match.empty()) {
+            // ETags are quoted strings themselves
+            json += ",\"if_none_match\":\"";
+            simd::json_escape_append(json, if_none_match);
+            json += "\"";
+        }
+        if (if_modified_since != 0) {
+            json += ",\"if_modified_since\":" + std::to_string(if_modified_since);
+        }
+        if (max_response_bytes != 0) {
+            json += ",\"max_response_bytes\":" + std::to_string(max_response_bytes);
+        }
         json += "}";
         return json;
     }
@@ -119,45 +325,60 @@ public:
         return !error.empty();
     }
 
+    // True when a conditional request found the cached copy still valid
+    bool is_not_modified() const {
+        return status_code == 304;
+    }
+
     std::string text() const {
         return std::string(body.begin(), body.end());
     }
 
-    // Simple base64 decode
+    // Decode a base64 body (see simd::base64_decode)
+    static std::vector<uint8_t> base64_decode(const char* input, size_t size) {
+        std::vector<uint8_t> output(simd::base64_decoded_max(size));
+        output.resize(simd::base64_decode(input, size, output.data()));
+        return output;
+    }
+
     static std::vector<uint8_t> base64_decode(const std::string& input) {
-        static const uint8_t base64_table[128] = {
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
-            255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
-            52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 0, 255, 255,
-            255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
-            15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
-            255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
-            41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
-        };
-
-        std::vector<uint8_t> output;
-        if (input.empty()) return output;
-
-        output.reserve((input.size() * 3) / 4);
-        uint32_t buf = 0;
-        int bits = 0;
-
-        for (char c : input) {
-            if (c == '=') break;
-            if (c >= 128 || base64_table[c] == 255) continue;
-
-            buf = (buf << 6) | base64_table[c];
-            bits += 6;
-
-            if (bits >= 8) {
-                bits -= 8;
-                output.push_back((buf >> bits) & 0xFF);
-                buf &= (1 << bits) - 1;
-            }
+        return base64_decode(input.data(), input.size());
+    }
+
+    // Parse a host_http_request_v2 response
+    static Result<HttpResponse> from_wire(const uint8_t* data, size_t size) {
+        using namespace http_wire;
+        if (data == nullptr || size < RESPONSE_HEADER_SIZE ||
+            get<uint16_t>(data + 4) != RESPONSE_VERSION) {
+            return Error::io("malformed HTTP response");
+        }
+        uint32_t total = get<uint32_t>(data);
+        uint32_t header_count = get<uint32_t>(data + 12);
+        uint32_t error_len = get<uint32_t>(data + 16);
+        uint32_t body_len = get<uint32_t>(data + 20);
+        if (total > size || total < RESPONSE_HEADER_SIZE + (uint64_t)error_len + body_len) {
+            return Error::io("malformed HTTP response");
         }
 
-        return output;
+        const uint8_t* p = data + RESPONSE_HEADER_SIZE;
+        const uint8_t* body_start = data + total - body_len;
+        if (error_len > 0) {
+            return Error::other(std::string(reinterpret_cast<const char*>(p), error_len));
+        }
+
+        HttpResponse resp;
+        resp.status_code = (int)get<uint32_t>(data + 8);
+        for (uint32_t i = 0; i < header_count; i++) {
+            std::string key;
+            std::string value;
+            if (!get_prefixed<uint16_t>(p, body_start, key) ||
+                !get_prefixed<uint32_t>(p, body_start, value)) {
+                return Error::io("malformed HTTP response");
+            }
+            resp.headers[std::move(key)] = std::move(value);
+        }
+        resp.body.assign(body_start, body_start + body_len);
+        return resp;
     }
 
     // Parse from JSON response
@@ -181,8 +402,7 @@ public:
             pos += 8;
             size_t end = json.find("\"", pos);
             if (end != std::string::npos) {
-                std::string body_b64 = json.substr(pos, end - pos);
-                resp.body = base64_decode(body_b64);
+                resp.body = base64_decode(json.data() + pos, end - pos);
             }
         }
 
@@ -204,13 +424,250 @@ public:
     }
 };
 
+// Streaming HTTP request
+// Bodies move in caller-sized chunks instead of whole buffers: upload with
+// write(), then pull the response body with read(), which the host fills
+// directly in the caller's buffer. Memory use is bounded by the chunk size
+// whatever the size of the object. The stream is closed (and the request
+// aborted if still running) when the HttpStream is destroyed.
+//
+// The host starts the request as soon as the stream is opened and does not
+// block the instance until response() or read(), so several streams opened
+// back to back run concurrently (see Http::submit / Http::wait_any).
+class HttpStream {
+public:
+    // Flags for open()
+    static constexpr uint32_t UPLOAD = 1 << 0;
+
+    // Most finish() reserves up front from Content-Length when the request
+    // sets no max_response_bytes; larger bodies grow chunk by chunk
+    static constexpr size_t MAX_FINISH_RESERVE = 1024 * 1024;
+
+    HttpStream() : id_(0), position_(0), have_response_(false), max_response_bytes_(0) {}
+
+    // Start a request
+    // With UPLOAD, req.body is the first chunk of the request body and
+    // write() appends the rest; otherwise req.body is the whole body.
+    static Result<HttpStream> open(const HttpRequest& req, uint32_t flags = 0) {
+        std::vector<uint8_t> header = req.encode_header();
+        uint64_t result = metrics::host([&] { return host_http_open(header.data(), (uint32_t)header.size(),
+                                                                    req.body.data(), (uint32_t)req.body.size(), flags); });
+
+        // Unpack: lower 32 bits = stream id, upper 32 bits = error pointer
+        uint32_t id = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+
+        if (err_ptr != 0) {
+            return stream_error(err_ptr);
+        }
+        if (id == 0) {
+            return Error::io("HTTP open failed");
+        }
+        HttpStream stream(id);
+        stream.max_response_bytes_ = req.max_response_bytes;
+        return stream;
+    }
+
+    ~HttpStream() { close(); }
+
+    HttpStream(const HttpStream&) = delete;
+    HttpStream& operator=(const HttpStream&) = delete;
+
+    HttpStream(HttpStream&& other) noexcept
+        : id_(other.id_), position_(other.position_),
+          have_response_(other.have_response_), response_(std::move(other.response_)),
+          max_response_bytes_(other.max_response_bytes_) {
+        other.id_ = 0;
+    }
+
+    HttpStream& operator=(HttpStream&& other) noexcept {
+        if (this != &other) {
+            close();
+            id_ = other.id_;
+            position_ = other.position_;
+            have_response_ = other.have_response_;
+            response_ = std::move(other.response_);
+            max_response_bytes_ = other.max_response_bytes_;
+            other.id_ = 0;
+        }
+        return *this;
+    }
+
+    bool is_open() const { return id_ != 0; }
+    uint32_t id() const { return id_; }
+
+    // Append a chunk to the request body (UPLOAD streams only)
+    Result<void> write(ConstByteSpan data) {
+        if (id_ == 0) {
+            return Error::invalid_input("stream is closed");
+        }
+        uint32_t err_ptr = metrics::host([&] { return host_http_write(id_, data.data(), (uint32_t)data.size()); });
+        if (err_ptr != 0) {
+            return stream_error(err_ptr);
+        }
+        return Result<void>();
+    }
+
+    // Finish the upload and wait for the status and headers
+    // The returned response has an empty body; read it with read().
+    Result<const HttpResponse*> response() {
+        if (have_response_) {
+            return &response_;
+        }
+        if (id_ == 0) {
+            return Error::invalid_input("stream is closed");
+        }
+
+        uint64_t result = metrics::host([&] { return host_http_response(id_); });
+
+        // Unpack: lower 32 bits = pointer, upper 32 bits = size
+        uint32_t response_ptr = result & 0xFFFFFFFF;
+        uint32_t response_size = (result >> 32) & 0xFFFFFFFF;
+
+        if (response_ptr == 0) {
+            return Error::other("HTTP request failed");
+        }
+
+        HostBuffer buf(reinterpret_cast<uint8_t*>(response_ptr), response_size);
+        auto parsed = HttpResponse::from_wire(buf.data(), buf.size());
+        if (parsed.is_err()) {
+            return parsed.unwrap_err();
+        }
+        response_ = std::move(parsed.unwrap());
+        have_response_ = true;
+        return &response_;
+    }
+
+    // Read the next out.size() bytes of the response body into out
+    // Returns: Number of bytes read; less than out.size() only at the end
+    // of the body, 0 once it is exhausted
+    Result<int64_t> read(ByteSpan out) {
+        if (id_ == 0) {
+            return Error::invalid_input("stream is closed");
+        }
+        uint64_t result = metrics::host([&] { return host_http_read(id_, out.data(), (uint32_t)out.size()); });
+
+        // Unpack: lower 32 bits = bytes read, upper 32 bits = error pointer
+        uint32_t bytes_read = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+
+        if (err_ptr != 0) {
+            return stream_error(err_ptr);
+        }
+        position_ += bytes_read;
+        return (int64_t)bytes_read;
+    }
+
+    // Discard the next n bytes of the response body
+    // Returns: Number of bytes skipped (less than n at the end of the body)
+    Result<int64_t> skip(int64_t n) {
+        uint8_t scratch[4096];
+        int64_t skipped = 0;
+        while (skipped < n) {
+            size_t chunk = (size_t)std::min<int64_t>(n - skipped, sizeof(scratch));
+            auto result = read(ByteSpan(scratch, chunk));
+            if (result.is_err()) {
+                return result.unwrap_err();
+            }
+            skipped += result.unwrap();
+            if ((size_t)result.unwrap() < chunk) {
+                break;
+            }
+        }
+        return skipped;
+    }
+
+    // Collect the rest of the response body and close the stream
+    Result<HttpResponse> finish() {
+        auto resp = response();
+        if (resp.is_err()) {
+            close();
+            return resp.unwrap_err();
+        }
+        HttpResponse out = *resp.unwrap();
+
+        // Content-Length comes from the server: reserve no more than the
+        // host would deliver anyway (max_response_bytes) or a fixed limit
+        const size_t chunk = 64 * 1024;
+        auto it = out.headers.find("Content-Length");
+        if (it != out.headers.end()) {
+            uint64_t limit = max_response_bytes_ > 0 ? (uint64_t)max_response_bytes_ : MAX_FINISH_RESERVE;
+            uint64_t length = std::strtoull(it->second.c_str(), nullptr, 10);
+            out.body.reserve((size_t)std::min(length, limit));
+        }
+        while (true) {
+            size_t used = out.body.size();
+            out.body.resize(used + chunk);
+            auto n = read(ByteSpan(out.body.data() + used, chunk));
+            if (n.is_err()) {
+                close();
+                return n.unwrap_err();
+            }
+            out.body.resize(used + (size_t)n.unwrap());
+            if ((size_t)n.unwrap() < chunk) {
+                break;
+            }
+        }
+        close();
+        return out;
+    }
+
+    // Bytes of the response body consumed so far
+    int64_t position() const { return position_; }
+
+    void close() {
+        if (id_ != 0) {
+            metrics::host([&] { host_http_close(id_); });
+            id_ = 0;
+        }
+    }
+
+private:
+    uint32_t id_;
+    int64_t position_;
+    bool have_response_;
+    HttpResponse response_;
+    int64_t max_response_bytes_;
+
+    explicit HttpStream(uint32_t id) : id_(id), position_(0), have_response_(false), max_response_bytes_(0) {}
+
+    static Error stream_error(uint32_t err_ptr) {
+        HostBuffer msg = HostBuffer::from_string(err_ptr);
+        return Error::other(msg.to_string());
+    }
+};
+
 // HTTP client
 class Http {
 public:
+    // Send a request through host_http_request_v2
+    // The body is handed to the host in place and the response body is
+    // copied once out of the host buffer.
     static Result<HttpResponse> request(const HttpRequest& req) {
+        std::vector<uint8_t> header = req.encode_header();
+
+        uint64_t result = metrics::host([&] { return host_http_request_v2(header.data(), (uint32_t)header.size(),
+                                                                          req.body.data(), (uint32_t)req.body.size()); });
+
+        // Unpack: lower 32 bits = pointer, upper 32 bits = size
+        uint32_t response_ptr = result & 0xFFFFFFFF;
+        uint32_t response_size = (result >> 32) & 0xFFFFFFFF;
+
+        if (response_ptr == 0) {
+            return Error::other("HTTP request failed");
+        }
+
+        HostBuffer response(reinterpret_cast<uint8_t*>(response_ptr), response_size);
+        return HttpResponse::from_wire(response.data(), response.size());
+    }
+
+    // Send a request through the JSON-based host_http_request
+    // Only for hosts that predate host_http_request_v2: the body is
+    // inflated to a decimal JSON array and the response is base64.
+    static Result<HttpResponse> request_json(const HttpRequest& req) {
         std::string request_json = req.to_json();
 
-        uint64_t result = host_http_request(request_json.c_str());
+        uint64_t result = metrics::host([&] { return host_http_request(request_json.c_str()); });
 
         // Unpack: lower 32 bits = pointer, upper 32 bits = size
         uint32_t response_ptr = result & 0xFFFFFFFF;
@@ -221,10 +678,125 @@ public:
         }
 
         // Read response from memory
-        const char* response_data = reinterpret_cast<const char*>(response_ptr);
-        std::string response_json(response_data, response_size);
+        HostBuffer response(reinterpret_cast<uint8_t*>(response_ptr), response_size);
+        return HttpResponse::from_json(response.to_string());
+    }
+
+    // Start a streaming request (see HttpStream)
+    static Result<HttpStream> open(const HttpRequest& req, uint32_t flags = 0) {
+        return HttpStream::open(req, flags);
+    }
+
+    // An in-flight request started with submit()
+    using Ticket = HttpStream;
+
+    // Start a request without waiting for it
+    // Requests submitted back to back run concurrently on the host; collect
+    // each with wait_any() and Ticket::finish().
+    static Result<Ticket> submit(const HttpRequest& req) {
+        return HttpStream::open(req);
+    }
+
+    // Wait until one of the open tickets has its response
+    // Finished (closed) tickets are skipped, so calling finish() on the
+    // returned ticket and waiting again walks the batch in completion order.
+    // Arguments:
+    //   tickets - The tickets to wait on
+    //   timeout_ms - How long to wait (-1 = indefinitely)
+    // Returns: The index of the ready ticket in tickets
+    static Result<size_t> wait_any(Span<Ticket> tickets, int32_t timeout_ms = -1) {
+        std::vector<uint32_t> ids;
+        std::vector<size_t> index;
+        ids.reserve(tickets.size());
+        index.reserve(tickets.size());
+        for (size_t i = 0; i < tickets.size(); i++) {
+            if (tickets[i].is_open()) {
+                ids.push_back(tickets[i].id());
+                index.push_back(i);
+            }
+        }
+        if (ids.empty()) {
+            return Error::invalid_input("no pending tickets");
+        }
 
-        return HttpResponse::from_json(response_json);
+        uint64_t result = metrics::host([&] { return host_http_wait_any(ids.data(), (uint32_t)ids.size(), timeout_ms); });
+
+        // Unpack: lower 32 bits = index of the ready stream, upper 32 bits = error pointer
+        uint32_t ready = (uint32_t)(result & 0xFFFFFFFF);
+        uint32_t err_ptr = (uint32_t)((result >> 32) & 0xFFFFFFFF);
+
+        if (err_ptr != 0) {
+            HostBuffer msg = HostBuffer::from_string(err_ptr);
+            return Error::other(msg.to_string());
+        }
+        if (ready >= ids.size()) {
+            return Error::io("timed out waiting for HTTP responses");
+        }
+        return index[ready];
+    }
+
+    // Run requests concurrently and return their responses in request order
+    // Takes as long as the slowest request rather than the sum.
+    static std::vector<Result<HttpResponse>> request_all(const std::vector<HttpRequest>& reqs) {
+        std::vector<Result<Ticket>> tickets;
+        tickets.reserve(reqs.size());
+        for (const auto& req : reqs) {
+            tickets.push_back(submit(req));
+        }
+
+        std::vector<Result<HttpResponse>> responses;
+        responses.reserve(reqs.size());
+        for (auto& ticket : tickets) {
+            if (ticket.is_err()) {
+                responses.push_back(ticket.unwrap_err());
+            } else {
+                responses.push_back(ticket.unwrap().finish());
+            }
+        }
+        return responses;
+    }
+
+    // Read out.size() bytes of the resource at offset into out
+    // Maps an HTTP object onto the fs_read offset/size model: only the
+    // requested range is transferred when the server honors Range, and
+    // memory use is bounded by out.size() either way.
+    // Returns: Number of bytes read (0 at or past the end of the object)
+    static Result<int64_t> read_range(const HttpRequest& req, int64_t offset, ByteSpan out) {
+        if (out.empty()) {
+            return (int64_t)0;
+        }
+        HttpRequest ranged = req;
+        ranged.add_header("Range", "bytes=" + std::to_string(offset) + "-" +
+                                   std::to_string(offset + (int64_t)out.size() - 1));
+
+        auto stream = HttpStream::open(ranged);
+        if (stream.is_err()) {
+            return stream.unwrap_err();
+        }
+        HttpStream& s = stream.unwrap();
+        auto resp = s.response();
+        if (resp.is_err()) {
+            return resp.unwrap_err();
+        }
+
+        int status = resp.unwrap()->status_code;
+        if (status == 416) {
+            return (int64_t)0; // Range not satisfiable: offset is past the end
+        }
+        if (!resp.unwrap()->is_success()) {
+            return Error::io("HTTP error: " + std::to_string(status));
+        }
+        // A server that ignores Range sends the whole object from the start
+        if (status != 206 && offset > 0) {
+            auto skipped = s.skip(offset);
+            if (skipped.is_err()) {
+                return skipped.unwrap_err();
+            }
+            if (skipped.unwrap() < offset) {
+                return (int64_t)0;
+            }
+        }
+        return s.read(out);
     }
 
     static Result<HttpResponse> get(const std::string& url) {
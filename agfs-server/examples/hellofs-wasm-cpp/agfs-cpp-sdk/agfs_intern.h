@@ -0,0 +1,89 @@
+#ifndef AGFS_INTERN_H
+#define AGFS_INTERN_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace agfs {
+
+// Maps paths to small integer ids that stay valid for the interner's life
+//
+// Plugins that keep per-file state (open counts, cached sizes, dirty
+// flags) can key it by id instead of by string, so the map lookups after
+// the first intern() hash and compare a uint32_t:
+//
+//   agfs::PathInterner paths;
+//   std::unordered_map<uint32_t, Entry> entries;
+//
+//   Result<FileInfo> stat(std::string_view path) override {
+//       uint32_t id = paths.find(path);
+//       if (id == agfs::PathInterner::NONE) return Error::not_found();
+//       ... entries[id] ...
+//   }
+//
+// Paths are stored as given: "/a" and "/a/" get different ids. Ids are
+// never reused and entries are only dropped by clear(), so intern paths
+// the plugin knows about (created files, listed entries), not every path a
+// caller asks for.
+class PathInterner {
+public:
+    // Id never returned by intern()
+    static constexpr uint32_t NONE = 0;
+
+    // Id of path, adding it if needed
+    uint32_t intern(std::string_view path) {
+        auto it = ids_.find(path);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        // deque never moves its elements, so views into them stay valid
+        paths_.emplace_back(path);
+        uint32_t id = (uint32_t)paths_.size();
+        ids_.emplace(std::string_view(paths_.back()), id);
+        bytes_ += path.size();
+        return id;
+    }
+
+    // Id of path, or NONE when it was never interned
+    uint32_t find(std::string_view path) const {
+        auto it = ids_.find(path);
+        return it == ids_.end() ? NONE : it->second;
+    }
+
+    // Path of id, or "" for NONE and unknown ids
+    // The view stays valid until clear().
+    std::string_view path(uint32_t id) const {
+        if (id == NONE || id > paths_.size()) {
+            return std::string_view();
+        }
+        return paths_[id - 1];
+    }
+
+    size_t size() const {
+        return paths_.size();
+    }
+
+    // Total length of the interned paths
+    size_t bytes() const {
+        return bytes_;
+    }
+
+    // Forget every path; ids handed out before are no longer valid
+    void clear() {
+        ids_.clear();
+        paths_.clear();
+        bytes_ = 0;
+    }
+
+private:
+    std::deque<std::string> paths_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    size_t bytes_ = 0;
+};
+
+} // namespace agfs
+
+#endif // AGFS_INTERN_H
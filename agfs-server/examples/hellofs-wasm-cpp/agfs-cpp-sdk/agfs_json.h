@@ -0,0 +1,750 @@
+#ifndef AGFS_JSON_H
+#define AGFS_JSON_H
+
+#include "agfs_arena.h"
+#include "agfs_simd.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Small JSON writer and reader for the SDK's own JSON
+//
+// The exports only flatten config objects, emit FileInfo and stats and
+// read FileInfo replies from the host, so the SDK does not need a JSON
+// DOM; nlohmann/json is only included with -DAGFS_SDK_WITH_NLOHMANN (see
+// agfs_ffi.h).
+
+namespace agfs {
+namespace ffi {
+
+// RFC3339 UTC ("2024-05-01T12:00:00Z") of a Unix time; 0, FileInfo's
+// "unset", is Go's zero time. Writes 20 bytes to out.
+inline void format_rfc3339(int64_t unix_seconds, char* out) {
+    static const char zero[] = "0001-01-01T00:00:00Z";
+    int64_t days = unix_seconds / 86400;
+    int64_t secs = unix_seconds % 86400;
+    if (secs < 0) {
+        secs += 86400;
+        days--;
+    }
+    // Civil date from days since 1970-01-01 (proleptic Gregorian)
+    int64_t z = days + 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int64_t day = doy - (153 * mp + 2) / 5 + 1;
+    int64_t month = mp < 10 ? mp + 3 : mp - 9;
+    int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+    if (unix_seconds == 0 || year < 1 || year > 9999) {
+        std::memcpy(out, zero, 20);
+        return;
+    }
+    auto put2 = [](char* p, int64_t v) {
+        p[0] = (char)('0' + v / 10);
+        p[1] = (char)('0' + v % 10);
+    };
+    put2(out, year / 100);
+    put2(out + 2, year % 100);
+    out[4] = '-';
+    put2(out + 5, month);
+    out[7] = '-';
+    put2(out + 8, day);
+    out[10] = 'T';
+    put2(out + 11, secs / 3600);
+    out[13] = ':';
+    put2(out + 14, secs / 60 % 60);
+    out[16] = ':';
+    put2(out + 17, secs % 60);
+    out[19] = 'Z';
+}
+
+// Unix time of an RFC3339 timestamp (fraction ignored; Z or +hh:mm
+// offset); Go's zero time gives 0. Returns false if text is not one.
+inline bool parse_rfc3339(std::string_view text, int64_t& unix_seconds) {
+    auto digits = [&](size_t pos, size_t n, int64_t& v) {
+        if (pos + n > text.size()) {
+            return false;
+        }
+        v = 0;
+        for (size_t i = pos; i < pos + n; i++) {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
+            }
+            v = v * 10 + (text[i] - '0');
+        }
+        return true;
+    };
+    int64_t year, month, day, hour, minute, second;
+    if (!digits(0, 4, year) || text.size() < 20 || text[4] != '-' || !digits(5, 2, month) ||
+        text[7] != '-' || !digits(8, 2, day) || (text[10] != 'T' && text[10] != 't') ||
+        !digits(11, 2, hour) || text[13] != ':' || !digits(14, 2, minute) || text[16] != ':' ||
+        !digits(17, 2, second) || month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    size_t pos = 19;
+    if (text[pos] == '.') {
+        pos++;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            pos++;
+        }
+    }
+    int64_t offset = 0;
+    if (pos < text.size() && (text[pos] == 'Z' || text[pos] == 'z') && pos + 1 == text.size()) {
+        offset = 0;
+    } else if (pos + 6 == text.size() && (text[pos] == '+' || text[pos] == '-') && text[pos + 3] == ':') {
+        int64_t oh, om;
+        if (!digits(pos + 1, 2, oh) || !digits(pos + 4, 2, om)) {
+            return false;
+        }
+        offset = (oh * 60 + om) * 60 * (text[pos] == '-' ? -1 : 1);
+    } else {
+        return false;
+    }
+    // Days since 1970-01-01 of the civil date
+    int64_t y = year - (month <= 2 ? 1 : 0);
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * 146097 + doe - 719468;
+    unix_seconds = days * 86400 + hour * 3600 + minute * 60 + second - offset;
+    if (year == 1 && month == 1 && day == 1 && hour == 0 && minute == 0 && second == 0 && offset == 0) {
+        unix_seconds = 0;
+    }
+    return true;
+}
+
+// Streams JSON into a fixed buffer without building a DOM
+//
+// Output past the capacity is dropped but still counted, so after an
+// overflowing pass size() is the capacity a second pass needs; a writer
+// over (nullptr, 0) only measures. Commas between members and elements
+// are inserted automatically.
+class JsonWriter {
+public:
+    JsonWriter(char* buf, size_t cap) : buf_(buf), cap_(cap) {}
+
+    size_t size() const { return len_; }
+    bool overflow() const { return len_ > cap_; }
+
+    // Raw output, also the sink simd::json_escape writes to
+    void append(const char* s, size_t n) {
+        if (n != 0 && len_ + n <= cap_) {
+            std::memcpy(buf_ + len_, s, n);
+        }
+        len_ += n;
+    }
+
+    void append(char c) {
+        if (len_ < cap_) {
+            buf_[len_] = c;
+        }
+        len_++;
+    }
+
+    JsonWriter& begin_object() { return open('{'); }
+    JsonWriter& end_object() { return close('}'); }
+    JsonWriter& begin_array() { return open('['); }
+    JsonWriter& end_array() { return close(']'); }
+
+    JsonWriter& key(std::string_view k) {
+        separate();
+        quoted(k);
+        append(':');
+        comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& string(std::string_view v) {
+        separate();
+        quoted(v);
+        comma_ = true;
+        return *this;
+    }
+
+    // Any integer type
+    template <typename T, typename std::enable_if<std::is_integral<T>::value &&
+                                                  !std::is_same<T, bool>::value, int>::type = 0>
+    JsonWriter& number(T v) {
+        separate();
+        if constexpr (std::is_signed<T>::value) {
+            if (v < 0) {
+                append('-');
+                return number_abs(0 - (uint64_t)(int64_t)v);
+            }
+        }
+        return number_abs((uint64_t)v);
+    }
+
+    // Shortest form that reads back as v, with ".0" kept on whole numbers;
+    // NaN and infinities have no JSON form and are written as null
+    JsonWriter& number(double v) {
+        if (!std::isfinite(v)) {
+            return null();
+        }
+        char text[32];
+        int n = 0;
+        for (int precision = 1; precision <= 17; precision++) {
+            n = std::snprintf(text, sizeof(text), "%.*g", precision, v);
+            if (std::strtod(text, nullptr) == v) {
+                break;
+            }
+        }
+        if (std::strpbrk(text, ".e") == nullptr) {
+            text[n++] = '.';
+            text[n++] = '0';
+        }
+        separate();
+        append(text, (size_t)n);
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& boolean(bool v) {
+        separate();
+        v ? append("true", 4) : append("false", 5);
+        comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& null() {
+        separate();
+        append("null", 4);
+        comma_ = true;
+        return *this;
+    }
+
+    // A value that already is JSON text
+    JsonWriter& raw_value(std::string_view json) {
+        separate();
+        append(json.data(), json.size());
+        comma_ = true;
+        return *this;
+    }
+
+    // RFC3339 string of a Unix time (format_rfc3339)
+    JsonWriter& time(int64_t unix_seconds) {
+        char text[20];
+        format_rfc3339(unix_seconds, text);
+        separate();
+        append('"');
+        append(text, sizeof(text));
+        append('"');
+        comma_ = true;
+        return *this;
+    }
+
+private:
+    void separate() {
+        if (comma_) {
+            append(',');
+        }
+    }
+
+    JsonWriter& open(char c) {
+        separate();
+        append(c);
+        comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& close(char c) {
+        append(c);
+        comma_ = true;
+        return *this;
+    }
+
+    void quoted(std::string_view s) {
+        append('"');
+        simd::json_escape(*this, s.data(), s.size());
+        append('"');
+    }
+
+    JsonWriter& number_abs(uint64_t v) {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[sizeof(digits) - ++n] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v != 0);
+        append(digits + sizeof(digits) - n, n);
+        comma_ = true;
+        return *this;
+    }
+
+    char* buf_;
+    size_t cap_;
+    size_t len_ = 0;
+    bool comma_ = false;
+};
+
+// Measure, then write into an arena string of the exact size
+// The string lives in the scratch arena.
+template <typename Write>
+ArenaString write_json(Write&& write) {
+    JsonWriter measure(nullptr, 0);
+    write(measure);
+    ArenaString out(measure.size(), '\0');
+    JsonWriter w(&out[0], out.size());
+    write(w);
+    return out;
+}
+
+// Pull reader over JSON text, validating as it goes
+//
+//   JsonReader r(text);
+//   std::string key;
+//   if (r.begin_object()) {
+//       while (r.next_member(key)) {
+//           if (key == "Size") r.read_number(num); else r.skip_value();
+//       }
+//   }
+//   if (r.failed()) ...
+//
+// The first syntax error stops the reader: every call after it returns
+// false. Strings are checked to be UTF-8 and nesting is limited to
+// MAX_DEPTH.
+class JsonReader {
+public:
+    enum class Type { Invalid, Null, Bool, Number, String, Array, Object };
+
+    struct Number {
+        std::string_view text; // the literal as written
+        bool is_integer = false; // no fraction or exponent, fits int64
+        int64_t i64 = 0;
+        double f64 = 0;
+    };
+
+    static constexpr int MAX_DEPTH = 128;
+
+    explicit JsonReader(std::string_view text) : text_(text) {}
+
+    bool failed() const { return failed_; }
+
+    // True if only whitespace is left after the values read
+    bool at_end() {
+        skip_ws();
+        return !failed_ && pos_ == text_.size();
+    }
+
+    // Type of the next value, without consuming it
+    Type peek() {
+        skip_ws();
+        if (failed_ || pos_ >= text_.size()) {
+            return Type::Invalid;
+        }
+        switch (text_[pos_]) {
+            case 'n': return Type::Null;
+            case 't': case 'f': return Type::Bool;
+            case '"': return Type::String;
+            case '[': return Type::Array;
+            case '{': return Type::Object;
+            default:
+                return (text_[pos_] == '-' || (text_[pos_] >= '0' && text_[pos_] <= '9'))
+                           ? Type::Number : Type::Invalid;
+        }
+    }
+
+    bool begin_object() { return open('{'); }
+    bool begin_array() { return open('['); }
+
+    // Read the next member's key and the ':' after it; false (consuming
+    // the '}') once the object ends
+    bool next_member(std::string& key) {
+        key.clear();
+        return member(&key);
+    }
+
+    // True if another element follows; false (consuming the ']') once the
+    // array ends
+    bool next_element() {
+        return next(']');
+    }
+
+    bool read_null() {
+        return peek() == Type::Null && literal("null");
+    }
+
+    bool read_bool(bool& out) {
+        if (peek() != Type::Bool) {
+            return fail();
+        }
+        out = text_[pos_] == 't';
+        return literal(out ? "true" : "false");
+    }
+
+    bool read_string(std::string& out) {
+        out.clear();
+        skip_ws();
+        return scan_string(&out);
+    }
+
+    bool read_number(Number& out) {
+        skip_ws();
+        return scan_number(&out);
+    }
+
+    // Skip over the next value, whatever it is
+    bool skip_value() {
+        switch (peek()) {
+            case Type::Null: return literal("null");
+            case Type::Bool: return literal(text_[pos_] == 't' ? "true" : "false");
+            case Type::String: return scan_string(nullptr);
+            case Type::Number: return scan_number(nullptr);
+            case Type::Array:
+                if (!begin_array()) {
+                    return false;
+                }
+                while (next_element()) {
+                    if (!skip_value()) {
+                        return false;
+                    }
+                }
+                return !failed_;
+            case Type::Object: {
+                if (!begin_object()) {
+                    return false;
+                }
+                while (member(nullptr)) {
+                    if (!skip_value()) {
+                        return false;
+                    }
+                }
+                return !failed_;
+            }
+            case Type::Invalid:
+                break;
+        }
+        return fail();
+    }
+
+    // True if text is exactly one JSON value
+    static bool accept(std::string_view text) {
+        JsonReader r(text);
+        return r.skip_value() && r.at_end();
+    }
+
+private:
+    bool fail() {
+        failed_ = true;
+        return false;
+    }
+
+    void skip_ws() {
+        while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' ||
+                                       text_[pos_] == '\n' || text_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool literal(const char* word) {
+        size_t n = std::strlen(word);
+        if (text_.compare(pos_, n, word) != 0) {
+            return fail();
+        }
+        pos_ += n;
+        first_ = false;
+        return true;
+    }
+
+    bool open(char c) {
+        skip_ws();
+        if (failed_ || pos_ >= text_.size() || text_[pos_] != c) {
+            return fail();
+        }
+        if (++depth_ > MAX_DEPTH) {
+            return fail();
+        }
+        pos_++;
+        first_ = true;
+        return true;
+    }
+
+    // Separator handling shared by next_member and next_element: a value
+    // just ended (first_ false) or the container just opened (first_ true)
+    bool next(char close) {
+        skip_ws();
+        if (failed_ || pos_ >= text_.size()) {
+            return fail();
+        }
+        if (text_[pos_] == close) {
+            pos_++;
+            depth_--;
+            first_ = false;
+            return false;
+        }
+        if (!first_) {
+            if (text_[pos_] != ',') {
+                return fail();
+            }
+            pos_++;
+        }
+        first_ = false;
+        return true;
+    }
+
+    bool member(std::string* key) {
+        if (!next('}')) {
+            return false;
+        }
+        skip_ws();
+        if (!scan_string(key)) {
+            return false;
+        }
+        skip_ws();
+        if (pos_ >= text_.size() || text_[pos_] != ':') {
+            return fail();
+        }
+        pos_++;
+        return true;
+    }
+
+    static int hex(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool hex4(uint32_t& v) {
+        if (text_.size() - pos_ < 4) {
+            return false;
+        }
+        v = 0;
+        for (int i = 0; i < 4; i++) {
+            int d = hex(text_[pos_++]);
+            if (d < 0) {
+                return false;
+            }
+            v = v << 4 | (uint32_t)d;
+        }
+        return true;
+    }
+
+    static void put_utf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += (char)cp;
+        } else if (cp < 0x800) {
+            out += (char)(0xC0 | cp >> 6);
+            out += (char)(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += (char)(0xE0 | cp >> 12);
+            out += (char)(0x80 | (cp >> 6 & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        } else {
+            out += (char)(0xF0 | cp >> 18);
+            out += (char)(0x80 | (cp >> 12 & 0x3F));
+            out += (char)(0x80 | (cp >> 6 & 0x3F));
+            out += (char)(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Length of the UTF-8 sequence at pos_, or 0 if it is malformed
+    size_t utf8_length() const {
+        const unsigned char* p = (const unsigned char*)text_.data() + pos_;
+        size_t left = text_.size() - pos_;
+        auto cont = [&](size_t i) { return i < left && (p[i] & 0xC0) == 0x80; };
+        if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+            return cont(1) ? 2 : 0;
+        }
+        if (p[0] >= 0xE0 && p[0] <= 0xEF) {
+            // No overlong forms or surrogates
+            if (left < 2 || (p[0] == 0xE0 && p[1] < 0xA0) || (p[0] == 0xED && p[1] > 0x9F)) {
+                return 0;
+            }
+            return cont(1) && cont(2) ? 3 : 0;
+        }
+        if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+            if (left < 2 || (p[0] == 0xF0 && p[1] < 0x90) || (p[0] == 0xF4 && p[1] > 0x8F)) {
+                return 0;
+            }
+            return cont(1) && cont(2) && cont(3) ? 4 : 0;
+        }
+        return 0;
+    }
+
+    // A string at pos_, decoded into out unless it is null
+    bool scan_string(std::string* out) {
+        if (failed_ || pos_ >= text_.size() || text_[pos_] != '"') {
+            return fail();
+        }
+        pos_++;
+        while (true) {
+            // Plain runs are copied in one piece
+            size_t run = pos_;
+            while (run < text_.size()) {
+                unsigned char c = (unsigned char)text_[run];
+                if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+                    break;
+                }
+                run++;
+            }
+            if (out != nullptr) {
+                out->append(text_.data() + pos_, run - pos_);
+            }
+            pos_ = run;
+            if (pos_ >= text_.size()) {
+                return fail();
+            }
+            unsigned char c = (unsigned char)text_[pos_];
+            if (c == '"') {
+                pos_++;
+                first_ = false;
+                return true;
+            }
+            if (c < 0x20) {
+                return fail();
+            }
+            if (c >= 0x80) {
+                size_t n = utf8_length();
+                if (n == 0) {
+                    return fail();
+                }
+                if (out != nullptr) {
+                    out->append(text_.data() + pos_, n);
+                }
+                pos_ += n;
+                continue;
+            }
+            // Escape
+            if (++pos_ >= text_.size()) {
+                return fail();
+            }
+            char e = text_[pos_++];
+            char plain = 0;
+            switch (e) {
+                case '"': plain = '"'; break;
+                case '\\': plain = '\\'; break;
+                case '/': plain = '/'; break;
+                case 'b': plain = '\b'; break;
+                case 'f': plain = '\f'; break;
+                case 'n': plain = '\n'; break;
+                case 'r': plain = '\r'; break;
+                case 't': plain = '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!hex4(cp)) {
+                        return fail();
+                    }
+                    if (cp >= 0xD800 && cp <= 0xDBFF) {
+                        // Surrogate pair
+                        uint32_t low;
+                        if (text_.compare(pos_, 2, "\\u") != 0) {
+                            return fail();
+                        }
+                        pos_ += 2;
+                        if (!hex4(low) || low < 0xDC00 || low > 0xDFFF) {
+                            return fail();
+                        }
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                        return fail();
+                    }
+                    if (out != nullptr) {
+                        put_utf8(*out, cp);
+                    }
+                    continue;
+                }
+                default:
+                    return fail();
+            }
+            if (out != nullptr) {
+                *out += plain;
+            }
+        }
+    }
+
+    // A number at pos_, parsed into out unless it is null
+    bool scan_number(Number* out) {
+        size_t start = pos_;
+        auto digit = [&] { return pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9'; };
+        if (pos_ < text_.size() && text_[pos_] == '-') {
+            pos_++;
+        }
+        if (!digit()) {
+            return fail();
+        }
+        if (text_[pos_] == '0') {
+            pos_++;
+        } else {
+            while (digit()) pos_++;
+        }
+        bool integer = true;
+        if (pos_ < text_.size() && text_[pos_] == '.') {
+            integer = false;
+            pos_++;
+            if (!digit()) {
+                return fail();
+            }
+            while (digit()) pos_++;
+        }
+        if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+            integer = false;
+            pos_++;
+            if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+                pos_++;
+            }
+            if (!digit()) {
+                return fail();
+            }
+            while (digit()) pos_++;
+        }
+        first_ = false;
+        if (out == nullptr) {
+            return true;
+        }
+
+        out->text = text_.substr(start, pos_ - start);
+        out->is_integer = false;
+        if (integer) {
+            // Accumulate as negative so INT64_MIN fits
+            bool negative = out->text[0] == '-';
+            int64_t v = 0;
+            bool overflow = false;
+            for (size_t i = negative ? 1 : 0; i < out->text.size(); i++) {
+                int d = out->text[i] - '0';
+                if (v < (INT64_MIN + d) / 10) {
+                    overflow = true;
+                    break;
+                }
+                v = v * 10 - d;
+            }
+            if (!overflow && (negative || v != INT64_MIN)) {
+                out->is_integer = true;
+                out->i64 = negative ? v : -v;
+            }
+        }
+        // strtod needs a terminated copy
+        char small[64];
+        std::string large;
+        const char* z = small;
+        if (out->text.size() < sizeof(small)) {
+            std::memcpy(small, out->text.data(), out->text.size());
+            small[out->text.size()] = '\0';
+        } else {
+            large.assign(out->text.data(), out->text.size());
+            z = large.c_str();
+        }
+        out->f64 = std::strtod(z, nullptr);
+        return true;
+    }
+
+    std::string_view text_;
+    size_t pos_ = 0;
+    int depth_ = 0;
+    bool first_ = false;
+    bool failed_ = false;
+};
+
+
+} // namespace ffi
+} // namespace agfs
+
+#endif // AGFS_JSON_H
@@ -0,0 +1,206 @@
+#ifndef AGFS_LZ4_H
+#define AGFS_LZ4_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// LZ4 block format compressor and decompressor
+//
+// Output is a raw LZ4 block (no frame header, no checksum), readable by
+// LZ4_decompress_safe and anything else that speaks the block format. The
+// compressor is the single-pass greedy matcher with a 4K-entry hash table
+// on the stack: it trades some ratio for no allocation and a small code
+// size, which is the right end of the curve for a plugin binary.
+namespace agfs {
+namespace lz4 {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;  // a block always ends with 5+ literals
+constexpr size_t MF_LIMIT = 12;      // no match starts in the last 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 12;
+
+// Worst-case compressed size of n bytes
+inline size_t compress_bound(size_t n) {
+    return n + n / 255 + 16;
+}
+
+namespace internal {
+
+inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash(uint32_t seq) {
+    return (seq * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Write a length continuation (the part above 15) as 255-runs
+inline uint8_t* put_length(uint8_t* op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// Bytes the sequence (lit_len literals, then an optional match) needs
+inline size_t sequence_size(size_t lit_len, size_t match_len) {
+    size_t n = 1 + lit_len + (lit_len >= 15 ? (lit_len - 15) / 255 + 1 : 0);
+    if (match_len != 0) {
+        size_t ml = match_len - MIN_MATCH;
+        n += 2 + (ml >= 15 ? (ml - 15) / 255 + 1 : 0);
+    }
+    return n;
+}
+
+} // namespace internal
+
+// Compress src into dst
+// Returns: Compressed size, or 0 if it does not fit in cap
+inline size_t compress(const uint8_t* src, size_t size, uint8_t* dst, size_t cap) {
+    using namespace internal;
+
+    uint8_t* op = dst;
+    uint8_t* const op_end = dst + cap;
+    size_t anchor = 0;
+
+    auto emit = [&](size_t lit_len, size_t offset, size_t match_len) -> bool {
+        if (sequence_size(lit_len, match_len) > (size_t)(op_end - op)) {
+            return false;
+        }
+        uint8_t* token = op++;
+        *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+        if (lit_len >= 15) {
+            op = put_length(op, lit_len - 15);
+        }
+        std::memcpy(op, src + anchor, lit_len);
+        op += lit_len;
+        if (match_len != 0) {
+            op[0] = (uint8_t)(offset & 0xFF);
+            op[1] = (uint8_t)(offset >> 8);
+            op += 2;
+            size_t ml = match_len - MIN_MATCH;
+            *token |= (uint8_t)(ml >= 15 ? 15 : ml);
+            if (ml >= 15) {
+                op = put_length(op, ml - 15);
+            }
+        }
+        return true;
+    };
+
+    if (size > MF_LIMIT) {
+        uint32_t table[1 << HASH_BITS];
+        std::memset(table, 0, sizeof(table));
+
+        const size_t match_limit = size - MF_LIMIT;
+        const size_t match_end = size - LAST_LITERALS;
+        size_t ip = 1;
+        while (ip < match_limit) {
+            uint32_t seq = read32(src + ip);
+            uint32_t h = hash(seq);
+            size_t ref = table[h];
+            table[h] = (uint32_t)ip;
+
+            if (ip - ref > MAX_OFFSET || read32(src + ref) != seq) {
+                // Step faster through data that does not compress
+                ip += 1 + ((ip - anchor) >> 6);
+                continue;
+            }
+
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                ip--;
+                ref--;
+            }
+            size_t len = MIN_MATCH;
+            while (ip + len < match_end && src[ip + len] == src[ref + len]) {
+                len++;
+            }
+            if (!emit(ip - anchor, ip - ref, len)) {
+                return 0;
+            }
+            ip += len;
+            anchor = ip;
+            if (ip - 2 < match_limit) {
+                table[hash(read32(src + ip - 2))] = (uint32_t)(ip - 2);
+            }
+        }
+    }
+
+    if (!emit(size - anchor, 0, 0)) {
+        return 0;
+    }
+    return (size_t)(op - dst);
+}
+
+// Decompress a block that expands to exactly out_size bytes
+// Every length and offset is bounds-checked, so malformed input fails
+// instead of reading or writing out of range.
+inline bool decompress(const uint8_t* src, size_t size, uint8_t* dst, size_t out_size) {
+    size_t ip = 0;
+    size_t op = 0;
+
+    auto get_length = [&](size_t& len) -> bool {
+        uint8_t b;
+        do {
+            if (ip >= size) {
+                return false;
+            }
+            b = src[ip++];
+            len += b;
+        } while (b == 255);
+        return true;
+    };
+
+    while (ip < size) {
+        uint8_t token = src[ip++];
+
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && !get_length(lit_len)) {
+            return false;
+        }
+        if (lit_len > size - ip || lit_len > out_size - op) {
+            return false;
+        }
+        std::memcpy(dst + op, src + ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == size) {
+            break; // the last sequence has no match
+        }
+
+        if (size - ip < 2) {
+            return false;
+        }
+        size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) {
+            return false;
+        }
+
+        size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(match_len)) {
+            return false;
+        }
+        match_len += MIN_MATCH;
+        if (match_len > out_size - op) {
+            return false;
+        }
+        // Byte by byte: the match may overlap the bytes it produces
+        const uint8_t* match = dst + op - offset;
+        for (size_t i = 0; i < match_len; i++) {
+            dst[op + i] = match[i];
+        }
+        op += match_len;
+    }
+    return op == out_size;
+}
+
+} // namespace lz4
+} // namespace agfs
+
+#endif // AGFS_LZ4_H
@@ -0,0 +1,478 @@
+#ifndef AGFS_MEMORY_H
+#define AGFS_MEMORY_H
+
+#include "agfs_arena.h"
+#include "agfs_ffi.h"
+#include "agfs_threads.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace agfs {
+
+// Fixed-size blocks carved from malloc'd slabs
+//
+// alloc/free are a free-list pop and push, so long-lived objects that are
+// created and dropped often (cache entries, tree nodes, FileInfo records)
+// reuse the same blocks instead of leaving holes of every size in the
+// heap. trim() gives slabs whose blocks are all free back to malloc.
+class BlockPool {
+public:
+    static constexpr size_t DEFAULT_SLAB_SIZE = 16 * 1024;
+
+    explicit BlockPool(size_t block_size, size_t slab_size = DEFAULT_SLAB_SIZE)
+        : block_size_(round_up(std::max(block_size, sizeof(Block)))),
+          blocks_per_slab_(std::max<size_t>(1, slab_size / block_size_)) {}
+
+    ~BlockPool() {
+        for (void* slab : slabs_) {
+            std::free(slab);
+        }
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    // nullptr when malloc fails
+    void* alloc() {
+        if (free_ == nullptr && !add_slab()) {
+            return nullptr;
+        }
+        Block* b = free_;
+        free_ = b->next;
+        free_count_--;
+        if (in_use() > high_water_) {
+            high_water_ = in_use();
+        }
+        return b;
+    }
+
+    void free(void* ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+        Block* b = static_cast<Block*>(ptr);
+        b->next = free_;
+        free_ = b;
+        free_count_++;
+    }
+
+    // Release the slabs holding no live block; returns the bytes released
+    size_t trim() {
+        if (free_count_ == 0) {
+            return 0;
+        }
+        std::vector<size_t> free_per_slab(slabs_.size(), 0);
+        for (Block* b = free_; b != nullptr; b = b->next) {
+            free_per_slab[slab_of(b)]++;
+        }
+
+        size_t slab_bytes = blocks_per_slab_ * block_size_;
+        size_t released = 0;
+        std::vector<bool> drop(slabs_.size(), false);
+        for (size_t i = 0; i < slabs_.size(); i++) {
+            if (free_per_slab[i] == blocks_per_slab_) {
+                drop[i] = true;
+                released += slab_bytes;
+            }
+        }
+        if (released == 0) {
+            return 0;
+        }
+
+        // Unlink the dropped slabs' blocks, then free the slabs
+        Block** link = &free_;
+        while (*link != nullptr) {
+            if (drop[slab_of(*link)]) {
+                *link = (*link)->next;
+                free_count_--;
+            } else {
+                link = &(*link)->next;
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < slabs_.size(); i++) {
+            if (drop[i]) {
+                std::free(slabs_[i]);
+            } else {
+                slabs_[kept++] = slabs_[i];
+            }
+        }
+        slabs_.resize(kept);
+        return released;
+    }
+
+    size_t block_size() const { return block_size_; }
+    // Blocks handed out and not freed
+    size_t in_use() const { return slabs_.size() * blocks_per_slab_ - free_count_; }
+    // Largest in_use() seen
+    size_t high_water() const { return high_water_; }
+    // Bytes held in slabs, used or not
+    size_t capacity() const { return slabs_.size() * blocks_per_slab_ * block_size_; }
+    // Bytes of free blocks in those slabs
+    size_t free_bytes() const { return free_count_ * block_size_; }
+
+private:
+    struct Block {
+        Block* next;
+    };
+
+    static size_t round_up(size_t n) {
+        constexpr size_t align = alignof(std::max_align_t);
+        return (n + align - 1) & ~(align - 1);
+    }
+
+    bool add_slab() {
+        uint8_t* slab = static_cast<uint8_t*>(std::malloc(blocks_per_slab_ * block_size_));
+        if (slab == nullptr) {
+            return false;
+        }
+        // Keep slabs sorted by address so slab_of can binary search
+        slabs_.insert(std::upper_bound(slabs_.begin(), slabs_.end(), (void*)slab, std::less<void*>()), slab);
+        for (size_t i = blocks_per_slab_; i > 0; i--) {
+            free(slab + (i - 1) * block_size_);
+        }
+        return true;
+    }
+
+    size_t slab_of(const Block* b) const {
+        auto it = std::upper_bound(slabs_.begin(), slabs_.end(), (void*)b, std::less<void*>());
+        return (size_t)(it - slabs_.begin()) - 1;
+    }
+
+    size_t block_size_;
+    size_t blocks_per_slab_;
+    std::vector<void*> slabs_;
+    Block* free_ = nullptr;
+    size_t free_count_ = 0;
+    size_t high_water_ = 0;
+};
+
+// Typed BlockPool: construct and destroy objects of one type
+//
+//   agfs::ObjectPool<agfs::FileInfo> infos;
+//   agfs::FileInfo* info = infos.make(agfs::FileInfo::file("a.txt", 0, 0644));
+//   ...
+//   infos.destroy(info);
+template<typename T>
+class ObjectPool {
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool: over-aligned type");
+
+    ObjectPool() : pool_(sizeof(T)) {}
+
+    // nullptr when malloc fails
+    template<typename... Args>
+    T* make(Args&&... args) {
+        void* p = pool_.alloc();
+        return p != nullptr ? new (p) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    void destroy(T* obj) {
+        if (obj != nullptr) {
+            obj->~T();
+            pool_.free(obj);
+        }
+    }
+
+    size_t trim() { return pool_.trim(); }
+    const BlockPool& blocks() const { return pool_; }
+
+private:
+    BlockPool pool_;
+};
+
+// Size-classed block pools for small allocations (up to MAX_SIZE bytes);
+// larger ones go to malloc
+class SmallPools {
+public:
+    static constexpr size_t CLASS_COUNT = 5;
+    static constexpr size_t MAX_SIZE = 256;
+
+    SmallPools() : pools_{BlockPool(16), BlockPool(32), BlockPool(64), BlockPool(128), BlockPool(256)} {}
+
+    // The per-instance pools used by PoolAllocator
+    static SmallPools& global() {
+        static SmallPools pools;
+        return pools;
+    }
+
+    void* alloc(size_t size) {
+        BlockPool* pool = pool_for(size);
+        return pool != nullptr ? pool->alloc() : std::malloc(size);
+    }
+
+    // size must be the size passed to alloc
+    void free(void* ptr, size_t size) {
+        BlockPool* pool = pool_for(size);
+        if (pool != nullptr) {
+            pool->free(ptr);
+        } else {
+            std::free(ptr);
+        }
+    }
+
+    size_t trim() {
+        size_t released = 0;
+        for (auto& pool : pools_) {
+            released += pool.trim();
+        }
+        return released;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const auto& pool : pools_) {
+            total += pool.capacity();
+        }
+        return total;
+    }
+
+    size_t free_bytes() const {
+        size_t total = 0;
+        for (const auto& pool : pools_) {
+            total += pool.free_bytes();
+        }
+        return total;
+    }
+
+private:
+    BlockPool* pool_for(size_t size) {
+        if (size > MAX_SIZE) {
+            return nullptr;
+        }
+        size_t i = 0;
+        while (pools_[i].block_size() < size) {
+            i++;
+        }
+        return &pools_[i];
+    }
+
+    BlockPool pools_[CLASS_COUNT];
+};
+
+// STL allocator backed by SmallPools::global()
+// For node containers and short strings that live across calls:
+//
+//   using Entries = std::map<agfs::PoolString, Entry, std::less<>,
+//                            agfs::PoolAllocator<std::pair<const agfs::PoolString, Entry>>>;
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(SmallPools::global().alloc(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        SmallPools::global().free(p, n * sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>&) const { return true; }
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+using PoolString = std::basic_string<char, std::char_traits<char>, PoolAllocator<char>>;
+
+namespace memory {
+
+// Heap usage of an instance, reported to the host by plugin_memory_stats
+//
+//   memory_bytes       - linear memory size; it never shrinks
+//   heap_bytes         - linear memory above __heap_base, i.e. what malloc
+//                        has grown into, free or not
+//   alloc_bytes/count  - live operator new allocations (std::string,
+//                        containers, plugin objects) and their peak
+//   scratch_bytes      - scratch arena chunks, and the arena's peak use
+//   pool_bytes         - SmallPools slabs, of which pool_free_bytes unused
+//   fragmentation      - share of heap_bytes none of the above accounts
+//                        for: free holes malloc cannot return, plus any
+//                        direct malloc calls (host buffers, C code)
+//
+// Build with -DAGFS_SDK_NO_HEAP_STATS to keep the default operator new;
+// alloc_* then read 0 and fragmentation is not computed.
+struct Stats {
+    uint64_t memory_bytes = 0;
+    uint64_t heap_bytes = 0;
+    uint64_t alloc_bytes = 0;
+    uint64_t alloc_count = 0;
+    uint64_t alloc_high_water = 0;
+    uint64_t scratch_bytes = 0;
+    uint64_t scratch_high_water = 0;
+    uint64_t pool_bytes = 0;
+    uint64_t pool_free_bytes = 0;
+    double fragmentation = 0;
+};
+
+// Live operator new allocations, kept by AGFS_EXPORT_HEAP_TRACKING
+#ifdef AGFS_SDK_THREADS
+// Worker threads (agfs_threads.h) allocate too
+struct HeapCounters {
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> high_water{0};
+};
+#else
+struct HeapCounters {
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+    uint64_t high_water = 0;
+};
+#endif
+
+// Raise a high-water mark to v; a compare-and-swap loop when workers race
+inline void raise_high_water(std::atomic<uint64_t>& mark, uint64_t v) {
+    uint64_t cur = mark.load(std::memory_order_relaxed);
+    while (v > cur && !mark.compare_exchange_weak(cur, v, std::memory_order_relaxed)) {
+    }
+}
+
+inline void raise_high_water(uint64_t& mark, uint64_t v) {
+    if (v > mark) {
+        mark = v;
+    }
+}
+
+inline HeapCounters& heap_counters() {
+    static HeapCounters c;
+    return c;
+}
+
+#if defined(__wasm__)
+extern "C" unsigned char __heap_base;
+
+inline uint64_t linear_memory_bytes() {
+    return (uint64_t)__builtin_wasm_memory_size(0) * 65536;
+}
+
+inline uint64_t heap_base() {
+    return (uint64_t)(uintptr_t)&__heap_base;
+}
+#else
+inline uint64_t linear_memory_bytes() { return 0; }
+inline uint64_t heap_base() { return 0; }
+#endif
+
+inline Stats stats() {
+    Stats s;
+    s.memory_bytes = linear_memory_bytes();
+    s.heap_bytes = s.memory_bytes > heap_base() ? s.memory_bytes - heap_base() : 0;
+    const HeapCounters& heap = heap_counters();
+    s.alloc_bytes = heap.bytes;
+    s.alloc_count = heap.count;
+    s.alloc_high_water = heap.high_water;
+    const Arena& scratch = Arena::scratch();
+    s.scratch_bytes = scratch.capacity();
+    s.scratch_high_water = scratch.high_water();
+    const SmallPools& pools = SmallPools::global();
+    s.pool_bytes = pools.capacity();
+    s.pool_free_bytes = pools.free_bytes();
+#ifndef AGFS_SDK_NO_HEAP_STATS
+    if (s.heap_bytes > 0) {
+        uint64_t accounted = s.alloc_bytes + s.scratch_bytes + s.pool_bytes - s.pool_free_bytes;
+        s.fragmentation = accounted >= s.heap_bytes ? 0 : 1 - (double)accounted / (double)s.heap_bytes;
+    }
+#endif
+    return s;
+}
+
+// Bytes accounted to the SDK's allocators; plugin_trim reports the drop
+inline uint64_t held_bytes() {
+    return heap_counters().bytes + Arena::scratch().capacity() + SmallPools::global().capacity();
+}
+
+// {"version":1,"memory_bytes":...} in the scratch arena
+inline ArenaString serialize(const Stats& s) {
+    return ffi::write_json([&](ffi::JsonWriter& w) {
+        w.begin_object();
+        w.key("version").number(1);
+        w.key("memory_bytes").number(s.memory_bytes);
+        w.key("heap_bytes").number(s.heap_bytes);
+        w.key("alloc_bytes").number(s.alloc_bytes);
+        w.key("alloc_count").number(s.alloc_count);
+        w.key("alloc_high_water").number(s.alloc_high_water);
+        w.key("scratch_bytes").number(s.scratch_bytes);
+        w.key("scratch_high_water").number(s.scratch_high_water);
+        w.key("pool_bytes").number(s.pool_bytes);
+        w.key("pool_free_bytes").number(s.pool_free_bytes);
+        w.key("fragmentation").number(s.fragmentation);
+        w.end_object();
+    });
+}
+
+// Counted malloc; nullptr when memory is exhausted
+inline void* tracked_try_alloc(size_t size) {
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+#ifndef AGFS_SDK_THREADS
+        // Low memory: give fully free pool slabs back to malloc and retry
+        // (not in threaded builds: any thread may be allocating here)
+        SmallPools::global().trim();
+        p = std::malloc(size == 0 ? 1 : size);
+#endif
+        if (p == nullptr) {
+            return nullptr;
+        }
+    }
+    HeapCounters& c = heap_counters();
+    uint64_t bytes = c.bytes += malloc_usable_size(p);
+    c.count++;
+    raise_high_water(c.high_water, bytes);
+    return p;
+}
+
+// Counted malloc for the throwing operator new, which has nothing to throw
+// under -fno-exceptions and aborts instead
+inline void* tracked_alloc(size_t size) {
+    void* p = tracked_try_alloc(size);
+    if (p == nullptr) {
+        std::abort();
+    }
+    return p;
+}
+
+inline void tracked_free(void* p) {
+    if (p == nullptr) {
+        return;
+    }
+    HeapCounters& c = heap_counters();
+    c.bytes -= malloc_usable_size(p);
+    c.count--;
+    std::free(p);
+}
+
+} // namespace memory
+} // namespace agfs
+
+// Replace the global operator new/delete to count live allocations; used
+// once, by AGFS_EXPORT_PLUGIN, in the translation unit exporting the plugin
+#ifndef AGFS_SDK_NO_HEAP_STATS
+#define AGFS_EXPORT_HEAP_TRACKING \
+    void* operator new(size_t size) { return agfs::memory::tracked_alloc(size); } \
+    void* operator new[](size_t size) { return agfs::memory::tracked_alloc(size); } \
+    void* operator new(size_t size, const std::nothrow_t&) noexcept { return agfs::memory::tracked_try_alloc(size); } \
+    void* operator new[](size_t size, const std::nothrow_t&) noexcept { return agfs::memory::tracked_try_alloc(size); } \
+    void operator delete(void* p) noexcept { agfs::memory::tracked_free(p); } \
+    void operator delete[](void* p) noexcept { agfs::memory::tracked_free(p); } \
+    void operator delete(void* p, size_t) noexcept { agfs::memory::tracked_free(p); } \
+    void operator delete[](void* p, size_t) noexcept { agfs::memory::tracked_free(p); }
+#else
+#define AGFS_EXPORT_HEAP_TRACKING
+#endif
+
+#endif // AGFS_MEMORY_H
@@ -0,0 +1,208 @@
+#ifndef AGFS_METRICS_H
+#define AGFS_METRICS_H
+
+#include "agfs_types.h"
+#include "agfs_ffi.h"
+#include <chrono>
+#include <cstdint>
+
+namespace agfs {
+namespace metrics {
+
+// Per-export counters kept by AGFS_EXPORT_PLUGIN and read by the host
+// through plugin_get_metrics
+//
+// For each export:
+//   calls / errors  - invocations, and those whose plugin call failed
+//   total_ns        - whole export, including argument decoding and
+//                     result encoding (JSON, BinaryFileInfo, copies)
+//   user_ns         - inside the FileSystem / FileHandle method
+//   host_ns         - inside HostFS / Http host imports (part of user_ns)
+//   host_calls      - number of those imports
+//   bytes_in / out  - file data written / read
+//
+// so total_ns - user_ns is SDK overhead and user_ns - host_ns is the
+// plugin's own work. Counters are per instance and cumulative; the host
+// sums them over its instance pool.
+//
+// Build with -DAGFS_SDK_NO_METRICS to drop the clock reads (four per export
+// plus two per host import) and the plugin_get_metrics export.
+
+enum class Op : uint8_t {
+    FsRead, FsReadv, FsWrite, FsStat, FsStatBin, FsReaddir, FsReaddirBin, FsReaddirPage,
+    FsCreate, FsMkdir, FsRemove, FsRemoveAll, FsRename, FsChmod, FsWatch, FsPollEvents,
+    HandleOpen, HandleRead, HandleReadAt, HandleWrite, HandleWriteAt,
+    HandleSeek, HandleSync, HandleStat, HandleClose,
+    Count
+};
+
+inline const char* op_name(Op op) {
+    static const char* const names[] = {
+        "fs_read", "fs_readv", "fs_write", "fs_stat", "fs_stat_bin", "fs_readdir", "fs_readdir_bin", "fs_readdir_page",
+        "fs_create", "fs_mkdir", "fs_remove", "fs_remove_all", "fs_rename", "fs_chmod", "fs_watch", "fs_poll_events",
+        "handle_open", "handle_read", "handle_read_at", "handle_write", "handle_write_at",
+        "handle_seek", "handle_sync", "handle_stat", "handle_close",
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == (size_t)Op::Count, "op_name out of sync with Op");
+    return names[(size_t)op];
+}
+
+struct OpStats {
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t total_ns = 0;
+    uint64_t user_ns = 0;
+    uint64_t host_ns = 0;
+    uint64_t host_calls = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+};
+
+struct Registry {
+    OpStats ops[(size_t)Op::Count];
+    // Running totals of host imports; exports record the difference
+    uint64_t host_ns = 0;
+    uint64_t host_calls = 0;
+};
+
+inline Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+// Monotonic time in nanoseconds (WASI clock_time_get)
+inline uint64_t now_ns() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+#ifndef AGFS_SDK_NO_METRICS
+
+// Times one export; opened at the top of each instrumented export
+class ExportScope {
+public:
+    explicit ExportScope(Op op)
+        : stats_(registry().ops[(size_t)op]),
+          start_(now_ns()),
+          host_ns_(registry().host_ns),
+          host_calls_(registry().host_calls) {}
+
+    ~ExportScope() {
+        const Registry& r = registry();
+        stats_.calls++;
+        stats_.total_ns += now_ns() - start_;
+        stats_.host_ns += r.host_ns - host_ns_;
+        stats_.host_calls += r.host_calls - host_calls_;
+    }
+
+    ExportScope(const ExportScope&) = delete;
+    ExportScope& operator=(const ExportScope&) = delete;
+
+    // Run the plugin call, timing it and counting a failed Result
+    template<typename F>
+    auto user(F&& call) -> decltype(call()) {
+        uint64_t start = now_ns();
+        auto result = call();
+        stats_.user_ns += now_ns() - start;
+        if (result.is_err()) {
+            stats_.errors++;
+        }
+        return result;
+    }
+
+    void bytes_in(uint64_t n) {
+        stats_.bytes_in += n;
+    }
+
+    void bytes_out(uint64_t n) {
+        stats_.bytes_out += n;
+    }
+
+private:
+    OpStats& stats_;
+    uint64_t start_;
+    uint64_t host_ns_;
+    uint64_t host_calls_;
+};
+
+// Times one host import call (see host() below)
+class HostCall {
+public:
+    HostCall() : start_(now_ns()) {}
+
+    ~HostCall() {
+        Registry& r = registry();
+        r.host_ns += now_ns() - start_;
+        r.host_calls++;
+    }
+
+    HostCall(const HostCall&) = delete;
+    HostCall& operator=(const HostCall&) = delete;
+
+private:
+    uint64_t start_;
+};
+
+#else
+
+class ExportScope {
+public:
+    explicit ExportScope(Op) {}
+
+    template<typename F>
+    auto user(F&& call) -> decltype(call()) {
+        return call();
+    }
+
+    void bytes_in(uint64_t) {}
+    void bytes_out(uint64_t) {}
+};
+
+class HostCall {
+public:
+    HostCall() {}
+};
+
+#endif // AGFS_SDK_NO_METRICS
+
+// Run one host import, timing it
+//   uint64_t result = metrics::host([&] { return host_fs_read(path, offset, size); });
+template<typename F>
+auto host(F&& call) -> decltype(call()) {
+    HostCall timer;
+    return call();
+}
+
+// {"version":1,"exports":{"fs_read":{"calls":...},...}} with the exports
+// called at least once; lives in the scratch arena
+inline ArenaString serialize() {
+    const Registry& r = registry();
+    return ffi::write_json([&](ffi::JsonWriter& w) {
+        w.begin_object();
+        w.key("version").number(1);
+        w.key("exports").begin_object();
+        for (size_t i = 0; i < (size_t)Op::Count; i++) {
+            const OpStats& s = r.ops[i];
+            if (s.calls == 0) {
+                continue;
+            }
+            w.key(op_name((Op)i)).begin_object();
+            w.key("calls").number(s.calls);
+            w.key("errors").number(s.errors);
+            w.key("total_ns").number(s.total_ns);
+            w.key("user_ns").number(s.user_ns);
+            w.key("host_ns").number(s.host_ns);
+            w.key("host_calls").number(s.host_calls);
+            w.key("bytes_in").number(s.bytes_in);
+            w.key("bytes_out").number(s.bytes_out);
+            w.end_object();
+        }
+        w.end_object();
+        w.end_object();
+    });
+}
+
+} // namespace metrics
+} // namespace agfs
+
+#endif // AGFS_METRICS_H
@@ -0,0 +1,181 @@
+#ifndef AGFS_NOTIFY_H
+#define AGFS_NOTIFY_H
+
+#include "agfs_types.h"
+#include "agfs_ffi.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agfs {
+
+extern "C" {
+    // Tells the host that change events are queued; it fetches them with
+    // fs_poll_events once the current export returns
+    __attribute__((import_module("env"))) __attribute__((import_name("host_fs_notify")))
+    void host_fs_notify(uint32_t pending);
+}
+
+// What happened to a path (values are part of the fs_poll_events format)
+enum class ChangeKind : uint8_t {
+    Created = 1,
+    Modified = 2, // content or size
+    Removed = 3,
+    Attrib = 4    // mode or other metadata
+};
+
+// Change events the plugin reported with notify_changed(), kept until the
+// host fetches them with fs_poll_events
+//
+// Nothing is queued until the host asks for it with fs_watch(path): events
+// outside every watched path are dropped, so a plugin whose mount nobody
+// watches pays one prefix check per notify_changed. A repeat of the last
+// event is dropped too. When more than MAX_EVENTS pile up between two polls
+// the queue is emptied and the next batch is flagged as overflowed, and the
+// host treats everything under the watched paths as changed.
+//
+// Wire format of a batch (little-endian, version 1):
+//   header: u32 total_len, u16 version, u16 flags (1 = overflow), u32 count
+//   event:  u8 kind, u8 reserved, u16 path_len, path
+class ChangeQueue {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t EVENT_FIXED_SIZE = 4;
+    static constexpr uint16_t FLAG_OVERFLOW = 1 << 0;
+    static constexpr size_t MAX_EVENTS = 1024;
+
+    static ChangeQueue& get() {
+        static ChangeQueue queue;
+        return queue;
+    }
+
+    // Start queueing events at or below path ("/" for all)
+    void watch(std::string_view path) {
+        for (const std::string& w : watches_) {
+            if (w == path) {
+                return;
+            }
+        }
+        watches_.emplace_back(path);
+    }
+
+    bool watched(std::string_view path) const {
+        for (const std::string& w : watches_) {
+            if (covers(w, path)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void push(std::string_view path, ChangeKind kind) {
+        if (!watched(path)) {
+            return;
+        }
+        if (!events_.empty() && events_.back().kind == kind && events_.back().path == path) {
+            return;
+        }
+        // A path the u16 length cannot carry is reported as an overflow
+        bool oversized = path.size() > 0xFFFF;
+        if (events_.size() >= MAX_EVENTS || oversized) {
+            events_.clear();
+            overflow_ = true;
+        }
+        if (!oversized) {
+            events_.push_back(Event{kind, std::string(path)});
+        }
+        if (!rung_) {
+            rung_ = true;
+            host_fs_notify((uint32_t)events_.size());
+        }
+    }
+
+    bool empty() const { return events_.empty() && !overflow_; }
+
+    // The host could not be handed the batch (out of memory): ring again
+    // with the next event
+    void rearm() { rung_ = false; }
+
+    // Encode up to max_events (0 = all) queued events into a buffer of
+    // encoded_size() bytes and drop them from the queue
+    size_t encoded_size(size_t max_events) const {
+        size_t size = HEADER_SIZE;
+        size_t n = count(max_events);
+        for (size_t i = 0; i < n; i++) {
+            size += EVENT_FIXED_SIZE + events_[i].path.size();
+        }
+        return size;
+    }
+
+    void encode(uint8_t* out, size_t total, size_t max_events) {
+        size_t n = count(max_events);
+        put<uint32_t>(out, (uint32_t)total);
+        put<uint16_t>(out + 4, VERSION);
+        put<uint16_t>(out + 6, overflow_ ? FLAG_OVERFLOW : 0);
+        put<uint32_t>(out + 8, (uint32_t)n);
+        uint8_t* p = out + HEADER_SIZE;
+        for (size_t i = 0; i < n; i++) {
+            const Event& e = events_[i];
+            p[0] = (uint8_t)e.kind;
+            p[1] = 0;
+            put<uint16_t>(p + 2, (uint16_t)e.path.size());
+            std::memcpy(p + EVENT_FIXED_SIZE, e.path.data(), e.path.size());
+            p += EVENT_FIXED_SIZE + e.path.size();
+        }
+        events_.erase(events_.begin(), events_.begin() + n);
+        overflow_ = false;
+        // Ring again for what is left over, or else for the next event
+        rung_ = !events_.empty();
+        if (rung_) {
+            host_fs_notify((uint32_t)events_.size());
+        }
+    }
+
+private:
+    struct Event {
+        ChangeKind kind;
+        std::string path;
+    };
+
+    std::vector<std::string> watches_;
+    std::vector<Event> events_;
+    bool overflow_ = false;
+    bool rung_ = false;
+
+    size_t count(size_t max_events) const {
+        return max_events == 0 ? events_.size() : std::min(max_events, events_.size());
+    }
+
+    // "/a" covers "/a" and "/a/b", not "/ab"
+    static bool covers(const std::string& watch, std::string_view path) {
+        if (watch == "/" || watch.empty()) {
+            return true;
+        }
+        if (path.size() < watch.size() || path.compare(0, watch.size(), watch) != 0) {
+            return false;
+        }
+        return path.size() == watch.size() || path[watch.size()] == '/';
+    }
+
+    template<typename T>
+    static void put(uint8_t* p, T v) {
+        std::memcpy(p, &v, sizeof(T));
+    }
+};
+
+// Report a change the host did not make itself (background work, expiry,
+// a remote update), so it can invalidate cached stat and readdir results
+// instead of waiting for a TTL. Changes made by the host's own calls
+// (fs_write, fs_remove, ...) are already known to it and need no report.
+// Paths are plugin paths, as in FileSystem calls. Call it from the
+// export's thread, not from spawn() tasks: it may call a host import.
+inline void notify_changed(std::string_view path, ChangeKind kind) {
+    ChangeQueue::get().push(path, kind);
+}
+
+} // namespace agfs
+
+#endif // AGFS_NOTIFY_H
@@ -0,0 +1,248 @@
+#ifndef AGFS_ROUTER_H
+#define AGFS_ROUTER_H
+
+#include "agfs_types.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace agfs {
+
+// Values captured by a route match
+// Views point into the matched path and the router, so a RouteParams is
+// only valid while both are.
+class RouteParams {
+public:
+    static constexpr size_t MAX_PARAMS = 8;
+
+    // Value of the {name} segment, or "" when the route has none
+    std::string_view get(std::string_view name) const {
+        for (size_t i = 0; i < count_; i++) {
+            if (names_[i] == name) {
+                return values_[i];
+            }
+        }
+        return std::string_view();
+    }
+
+    // What a trailing * matched, with its leading slash ("/a/b"), or ""
+    std::string_view rest() const {
+        return rest_;
+    }
+
+    size_t size() const {
+        return count_;
+    }
+
+private:
+    template<typename T> friend class Router;
+
+    void clear() {
+        count_ = 0;
+        rest_ = std::string_view();
+    }
+
+    std::string_view names_[MAX_PARAMS];
+    std::string_view values_[MAX_PARAMS];
+    size_t count_ = 0;
+    std::string_view rest_;
+};
+
+// Path router for FileSystem implementations
+//
+// Routes are declared once, typically in the plugin constructor or
+// initialize(), and every FileSystem method dispatches with one match():
+//
+//   enum class Node { Root, Readme, User, UserFile, Blob };
+//   agfs::Router<Node> routes;
+//   routes.add("/", Node::Root);
+//   routes.add("/README", Node::Readme);
+//   routes.add("/users/{id}", Node::User);
+//   routes.add("/users/{id}/{file}", Node::UserFile);
+//   routes.add("/blobs/*", Node::Blob);
+//
+//   agfs::RouteParams params;
+//   if (const Node* node = routes.match(path, params)) {
+//       switch (*node) { case Node::User: ... params.get("id") ... }
+//   }
+//
+// Patterns are split into segments. A segment is a literal, a {name}
+// parameter matching any one segment, or a final * matching one or more
+// segments. At each level literals win over parameters and parameters
+// over *, falling back when the more specific branch does not match
+// further down. Empty segments are ignored, so "/a/" matches "/a".
+//
+// Routes are kept in a segment trie with sorted literal children, so a
+// match costs one binary search per path segment, independent of the
+// number of routes, and allocates nothing.
+template<typename T>
+class Router {
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    struct Node {
+        // Literal children sorted by segment
+        std::vector<std::pair<std::string, uint32_t>> literals;
+        uint32_t param = NONE;      // {name} child
+        std::string param_name;
+        uint32_t value = NONE;      // route ending here
+        uint32_t rest_value = NONE; // route ending in * here
+    };
+
+public:
+    Router() : nodes_(1) {}
+
+    // Declare a route
+    // Fails on malformed patterns, on a * that is not the last segment, on
+    // two parameters with different names at one position, and on a
+    // pattern that is already declared.
+    Result<void> add(std::string_view pattern, T value) {
+        uint32_t node = 0;
+        size_t pos = 0;
+        std::string_view segment;
+        size_t params = 0;
+        while (next_segment(pattern, pos, segment)) {
+            if (segment == "*") {
+                if (next_segment(pattern, pos, segment)) {
+                    return Error::invalid_input("route " + std::string(pattern) + ": * must be last");
+                }
+                return set_value(nodes_[node].rest_value, pattern, std::move(value));
+            }
+            if (segment.front() == '{') {
+                if (segment.size() < 3 || segment.back() != '}') {
+                    return Error::invalid_input("route " + std::string(pattern) + ": bad parameter");
+                }
+                if (++params > RouteParams::MAX_PARAMS) {
+                    return Error::invalid_input("route " + std::string(pattern) + ": too many parameters");
+                }
+                std::string_view name = segment.substr(1, segment.size() - 2);
+                if (nodes_[node].param == NONE) {
+                    uint32_t child = new_node();
+                    nodes_[node].param = child;
+                    nodes_[node].param_name = std::string(name);
+                } else if (nodes_[node].param_name != name) {
+                    return Error::invalid_input("route " + std::string(pattern) + ": parameter {" +
+                                                std::string(name) + "} conflicts with {" +
+                                                nodes_[node].param_name + "}");
+                }
+                node = nodes_[node].param;
+                continue;
+            }
+
+            auto& literals = nodes_[node].literals;
+            auto it = std::lower_bound(literals.begin(), literals.end(), segment, literal_less);
+            if (it != literals.end() && it->first == segment) {
+                node = it->second;
+                continue;
+            }
+            size_t index = it - literals.begin();
+            uint32_t child = new_node();
+            // new_node may have moved nodes_, so look the vector up again
+            auto& children = nodes_[node].literals;
+            children.insert(children.begin() + index, {std::string(segment), child});
+            node = child;
+        }
+        return set_value(nodes_[node].value, pattern, std::move(value));
+    }
+
+    // Find the route for path, filling params
+    // Returns: The route's value, or nullptr when no route matches
+    const T* match(std::string_view path, RouteParams& params) const {
+        params.clear();
+        uint32_t value = match_from(0, path, 0, params);
+        return value == NONE ? nullptr : &values_[value];
+    }
+
+    const T* match(std::string_view path) const {
+        RouteParams params;
+        return match(path, params);
+    }
+
+    size_t size() const {
+        return values_.size();
+    }
+
+private:
+    static bool literal_less(const std::pair<std::string, uint32_t>& entry, std::string_view segment) {
+        return std::string_view(entry.first) < segment;
+    }
+
+    // Advance pos past the next non-empty segment of path
+    static bool next_segment(std::string_view path, size_t& pos, std::string_view& segment) {
+        while (pos < path.size() && path[pos] == '/') {
+            pos++;
+        }
+        if (pos >= path.size()) {
+            return false;
+        }
+        size_t end = path.find('/', pos);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        segment = path.substr(pos, end - pos);
+        pos = end;
+        return true;
+    }
+
+    uint32_t new_node() {
+        nodes_.emplace_back();
+        return (uint32_t)(nodes_.size() - 1);
+    }
+
+    Result<void> set_value(uint32_t& slot, std::string_view pattern, T value) {
+        if (slot != NONE) {
+            return Error(ErrorKind::AlreadyExists, "route " + std::string(pattern) + " already declared");
+        }
+        slot = (uint32_t)values_.size();
+        values_.push_back(std::move(value));
+        return Result<void>();
+    }
+
+    uint32_t match_from(uint32_t node_index, std::string_view path, size_t pos,
+                        RouteParams& params) const {
+        const Node& node = nodes_[node_index];
+        size_t start = pos;
+        std::string_view segment;
+        if (!next_segment(path, pos, segment)) {
+            return node.value;
+        }
+
+        auto it = std::lower_bound(node.literals.begin(), node.literals.end(), segment, literal_less);
+        if (it != node.literals.end() && it->first == segment) {
+            uint32_t value = match_from(it->second, path, pos, params);
+            if (value != NONE) {
+                return value;
+            }
+        }
+
+        if (node.param != NONE) {
+            size_t count = params.count_;
+            params.names_[count] = node.param_name;
+            params.values_[count] = segment;
+            params.count_ = count + 1;
+            uint32_t value = match_from(node.param, path, pos, params);
+            if (value != NONE) {
+                return value;
+            }
+            params.count_ = count;
+        }
+
+        if (node.rest_value != NONE) {
+            // Keep the slash before the first remaining segment
+            size_t seg_start = pos - segment.size();
+            params.rest_ = path.substr(seg_start > start ? seg_start - 1 : seg_start);
+            return node.rest_value;
+        }
+        return NONE;
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<T> values_;
+};
+
+} // namespace agfs
+
+#endif // AGFS_ROUTER_H
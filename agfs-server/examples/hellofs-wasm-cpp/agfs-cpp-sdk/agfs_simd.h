@@ -0,0 +1,264 @@
+#ifndef AGFS_SIMD_H
+#define AGFS_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Byte-scan, base64 and JSON-escape kernels for the data path
+//
+// Built with -msimd128 (make SIMD=1) these process 16 bytes per step with
+// wasm simd128; otherwise, or with -DAGFS_SDK_NO_SIMD, they compile to the
+// scalar loops. Both produce the same results.
+#if defined(__wasm_simd128__) && !defined(AGFS_SDK_NO_SIMD)
+#define AGFS_SDK_SIMD 1
+#include <wasm_simd128.h>
+#endif
+
+namespace agfs {
+namespace simd {
+
+#ifdef AGFS_SDK_SIMD
+// Bit i set when byte i of v is zero
+inline uint32_t zero_mask(v128_t v) {
+    return wasm_i8x16_bitmask(wasm_i8x16_eq(v, wasm_i8x16_splat(0)));
+}
+#endif
+
+// Length of a NUL-terminated string
+inline size_t strlen(const char* s) {
+#ifdef AGFS_SDK_SIMD
+    // Aligned 16-byte loads never cross the end of linear memory, so the
+    // bytes around s and past the terminator are safe to read
+    uintptr_t addr = (uintptr_t)s;
+    const char* block = reinterpret_cast<const char*>(addr & ~(uintptr_t)15);
+    uint32_t mask = zero_mask(wasm_v128_load(block)) & (0xFFFFu << (addr & 15));
+    while (mask == 0) {
+        block += 16;
+        mask = zero_mask(wasm_v128_load(block));
+    }
+    return (size_t)(block + __builtin_ctz(mask) - s);
+#else
+    return std::strlen(s);
+#endif
+}
+
+// First occurrence of c in [data, data + size), or nullptr
+inline const void* memchr(const void* data, int c, size_t size) {
+#ifdef AGFS_SDK_SIMD
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    v128_t needle = wasm_i8x16_splat((int8_t)c);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        uint32_t mask = wasm_i8x16_bitmask(wasm_i8x16_eq(wasm_v128_load(p + i), needle));
+        if (mask != 0) {
+            return p + i + __builtin_ctz(mask);
+        }
+    }
+    for (; i < size; i++) {
+        if (p[i] == (uint8_t)c) {
+            return p + i;
+        }
+    }
+    return nullptr;
+#else
+    return size == 0 ? nullptr : std::memchr(data, c, size);
+#endif
+}
+
+// Bytes base64_encode writes for size input bytes (padded, no NUL)
+constexpr size_t base64_encoded_size(size_t size) {
+    return (size + 2) / 3 * 4;
+}
+
+// Largest number of bytes base64_decode writes for size characters
+constexpr size_t base64_decoded_max(size_t size) {
+    return size / 4 * 3 + 3;
+}
+
+// Standard base64 with '=' padding; out needs base64_encoded_size(size)
+inline size_t base64_encode(const uint8_t* in, size_t size, char* out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    size_t o = 0;
+#ifdef AGFS_SDK_SIMD
+    // 12 input bytes -> 16 characters; the load reads 16, so stop 4 early
+    for (; i + 16 <= size; i += 12, o += 16) {
+        v128_t bytes = wasm_v128_load(in + i);
+        // Lane k holds input bytes 3k..3k+2 as the 24-bit value b0<<16 | b1<<8 | b2
+        v128_t v = wasm_i8x16_shuffle(bytes, bytes, 2, 1, 0, 0, 5, 4, 3, 3, 8, 7, 6, 6, 11, 10, 9, 9);
+        // Split into four sextets, most significant first in memory order
+        v128_t s = wasm_v128_or(
+            wasm_v128_or(wasm_v128_and(wasm_u32x4_shr(v, 18), wasm_i32x4_splat(0x3f)),
+                         wasm_v128_and(wasm_u32x4_shr(v, 4), wasm_i32x4_splat(0x3f00))),
+            wasm_v128_or(wasm_v128_and(wasm_i32x4_shl(v, 10), wasm_i32x4_splat(0x3f0000)),
+                         wasm_v128_and(wasm_i32x4_shl(v, 24), wasm_i32x4_splat(0x3f000000))));
+        // Sextet -> ASCII: add the offset of its alphabet range
+        v128_t offset = wasm_i8x16_splat('A');
+        offset = wasm_v128_bitselect(wasm_i8x16_splat('a' - 26), offset, wasm_u8x16_ge(s, wasm_i8x16_splat(26)));
+        offset = wasm_v128_bitselect(wasm_i8x16_splat('0' - 52), offset, wasm_u8x16_ge(s, wasm_i8x16_splat(52)));
+        offset = wasm_v128_bitselect(wasm_i8x16_splat('+' - 62), offset, wasm_i8x16_eq(s, wasm_i8x16_splat(62)));
+        offset = wasm_v128_bitselect(wasm_i8x16_splat('/' - 63), offset, wasm_i8x16_eq(s, wasm_i8x16_splat(63)));
+        wasm_v128_store(out + o, wasm_i8x16_add(s, offset));
+    }
+#endif
+    for (; i + 3 <= size; i += 3, o += 4) {
+        uint32_t v = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+        out[o] = alphabet[v >> 18];
+        out[o + 1] = alphabet[(v >> 12) & 63];
+        out[o + 2] = alphabet[(v >> 6) & 63];
+        out[o + 3] = alphabet[v & 63];
+    }
+    if (i < size) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < size) {
+            v |= (uint32_t)in[i + 1] << 8;
+        }
+        out[o] = alphabet[v >> 18];
+        out[o + 1] = alphabet[(v >> 12) & 63];
+        out[o + 2] = i + 1 < size ? alphabet[(v >> 6) & 63] : '=';
+        out[o + 3] = '=';
+        o += 4;
+    }
+    return o;
+}
+
+inline std::string base64_encode(const uint8_t* in, size_t size) {
+    std::string out(base64_encoded_size(size), '\0');
+    base64_encode(in, size, &out[0]);
+    return out;
+}
+
+// Decode base64, skipping characters outside the alphabet and stopping at
+// the first '='; out needs base64_decoded_max(size). Returns bytes written.
+inline size_t base64_decode(const char* in, size_t size, uint8_t* out) {
+    static const uint8_t table[128] = {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 62, 255, 255, 255, 63,
+        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 255, 255, 255, 0, 255, 255,
+        255, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 255, 255, 255, 255, 255,
+        255, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 255, 255, 255, 255, 255,
+    };
+
+    size_t i = 0;
+    size_t o = 0;
+#ifdef AGFS_SDK_SIMD
+    // 16 characters -> 12 bytes while every character is in the alphabet;
+    // a block holding '=', whitespace or junk is left to the scalar loop,
+    // which starts on a 4-character boundary with no pending bits
+    for (; i + 16 <= size; i += 16, o += 12) {
+        v128_t c = wasm_v128_load(in + i);
+        v128_t upper = wasm_v128_and(wasm_u8x16_ge(c, wasm_i8x16_splat('A')), wasm_u8x16_le(c, wasm_i8x16_splat('Z')));
+        v128_t lower = wasm_v128_and(wasm_u8x16_ge(c, wasm_i8x16_splat('a')), wasm_u8x16_le(c, wasm_i8x16_splat('z')));
+        v128_t digit = wasm_v128_and(wasm_u8x16_ge(c, wasm_i8x16_splat('0')), wasm_u8x16_le(c, wasm_i8x16_splat('9')));
+        v128_t plus = wasm_i8x16_eq(c, wasm_i8x16_splat('+'));
+        v128_t slash = wasm_i8x16_eq(c, wasm_i8x16_splat('/'));
+        if (!wasm_i8x16_all_true(wasm_v128_or(wasm_v128_or(upper, lower), wasm_v128_or(digit, wasm_v128_or(plus, slash))))) {
+            break;
+        }
+        // ASCII -> sextet: add the offset of the character's range
+        v128_t offset = wasm_v128_or(
+            wasm_v128_or(wasm_v128_and(upper, wasm_i8x16_splat(-'A')),
+                         wasm_v128_and(lower, wasm_i8x16_splat(26 - 'a'))),
+            wasm_v128_or(wasm_v128_and(digit, wasm_i8x16_splat(52 - '0')),
+                         wasm_v128_or(wasm_v128_and(plus, wasm_i8x16_splat(62 - '+')),
+                                      wasm_v128_and(slash, wasm_i8x16_splat(63 - '/')))));
+        v128_t s = wasm_i8x16_add(c, offset);
+        // Merge sextet pairs into 12 bits, then 12-bit pairs into 24
+        v128_t pairs = wasm_v128_or(wasm_i16x8_shl(wasm_v128_and(s, wasm_i16x8_splat(0x00ff)), 6),
+                                    wasm_u16x8_shr(s, 8));
+        v128_t quads = wasm_v128_or(wasm_i32x4_shl(wasm_v128_and(pairs, wasm_i32x4_splat(0xffff)), 12),
+                                    wasm_u32x4_shr(pairs, 16));
+        v128_t bytes = wasm_i8x16_shuffle(quads, quads, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 0, 0, 0, 0);
+        uint8_t block[16];
+        wasm_v128_store(block, bytes);
+        std::memcpy(out + o, block, 12);
+    }
+#endif
+    uint32_t buf = 0;
+    int bits = 0;
+    for (; i < size; i++) {
+        unsigned char c = (unsigned char)in[i];
+        if (c == '=') break;
+        if (c >= 128 || table[c] == 255) continue;
+
+        buf = (buf << 6) | table[c];
+        bits += 6;
+
+        if (bits >= 8) {
+            bits -= 8;
+            out[o++] = (uint8_t)((buf >> bits) & 0xFF);
+            buf &= (1 << bits) - 1;
+        }
+    }
+    return o;
+}
+
+// Write s to out as the inside of a JSON string literal; Out is anything
+// with append(const char*, size_t) (std::string, ffi::JsonWriter)
+template <typename Out>
+inline void json_escape(Out& out, const char* s, size_t size) {
+    static const char hex[] = "0123456789abcdef";
+    size_t i = 0;
+    size_t run = 0; // start of the bytes not yet appended
+#ifdef AGFS_SDK_SIMD
+    const v128_t quote = wasm_i8x16_splat('"');
+    const v128_t backslash = wasm_i8x16_splat('\\');
+    const v128_t space = wasm_i8x16_splat(0x20);
+#endif
+    while (i < size) {
+#ifdef AGFS_SDK_SIMD
+        // Skip 16-byte blocks with nothing to escape
+        if (i + 16 <= size) {
+            v128_t c = wasm_v128_load(s + i);
+            v128_t special = wasm_v128_or(wasm_v128_or(wasm_i8x16_eq(c, quote), wasm_i8x16_eq(c, backslash)),
+                                          wasm_u8x16_lt(c, space));
+            if (!wasm_v128_any_true(special)) {
+                i += 16;
+                continue;
+            }
+        }
+#endif
+        size_t end = size - i > 16 ? i + 16 : size;
+        for (; i < end; i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out.append(s + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"': out.append("\\\"", 2); break;
+                case '\\': out.append("\\\\", 2); break;
+                case '\n': out.append("\\n", 2); break;
+                case '\r': out.append("\\r", 2); break;
+                case '\t': out.append("\\t", 2); break;
+                case '\b': out.append("\\b", 2); break;
+                case '\f': out.append("\\f", 2); break;
+                default: {
+                    char u[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+                    out.append(u, 6);
+                    break;
+                }
+            }
+        }
+    }
+    out.append(s + run, size - run);
+}
+
+inline void json_escape_append(std::string& out, const char* s, size_t size) {
+    json_escape(out, s, size);
+}
+
+inline void json_escape_append(std::string& out, const std::string& s) {
+    json_escape(out, s.data(), s.size());
+}
+
+} // namespace simd
+} // namespace agfs
+
+#endif // AGFS_SIMD_H
@@ -0,0 +1,375 @@
+#ifndef AGFS_THREADS_H
+#define AGFS_THREADS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Fork-join tasks inside one export call
+//
+// In a wasi-threads build (make build-threads, which compiles with -pthread)
+// spawn() and parallel_for() run on a small work-stealing pool of worker
+// threads sharing the instance's memory; otherwise, or with
+// -DAGFS_SDK_NO_THREADS, they run inline on the calling thread, so plugin
+// code is the same for both builds.
+//
+// Tasks may compute on memory and allocate with new/malloc. They must not
+// call host imports (HostFS, Http) or use the scratch arena or SmallPools:
+// those belong to the instance and only the export's own thread uses them.
+#if defined(_REENTRANT) && !defined(AGFS_SDK_NO_THREADS)
+#define AGFS_SDK_THREADS 1
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#endif
+
+// Stack size of each worker thread, taken from linear memory
+#ifndef AGFS_SDK_THREAD_STACK
+#define AGFS_SDK_THREAD_STACK (256 * 1024)
+#endif
+
+namespace agfs {
+namespace threads {
+
+#ifdef AGFS_SDK_THREADS
+namespace detail {
+
+struct Job {
+    std::function<void()> fn;
+    std::atomic<bool> done{false};
+};
+
+using JobPtr = std::shared_ptr<Job>;
+
+// Worker slots each own a deque: a worker pushes and pops at the back of
+// its own, idle workers and waiting threads steal from the front of the
+// others. Workers start on first use and exit after IDLE_EXIT without
+// work, so an idle instance holds no threads.
+class Scheduler {
+public:
+    static constexpr size_t MAX_WORKERS = 64;
+    static constexpr std::chrono::milliseconds IDLE_EXIT{1000};
+
+    // Never destroyed: workers may still be running at exit
+    static Scheduler& get() {
+        static Scheduler* scheduler = new Scheduler();
+        return *scheduler;
+    }
+
+    size_t workers() const { return workers_.load(std::memory_order_relaxed); }
+
+    void set_workers(size_t n) {
+        workers_.store(std::min(n, MAX_WORKERS), std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(sleep_mu_);
+        sleep_cv_.notify_all();
+    }
+
+    void submit(const JobPtr& job) {
+        size_t n = workers();
+        if (n == 0) {
+            run(job);
+            return;
+        }
+        size_t i = current_worker() >= 0 ? (size_t)current_worker()
+                                          : next_slot_.fetch_add(1, std::memory_order_relaxed) % n;
+        pending_.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(slots_[i].mu);
+            slots_[i].queue.push_back(job);
+        }
+        size_t used = slots_used_.load(std::memory_order_relaxed);
+        while (used < i + 1 && !slots_used_.compare_exchange_weak(used, i + 1)) {
+        }
+        start_worker(i);
+        std::lock_guard<std::mutex> lock(sleep_mu_);
+        sleep_cv_.notify_one();
+    }
+
+    // Run other jobs until job is done
+    void wait(const JobPtr& job) {
+        while (!job->done.load(std::memory_order_acquire)) {
+            JobPtr other = take(current_worker());
+            if (other) {
+                run(other);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(done_mu_);
+            done_cv_.wait_for(lock, std::chrono::milliseconds(1),
+                              [&] { return job->done.load(std::memory_order_acquire); });
+        }
+    }
+
+private:
+    struct Slot {
+        std::mutex mu;
+        std::deque<JobPtr> queue;
+        bool running = false;
+    };
+
+    Scheduler() {
+        size_t n = 0;
+        if (const char* env = std::getenv("AGFS_MAX_THREADS")) {
+            n = (size_t)std::strtoul(env, nullptr, 10);
+        } else {
+            unsigned hw = std::thread::hardware_concurrency();
+            n = hw > 1 ? hw - 1 : 3;
+        }
+        workers_.store(std::min(n, MAX_WORKERS), std::memory_order_relaxed);
+    }
+
+    static int& current_worker() {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    static void* worker_main(void* arg) {
+        Scheduler& s = get();
+        size_t i = (size_t)(uintptr_t)arg;
+        current_worker() = (int)i;
+        while (true) {
+            JobPtr job = s.take((int)i);
+            if (job) {
+                s.run(job);
+                continue;
+            }
+            bool woken;
+            {
+                std::unique_lock<std::mutex> lock(s.sleep_mu_);
+                woken = s.sleep_cv_.wait_for(lock, IDLE_EXIT, [&] {
+                    return s.pending_.load(std::memory_order_acquire) > 0 || i >= s.workers();
+                });
+            }
+            if (woken && i < s.workers()) {
+                continue;
+            }
+            // Exiting: a job pushed to this slot meanwhile keeps it alive
+            std::lock_guard<std::mutex> lock(s.slots_[i].mu);
+            if (!s.slots_[i].queue.empty()) {
+                continue;
+            }
+            s.slots_[i].running = false;
+            s.exits_.fetch_add(1, std::memory_order_release);
+            return nullptr;
+        }
+    }
+
+    void start_worker(size_t i) {
+        std::lock_guard<std::mutex> lock(slots_[i].mu);
+        if (slots_[i].running) {
+            return;
+        }
+        // After a refused spawn (the host's thread limit) retry only once
+        // some worker has exited; waiting threads run the queued jobs
+        int64_t exits = exits_.load(std::memory_order_acquire);
+        if (refused_at_exits_.load(std::memory_order_relaxed) == exits) {
+            return;
+        }
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, AGFS_SDK_THREAD_STACK);
+        pthread_t thread;
+        int rc = pthread_create(&thread, &attr, &Scheduler::worker_main, (void*)(uintptr_t)i);
+        pthread_attr_destroy(&attr);
+        if (rc != 0) {
+            refused_at_exits_.store(exits, std::memory_order_relaxed);
+            return;
+        }
+        refused_at_exits_.store(-1, std::memory_order_relaxed);
+        slots_[i].running = true;
+        pthread_detach(thread);
+    }
+
+    // Own slot's newest job, else the oldest job of another slot
+    JobPtr take(int self) {
+        size_t used = slots_used_.load(std::memory_order_acquire);
+        if (self >= 0) {
+            Slot& own = slots_[self];
+            std::lock_guard<std::mutex> lock(own.mu);
+            if (!own.queue.empty()) {
+                JobPtr job = std::move(own.queue.back());
+                own.queue.pop_back();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        size_t start = self >= 0 ? (size_t)self + 1 : 0;
+        for (size_t k = 0; k < used; k++) {
+            Slot& slot = slots_[(start + k) % used];
+            std::lock_guard<std::mutex> lock(slot.mu);
+            if (!slot.queue.empty()) {
+                JobPtr job = std::move(slot.queue.front());
+                slot.queue.pop_front();
+                pending_.fetch_sub(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void run(const JobPtr& job) {
+        job->fn();
+        job->fn = nullptr;
+        job->done.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(done_mu_);
+        done_cv_.notify_all();
+    }
+
+    Slot slots_[MAX_WORKERS];
+    std::atomic<size_t> workers_{0};
+    std::atomic<size_t> slots_used_{0};
+    std::atomic<size_t> next_slot_{0};
+    std::atomic<size_t> pending_{0};
+    std::atomic<int64_t> exits_{0};
+    std::atomic<int64_t> refused_at_exits_{-1}; // exits_ when a spawn was last refused
+    std::mutex sleep_mu_;
+    std::condition_variable sleep_cv_;
+    std::mutex done_mu_;
+    std::condition_variable done_cv_;
+};
+
+} // namespace detail
+
+// Threads that run tasks, counting the calling one
+inline size_t concurrency() {
+    return detail::Scheduler::get().workers() + 1;
+}
+
+// Limit the worker threads (at most 64); 0 runs every task inline. The
+// host's limit comes in as AGFS_MAX_THREADS and is the default.
+inline void set_max_workers(size_t n) {
+    detail::Scheduler::get().set_workers(n);
+}
+#else
+inline size_t concurrency() { return 1; }
+inline void set_max_workers(size_t) {}
+#endif
+
+} // namespace threads
+
+// Handle of a spawned task; wait() (or the destructor) returns once it has
+// run. The waiting thread runs other queued tasks in the meantime, so
+// tasks may spawn and wait on tasks of their own.
+class Task {
+public:
+    Task() = default;
+    Task(Task&&) = default;
+    Task& operator=(Task&& other) {
+        wait();
+#ifdef AGFS_SDK_THREADS
+        job_ = std::move(other.job_);
+#else
+        (void)other;
+#endif
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() { wait(); }
+
+    void wait() {
+#ifdef AGFS_SDK_THREADS
+        if (job_) {
+            threads::detail::Scheduler::get().wait(job_);
+            job_.reset();
+        }
+#endif
+    }
+
+    bool done() const {
+#ifdef AGFS_SDK_THREADS
+        return !job_ || job_->done.load(std::memory_order_acquire);
+#else
+        return true;
+#endif
+    }
+
+private:
+#ifdef AGFS_SDK_THREADS
+    explicit Task(threads::detail::JobPtr job) : job_(std::move(job)) {}
+    threads::detail::JobPtr job_;
+#endif
+
+    template <typename F>
+    friend Task spawn(F&& fn);
+};
+
+// Run fn on a worker thread (inline without threads)
+template <typename F>
+Task spawn(F&& fn) {
+#ifdef AGFS_SDK_THREADS
+    auto job = std::make_shared<threads::detail::Job>();
+    job->fn = std::forward<F>(fn);
+    threads::detail::Scheduler::get().submit(job);
+    return Task(std::move(job));
+#else
+    fn();
+    return Task();
+#endif
+}
+
+// Call body(lo, hi) on subranges of [begin, end) of about grain indices,
+// spread over the workers, and return when all are done. grain 0 picks
+// about eight chunks per thread.
+template <typename F>
+void parallel_for_chunks(size_t begin, size_t end, size_t grain, F&& body) {
+    if (end <= begin) {
+        return;
+    }
+    size_t count = end - begin;
+    size_t threads = threads::concurrency();
+    if (grain == 0) {
+        grain = std::max<size_t>(1, count / (threads * 8));
+    }
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1 || threads == 1) {
+        body(begin, end);
+        return;
+    }
+
+    // Every thread claims chunks off one counter until none are left, so
+    // uneven chunks balance themselves
+    std::atomic<size_t> next{0};
+    auto claim = [&] {
+        for (size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            size_t lo = begin + c * grain;
+            body(lo, std::min(end, lo + grain));
+        }
+    };
+    std::vector<Task> helpers;
+    helpers.reserve(std::min(chunks, threads) - 1);
+    for (size_t h = 1; h < std::min(chunks, threads); h++) {
+        helpers.push_back(spawn(claim));
+    }
+    claim();
+    for (Task& t : helpers) {
+        t.wait();
+    }
+}
+
+// Call body(i) for every i in [begin, end), in parallel
+template <typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+    parallel_for_chunks(begin, end, grain, [&](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; i++) {
+            body(i);
+        }
+    });
+}
+
+template <typename F>
+void parallel_for(size_t begin, size_t end, F&& body) {
+    parallel_for(begin, end, 0, std::forward<F>(body));
+}
+
+} // namespace agfs
+
+#endif // AGFS_THREADS_H
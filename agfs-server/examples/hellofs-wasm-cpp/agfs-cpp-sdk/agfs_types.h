@@ -6,13 +6,60 @@
 #include <map>
 #include <optional>
 #include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <string_view>
 #include <stdexcept>
+#include <type_traits>
 
 namespace agfs {
 
 // Forward declarations
 class MetaData;
 
+// Non-owning view over contiguous memory (std::span is C++20)
+template<typename T>
+class Span {
+public:
+    Span() : data_(nullptr), size_(0) {}
+    Span(T* data, size_t size) : data_(data), size_(size) {}
+    Span(std::vector<typename std::remove_const<T>::type>& v) : data_(v.data()), size_(v.size()) {}
+    Span(const std::vector<typename std::remove_const<T>::type>& v) : data_(v.data()), size_(v.size()) {}
+
+    // Allow Span<uint8_t> -> Span<const uint8_t>
+    template<typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+    Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) const { return data_[i]; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+    // View of count elements starting at offset, clamped to this span
+    Span subspan(size_t offset, size_t count = (size_t)-1) const {
+        if (offset > size_) offset = size_;
+        if (count > size_ - offset) count = size_ - offset;
+        return Span(data_ + offset, count);
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+using ByteSpan = Span<uint8_t>;
+using ConstByteSpan = Span<const uint8_t>;
+
+// One range of a vectored read (FileSystem::readv, HostFS::readv)
+struct ReadRange {
+    int64_t offset;
+    int64_t size;
+};
+
 // Error types matching the Rust implementation
 enum class ErrorKind {
     NotFound,
@@ -44,10 +91,7 @@ public:
     static Error io(const std::string& msg) { return Error(ErrorKind::Io, msg); }
     static Error other(const std::string& msg) { return Error(ErrorKind::Other, msg); }
 
-    std::string to_string() const {
-        if (!message.empty()) {
-            return message;
-        }
+    static const char* default_message(ErrorKind kind) {
         switch (kind) {
             case ErrorKind::NotFound: return "file not found";
             case ErrorKind::PermissionDenied: return "permission denied";
@@ -58,6 +102,13 @@ public:
             default: return "unknown error";
         }
     }
+
+    std::string to_string() const {
+        if (!message.empty()) {
+            return message;
+        }
+        return default_message(kind);
+    }
 };
 
 // Result type (similar to Rust's Result)
@@ -224,37 +275,152 @@ public:
     }
 };
 
+// One configuration value, converted once when the config is parsed
+// str holds the textual form; numbers and bools are also kept natively,
+// and strings that spell a number or bool are converted up front so
+// lookups never parse.
+struct ConfigValue {
+    enum class Type : uint8_t { String, Int, Float, Bool };
+
+    Type type = Type::String;
+    std::string str;
+    int64_t i64 = 0;
+    double f64 = 0;
+    bool boolean = false;
+    bool is_number = false; // i64/f64 are meaningful
+
+    ConfigValue() = default;
+
+    // Implicit, so values[key] = "text" keeps working
+    ConfigValue(std::string value) : str(std::move(value)) {
+        const char* begin = str.c_str();
+        char* end = nullptr;
+        char first = str.empty() ? '\0' : str[0];
+        if ((first >= '0' && first <= '9') || first == '-' || first == '+' || first == '.') {
+            int64_t i = std::strtoll(begin, &end, 10);
+            if (*end == '\0') {
+                i64 = i;
+                f64 = (double)i;
+                is_number = true;
+            } else {
+                double f = std::strtod(begin, &end);
+                if (*end == '\0') {
+                    i64 = (int64_t)f;
+                    f64 = f;
+                    is_number = true;
+                }
+            }
+        }
+        boolean = str == "true" || str == "1";
+    }
+
+    ConfigValue(const char* value) : ConfigValue(std::string(value)) {}
+
+    static ConfigValue of_string(std::string value) {
+        return ConfigValue(std::move(value));
+    }
+
+    static ConfigValue of_int(int64_t value) {
+        ConfigValue v;
+        v.type = Type::Int;
+        v.str = std::to_string(value);
+        v.i64 = value;
+        v.f64 = (double)value;
+        v.boolean = value != 0;
+        v.is_number = true;
+        return v;
+    }
+
+    // text is the shortest form that round-trips, as the host sent it
+    static ConfigValue of_float(double value, std::string text) {
+        ConfigValue v;
+        v.type = Type::Float;
+        v.str = std::move(text);
+        v.i64 = (int64_t)value;
+        v.f64 = value;
+        v.boolean = value != 0;
+        v.is_number = true;
+        return v;
+    }
+
+    static ConfigValue of_bool(bool value) {
+        ConfigValue v;
+        v.type = Type::Bool;
+        v.str = value ? "true" : "false";
+        v.i64 = value ? 1 : 0;
+        v.f64 = value ? 1 : 0;
+        v.boolean = value;
+        return v;
+    }
+
+    // Same type and text; the other fields derive from them
+    bool operator==(const ConfigValue& other) const {
+        return type == other.type && str == other.str;
+    }
+
+    bool operator!=(const ConfigValue& other) const {
+        return !(*this == other);
+    }
+};
+
 // Configuration class
+// Lookups take const char* (or std::string_view) without building a
+// std::string, and return the value converted at parse time.
 class Config {
 public:
-    std::map<std::string, std::string> values;
+    std::map<std::string, ConfigValue, std::less<>> values;
 
-    const char* get_str(const char* key) const {
+    const ConfigValue* find(std::string_view key) const {
         auto it = values.find(key);
-        if (it != values.end()) {
-            return it->second.c_str();
-        }
-        return nullptr;
+        return it == values.end() ? nullptr : &it->second;
     }
 
+    const char* get_str(const char* key) const {
+        const ConfigValue* v = find(key);
+        return v != nullptr ? v->str.c_str() : nullptr;
+    }
+
+    // Non-numeric values yield default_value
     int64_t get_i64(const char* key, int64_t default_value = 0) const {
-        auto it = values.find(key);
-        if (it != values.end()) {
-            return std::stoll(it->second);
-        }
-        return default_value;
+        const ConfigValue* v = find(key);
+        return v != nullptr && v->is_number ? v->i64 : default_value;
+    }
+
+    double get_f64(const char* key, double default_value = 0) const {
+        const ConfigValue* v = find(key);
+        return v != nullptr && v->is_number ? v->f64 : default_value;
     }
 
     bool get_bool(const char* key, bool default_value = false) const {
-        auto it = values.find(key);
-        if (it != values.end()) {
-            return it->second == "true" || it->second == "1";
-        }
-        return default_value;
+        const ConfigValue* v = find(key);
+        return v != nullptr ? v->boolean : default_value;
     }
 
     bool contains(const char* key) const {
-        return values.find(key) != values.end();
+        return find(key) != nullptr;
+    }
+
+    void set(std::string key, ConfigValue value) {
+        values[std::move(key)] = std::move(value);
+    }
+
+    // Copy of the values as text, the shape values had before it held
+    // ConfigValue; for code that iterates or .at()s plain strings
+    std::map<std::string, std::string> strings() const {
+        std::map<std::string, std::string> out;
+        for (const auto& kv : values) {
+            out.emplace(kv.first, kv.second.str);
+        }
+        return out;
+    }
+
+    // Same keys with the same values, whatever order the JSON listed them in
+    bool operator==(const Config& other) const {
+        return values == other.values;
+    }
+
+    bool operator!=(const Config& other) const {
+        return !(*this == other);
     }
 };
 
@@ -302,6 +468,62 @@ inline const WriteFlag WriteFlag::EXCLUSIVE = WriteFlag(1 << 2);
 inline const WriteFlag WriteFlag::TRUNCATE = WriteFlag(1 << 3);
 inline const WriteFlag WriteFlag::SYNC = WriteFlag(1 << 4);
 
+/// Open flags for file handle operations (matches Go filesystem.OpenFlag)
+class OpenFlag {
+public:
+    uint32_t value;
+
+    OpenFlag() : value(0) {}
+    explicit OpenFlag(uint32_t v) : value(v) {}
+
+    /// Open for reading only
+    static const OpenFlag RDONLY;
+    /// Open for writing only
+    static const OpenFlag WRONLY;
+    /// Open for reading and writing
+    static const OpenFlag RDWR;
+    /// Append mode - writes go to the end of file
+    static const OpenFlag APPEND;
+    /// Create file if it doesn't exist
+    static const OpenFlag CREATE;
+    /// Fail if file already exists (used with CREATE)
+    static const OpenFlag EXCLUSIVE;
+    /// Truncate file to zero length on open
+    static const OpenFlag TRUNCATE;
+
+    /// Check if a flag is set
+    bool contains(OpenFlag flag) const {
+        return (value & flag.value) != 0;
+    }
+
+    /// Get the access mode (RDONLY, WRONLY or RDWR)
+    OpenFlag access_mode() const {
+        return OpenFlag(value & 3);
+    }
+
+    bool is_readable() const {
+        uint32_t mode = access_mode().value;
+        return mode == RDONLY.value || mode == RDWR.value;
+    }
+
+    bool is_writable() const {
+        uint32_t mode = access_mode().value;
+        return mode == WRONLY.value || mode == RDWR.value;
+    }
+
+    OpenFlag operator|(OpenFlag other) const {
+        return OpenFlag(value | other.value);
+    }
+};
+
+inline const OpenFlag OpenFlag::RDONLY = OpenFlag(0);
+inline const OpenFlag OpenFlag::WRONLY = OpenFlag(1);
+inline const OpenFlag OpenFlag::RDWR = OpenFlag(2);
+inline const OpenFlag OpenFlag::APPEND = OpenFlag(1 << 3);
+inline const OpenFlag OpenFlag::CREATE = OpenFlag(1 << 4);
+inline const OpenFlag OpenFlag::EXCLUSIVE = OpenFlag(1 << 5);
+inline const OpenFlag OpenFlag::TRUNCATE = OpenFlag(1 << 6);
+
 } // namespace agfs
 
 #endif // AGFS_TYPES_H
@@ -15,13 +15,15 @@ public:
         return "HTTP Test Filesystem - Demonstrates HTTP requests from C++ WASM\n"
                "\n"
                "cat /test_get - Make a GET request to example.com\n"
-               "cat /test_json - Fetch JSON from an API\n";
+               "cat /test_json - Fetch JSON from an API\n"
+               "cat /test_stream - Stream example.com in bounded chunks\n";
     }
 
     agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
         if (path == "/") {
             return agfs::FileInfo::dir("", 0755);
-        } else if (path == "/test_get" || path == "/test_json") {
+        } else if (path == "/test_get" || path == "/test_json" ||
+                   path == "/test_stream") {
             return agfs::FileInfo::file(path.substr(1), 0, 0644);
         }
         return agfs::Error::not_found();
@@ -31,7 +33,8 @@ public:
         if (path == "/") {
             return std::vector<agfs::FileInfo>{
                 agfs::FileInfo::file("test_get", 0, 0644),
-                agfs::FileInfo::file("test_json", 0, 0644)
+                agfs::FileInfo::file("test_json", 0, 0644),
+                agfs::FileInfo::file("test_stream", 0, 0644)
             };
         }
         return agfs::Error::not_found();
@@ -43,7 +46,7 @@ public:
             // Simple GET request
             auto result = agfs::Http::get("https://example.com");
             if (!result.is_ok()) {
-                return result.error();
+                return result.unwrap_err();
             }
 
             auto response = result.unwrap();
@@ -63,7 +66,7 @@ public:
             );
 
             if (!result.is_ok()) {
-                return result.error();
+                return result.unwrap_err();
             }
 
             auto response = result.unwrap();
@@ -74,9 +77,49 @@ public:
 
             return response.body;
         }
+        else if (path == "/test_stream") {
+            // Unbounded reads still collect the body, but in 16KB chunks
+            // starting at offset rather than as one response
+            std::vector<uint8_t> data;
+            uint8_t chunk[16 * 1024];
+            auto stream = agfs::Http::open(agfs::HttpRequest::get("https://example.com"));
+            if (!stream.is_ok()) {
+                return stream.unwrap_err();
+            }
+            auto skipped = stream.unwrap().skip(offset);
+            if (!skipped.is_ok()) {
+                return skipped.unwrap_err();
+            }
+            while (true) {
+                auto n = stream.unwrap().read(agfs::ByteSpan(chunk, sizeof(chunk)));
+                if (!n.is_ok()) {
+                    return n.unwrap_err();
+                }
+                data.insert(data.end(), chunk, chunk + n.unwrap());
+                if ((size_t)n.unwrap() < sizeof(chunk) ||
+                    (size >= 0 && (int64_t)data.size() >= size)) {
+                    if (size >= 0 && (int64_t)data.size() > size) {
+                        data.resize(size);
+                    }
+                    return data;
+                }
+            }
+        }
 
         return agfs::Error::not_found();
     }
+
+    // Bounded reads (fs_read up to 64KB) fetch only the requested range, so
+    // the object is never held in memory and the first byte arrives as soon
+    // as the first range does
+    agfs::Result<int64_t> read_into(const std::string& path, int64_t offset,
+                                    agfs::ByteSpan out) override {
+        if (path == "/test_stream") {
+            return agfs::Http::read_range(agfs::HttpRequest::get("https://example.com"),
+                                          offset, out);
+        }
+        return agfs::FileSystem::read_into(path, offset, out);
+    }
 };
 
 AGFS_EXPORT_PLUGIN(HttpTestFS);
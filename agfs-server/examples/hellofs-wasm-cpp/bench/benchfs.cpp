@@ -0,0 +1,139 @@
+// BenchFS - synthetic filesystem for measuring the C++ SDK FFI paths
+//
+// Driven by the Go benchmarks in pkg/plugin/api (make bench)
+//  - /bytes/<n> - A file of n bytes
+//  - /dir/<n>   - A directory with n empty files
+//  - /sink      - Accepts and discards writes
+
+#include "../agfs-cpp-sdk/agfs.h"
+#include <cstdlib>
+
+class BenchFS : public agfs::FileSystem {
+private:
+    // Parse the numeric suffix of /<prefix>/<n>; returns false if path does not match
+    static bool parse_size(const std::string& path, const char* prefix, uint64_t& n) {
+        size_t len = std::strlen(prefix);
+        if (path.compare(0, len, prefix) != 0 || path.size() == len) {
+            return false;
+        }
+        char* end = nullptr;
+        n = std::strtoull(path.c_str() + len, &end, 10);
+        return end != nullptr && *end == '\0';
+    }
+
+    static void fill(uint8_t* p, size_t len, int64_t offset) {
+        for (size_t i = 0; i < len; i++) {
+            p[i] = (uint8_t)('a' + (offset + i) % 26);
+        }
+    }
+
+    // Bytes available at offset for a read of size (-1 = to end of file)
+    static size_t read_len(uint64_t file_size, int64_t offset, int64_t size) {
+        if (offset < 0 || (uint64_t)offset >= file_size) {
+            return 0;
+        }
+        uint64_t avail = file_size - offset;
+        if (size >= 0 && (uint64_t)size < avail) {
+            return (size_t)size;
+        }
+        return (size_t)avail;
+    }
+
+public:
+    const char* name() const override {
+        return "benchfs";
+    }
+
+    const char* readme() const override {
+        return "BenchFS - synthetic filesystem for FFI benchmarks\n"
+               " - /bytes/<n> - A file of n bytes\n"
+               " - /dir/<n> - A directory with n empty files\n"
+               " - /sink - Accepts and discards writes";
+    }
+
+    agfs::Result<std::vector<uint8_t>> read(const std::string& path,
+                                           int64_t offset, int64_t size) override {
+        uint64_t n;
+        if (!parse_size(path, "/bytes/", n)) {
+            return agfs::Error::not_found();
+        }
+        std::vector<uint8_t> data(read_len(n, offset, size));
+        fill(data.data(), data.size(), offset);
+        return data;
+    }
+
+    agfs::Result<int64_t> read_into(const std::string& path, int64_t offset,
+                                    agfs::ByteSpan out) override {
+        uint64_t n;
+        if (!parse_size(path, "/bytes/", n)) {
+            return agfs::Error::not_found();
+        }
+        size_t len = read_len(n, offset, (int64_t)out.size());
+        fill(out.data(), len, offset);
+        return (int64_t)len;
+    }
+
+    agfs::Result<int64_t> write(const std::string& path, agfs::ConstByteSpan data,
+                                int64_t offset, agfs::WriteFlag flags) override {
+        (void)offset; (void)flags; // unused
+        if (path != "/sink") {
+            return agfs::Error::read_only();
+        }
+        return (int64_t)data.size();
+    }
+
+    agfs::Result<int64_t> write(const std::string& path, const std::vector<uint8_t>& data,
+                                int64_t offset, agfs::WriteFlag flags) override {
+        return write(path, agfs::ConstByteSpan(data), offset, flags);
+    }
+
+    agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
+        uint64_t n;
+        if (path == "/") {
+            return agfs::FileInfo::dir("", 0755);
+        }
+        if (path == "/sink") {
+            return agfs::FileInfo::file("sink", 0, 0644);
+        }
+        if (parse_size(path, "/bytes/", n)) {
+            return agfs::FileInfo::file(path.substr(7), (int64_t)n, 0644);
+        }
+        if (parse_size(path, "/dir/", n)) {
+            return agfs::FileInfo::dir(path.substr(5), 0755);
+        }
+        return agfs::Error::not_found();
+    }
+
+    agfs::Result<std::vector<agfs::FileInfo>> readdir(const std::string& path) override {
+        uint64_t n;
+        if (!parse_size(path, "/dir/", n)) {
+            return agfs::Error::not_found();
+        }
+        std::vector<agfs::FileInfo> entries;
+        entries.reserve(n);
+        for (uint64_t i = 0; i < n; i++) {
+            entries.push_back(agfs::FileInfo::file("f" + std::to_string(i), 0, 0644));
+        }
+        return entries;
+    }
+
+    // Entries are generated per page, so paged listings never build the
+    // whole directory
+    agfs::Result<std::string> readdir_page(const std::string& path, const std::string& cursor,
+                                           agfs::DirSink& sink) override {
+        uint64_t n;
+        if (!parse_size(path, "/dir/", n)) {
+            return agfs::Error::not_found();
+        }
+        uint64_t i = cursor.empty() ? 0 : std::strtoull(cursor.c_str(), nullptr, 10);
+        for (; i < n; i++) {
+            if (!sink.emit(agfs::FileInfo::file("f" + std::to_string(i), 0, 0644))) {
+                return std::to_string(i);
+            }
+        }
+        return std::string();
+    }
+};
+
+// Export the plugin
+AGFS_EXPORT_PLUGIN(BenchFS);
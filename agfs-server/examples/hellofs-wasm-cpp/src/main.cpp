@@ -8,17 +8,46 @@
 
 class HelloFS : public agfs::FileSystem {
 private:
+    enum class Node { Root, Hello, HostRoot, Host };
+
+    // Set from the config before initialize() (see config_schema)
     std::string host_prefix;
+    agfs::ConfigSchema schema;
+    // stat/readdir results of /host/*, which FUSE asks for repeatedly (opt-in)
+    agfs::CachedHostFS host;
+    // Rebuilt by each initialize(); the /host routes only exist when
+    // host_prefix is set
+    agfs::Router<Node> routes;
+
+    void build_routes() {
+        routes = agfs::Router<Node>();
+        routes.add("/", Node::Root);
+        routes.add("/hello.txt", Node::Hello);
+        if (!host_prefix.empty()) {
+            routes.add("/host", Node::HostRoot);
+            routes.add("/host/*", Node::Host);
+        }
+    }
 
     // Convert /host/xxx to actual host path, or return empty if not host path
     std::string get_host_path(const std::string& path) const {
-        if (path.rfind("/host/", 0) == 0 && !host_prefix.empty()) {
-            return host_prefix + path.substr(5);  // Remove "/host", add prefix
+        if (host_prefix.empty()) {
+            return "";
+        }
+        agfs::RouteParams params;
+        const Node* node = routes.match(path, params);
+        if (node != nullptr && *node == Node::Host) {
+            return host_prefix + std::string(params.rest());
         }
         return "";
     }
 
 public:
+    HelloFS() {
+        build_routes();
+        schema.add("host_prefix", &host_prefix, "Host directory exposed under /host (empty disables it)");
+    }
+
     const char* name() const override {
         return "hellofs-wasm-cpp";
     }
@@ -26,88 +55,123 @@ public:
     const char* readme() const override {
         return "HelloFS WASM (C++) - Demonstrates host filesystem access\n"
                " - /hello.txt - Returns 'Hello World from C++'\n"
-               " - /host/* - Proxies to host filesystem (if configured host_prefix)";
+               " - /host/* - Proxies to host filesystem (if configured host_prefix)\n"
+               "   metadata is cached when cache_enabled or cache_ttl_ms is set";
+    }
+
+    const agfs::ConfigSchema* config_schema() const override {
+        return &schema;
     }
 
     agfs::Result<void> initialize(const agfs::Config& config) override {
-        // Get optional host_prefix from config
-        const char* prefix = config.get_str("host_prefix");
-        if (prefix != nullptr) {
-            host_prefix = prefix;
-        }
+        build_routes();
+        host.configure(agfs::CacheOptions::from_config(config));
         return agfs::Result<void>();
     }
 
     agfs::Result<std::vector<uint8_t>> read(const std::string& path,
                                            int64_t offset, int64_t size) override {
-        if (path == "/hello.txt") {
+        const Node* node = routes.match(path);
+        if (node != nullptr && *node == Node::Hello) {
             std::string content = "Hello World from C++\n";
             std::vector<uint8_t> data(content.begin(), content.end());
             return data;
         }
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::read(host_path, offset, size);
+            auto result = host.read(host_path, offset, size);
+            if (result.is_err()) {
+                return result.unwrap_err();
+            }
+            return result.unwrap().to_vector();
         }
         return agfs::Error::not_found();
     }
 
-    agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
-        if (path == "/") {
-            return agfs::FileInfo::dir("", 0755);
-        }
-        if (path == "/hello.txt") {
-            return agfs::FileInfo::file("hello.txt", 21, 0644);
-        }
-        if (path == "/host" && !host_prefix.empty()) {
-            return agfs::FileInfo::dir("host", 0755);
-        }
+    // Bounded reads (fs_read up to 64KB) are filled by the host directly
+    // in the output buffer
+    agfs::Result<int64_t> read_into(const std::string& path, int64_t offset,
+                                    agfs::ByteSpan out) override {
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::stat(host_path);
+            return host.read_into(host_path, offset, out);
+        }
+        return agfs::FileSystem::read_into(path, offset, out);
+    }
+
+    agfs::Result<agfs::FileInfo> stat(const std::string& path) override {
+        agfs::RouteParams params;
+        const Node* node = routes.match(path, params);
+        if (node == nullptr) {
+            return agfs::Error::not_found();
+        }
+        switch (*node) {
+            case Node::Root:
+                return agfs::FileInfo::dir("", 0755);
+            case Node::Hello:
+                return agfs::FileInfo::file("hello.txt", 21, 0644);
+            case Node::HostRoot:
+                return agfs::FileInfo::dir("host", 0755);
+            case Node::Host:
+                if (host_prefix.empty()) {
+                    return agfs::Error::not_found();
+                }
+                return host.stat(host_prefix + std::string(params.rest()));
         }
         return agfs::Error::not_found();
     }
 
     agfs::Result<std::vector<agfs::FileInfo>> readdir(const std::string& path) override {
-        if (path == "/") {
-            std::vector<agfs::FileInfo> entries;
-            entries.push_back(agfs::FileInfo::file("hello.txt", 21, 0644));
-            if (!host_prefix.empty()) {
-                entries.push_back(agfs::FileInfo::dir("host", 0755));
+        agfs::RouteParams params;
+        const Node* node = routes.match(path, params);
+        if (node == nullptr) {
+            return agfs::Error::not_found();
+        }
+        switch (*node) {
+            case Node::Root: {
+                std::vector<agfs::FileInfo> entries;
+                entries.push_back(agfs::FileInfo::file("hello.txt", 21, 0644));
+                if (!host_prefix.empty()) {
+                    entries.push_back(agfs::FileInfo::dir("host", 0755));
+                }
+                return entries;
             }
-            return entries;
-        }
-        if (path == "/host" && !host_prefix.empty()) {
-            return agfs::HostFS::readdir(host_prefix);
-        }
-        auto host_path = get_host_path(path);
-        if (!host_path.empty()) {
-            return agfs::HostFS::readdir(host_path);
+            case Node::Hello:
+                return agfs::Error::not_directory();
+            case Node::HostRoot:
+            case Node::Host:
+                if (host_prefix.empty()) {
+                    return agfs::Error::not_found();
+                }
+                return host.readdir(host_prefix + std::string(params.rest()));
         }
         return agfs::Error::not_found();
     }
 
+    // Writes are forwarded with their offset and flags, so partial writes do
+    // not rewrite the whole host file
     agfs::Result<int64_t> write(const std::string& path,
-                                const std::vector<uint8_t>& data,
+                                agfs::ConstByteSpan data,
                                 int64_t offset,
                                 agfs::WriteFlag flags) override {
-        (void)offset; (void)flags; // HostFS doesn't support offset/flags yet
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            auto result = agfs::HostFS::write(host_path, data);
-            if (result.is_ok()) {
-                return static_cast<int64_t>(data.size());
-            }
-            return result.unwrap_err();
+            return host.write_at(host_path, data, offset, flags);
         }
         return agfs::Error::permission_denied();
     }
 
+    agfs::Result<int64_t> write(const std::string& path,
+                                const std::vector<uint8_t>& data,
+                                int64_t offset,
+                                agfs::WriteFlag flags) override {
+        return write(path, agfs::ConstByteSpan(data), offset, flags);
+    }
+
     agfs::Result<void> create(const std::string& path) override {
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::create(host_path);
+            return host.create(host_path);
         }
         return agfs::Error::permission_denied();
     }
@@ -115,7 +179,7 @@ public:
     agfs::Result<void> mkdir(const std::string& path, uint32_t perm) override {
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::mkdir(host_path, perm);
+            return host.mkdir(host_path, perm);
         }
         return agfs::Error::permission_denied();
     }
@@ -123,7 +187,7 @@ public:
     agfs::Result<void> remove(const std::string& path) override {
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::remove(host_path);
+            return host.remove(host_path);
         }
         return agfs::Error::permission_denied();
     }
@@ -131,7 +195,7 @@ public:
     agfs::Result<void> remove_all(const std::string& path) override {
         auto host_path = get_host_path(path);
         if (!host_path.empty()) {
-            return agfs::HostFS::remove_all(host_path);
+            return host.remove_all(host_path);
         }
         return agfs::Error::permission_denied();
     }
@@ -140,7 +204,7 @@ public:
         auto host_old = get_host_path(old_path);
         auto host_new = get_host_path(new_path);
         if (!host_old.empty() && !host_new.empty()) {
-            return agfs::HostFS::rename(host_old, host_new);
+            return host.rename(host_old, host_new);
         }
         return agfs::Error::permission_denied();
     }
@@ -151,5 +215,7 @@ public:
     }
 };
 
-// Export the plugin
+// Export the plugin. HelloFS calls the host for every /host operation;
+// export agfs::BufferedFileSystem<HelloFS> instead to batch sequential reads
+// and small writes into fewer host calls.
 AGFS_EXPORT_PLUGIN(HelloFS)
@@ -0,0 +1,114 @@
+// Checks the alignment and rewind behaviour of agfs_arena.h
+//
+// Allocations of mixed sizes and alignments are made in arenas with small
+// chunks, so that most of them land right after a chunk boundary, and every
+// returned pointer must honour the requested alignment.
+//
+//   make test
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "agfs_arena.h"
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                         \
+    do {                                                         \
+        if (!(cond)) {                                           \
+            std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                   \
+            std::fprintf(stderr, "\n");                          \
+            failures++;                                          \
+        }                                                        \
+    } while (0)
+
+std::mt19937 rng(20261014);
+
+bool aligned(const void* p, size_t align) {
+    return (reinterpret_cast<uintptr_t>(p) & (align - 1)) == 0;
+}
+
+void test_small_then_aligned() {
+    // The case that used to come back 8 mod 16
+    agfs::Arena arena;
+    void* a = arena.alloc(1, 1);
+    void* b = arena.alloc(8, 16);
+    CHECK(a != nullptr && b != nullptr, "alloc failed");
+    CHECK(aligned(b, 16), "alloc(8, 16) after alloc(1, 1) at %p", b);
+    void* c = arena.alloc(8, 8);
+    CHECK(aligned(c, 8), "alloc(8, 8) at %p", c);
+}
+
+void test_chunk_boundaries() {
+    const size_t aligns[] = {1, 2, 4, 8, 16, 32, 64};
+    for (size_t chunk_size : {24, 40, 64, 100, 256}) {
+        agfs::Arena arena(chunk_size);
+        for (int round = 0; round < 3; round++) {
+            agfs::Arena::Scope scope(arena);
+            std::vector<std::pair<uint8_t*, size_t>> live;
+            for (int i = 0; i < 500; i++) {
+                size_t align = aligns[rng() % (sizeof(aligns) / sizeof(aligns[0]))];
+                size_t size = 1 + rng() % (chunk_size + 16);
+                uint8_t* p = static_cast<uint8_t*>(arena.alloc(size, align));
+                CHECK(p != nullptr, "alloc(%zu, %zu) failed", size, align);
+                if (p == nullptr) {
+                    continue;
+                }
+                CHECK(aligned(p, align), "alloc(%zu, %zu) at %p with %zu-byte chunks (round %d)",
+                      size, align, static_cast<void*>(p), chunk_size, round);
+                std::memset(p, (int)(i & 0xff), size);
+                live.emplace_back(p, size);
+            }
+            // Nothing handed out in this scope may overlap
+            for (size_t i = 0; i < live.size(); i++) {
+                uint8_t want = (uint8_t)(i & 0xff);
+                for (size_t j = 0; j < live[i].second; j++) {
+                    if (live[i].first[j] != want) {
+                        CHECK(false, "allocation %zu overwritten at byte %zu", i, j);
+                        break;
+                    }
+                }
+            }
+        }
+        CHECK(arena.bytes_in_use() == 0, "%zu bytes in use after the scopes", arena.bytes_in_use());
+    }
+}
+
+void test_arena_vector() {
+    agfs::Arena arena(64);
+    agfs::Arena::Scope scope(arena);
+    agfs::ArenaAllocator<char> chars(arena);
+    agfs::ArenaString s("x", chars);
+    agfs::ArenaVector<int64_t> v{agfs::ArenaAllocator<int64_t>(arena)};
+    for (int64_t i = 0; i < 100; i++) {
+        v.push_back(i);
+        s.push_back('y');
+        CHECK(aligned(v.data(), alignof(int64_t)), "ArenaVector<int64_t> data at %p",
+              static_cast<void*>(v.data()));
+    }
+    int64_t sum = 0;
+    for (int64_t x : v) {
+        sum += x;
+    }
+    CHECK(sum == 4950, "ArenaVector<int64_t> sum %lld", (long long)sum);
+}
+
+} // namespace
+
+int main() {
+    test_small_then_aligned();
+    test_chunk_boundaries();
+    test_arena_vector();
+    if (failures != 0) {
+        std::fprintf(stderr, "arena_test: %d failures\n", failures);
+        return 1;
+    }
+    std::printf("arena_test: ok\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+#ifndef AGFS_TEST_WASM_SIMD128_H
+#define AGFS_TEST_WASM_SIMD128_H
+
+// Portable stand-in for <wasm_simd128.h>, so the simd128 paths of
+// agfs_simd.h build and run on the host (tests/simd_test.cpp)
+//
+// Only the intrinsics agfs_simd.h uses are provided, lane by lane, with the
+// wasm semantics (little-endian lanes, shifts modulo the lane width).
+
+#include <cstdint>
+#include <cstring>
+
+struct v128_t {
+    uint8_t b[16];
+};
+
+namespace agfs_test_simd {
+
+template <typename T>
+inline T lane(const v128_t& v, int i) {
+    T x;
+    std::memcpy(&x, v.b + i * sizeof(T), sizeof(T));
+    return x;
+}
+
+template <typename T>
+inline void set_lane(v128_t& v, int i, T x) {
+    std::memcpy(v.b + i * sizeof(T), &x, sizeof(T));
+}
+
+template <typename T, typename F>
+inline v128_t map(const v128_t& a, F f) {
+    v128_t r;
+    for (int i = 0; i < (int)(16 / sizeof(T)); i++) {
+        set_lane<T>(r, i, (T)f(lane<T>(a, i)));
+    }
+    return r;
+}
+
+template <typename T, typename F>
+inline v128_t zip(const v128_t& a, const v128_t& b, F f) {
+    v128_t r;
+    for (int i = 0; i < (int)(16 / sizeof(T)); i++) {
+        set_lane<T>(r, i, (T)f(lane<T>(a, i), lane<T>(b, i)));
+    }
+    return r;
+}
+
+template <typename T>
+inline v128_t splat(T x) {
+    v128_t r;
+    for (int i = 0; i < (int)(16 / sizeof(T)); i++) {
+        set_lane<T>(r, i, x);
+    }
+    return r;
+}
+
+// All ones where pred holds, per byte lane
+template <typename P>
+inline v128_t cmp8(const v128_t& a, const v128_t& b, P pred) {
+    return zip<uint8_t>(a, b, [&](uint8_t x, uint8_t y) { return pred(x, y) ? 0xFF : 0; });
+}
+
+} // namespace agfs_test_simd
+
+inline v128_t wasm_v128_load(const void* p) {
+    v128_t r;
+    std::memcpy(r.b, p, 16);
+    return r;
+}
+
+inline void wasm_v128_store(void* p, v128_t v) {
+    std::memcpy(p, v.b, 16);
+}
+
+inline v128_t wasm_i8x16_splat(int8_t x) { return agfs_test_simd::splat<int8_t>(x); }
+inline v128_t wasm_i16x8_splat(int16_t x) { return agfs_test_simd::splat<int16_t>(x); }
+inline v128_t wasm_i32x4_splat(int32_t x) { return agfs_test_simd::splat<int32_t>(x); }
+
+inline v128_t wasm_v128_and(v128_t a, v128_t b) {
+    return agfs_test_simd::zip<uint8_t>(a, b, [](uint8_t x, uint8_t y) { return x & y; });
+}
+
+inline v128_t wasm_v128_or(v128_t a, v128_t b) {
+    return agfs_test_simd::zip<uint8_t>(a, b, [](uint8_t x, uint8_t y) { return x | y; });
+}
+
+// Bits of a where mask is set, of b elsewhere
+inline v128_t wasm_v128_bitselect(v128_t a, v128_t b, v128_t mask) {
+    return wasm_v128_or(wasm_v128_and(a, mask),
+                        agfs_test_simd::zip<uint8_t>(b, mask, [](uint8_t x, uint8_t m) { return x & ~m; }));
+}
+
+inline bool wasm_v128_any_true(v128_t v) {
+    for (uint8_t x : v.b) {
+        if (x != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool wasm_i8x16_all_true(v128_t v) {
+    for (uint8_t x : v.b) {
+        if (x == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline uint32_t wasm_i8x16_bitmask(v128_t v) {
+    uint32_t mask = 0;
+    for (int i = 0; i < 16; i++) {
+        mask |= (uint32_t)(v.b[i] >> 7) << i;
+    }
+    return mask;
+}
+
+inline v128_t wasm_i8x16_eq(v128_t a, v128_t b) {
+    return agfs_test_simd::cmp8(a, b, [](uint8_t x, uint8_t y) { return x == y; });
+}
+
+inline v128_t wasm_u8x16_lt(v128_t a, v128_t b) {
+    return agfs_test_simd::cmp8(a, b, [](uint8_t x, uint8_t y) { return x < y; });
+}
+
+inline v128_t wasm_u8x16_le(v128_t a, v128_t b) {
+    return agfs_test_simd::cmp8(a, b, [](uint8_t x, uint8_t y) { return x <= y; });
+}
+
+inline v128_t wasm_u8x16_ge(v128_t a, v128_t b) {
+    return agfs_test_simd::cmp8(a, b, [](uint8_t x, uint8_t y) { return x >= y; });
+}
+
+inline v128_t wasm_i8x16_add(v128_t a, v128_t b) {
+    return agfs_test_simd::zip<uint8_t>(a, b, [](uint8_t x, uint8_t y) { return x + y; });
+}
+
+inline v128_t wasm_i16x8_shl(v128_t a, uint32_t n) {
+    return agfs_test_simd::map<uint16_t>(a, [&](uint16_t x) { return x << (n & 15); });
+}
+
+inline v128_t wasm_u16x8_shr(v128_t a, uint32_t n) {
+    return agfs_test_simd::map<uint16_t>(a, [&](uint16_t x) { return x >> (n & 15); });
+}
+
+inline v128_t wasm_i32x4_shl(v128_t a, uint32_t n) {
+    return agfs_test_simd::map<uint32_t>(a, [&](uint32_t x) { return x << (n & 31); });
+}
+
+inline v128_t wasm_u32x4_shr(v128_t a, uint32_t n) {
+    return agfs_test_simd::map<uint32_t>(a, [&](uint32_t x) { return x >> (n & 31); });
+}
+
+// Lane i of the result is lane idx[i] of a:b (0-15 from a, 16-31 from b)
+inline v128_t wasm_i8x16_shuffle(v128_t a, v128_t b, int i0, int i1, int i2, int i3, int i4, int i5,
+                                 int i6, int i7, int i8, int i9, int i10, int i11, int i12, int i13,
+                                 int i14, int i15) {
+    const int idx[16] = {i0, i1, i2, i3, i4, i5, i6, i7, i8, i9, i10, i11, i12, i13, i14, i15};
+    v128_t r;
+    for (int i = 0; i < 16; i++) {
+        r.b[i] = idx[i] < 16 ? a.b[idx[i]] : b.b[idx[i] - 16];
+    }
+    return r;
+}
+
+#endif // AGFS_TEST_WASM_SIMD128_H
@@ -0,0 +1,148 @@
+// Checks the simd128 kernels of agfs_simd.h against the scalar ones
+//
+// agfs_simd.h is compiled twice: first scalar (AGFS_SDK_NO_SIMD) into
+// namespace agfs_scalar, then with its simd128 paths on top of the
+// intrinsics shim in tests/shim. Both must produce the same results.
+//
+//   make test
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#define AGFS_SDK_NO_SIMD
+#define agfs agfs_scalar
+#include "agfs_simd.h"
+#undef agfs
+#undef AGFS_SDK_NO_SIMD
+#undef AGFS_SIMD_H
+
+#define __wasm_simd128__ 1
+#include "agfs_simd.h"
+
+#ifndef AGFS_SDK_SIMD
+#error "simd128 paths of agfs_simd.h not enabled"
+#endif
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(cond, ...)                                         \
+    do {                                                         \
+        if (!(cond)) {                                           \
+            std::fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); \
+            std::fprintf(stderr, __VA_ARGS__);                   \
+            std::fprintf(stderr, "\n");                          \
+            failures++;                                          \
+        }                                                        \
+    } while (0)
+
+std::mt19937 rng(20261014);
+
+// Random bytes, mostly from alphabet when it is given
+std::vector<uint8_t> random_bytes(size_t n, const std::string& alphabet = "") {
+    std::vector<uint8_t> out(n);
+    for (auto& b : out) {
+        if (!alphabet.empty() && rng() % 8 != 0) {
+            b = (uint8_t)alphabet[rng() % alphabet.size()];
+        } else {
+            b = (uint8_t)rng();
+        }
+    }
+    return out;
+}
+
+void test_strlen() {
+    // strlen reads whole aligned 16-byte blocks, so keep them in the buffer
+    alignas(16) char buf[128];
+    for (size_t start = 0; start < 32; start++) {
+        for (size_t len = 0; start + len < 96; len++) {
+            for (size_t i = 0; i < sizeof(buf); i++) {
+                buf[i] = (char)(1 + rng() % 255);
+            }
+            buf[start + len] = '\0';
+            buf[sizeof(buf) - 1] = '\0';
+            size_t got = agfs::simd::strlen(buf + start);
+            CHECK(got == len, "strlen at %zu: got %zu, want %zu", start, got, len);
+        }
+    }
+}
+
+void test_memchr() {
+    for (size_t n = 0; n < 100; n++) {
+        for (int round = 0; round < 8; round++) {
+            std::vector<uint8_t> data = random_bytes(n, "abc");
+            int c = round % 2 == 0 ? 'a' : (int)(uint8_t)rng();
+            const void* want = agfs_scalar::simd::memchr(data.data(), c, n);
+            const void* got = agfs::simd::memchr(data.data(), c, n);
+            CHECK(got == want, "memchr(%d) over %zu bytes: got %p, want %p", c, n, got, want);
+        }
+    }
+}
+
+void test_base64() {
+    const std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    for (size_t n = 0; n < 200; n++) {
+        std::vector<uint8_t> data = random_bytes(n);
+        std::string want = agfs_scalar::simd::base64_encode(data.data(), n);
+        std::string got = agfs::simd::base64_encode(data.data(), n);
+        CHECK(got == want, "base64_encode of %zu bytes differs", n);
+
+        std::vector<uint8_t> back(agfs::simd::base64_decoded_max(got.size()));
+        size_t m = agfs::simd::base64_decode(got.data(), got.size(), back.data());
+        back.resize(m);
+        CHECK(back == data, "base64 round trip of %zu bytes differs", n);
+    }
+
+    // Mostly valid text with junk, whitespace and early '=' mixed in
+    for (size_t n = 0; n < 200; n++) {
+        for (int round = 0; round < 4; round++) {
+            std::vector<uint8_t> text = random_bytes(n, alphabet);
+            if (round == 1 && n > 0) {
+                text[rng() % n] = '\n';
+            }
+            if (round == 2 && n > 0) {
+                text[rng() % n] = '=';
+            }
+            const char* in = reinterpret_cast<const char*>(text.data());
+            std::vector<uint8_t> want(agfs::simd::base64_decoded_max(n));
+            std::vector<uint8_t> got(want.size());
+            want.resize(agfs_scalar::simd::base64_decode(in, n, want.data()));
+            got.resize(agfs::simd::base64_decode(in, n, got.data()));
+            CHECK(got == want, "base64_decode of %zu characters (round %d) differs", n, round);
+        }
+    }
+}
+
+void test_json_escape() {
+    for (size_t n = 0; n < 200; n++) {
+        for (int round = 0; round < 4; round++) {
+            // Plain text with the odd quote, backslash or control byte
+            std::vector<uint8_t> data = random_bytes(n, round == 0 ? "abcdefgh \"\\\n\t\x01\x1f" : "abcdefgh");
+            const char* s = reinterpret_cast<const char*>(data.data());
+            std::string want;
+            std::string got;
+            agfs_scalar::simd::json_escape_append(want, s, n);
+            agfs::simd::json_escape_append(got, s, n);
+            CHECK(got == want, "json_escape of %zu bytes (round %d) differs", n, round);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    test_strlen();
+    test_memchr();
+    test_base64();
+    test_json_escape();
+    if (failures != 0) {
+        std::fprintf(stderr, "simd_test: %d failures\n", failures);
+        return 1;
+    }
+    std::printf("simd_test: ok\n");
+    return 0;
+}
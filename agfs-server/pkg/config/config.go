@@ -37,6 +37,9 @@ type WASMPluginConfig struct {
 	InstanceMaxRequests  int `yaml:"instance_max_requests"`   // Maximum requests per instance (0 = unlimited)
 	HealthCheckInterval  int `yaml:"health_check_interval"`   // Health check interval in seconds (0 = disabled)
 	EnablePoolStatistics bool `yaml:"enable_pool_statistics"` // Enable pool statistics collection
+	InstanceMaxMemoryMB  int  `yaml:"instance_max_memory_mb"` // Recycle instances whose linear memory exceeds this (0 = unlimited)
+	TrimMemoryGrowthMB   int  `yaml:"trim_memory_growth_mb"`  // Trim instances whose memory grew this much since the last trim (0 = disabled)
+	InstanceMaxThreads   int  `yaml:"instance_max_threads"`   // Threads each instance of a wasi-threads build may spawn (0 = number of CPUs)
 }
 
 // PluginConfig can be either a single plugin or an array of plugin instances
@@ -111,6 +114,15 @@ func (c *Config) GetWASMConfig() WASMPluginConfig {
 	if cfg.HealthCheckInterval < 0 {
 		cfg.HealthCheckInterval = 0 // Default: disabled
 	}
+	if cfg.InstanceMaxMemoryMB < 0 {
+		cfg.InstanceMaxMemoryMB = 0 // Default: unlimited
+	}
+	if cfg.TrimMemoryGrowthMB < 0 {
+		cfg.TrimMemoryGrowthMB = 0 // Default: disabled
+	}
+	if cfg.InstanceMaxThreads < 0 {
+		cfg.InstanceMaxThreads = 0 // Default: number of CPUs
+	}
 
 	return cfg
 }
@@ -136,6 +136,19 @@ func (b *BaseFileSystem) Sync(path string) error {
 	return nil
 }
 
+// ReadV provides a default implementation of VectorReader with one Read per range
+func (b *BaseFileSystem) ReadV(path string, ranges []ReadRange) ([][]byte, error) {
+	out := make([][]byte, len(ranges))
+	for i, r := range ranges {
+		data, err := b.FS.Read(path, r.Offset, r.Size)
+		if err != nil && err != io.EOF {
+			return nil, err
+		}
+		out[i] = data
+	}
+	return out, nil
+}
+
 // GetCapabilities returns default capabilities
 func (b *BaseFileSystem) GetCapabilities() Capabilities {
 	return DefaultCapabilities()
@@ -56,6 +56,66 @@ type Syncer interface {
 	Sync(path string) error
 }
 
+// ReadRange is one range of a vectored read
+type ReadRange struct {
+	Offset int64
+	Size   int64
+}
+
+// VectorReader is implemented by file systems that read several ranges of
+// one file in a single call, such as a Parquet footer and its column chunks
+type VectorReader interface {
+	// ReadV returns the data of each range in order; ranges reaching past
+	// the end of the file come back short or empty
+	ReadV(path string, ranges []ReadRange) ([][]byte, error)
+}
+
+// ChangeKind is what happened to the path of a ChangeEvent
+type ChangeKind uint8
+
+const (
+	ChangeCreated  ChangeKind = 1
+	ChangeModified ChangeKind = 2 // Content or size
+	ChangeRemoved  ChangeKind = 3
+	ChangeAttrib   ChangeKind = 4 // Mode or other metadata
+)
+
+// String returns the name used for the kind in the HTTP API
+func (k ChangeKind) String() string {
+	switch k {
+	case ChangeCreated:
+		return "created"
+	case ChangeModified:
+		return "modified"
+	case ChangeRemoved:
+		return "removed"
+	case ChangeAttrib:
+		return "attrib"
+	default:
+		return "unknown"
+	}
+}
+
+// ChangeEvent reports a change to one path
+type ChangeEvent struct {
+	Path string
+	Kind ChangeKind
+}
+
+// ChangeFunc receives batches of change events. overflow means events were
+// lost and anything under the watched path may have changed.
+type ChangeFunc func(events []ChangeEvent, overflow bool)
+
+// ChangeNotifier is implemented by file systems that report changes they
+// make on their own (background work, expiry, remote updates), so callers
+// can invalidate cached metadata instead of polling Stat
+type ChangeNotifier interface {
+	// Watch delivers changes at or below path to fn, with paths relative to
+	// this file system. fn may be called from any goroutine and must not
+	// call back into the file system.
+	Watch(path string, fn ChangeFunc) error
+}
+
 // === Special Semantics Interfaces ===
 
 // AppendOnlyFS marks file systems where certain paths only support append operations
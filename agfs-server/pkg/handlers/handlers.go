@@ -553,11 +553,59 @@ func (h *Handler) Capabilities(w http.ResponseWriter, r *http.Request) {
 			"digest",   // Server-side checksums
 			"stream",   // Streaming read
 			"touch",    // Touch/update timestamp
+			"events",   // Change log for cache invalidation
 		},
 	}
 	writeJSON(w, http.StatusOK, response)
 }
 
+// EventsResponse is the response of GET /events
+type EventsResponse struct {
+	Events []mountablefs.Change `json:"events"`
+	Next   int64                `json:"next"`  // since of the next request
+	Reset  bool                 `json:"reset"` // changes were missed; drop all cached state
+}
+
+// maxEventsTimeout caps how long GET /events waits for a change
+const maxEventsTimeout = 60 * time.Second
+
+// Events handles GET /events?since=<seq>&timeout=<seconds>
+// Returns the changes with seq >= since, waiting up to timeout seconds for
+// one (long poll). since=0 returns no changes and the current position.
+func (h *Handler) Events(w http.ResponseWriter, r *http.Request) {
+	logSource, ok := h.fs.(interface{ Changes() *mountablefs.ChangeLog })
+	if !ok {
+		writeError(w, http.StatusNotImplemented, "filesystem does not record changes")
+		return
+	}
+
+	var since int64
+	if sinceStr := r.URL.Query().Get("since"); sinceStr != "" {
+		parsed, err := strconv.ParseInt(sinceStr, 10, 64)
+		if err != nil {
+			writeError(w, http.StatusBadRequest, "invalid since parameter")
+			return
+		}
+		since = parsed
+	}
+
+	var timeout time.Duration
+	if timeoutStr := r.URL.Query().Get("timeout"); timeoutStr != "" {
+		seconds, err := strconv.ParseFloat(timeoutStr, 64)
+		if err != nil || seconds < 0 {
+			writeError(w, http.StatusBadRequest, "invalid timeout parameter")
+			return
+		}
+		timeout = time.Duration(seconds * float64(time.Second))
+		if timeout > maxEventsTimeout {
+			timeout = maxEventsTimeout
+		}
+	}
+
+	events, next, reset := logSource.Changes().Since(since, timeout)
+	writeJSON(w, http.StatusOK, EventsResponse{Events: events, Next: next, Reset: reset})
+}
+
 // HealthResponse represents the health check response
 type HealthResponse struct {
 	Status    string `json:"status"`
@@ -905,6 +953,13 @@ func (h *Handler) SetupRoutes(mux *http.ServeMux) {
 		}
 		h.Touch(w, r)
 	})
+	mux.HandleFunc("/api/v1/events", func(w http.ResponseWriter, r *http.Request) {
+		if r.Method != http.MethodGet {
+			writeError(w, http.StatusMethodNotAllowed, "method not allowed")
+			return
+		}
+		h.Events(w, r)
+	})
 	mux.HandleFunc("/api/v1/symlink", func(w http.ResponseWriter, r *http.Request) {
 		if r.Method != http.MethodPost {
 			writeError(w, http.StatusMethodNotAllowed, "method not allowed")
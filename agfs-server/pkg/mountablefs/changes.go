@@ -0,0 +1,186 @@
+package mountablefs
+
+import (
+	"sync"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	iradix "github.com/hashicorp/go-immutable-radix"
+	log "github.com/sirupsen/logrus"
+)
+
+// ChangeKindTree marks a change of everything at or below the path: a
+// plugin's queue overflowed, or a mount came or went
+const ChangeKindTree = "tree"
+
+// defaultChangeLogSize is how many changes a ChangeLog keeps
+const defaultChangeLogSize = 4096
+
+// Change is one entry of the change log
+type Change struct {
+	Seq  int64  `json:"seq"`
+	Path string `json:"path"`
+	Kind string `json:"kind"` // created, modified, removed, attrib or tree
+}
+
+// ChangeLog is a bounded, sequence-numbered log of the changes made through
+// a MountableFS and reported by its plugins (filesystem.ChangeNotifier), for
+// clients that cache metadata and want to invalidate it instead of polling
+type ChangeLog struct {
+	mu      sync.Mutex
+	ring    []Change
+	start   int   // Index of the oldest entry in ring
+	count   int   // Entries in ring
+	nextSeq int64 // Seq of the next change; seqs start at 1
+	wake    chan struct{}
+}
+
+// NewChangeLog creates a change log that keeps the last size changes
+func NewChangeLog(size int) *ChangeLog {
+	if size <= 0 {
+		size = defaultChangeLogSize
+	}
+	return &ChangeLog{
+		ring:    make([]Change, size),
+		nextSeq: 1,
+		wake:    make(chan struct{}),
+	}
+}
+
+// Record appends a change; a repeat of the latest change is dropped
+func (l *ChangeLog) Record(path, kind string) {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+
+	if l.count > 0 {
+		last := &l.ring[(l.start+l.count-1)%len(l.ring)]
+		if last.Path == path && last.Kind == kind {
+			return
+		}
+	}
+
+	c := Change{Seq: l.nextSeq, Path: path, Kind: kind}
+	l.nextSeq++
+	if l.count < len(l.ring) {
+		l.ring[(l.start+l.count)%len(l.ring)] = c
+		l.count++
+	} else {
+		l.ring[l.start] = c
+		l.start = (l.start + 1) % len(l.ring)
+	}
+
+	close(l.wake)
+	l.wake = make(chan struct{})
+}
+
+// Next returns the seq the next change will get
+func (l *ChangeLog) Next() int64 {
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return l.nextSeq
+}
+
+// Since returns the changes with seq >= since, waiting up to timeout for
+// one if there are none yet, and the since of the next call. reset is true
+// when changes after since were already dropped from the log (or since is
+// from another server run); the caller must then treat everything it
+// cached as changed. A since of 0 or less returns no changes and the
+// current position, to start following the log from now.
+func (l *ChangeLog) Since(since int64, timeout time.Duration) (changes []Change, next int64, reset bool) {
+	if since <= 0 {
+		return []Change{}, l.Next(), false
+	}
+
+	var timer *time.Timer
+	for {
+		l.mu.Lock()
+		oldest := l.nextSeq - int64(l.count)
+		// A since past the end is from before a server restart
+		if since < oldest || since > l.nextSeq {
+			since, reset = oldest, true
+		}
+		if since < l.nextSeq || reset || timeout <= 0 {
+			changes = l.copyFrom(since, oldest)
+			next = l.nextSeq
+			l.mu.Unlock()
+			if timer != nil {
+				timer.Stop()
+			}
+			return changes, next, reset
+		}
+		wake := l.wake
+		l.mu.Unlock()
+
+		if timer == nil {
+			timer = time.NewTimer(timeout)
+		}
+		select {
+		case <-wake:
+		case <-timer.C:
+			timeout = 0
+		}
+	}
+}
+
+// copyFrom copies the changes from seq since on; l.mu must be held
+func (l *ChangeLog) copyFrom(since, oldest int64) []Change {
+	n := int(l.nextSeq - since)
+	if n <= 0 {
+		return []Change{}
+	}
+	out := make([]Change, n)
+	first := l.start + int(since-oldest)
+	for i := range out {
+		out[i] = l.ring[(first+i)%len(l.ring)]
+	}
+	return out
+}
+
+// Changes returns the change log of this filesystem
+func (mfs *MountableFS) Changes() *ChangeLog {
+	return mfs.changes
+}
+
+// recordChange logs a change to path made through mfs, if err is nil
+func (mfs *MountableFS) recordChange(err error, path string, kind filesystem.ChangeKind) error {
+	if err == nil {
+		mfs.changes.Record(filesystem.NormalizePath(path), kind.String())
+	}
+	return err
+}
+
+// watchMount subscribes to the change events of a mount's plugin, if it
+// reports any; events are logged under the mount path while it is mounted
+func (mfs *MountableFS) watchMount(mount *MountPoint) {
+	notifier, ok := mount.Plugin.GetFileSystem().(filesystem.ChangeNotifier)
+	if !ok {
+		return
+	}
+
+	err := notifier.Watch("/", func(events []filesystem.ChangeEvent, overflow bool) {
+		tree := mfs.mountTree.Load().(*iradix.Tree)
+		if current, exists := tree.Get([]byte(mount.Path)); !exists || current != mount {
+			return
+		}
+		if overflow {
+			mfs.changes.Record(mount.Path, ChangeKindTree)
+		}
+		for _, e := range events {
+			mfs.changes.Record(joinMountPath(mount.Path, e.Path), e.Kind.String())
+		}
+	})
+	if err != nil && err != filesystem.ErrNotSupported {
+		log.Warnf("Failed to watch changes of mount %s: %v", mount.Path, err)
+	}
+}
+
+// joinMountPath turns a plugin path into the path under the mount
+func joinMountPath(mountPath, relPath string) string {
+	if relPath == "" || relPath == "/" {
+		return mountPath
+	}
+	if mountPath == "/" {
+		return filesystem.NormalizePath(relPath)
+	}
+	return mountPath + filesystem.NormalizePath(relPath)
+}
@@ -0,0 +1,105 @@
+package mountablefs
+
+import (
+	"testing"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/api"
+)
+
+func TestChangeLogSince(t *testing.T) {
+	l := NewChangeLog(4)
+
+	changes, next, reset := l.Since(0, 0)
+	if len(changes) != 0 || next != 1 || reset {
+		t.Fatalf("empty log: changes=%v next=%d reset=%v", changes, next, reset)
+	}
+
+	l.Record("/a", "modified")
+	l.Record("/a", "modified") // coalesced
+	l.Record("/b", "created")
+
+	changes, next, reset = l.Since(1, 0)
+	if reset || next != 3 || len(changes) != 2 {
+		t.Fatalf("expected 2 changes to seq 3, got changes=%v next=%d reset=%v", changes, next, reset)
+	}
+	if changes[0].Seq != 1 || changes[0].Path != "/a" || changes[1].Seq != 2 || changes[1].Path != "/b" {
+		t.Errorf("unexpected changes %v", changes)
+	}
+
+	changes, next, _ = l.Since(3, 0)
+	if len(changes) != 0 || next != 3 {
+		t.Errorf("caught up: changes=%v next=%d", changes, next)
+	}
+
+	// Push /a and /b out of the 4-entry ring
+	for _, p := range []string{"/c", "/d", "/e", "/f"} {
+		l.Record(p, "removed")
+	}
+	changes, next, reset = l.Since(1, 0)
+	if !reset || next != 7 || len(changes) != 4 || changes[0].Path != "/c" {
+		t.Errorf("dropped changes: changes=%v next=%d reset=%v", changes, next, reset)
+	}
+
+	// A since from a previous server run
+	if _, _, reset = l.Since(100, 0); !reset {
+		t.Errorf("since past the end not reported as reset")
+	}
+}
+
+func TestChangeLogSinceWaits(t *testing.T) {
+	l := NewChangeLog(0)
+	next := l.Next()
+
+	done := make(chan []Change)
+	go func() {
+		changes, _, _ := l.Since(next, 5*time.Second)
+		done <- changes
+	}()
+
+	time.Sleep(20 * time.Millisecond)
+	l.Record("/x", "modified")
+
+	select {
+	case changes := <-done:
+		if len(changes) != 1 || changes[0].Path != "/x" {
+			t.Errorf("unexpected changes %v", changes)
+		}
+	case <-time.After(2 * time.Second):
+		t.Fatal("Since did not wake up on Record")
+	}
+
+	start := time.Now()
+	changes, _, _ := l.Since(l.Next(), 30*time.Millisecond)
+	if len(changes) != 0 || time.Since(start) < 30*time.Millisecond {
+		t.Errorf("timeout: changes=%v after %v", changes, time.Since(start))
+	}
+}
+
+func TestJoinMountPath(t *testing.T) {
+	cases := []struct{ mount, rel, want string }{
+		{"/", "/a", "/a"},
+		{"/m", "/", "/m"},
+		{"/m", "/a/b", "/m/a/b"},
+		{"/m", "a", "/m/a"},
+	}
+	for _, c := range cases {
+		if got := joinMountPath(c.mount, c.rel); got != c.want {
+			t.Errorf("joinMountPath(%q, %q) = %q, want %q", c.mount, c.rel, got, c.want)
+		}
+	}
+}
+
+func TestRecordChangeSkipsErrors(t *testing.T) {
+	mfs := NewMountableFS(api.PoolConfig{})
+	start := mfs.Changes().Next()
+
+	mfs.recordChange(filesystem.ErrNotFound, "/a", filesystem.ChangeModified)
+	mfs.recordChange(nil, "/b/", filesystem.ChangeRemoved)
+
+	changes, _, _ := mfs.Changes().Since(start, 0)
+	if len(changes) != 1 || changes[0].Path != "/b" || changes[0].Kind != "removed" {
+		t.Errorf("unexpected changes %v", changes)
+	}
+}
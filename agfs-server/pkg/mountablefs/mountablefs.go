@@ -57,6 +57,9 @@ type MountableFS struct {
 	// This allows symlinks to work across all filesystems without backend support
 	symlinks   map[string]string // Key: link path, Value: target path
 	symlinksMu sync.RWMutex
+
+	// Changes made through this filesystem or reported by its plugins
+	changes *ChangeLog
 }
 
 // handleInfo stores information about a handle, including its mount point and local handle
@@ -73,6 +76,7 @@ func NewMountableFS(poolConfig api.PoolConfig) *MountableFS {
 		pluginNameCounters: make(map[string]int),
 		handleInfos:        make(map[int64]*handleInfo),
 		symlinks:           make(map[string]string),
+		changes:            NewChangeLog(0),
 	}
 	mfs.mountTree.Store(iradix.New())
 	// Start global handle IDs from 1
@@ -173,15 +177,19 @@ func (mfs *MountableFS) Mount(path string, plugin plugin.ServicePlugin) error {
 	}
 
 	// Create new tree with added mount
-	newTree, _, _ := tree.Insert([]byte(path), &MountPoint{
+	mount := &MountPoint{
 		Path:   path,
 		Plugin: plugin,
 		Config: make(map[string]interface{}),
-	})
+	}
+	newTree, _, _ := tree.Insert([]byte(path), mount)
 
 	// Atomically update tree
 	mfs.mountTree.Store(newTree)
 
+	mfs.watchMount(mount)
+	mfs.changes.Record(path, ChangeKindTree)
+
 	return nil
 }
 
@@ -246,15 +254,19 @@ func (mfs *MountableFS) MountPlugin(fstype string, path string, config map[strin
 	}
 
 	// Create new tree with added mount
-	newTree, _, _ := tree.Insert([]byte(path), &MountPoint{
+	mount := &MountPoint{
 		Path:   path,
 		Plugin: pluginInstance,
 		Config: config,
-	})
+	}
+	newTree, _, _ := tree.Insert([]byte(path), mount)
 
 	// Atomically update tree
 	mfs.mountTree.Store(newTree)
 
+	mfs.watchMount(mount)
+	mfs.changes.Record(path, ChangeKindTree)
+
 	log.Infof("mounted %s at %s", fstype, path)
 	return nil
 }
@@ -285,6 +297,7 @@ func (mfs *MountableFS) Unmount(path string) error {
 
 	// Atomically update tree
 	mfs.mountTree.Store(newTree)
+	mfs.changes.Record(path, ChangeKindTree)
 
 	log.Infof("Unmounted plugin at %s", path)
 	return nil
@@ -425,6 +438,22 @@ func (mfs *MountableFS) GetMounts() []*MountPoint {
 	return mounts
 }
 
+// GetPluginStats returns the instance pool statistics and plugin metrics of
+// the mounted WASM plugins, keyed by mount path
+func (mfs *MountableFS) GetPluginStats() interface{} {
+	stats := make(map[string]api.WASMRuntimeStats)
+	for _, mount := range mfs.GetMounts() {
+		p := mount.Plugin
+		if renamed, ok := p.(*RenamedPlugin); ok {
+			p = renamed.ServicePlugin
+		}
+		if wasmPlugin, ok := p.(*api.WASMPlugin); ok {
+			stats[mount.Path] = wasmPlugin.GetRuntimeStats()
+		}
+	}
+	return stats
+}
+
 // findMount finds the mount point for a given path using lock-free radix tree lookup
 // Returns the mount and the relative path within the mount
 func (mfs *MountableFS) findMount(path string) (*MountPoint, string, bool) {
@@ -478,7 +507,7 @@ func (mfs *MountableFS) Create(path string) error {
 	mount, relPath, found := mfs.findMount(resolved)
 
 	if found {
-		return mount.Plugin.GetFileSystem().Create(relPath)
+		return mfs.recordChange(mount.Plugin.GetFileSystem().Create(relPath), path, filesystem.ChangeCreated)
 	}
 	return filesystem.NewPermissionDeniedError("create", path, "not allowed to create file in rootfs, use mount instead")
 }
@@ -493,7 +522,7 @@ func (mfs *MountableFS) Mkdir(path string, perm uint32) error {
 	mount, relPath, found := mfs.findMount(resolved)
 
 	if found {
-		return mount.Plugin.GetFileSystem().Mkdir(relPath, perm)
+		return mfs.recordChange(mount.Plugin.GetFileSystem().Mkdir(relPath, perm), path, filesystem.ChangeCreated)
 	}
 	return filesystem.NewPermissionDeniedError("mkdir", path, "not allowed to create directory in rootfs, use mount instead")
 }
@@ -506,7 +535,7 @@ func (mfs *MountableFS) Remove(path string) error {
 		delete(mfs.symlinks, path)
 		mfs.symlinksMu.Unlock()
 		log.Infof("Removed symlink: %s", path)
-		return nil
+		return mfs.recordChange(nil, path, filesystem.ChangeRemoved)
 	}
 	mfs.symlinksMu.Unlock()
 
@@ -519,7 +548,7 @@ func (mfs *MountableFS) Remove(path string) error {
 	mount, relPath, found := mfs.findMount(resolved)
 
 	if found {
-		return mount.Plugin.GetFileSystem().Remove(relPath)
+		return mfs.recordChange(mount.Plugin.GetFileSystem().Remove(relPath), path, filesystem.ChangeRemoved)
 	}
 	return filesystem.NewNotFoundError("remove", path)
 }
@@ -528,7 +557,7 @@ func (mfs *MountableFS) RemoveAll(path string) error {
 	mount, relPath, found := mfs.findMount(path)
 
 	if found {
-		return mount.Plugin.GetFileSystem().RemoveAll(relPath)
+		return mfs.recordChange(mount.Plugin.GetFileSystem().RemoveAll(relPath), path, filesystem.ChangeRemoved)
 	}
 	return filesystem.NewNotFoundError("removeall", path)
 }
@@ -558,7 +587,8 @@ func (mfs *MountableFS) Write(path string, data []byte, offset int64, flags file
 	mount, relPath, found := mfs.findMount(resolved)
 
 	if found {
-		return mount.Plugin.GetFileSystem().Write(relPath, data, offset, flags)
+		n, err := mount.Plugin.GetFileSystem().Write(relPath, data, offset, flags)
+		return n, mfs.recordChange(err, path, filesystem.ChangeModified)
 	}
 	return 0, filesystem.NewNotFoundError("write", path)
 }
@@ -885,7 +915,11 @@ func (mfs *MountableFS) Rename(oldPath, newPath string) error {
 		if oldMount != newMount {
 			return fmt.Errorf("cannot rename across different mounts")
 		}
-		return oldMount.Plugin.GetFileSystem().Rename(oldRelPath, newRelPath)
+		if err := oldMount.Plugin.GetFileSystem().Rename(oldRelPath, newRelPath); err != nil {
+			return err
+		}
+		mfs.recordChange(nil, oldPath, filesystem.ChangeRemoved)
+		return mfs.recordChange(nil, newPath, filesystem.ChangeCreated)
 	}
 
 	return fmt.Errorf("cannot rename: paths not in same mounted filesystem")
@@ -901,7 +935,7 @@ func (mfs *MountableFS) Chmod(path string, mode uint32) error {
 	mount, relPath, found := mfs.findMount(resolved)
 
 	if found {
-		return mount.Plugin.GetFileSystem().Chmod(relPath, mode)
+		return mfs.recordChange(mount.Plugin.GetFileSystem().Chmod(relPath, mode), path, filesystem.ChangeAttrib)
 	}
 	return filesystem.NewNotFoundError("chmod", path)
 }
@@ -916,13 +950,39 @@ func (mfs *MountableFS) Truncate(path string, size int64) error {
 
 	fs := mount.Plugin.GetFileSystem()
 	if truncater, ok := fs.(filesystem.Truncater); ok {
-		return truncater.Truncate(relPath, size)
+		return mfs.recordChange(truncater.Truncate(relPath, size), path, filesystem.ChangeModified)
 	}
 	return fmt.Errorf("filesystem does not support truncate: %s", path)
 }
 
+// ReadV implements filesystem.VectorReader, reading one Read per range
+// from mounts that do not implement it themselves
+func (mfs *MountableFS) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	// Resolve symlinks in all path components
+	resolved, err := mfs.resolvePath(path)
+	if err != nil {
+		return nil, err
+	}
+
+	mount, relPath, found := mfs.findMount(resolved)
+
+	if !found {
+		return nil, filesystem.NewNotFoundError("readv", path)
+	}
+
+	fs := mount.Plugin.GetFileSystem()
+	if reader, ok := fs.(filesystem.VectorReader); ok {
+		return reader.ReadV(relPath, ranges)
+	}
+	return filesystem.NewBaseFileSystem(fs).ReadV(relPath, ranges)
+}
+
 // Touch implements filesystem.Toucher interface
 func (mfs *MountableFS) Touch(path string) error {
+	return mfs.recordChange(mfs.touch(path), path, filesystem.ChangeModified)
+}
+
+func (mfs *MountableFS) touch(path string) error {
 	mount, relPath, found := mfs.findMount(path)
 
 	if found {
@@ -1103,6 +1163,11 @@ func (mfs *MountableFS) CloseHandle(id int64) error {
 		mfs.handleInfosMu.Lock()
 		delete(mfs.handleInfos, id)
 		mfs.handleInfosMu.Unlock()
+
+		// Handle writes are logged once, when the handle is closed
+		if info.localHandle.Flags()&(filesystem.O_WRONLY|filesystem.O_RDWR) != 0 {
+			mfs.changes.Record(joinMountPath(info.mount.Path, info.localHandle.Path()), filesystem.ChangeModified.String())
+		}
 	}
 
 	return err
@@ -1292,7 +1357,7 @@ func (mfs *MountableFS) Symlink(targetPath, linkPath string) error {
 	mfs.symlinksMu.Unlock()
 
 	log.Infof("Created symlink: %s -> %s", linkPath, targetPath)
-	return nil
+	return mfs.recordChange(nil, linkPath, filesystem.ChangeCreated)
 }
 
 // Readlink implements filesystem.Symlinker interface
@@ -1363,3 +1428,6 @@ var _ filesystem.FileHandle = (*globalFileHandle)(nil)
 
 // Ensure MountableFS implements Truncater interface
 var _ filesystem.Truncater = (*MountableFS)(nil)
+
+// Ensure MountableFS implements VectorReader interface
+var _ filesystem.VectorReader = (*MountableFS)(nil)
@@ -693,6 +693,35 @@ func TestSymlinkCrossMount(t *testing.T) {
 	}
 }
 
+func TestSymlinkReadV(t *testing.T) {
+	mfs := NewMountableFS(api.PoolConfig{})
+
+	plugin1 := NewMockServicePlugin("plugin1")
+	plugin2 := NewMockServicePlugin("plugin2")
+	if err := mfs.Mount("/mnt1", plugin1); err != nil {
+		t.Fatalf("Failed to mount plugin1: %v", err)
+	}
+	if err := mfs.Mount("/mnt2", plugin2); err != nil {
+		t.Fatalf("Failed to mount plugin2: %v", err)
+	}
+
+	_, err := plugin1.fs.Write("/file.txt", []byte("0123456789"), 0, filesystem.WriteFlagCreate)
+	if err != nil {
+		t.Fatalf("Failed to create file in plugin1: %v", err)
+	}
+	if err := mfs.Symlink("/mnt1/file.txt", "/mnt2/link"); err != nil {
+		t.Fatalf("Failed to create cross-mount symlink: %v", err)
+	}
+
+	parts, err := mfs.ReadV("/mnt2/link", []filesystem.ReadRange{{Offset: 0, Size: 2}, {Offset: 7, Size: 3}})
+	if err != nil {
+		t.Fatalf("Failed to readv through symlink: %v", err)
+	}
+	if len(parts) != 2 || string(parts[0]) != "01" || string(parts[1]) != "789" {
+		t.Errorf("Unexpected ranges %q", parts)
+	}
+}
+
 func TestSymlinkVisibility(t *testing.T) {
 	mfs := NewMountableFS(api.PoolConfig{})
 
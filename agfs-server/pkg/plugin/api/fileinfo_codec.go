@@ -0,0 +1,252 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"encoding/json"
+	"fmt"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// ABI capabilities advertised by a plugin through the plugin_abi_caps export
+const (
+	// ABICapBinaryFileInfo: plugin exports fs_stat_bin / fs_readdir_bin
+	ABICapBinaryFileInfo uint32 = 1 << 0
+	// ABICapReadDirPage: fs_readdir_page produces entries lazily, so ReadDir should page
+	ABICapReadDirPage uint32 = 1 << 1
+	// ABICapErrorCodes: fs_* / handle_* error slots carry an error code, or a
+	// string starting with one, instead of a bare message (see pluginError)
+	ABICapErrorCodes uint32 = 1 << 2
+)
+
+// Binary FileInfo layout (little-endian, version 1)
+//
+//	header: u32 total_len (including header), u16 version, u16 reserved, u32 count
+//	entry:  i64 size, i64 mod_time (unix seconds, 0 = unset), u32 mode,
+//	        u8 is_dir, u8 flags, u16 name_len, name
+//	        if flags&1: u16 meta_name_len, meta_name, u16 meta_type_len, meta_type,
+//	                    u32 meta_content_len, meta_content (JSON object)
+const (
+	fileInfoBinaryVersion    = 1
+	fileInfoBinaryHeaderSize = 12
+	fileInfoEntryFixedSize   = 8 + 8 + 4 + 1 + 1 + 2
+	fileInfoFlagHasMeta      = 1 << 0
+)
+
+// queryABICapabilities calls the optional plugin_abi_caps export
+func queryABICapabilities(module wazeroapi.Module, ctx context.Context) uint32 {
+	capsFunc := module.ExportedFunction("plugin_abi_caps")
+	if capsFunc == nil {
+		return 0
+	}
+	results, err := capsFunc.Call(ctx)
+	if err != nil || len(results) == 0 {
+		log.Warnf("Failed to query plugin ABI capabilities: %v", err)
+		return 0
+	}
+	return uint32(results[0])
+}
+
+func hasMeta(meta *filesystem.MetaData) bool {
+	return meta.Name != "" || meta.Type != "" || len(meta.Content) > 0
+}
+
+// encodeFileInfos serializes infos in the binary FileInfo layout
+func encodeFileInfos(infos []filesystem.FileInfo) []byte {
+	size := fileInfoBinaryHeaderSize
+	metaContents := make([][]byte, len(infos))
+	for i := range infos {
+		size += fileInfoEntryFixedSize + len(infos[i].Name)
+		if hasMeta(&infos[i].Meta) {
+			content, err := json.Marshal(infos[i].Meta.Content)
+			if err != nil || infos[i].Meta.Content == nil {
+				content = []byte("{}")
+			}
+			metaContents[i] = content
+			size += 2 + len(infos[i].Meta.Name) + 2 + len(infos[i].Meta.Type) + 4 + len(content)
+		}
+	}
+
+	buf := make([]byte, size)
+	le := binary.LittleEndian
+	le.PutUint32(buf[0:], uint32(size))
+	le.PutUint16(buf[4:], fileInfoBinaryVersion)
+	le.PutUint32(buf[8:], uint32(len(infos)))
+
+	off := fileInfoBinaryHeaderSize
+	for i := range infos {
+		info := &infos[i]
+		var modTime int64
+		if !info.ModTime.IsZero() {
+			modTime = info.ModTime.Unix()
+		}
+		le.PutUint64(buf[off:], uint64(info.Size))
+		le.PutUint64(buf[off+8:], uint64(modTime))
+		le.PutUint32(buf[off+16:], info.Mode)
+		if info.IsDir {
+			buf[off+20] = 1
+		}
+		if metaContents[i] != nil {
+			buf[off+21] = fileInfoFlagHasMeta
+		}
+		le.PutUint16(buf[off+22:], uint16(len(info.Name)))
+		off += fileInfoEntryFixedSize
+		off += copy(buf[off:], info.Name)
+
+		if metaContents[i] != nil {
+			le.PutUint16(buf[off:], uint16(len(info.Meta.Name)))
+			off += 2
+			off += copy(buf[off:], info.Meta.Name)
+			le.PutUint16(buf[off:], uint16(len(info.Meta.Type)))
+			off += 2
+			off += copy(buf[off:], info.Meta.Type)
+			le.PutUint32(buf[off:], uint32(len(metaContents[i])))
+			off += 4
+			off += copy(buf[off:], metaContents[i])
+		}
+	}
+	return buf
+}
+
+// decodeFileInfos parses a buffer in the binary FileInfo layout
+func decodeFileInfos(data []byte) ([]filesystem.FileInfo, error) {
+	le := binary.LittleEndian
+	if len(data) < fileInfoBinaryHeaderSize {
+		return nil, fmt.Errorf("binary fileinfo: short header")
+	}
+	total := le.Uint32(data[0:])
+	if version := le.Uint16(data[4:]); version != fileInfoBinaryVersion {
+		return nil, fmt.Errorf("binary fileinfo: unsupported version %d", version)
+	}
+	if uint64(total) > uint64(len(data)) {
+		return nil, fmt.Errorf("binary fileinfo: truncated buffer")
+	}
+	data = data[:total]
+	count := le.Uint32(data[8:])
+
+	// Each entry takes at least fileInfoEntryFixedSize bytes, so a corrupt
+	// count cannot force a huge allocation
+	if uint64(count)*fileInfoEntryFixedSize > uint64(len(data)) {
+		return nil, fmt.Errorf("binary fileinfo: invalid entry count %d", count)
+	}
+	infos := make([]filesystem.FileInfo, count)
+
+	off := fileInfoBinaryHeaderSize
+	readString := func(n int) (string, bool) {
+		if off+n > len(data) {
+			return "", false
+		}
+		s := string(data[off : off+n])
+		off += n
+		return s, true
+	}
+
+	for i := range infos {
+		if off+fileInfoEntryFixedSize > len(data) {
+			return nil, fmt.Errorf("binary fileinfo: truncated entry %d", i)
+		}
+		info := &infos[i]
+		info.Size = int64(le.Uint64(data[off:]))
+		if modTime := int64(le.Uint64(data[off+8:])); modTime != 0 {
+			info.ModTime = time.Unix(modTime, 0)
+		}
+		info.Mode = le.Uint32(data[off+16:])
+		info.IsDir = data[off+20] != 0
+		flags := data[off+21]
+		nameLen := int(le.Uint16(data[off+22:]))
+		off += fileInfoEntryFixedSize
+
+		var ok bool
+		if info.Name, ok = readString(nameLen); !ok {
+			return nil, fmt.Errorf("binary fileinfo: truncated name in entry %d", i)
+		}
+
+		if flags&fileInfoFlagHasMeta == 0 {
+			continue
+		}
+		if off+2 > len(data) {
+			return nil, fmt.Errorf("binary fileinfo: truncated meta in entry %d", i)
+		}
+		n := int(le.Uint16(data[off:]))
+		off += 2
+		if info.Meta.Name, ok = readString(n); !ok || off+2 > len(data) {
+			return nil, fmt.Errorf("binary fileinfo: truncated meta in entry %d", i)
+		}
+		n = int(le.Uint16(data[off:]))
+		off += 2
+		if info.Meta.Type, ok = readString(n); !ok || off+4 > len(data) {
+			return nil, fmt.Errorf("binary fileinfo: truncated meta in entry %d", i)
+		}
+		n = int(le.Uint32(data[off:]))
+		off += 4
+		if off+n > len(data) {
+			return nil, fmt.Errorf("binary fileinfo: truncated meta in entry %d", i)
+		}
+		// Content is free-form JSON on the plugin side; keep only string values
+		var content map[string]interface{}
+		if err := json.Unmarshal(data[off:off+n], &content); err == nil && len(content) > 0 {
+			info.Meta.Content = make(map[string]string, len(content))
+			for k, v := range content {
+				if s, isStr := v.(string); isStr {
+					info.Meta.Content[k] = s
+				} else if b, err := json.Marshal(v); err == nil {
+					info.Meta.Content[k] = string(b)
+				}
+			}
+		}
+		off += n
+	}
+
+	return infos, nil
+}
+
+// readBinaryFromMemory copies a length-prefixed binary FileInfo buffer out of WASM memory
+func readBinaryFromMemory(module wazeroapi.Module, ptr uint32) ([]byte, bool) {
+	header, ok := module.Memory().Read(ptr, fileInfoBinaryHeaderSize)
+	if !ok {
+		return nil, false
+	}
+	total := binary.LittleEndian.Uint32(header)
+	if total < fileInfoBinaryHeaderSize {
+		return nil, false
+	}
+	view, ok := module.Memory().Read(ptr, total)
+	if !ok {
+		return nil, false
+	}
+	data := make([]byte, total)
+	copy(data, view)
+	return data, true
+}
+
+// readDirPageFromMemory decodes an fs_readdir_page result
+// The page is a binary FileInfo block followed by a u32 length-prefixed cursor
+func readDirPageFromMemory(module wazeroapi.Module, ptr uint32) ([]filesystem.FileInfo, string, error) {
+	data, ok := readBinaryFromMemory(module, ptr)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page")
+	}
+	infos, err := decodeFileInfos(data)
+	if err != nil {
+		return nil, "", err
+	}
+
+	cursorPtr := ptr + uint32(len(data))
+	lenBytes, ok := module.Memory().Read(cursorPtr, 4)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page cursor")
+	}
+	cursorLen := binary.LittleEndian.Uint32(lenBytes)
+	if cursorLen == 0 {
+		return infos, "", nil
+	}
+	cursor, ok := module.Memory().Read(cursorPtr+4, cursorLen)
+	if !ok {
+		return nil, "", fmt.Errorf("failed to read readdir page cursor")
+	}
+	return infos, string(cursor), nil
+}
@@ -0,0 +1,77 @@
+package api
+
+import (
+	"testing"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+func TestFileInfoBinaryRoundTrip(t *testing.T) {
+	infos := []filesystem.FileInfo{
+		{
+			Name:    "hello.txt",
+			Size:    12,
+			Mode:    0644,
+			ModTime: time.Unix(1700000000, 0),
+			Meta: filesystem.MetaData{
+				Name:    "memfs",
+				Type:    "file",
+				Content: map[string]string{"k": "v"},
+			},
+		},
+		{Name: "sub", Mode: 0755, IsDir: true},
+		{Name: "", Size: -1},
+	}
+
+	decoded, err := decodeFileInfos(encodeFileInfos(infos))
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if len(decoded) != len(infos) {
+		t.Fatalf("expected %d entries, got %d", len(infos), len(decoded))
+	}
+
+	for i := range infos {
+		want, got := infos[i], decoded[i]
+		if got.Name != want.Name || got.Size != want.Size || got.Mode != want.Mode || got.IsDir != want.IsDir {
+			t.Errorf("entry %d: expected %+v, got %+v", i, want, got)
+		}
+		if !got.ModTime.Equal(want.ModTime) {
+			t.Errorf("entry %d: expected ModTime %v, got %v", i, want.ModTime, got.ModTime)
+		}
+		if got.Meta.Name != want.Meta.Name || got.Meta.Type != want.Meta.Type || len(got.Meta.Content) != len(want.Meta.Content) {
+			t.Errorf("entry %d: expected Meta %+v, got %+v", i, want.Meta, got.Meta)
+		}
+		for k, v := range want.Meta.Content {
+			if got.Meta.Content[k] != v {
+				t.Errorf("entry %d: expected Meta.Content[%q] = %q, got %q", i, k, v, got.Meta.Content[k])
+			}
+		}
+	}
+}
+
+func TestFileInfoBinaryMalformed(t *testing.T) {
+	data := encodeFileInfos([]filesystem.FileInfo{{Name: "hello.txt", Size: 12}})
+
+	tests := []struct {
+		name string
+		data []byte
+	}{
+		{name: "Empty", data: nil},
+		{name: "Short header", data: data[:8]},
+		{name: "Truncated entry", data: data[:len(data)-3]},
+		{name: "Bad version", data: append([]byte{}, data...)},
+		{name: "Huge count", data: append([]byte{}, data...)},
+	}
+	tests[3].data[4] = 0xFF
+	tests[4].data[11] = 0x7F
+
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			if _, err := decodeFileInfos(tt.data); err == nil {
+				t.Errorf("expected error for %s", tt.name)
+			}
+		})
+	}
+}
@@ -3,6 +3,7 @@ package api
 import (
 	"context"
 	"encoding/json"
+	"io"
 
 	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
 	log "github.com/sirupsen/logrus"
@@ -11,6 +12,15 @@ import (
 
 // Host function implementations for filesystem operations
 // These functions are exported to WASM modules and allow them to access the host filesystem
+//
+// Strings and buffers returned to the plugin are allocated with the module's
+// malloc export; the plugin owns them and frees them after use.
+
+// hostFSPathError returns an error pointer for a path that could not be read from memory
+func hostFSPathError(mod wazeroapi.Module) []uint64 {
+	errPtr, _, _ := writeStringToMemory(mod, "failed to read path from memory")
+	return []uint64{uint64(errPtr)}
+}
 
 func HostFSRead(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
 	pathPtr := uint32(params[0])
@@ -31,8 +41,9 @@ func HostFSRead(ctx context.Context, mod wazeroapi.Module, params []uint64, fs f
 		return []uint64{0}
 	}
 
+	// io.EOF only means the read reached the end of the file
 	data, err := fs.Read(path, offset, size)
-	if err != nil {
+	if err != nil && err != io.EOF {
 		log.Errorf("host_fs_read: error reading file: %v", err)
 		return []uint64{0}
 	}
@@ -85,6 +96,92 @@ func HostFSWrite(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	return []uint64{uint64(bytesWritten)}
 }
 
+// HostFSWriteAt writes data at offset with the given filesystem.WriteFlag
+// Returns packed u64: high 32 bits = bytes written, low 32 bits = error pointer (0 = success)
+func HostFSWriteAt(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+	dataPtr := uint32(params[1])
+	dataLen := uint32(params[2])
+	offset := int64(params[3])
+	flags := filesystem.WriteFlag(uint32(params[4]))
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_write_at: failed to read path from memory")
+		return hostFSPathError(mod)
+	}
+
+	data, ok := mod.Memory().Read(dataPtr, dataLen)
+	if !ok {
+		log.Errorf("host_fs_write_at: failed to read data from memory")
+		errPtr, _, _ := writeStringToMemory(mod, "failed to read data from memory")
+		return []uint64{uint64(errPtr)}
+	}
+
+	log.Debugf("host_fs_write_at: path=%s, dataLen=%d, offset=%d, flags=%d", path, dataLen, offset, flags)
+
+	if fs == nil {
+		log.Errorf("host_fs_write_at: no host filesystem provided")
+		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr)}
+	}
+
+	bytesWritten, err := fs.Write(path, data, offset, flags)
+	if err != nil {
+		log.Errorf("host_fs_write_at: error writing file: %v", err)
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
+		return []uint64{uint64(errPtr)}
+	}
+
+	return []uint64{uint64(uint32(bytesWritten)) << 32}
+}
+
+// HostFSReadInto reads up to capacity bytes at offset into a buffer owned by the plugin
+// Nothing is allocated in WASM memory on success
+// Returns packed u64: low 32 bits = bytes read, high 32 bits = error pointer (0 = success)
+func HostFSReadInto(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+	offset := int64(params[1])
+	dstPtr := uint32(params[2])
+	capacity := uint32(params[3])
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_read_into: failed to read path from memory")
+		errPtr, _, _ := writeStringToMemory(mod, "failed to read path from memory")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	log.Debugf("host_fs_read_into: path=%s, offset=%d, cap=%d", path, offset, capacity)
+
+	if fs == nil {
+		log.Errorf("host_fs_read_into: no host filesystem provided")
+		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr) << 32}
+	}
+	if capacity == 0 {
+		return []uint64{0}
+	}
+
+	data, err := fs.Read(path, offset, int64(capacity))
+	if err != nil && err != io.EOF {
+		log.Errorf("host_fs_read_into: error reading file: %v", err)
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
+		return []uint64{uint64(errPtr) << 32}
+	}
+	if uint32(len(data)) > capacity {
+		data = data[:capacity]
+	}
+
+	if !mod.Memory().Write(dstPtr, data) {
+		log.Errorf("host_fs_read_into: destination buffer out of range")
+		errPtr, _, _ := writeStringToMemory(mod, "destination buffer out of range")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	return []uint64{uint64(len(data))}
+}
+
 func HostFSStat(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
 	pathPtr := uint32(params[0])
 
@@ -106,8 +203,7 @@ func HostFSStat(ctx context.Context, mod wazeroapi.Module, params []uint64, fs f
 	if err != nil {
 		log.Errorf("host_fs_stat: error stating file: %v", err)
 		// Pack error: upper 32 bits = error pointer
-		errStr := err.Error()
-		errPtr, _, err := writeStringToMemory(mod, errStr)
+		errPtr, _, err := writeStringToMemory(mod, hostErrorString(err))
 		if err != nil {
 			return []uint64{0}
 		}
@@ -151,8 +247,7 @@ func HostFSReadDir(ctx context.Context, mod wazeroapi.Module, params []uint64, f
 	fileInfos, err := fs.ReadDir(path)
 	if err != nil {
 		log.Errorf("host_fs_readdir: error reading directory: %v", err)
-		errStr := err.Error()
-		errPtr, _, err := writeStringToMemory(mod, errStr)
+		errPtr, _, err := writeStringToMemory(mod, hostErrorString(err))
 		if err != nil {
 			return []uint64{0}
 		}
@@ -175,12 +270,85 @@ func HostFSReadDir(ctx context.Context, mod wazeroapi.Module, params []uint64, f
 	return []uint64{uint64(jsonPtr)}
 }
 
+// hostFSWriteFileInfoBinary writes infos in the binary FileInfo layout and packs the result
+// Lower 32 bits = buffer pointer, upper 32 bits = error pointer
+func hostFSWriteFileInfoBinary(mod wazeroapi.Module, name string, infos []filesystem.FileInfo) []uint64 {
+	bufPtr, _, err := writeBytesToMemory(mod, encodeFileInfos(infos))
+	if err != nil {
+		log.Errorf("%s: failed to write result to memory: %v", name, err)
+		return []uint64{0}
+	}
+	return []uint64{uint64(bufPtr)}
+}
+
+// HostFSStatBinary is host_fs_stat with a binary FileInfo result (see fileinfo_codec.go)
+func HostFSStatBinary(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_stat_bin: failed to read path from memory")
+		return []uint64{0}
+	}
+
+	log.Debugf("host_fs_stat_bin: path=%s", path)
+
+	if fs == nil {
+		log.Errorf("host_fs_stat_bin: no host filesystem provided")
+		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	fileInfo, err := fs.Stat(path)
+	if err != nil {
+		log.Errorf("host_fs_stat_bin: error stating file: %v", err)
+		errPtr, _, err := writeStringToMemory(mod, hostErrorString(err))
+		if err != nil {
+			return []uint64{0}
+		}
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	return hostFSWriteFileInfoBinary(mod, "host_fs_stat_bin", []filesystem.FileInfo{*fileInfo})
+}
+
+// HostFSReadDirBinary is host_fs_readdir with a binary FileInfo result (see fileinfo_codec.go)
+func HostFSReadDirBinary(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	pathPtr := uint32(params[0])
+
+	path, ok := readStringFromMemory(mod, pathPtr)
+	if !ok {
+		log.Errorf("host_fs_readdir_bin: failed to read path from memory")
+		return []uint64{0}
+	}
+
+	log.Debugf("host_fs_readdir_bin: path=%s", path)
+
+	if fs == nil {
+		log.Errorf("host_fs_readdir_bin: no host filesystem provided")
+		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	fileInfos, err := fs.ReadDir(path)
+	if err != nil {
+		log.Errorf("host_fs_readdir_bin: error reading directory: %v", err)
+		errPtr, _, err := writeStringToMemory(mod, hostErrorString(err))
+		if err != nil {
+			return []uint64{0}
+		}
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	return hostFSWriteFileInfoBinary(mod, "host_fs_readdir_bin", fileInfos)
+}
+
 func HostFSCreate(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
 	pathPtr := uint32(params[0])
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1} // Error
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_create: path=%s", path)
@@ -194,7 +362,7 @@ func HostFSCreate(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	err := fs.Create(path)
 	if err != nil {
 		log.Errorf("host_fs_create: error creating file: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -207,7 +375,7 @@ func HostFSMkdir(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_mkdir: path=%s, perm=%o", path, perm)
@@ -221,7 +389,7 @@ func HostFSMkdir(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	err := fs.Mkdir(path, perm)
 	if err != nil {
 		log.Errorf("host_fs_mkdir: error creating directory: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -233,7 +401,7 @@ func HostFSRemove(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_remove: path=%s", path)
@@ -247,7 +415,7 @@ func HostFSRemove(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	err := fs.Remove(path)
 	if err != nil {
 		log.Errorf("host_fs_remove: error removing: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -259,7 +427,7 @@ func HostFSRemoveAll(ctx context.Context, mod wazeroapi.Module, params []uint64,
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_remove_all: path=%s", path)
@@ -273,7 +441,7 @@ func HostFSRemoveAll(ctx context.Context, mod wazeroapi.Module, params []uint64,
 	err := fs.RemoveAll(path)
 	if err != nil {
 		log.Errorf("host_fs_remove_all: error removing: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -286,12 +454,12 @@ func HostFSRename(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	oldPath, ok := readStringFromMemory(mod, oldPathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	newPath, ok := readStringFromMemory(mod, newPathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_rename: oldPath=%s, newPath=%s", oldPath, newPath)
@@ -305,7 +473,7 @@ func HostFSRename(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	err := fs.Rename(oldPath, newPath)
 	if err != nil {
 		log.Errorf("host_fs_rename: error renaming: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -318,7 +486,7 @@ func HostFSChmod(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 
 	path, ok := readStringFromMemory(mod, pathPtr)
 	if !ok {
-		return []uint64{1}
+		return hostFSPathError(mod)
 	}
 
 	log.Debugf("host_fs_chmod: path=%s, mode=%o", path, mode)
@@ -332,7 +500,7 @@ func HostFSChmod(ctx context.Context, mod wazeroapi.Module, params []uint64, fs
 	err := fs.Chmod(path, mode)
 	if err != nil {
 		log.Errorf("host_fs_chmod: error changing mode: %v", err)
-		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		errPtr, _, _ := writeStringToMemory(mod, hostErrorString(err))
 		return []uint64{uint64(errPtr)}
 	}
 
@@ -0,0 +1,221 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"fmt"
+	"io"
+	"sync"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Batched host filesystem calls (host_fs_batch)
+//
+// A plugin queues stat/read/readdir operations and submits them in one host
+// call; the host runs them concurrently and returns all results at once.
+//
+// Request (little-endian, version 1):
+//
+//	header: u32 total_len, u16 version, u16 reserved, u32 op_count
+//	op:     u8 kind, u8 reserved[3], i64 offset, i64 size, u32 path_len, path
+//
+// Response:
+//
+//	header: u32 total_len, u16 version, u16 reserved, u32 result_count
+//	result: u8 kind, u8 status (0 = ok, else PluginErrorKind + 1), u16 reserved,
+//	        u32 payload_len, payload
+//	        stat/readdir: binary FileInfo block (see fileinfo_codec.go)
+//	        read: raw bytes
+//	        error: message
+const (
+	batchOpStat    = 1
+	batchOpRead    = 2
+	batchOpReadDir = 3
+
+	batchVersion         = 1
+	batchHeaderSize      = 12
+	batchOpFixedSize     = 1 + 3 + 8 + 8 + 4
+	batchResultFixedSize = 1 + 1 + 2 + 4
+
+	// maxBatchWorkers bounds the goroutines used for one batch
+	maxBatchWorkers = 16
+)
+
+type batchOp struct {
+	kind   uint8
+	offset int64
+	size   int64
+	path   string
+}
+
+type batchResult struct {
+	kind    uint8
+	err     error
+	payload []byte
+}
+
+func decodeBatchRequest(data []byte) ([]batchOp, error) {
+	le := binary.LittleEndian
+	if len(data) < batchHeaderSize {
+		return nil, fmt.Errorf("batch: short header")
+	}
+	if version := le.Uint16(data[4:]); version != batchVersion {
+		return nil, fmt.Errorf("batch: unsupported version %d", version)
+	}
+	count := le.Uint32(data[8:])
+	if uint64(count)*batchOpFixedSize > uint64(len(data)) {
+		return nil, fmt.Errorf("batch: invalid op count %d", count)
+	}
+
+	ops := make([]batchOp, count)
+	off := batchHeaderSize
+	for i := range ops {
+		if off+batchOpFixedSize > len(data) {
+			return nil, fmt.Errorf("batch: truncated op %d", i)
+		}
+		ops[i].kind = data[off]
+		ops[i].offset = int64(le.Uint64(data[off+4:]))
+		ops[i].size = int64(le.Uint64(data[off+12:]))
+		pathLen := int(le.Uint32(data[off+20:]))
+		off += batchOpFixedSize
+		if off+pathLen > len(data) {
+			return nil, fmt.Errorf("batch: truncated path in op %d", i)
+		}
+		ops[i].path = string(data[off : off+pathLen])
+		off += pathLen
+	}
+	return ops, nil
+}
+
+func runBatchOp(fs filesystem.FileSystem, op batchOp) batchResult {
+	result := batchResult{kind: op.kind}
+	switch op.kind {
+	case batchOpStat:
+		info, err := fs.Stat(op.path)
+		if err != nil {
+			result.err = err
+			break
+		}
+		result.payload = encodeFileInfos([]filesystem.FileInfo{*info})
+	case batchOpRead:
+		data, err := fs.Read(op.path, op.offset, op.size)
+		if err != nil && err != io.EOF {
+			result.err = err
+			break
+		}
+		result.payload = data
+	case batchOpReadDir:
+		infos, err := fs.ReadDir(op.path)
+		if err != nil {
+			result.err = err
+			break
+		}
+		result.payload = encodeFileInfos(infos)
+	default:
+		result.err = fmt.Errorf("unknown batch op %d", op.kind)
+	}
+	return result
+}
+
+// runBatch executes ops concurrently; results are in request order
+func runBatch(fs filesystem.FileSystem, ops []batchOp) []batchResult {
+	results := make([]batchResult, len(ops))
+	if len(ops) == 1 {
+		results[0] = runBatchOp(fs, ops[0])
+		return results
+	}
+
+	workers := len(ops)
+	if workers > maxBatchWorkers {
+		workers = maxBatchWorkers
+	}
+
+	var wg sync.WaitGroup
+	next := make(chan int)
+	for w := 0; w < workers; w++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for i := range next {
+				results[i] = runBatchOp(fs, ops[i])
+			}
+		}()
+	}
+	for i := range ops {
+		next <- i
+	}
+	close(next)
+	wg.Wait()
+	return results
+}
+
+func encodeBatchResponse(results []batchResult) []byte {
+	size := batchHeaderSize
+	for i := range results {
+		size += batchResultFixedSize
+		if results[i].err != nil {
+			size += len(results[i].err.Error())
+		} else {
+			size += len(results[i].payload)
+		}
+	}
+
+	buf := make([]byte, size)
+	le := binary.LittleEndian
+	le.PutUint32(buf[0:], uint32(size))
+	le.PutUint16(buf[4:], batchVersion)
+	le.PutUint32(buf[8:], uint32(len(results)))
+
+	off := batchHeaderSize
+	for i := range results {
+		payload := results[i].payload
+		buf[off] = results[i].kind
+		if results[i].err != nil {
+			buf[off+1] = byte(hostErrorKind(results[i].err)) + 1
+			payload = []byte(results[i].err.Error())
+		}
+		le.PutUint32(buf[off+4:], uint32(len(payload)))
+		off += batchResultFixedSize
+		off += copy(buf[off:], payload)
+	}
+	return buf
+}
+
+// HostFSBatch runs a batch of stat/read/readdir operations in one host call
+// Returns packed u64: lower 32 bits = response pointer, upper 32 bits = error pointer
+func HostFSBatch(ctx context.Context, mod wazeroapi.Module, params []uint64, fs filesystem.FileSystem) []uint64 {
+	reqPtr := uint32(params[0])
+	reqLen := uint32(params[1])
+
+	if fs == nil {
+		log.Errorf("host_fs_batch: no host filesystem provided")
+		errPtr, _, _ := writeStringToMemory(mod, "no host filesystem provided")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	req, ok := mod.Memory().Read(reqPtr, reqLen)
+	if !ok {
+		log.Errorf("host_fs_batch: failed to read request from memory")
+		errPtr, _, _ := writeStringToMemory(mod, "failed to read batch request from memory")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	ops, err := decodeBatchRequest(req)
+	if err != nil {
+		log.Errorf("host_fs_batch: %v", err)
+		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	log.Debugf("host_fs_batch: %d ops", len(ops))
+
+	respPtr, _, err := writeBytesToMemory(mod, encodeBatchResponse(runBatch(fs, ops)))
+	if err != nil {
+		log.Errorf("host_fs_batch: failed to write response to memory: %v", err)
+		return []uint64{0}
+	}
+	return []uint64{uint64(respPtr)}
+}
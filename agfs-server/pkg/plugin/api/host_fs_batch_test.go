@@ -0,0 +1,139 @@
+package api
+
+import (
+	"encoding/binary"
+	"fmt"
+	"io"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+// batchTestFS serves Stat/Read/ReadDir from a map; other methods are not used by batches
+type batchTestFS struct {
+	filesystem.FileSystem
+	files map[string][]byte
+}
+
+func (fs *batchTestFS) Stat(path string) (*filesystem.FileInfo, error) {
+	data, ok := fs.files[path]
+	if !ok {
+		return nil, filesystem.NewNotFoundError("stat", path)
+	}
+	return &filesystem.FileInfo{Name: path[1:], Size: int64(len(data)), Mode: 0644}, nil
+}
+
+func (fs *batchTestFS) Read(path string, offset int64, size int64) ([]byte, error) {
+	data, ok := fs.files[path]
+	if !ok {
+		return nil, filesystem.NewNotFoundError("read", path)
+	}
+	end := int64(len(data))
+	if size >= 0 && offset+size < end {
+		return data[offset : offset+size], nil
+	}
+	return data[offset:], io.EOF
+}
+
+func (fs *batchTestFS) ReadDir(path string) ([]filesystem.FileInfo, error) {
+	var infos []filesystem.FileInfo
+	for name := range fs.files {
+		info, _ := fs.Stat(name)
+		infos = append(infos, *info)
+	}
+	return infos, nil
+}
+
+func encodeBatchRequest(ops []batchOp) []byte {
+	size := batchHeaderSize
+	for _, op := range ops {
+		size += batchOpFixedSize + len(op.path)
+	}
+	buf := make([]byte, size)
+	le := binary.LittleEndian
+	le.PutUint32(buf[0:], uint32(size))
+	le.PutUint16(buf[4:], batchVersion)
+	le.PutUint32(buf[8:], uint32(len(ops)))
+	off := batchHeaderSize
+	for _, op := range ops {
+		buf[off] = op.kind
+		le.PutUint64(buf[off+4:], uint64(op.offset))
+		le.PutUint64(buf[off+12:], uint64(op.size))
+		le.PutUint32(buf[off+20:], uint32(len(op.path)))
+		off += batchOpFixedSize
+		off += copy(buf[off:], op.path)
+	}
+	return buf
+}
+
+func TestHostFSBatch(t *testing.T) {
+	fs := &batchTestFS{files: map[string][]byte{}}
+	var ops []batchOp
+	for i := 0; i < 40; i++ {
+		path := fmt.Sprintf("/file%d", i)
+		fs.files[path] = []byte(fmt.Sprintf("content of %d", i))
+		ops = append(ops, batchOp{kind: batchOpStat, path: path})
+	}
+	ops = append(ops,
+		batchOp{kind: batchOpRead, path: "/file7", offset: 3, size: 4},
+		batchOp{kind: batchOpReadDir, path: "/"},
+		batchOp{kind: batchOpStat, path: "/missing"},
+	)
+
+	decoded, err := decodeBatchRequest(encodeBatchRequest(ops))
+	if err != nil {
+		t.Fatalf("decodeBatchRequest failed: %v", err)
+	}
+	if len(decoded) != len(ops) {
+		t.Fatalf("expected %d ops, got %d", len(ops), len(decoded))
+	}
+
+	resp := encodeBatchResponse(runBatch(fs, decoded))
+	le := binary.LittleEndian
+	if int(le.Uint32(resp[0:])) != len(resp) || int(le.Uint32(resp[8:])) != len(ops) {
+		t.Fatalf("bad response header")
+	}
+
+	off := batchHeaderSize
+	for i, op := range ops {
+		kind, status := resp[off], resp[off+1]
+		n := int(le.Uint32(resp[off+4:]))
+		payload := resp[off+batchResultFixedSize : off+batchResultFixedSize+n]
+		off += batchResultFixedSize + n
+
+		if kind != op.kind {
+			t.Fatalf("result %d: expected kind %d, got %d", i, op.kind, kind)
+		}
+		switch {
+		case op.path == "/missing":
+			if status != byte(PluginErrNotFound)+1 {
+				t.Errorf("result %d: expected not found status, got %d", i, status)
+			}
+		case op.kind == batchOpStat:
+			infos, err := decodeFileInfos(payload)
+			if status != 0 || err != nil || len(infos) != 1 || "/"+infos[0].Name != op.path {
+				t.Errorf("result %d: bad stat result %v %v", i, infos, err)
+			}
+		case op.kind == batchOpRead:
+			if status != 0 || string(payload) != "tent" {
+				t.Errorf("result %d: expected %q, got %q", i, "tent", payload)
+			}
+		case op.kind == batchOpReadDir:
+			infos, err := decodeFileInfos(payload)
+			if status != 0 || err != nil || len(infos) != 40 {
+				t.Errorf("result %d: expected 40 entries, got %d (%v)", i, len(infos), err)
+			}
+		}
+	}
+}
+
+func TestDecodeBatchRequestMalformed(t *testing.T) {
+	req := encodeBatchRequest([]batchOp{{kind: batchOpStat, path: "/a"}})
+	if _, err := decodeBatchRequest(req[:len(req)-1]); err == nil {
+		t.Error("expected error for truncated request")
+	}
+	req[4] = 9
+	if _, err := decodeBatchRequest(req); err == nil {
+		t.Error("expected error for bad version")
+	}
+}
@@ -1,17 +1,27 @@
 package api
 
 import (
+	"bytes"
 	"context"
+	"crypto/tls"
 	"encoding/json"
+	"fmt"
 	"io"
 	"net/http"
-	"strings"
+	"sync"
 	"time"
 
 	log "github.com/sirupsen/logrus"
 	wazeroapi "github.com/tetratelabs/wazero/api"
 )
 
+// HTTP/2 preference of an HTTPRequest
+const (
+	HTTP2Auto    = 0 // HTTP/2 when the server negotiates it over TLS
+	HTTP2Prefer  = 1 // Always attempt HTTP/2, even with custom TLS settings
+	HTTP2Disable = 2 // HTTP/1.1 only
+)
+
 // HTTPRequest represents an HTTP request from WASM
 type HTTPRequest struct {
 	Method  string            `json:"method"`
@@ -19,6 +29,17 @@ type HTTPRequest struct {
 	Headers map[string]string `json:"headers"`
 	Body    []byte            `json:"body"`
 	Timeout int               `json:"timeout"` // timeout in seconds
+
+	// PoolKey selects the connection pool; requests with the same key (and
+	// HTTP2 mode) reuse each other's idle connections. "" is the shared pool.
+	PoolKey          string `json:"pool_key,omitempty"`
+	HTTP2            int    `json:"http2,omitempty"`
+	DisableKeepAlive bool   `json:"disable_keep_alive,omitempty"`
+	// Conditional request validators; a 304 response has an empty body
+	IfNoneMatch     string `json:"if_none_match,omitempty"`
+	IfModifiedSince int64  `json:"if_modified_since,omitempty"` // unix seconds, 0 = unset
+	// MaxResponseBytes fails the request once the body exceeds it (0 = unlimited)
+	MaxResponseBytes int64 `json:"max_response_bytes,omitempty"`
 }
 
 // HTTPResponse represents an HTTP response to WASM
@@ -56,79 +77,201 @@ func HostHTTPRequest(ctx context.Context, mod wazeroapi.Module, params []uint64)
 		return packHTTPResponse(mod, &resp)
 	}
 
-	// Validate method
-	if req.Method == "" {
-		req.Method = "GET"
+	httpResp, err := performHTTPRequest(ctx, &req)
+	if err != nil {
+		log.Errorf("host_http_request: %v", err)
+		resp := HTTPResponse{
+			Error: err.Error(),
+		}
+		return packHTTPResponse(mod, &resp)
+	}
+	defer httpResp.Body.Close()
+
+	// Read response body
+	respBody, err := io.ReadAll(limitResponseBody(httpResp, req.MaxResponseBytes))
+	if err != nil {
+		log.Errorf("host_http_request: failed to read response body: %v", err)
+		resp := HTTPResponse{
+			StatusCode: httpResp.StatusCode,
+			Error:      "failed to read response body: " + err.Error(),
+		}
+		return packHTTPResponse(mod, &resp)
 	}
 
-	// Create HTTP client with timeout
+	// Create response
+	resp := HTTPResponse{
+		StatusCode: httpResp.StatusCode,
+		Headers:    responseHeaders(httpResp.Header),
+		Body:       respBody,
+	}
+
+	log.Debugf("host_http_request: status=%d, bodyLen=%d", resp.StatusCode, len(resp.Body))
+	return packHTTPResponse(mod, &resp)
+}
+
+// performHTTPRequest sends req; the caller must close the response body
+func performHTTPRequest(ctx context.Context, req *HTTPRequest) (*http.Response, error) {
+	httpReq, err := newHTTPRequest(ctx, req, nil)
+	if err != nil {
+		return nil, err
+	}
+
+	// Create HTTP client with timeout; the client is cheap, the pooled
+	// transport behind it keeps the connections
+	client := &http.Client{
+		Timeout:   requestTimeout(req),
+		Transport: httpTransportFor(req),
+	}
+
+	// Perform request
+	httpResp, err := client.Do(httpReq)
+	if err != nil {
+		return nil, fmt.Errorf("request failed: %w", err)
+	}
+	return httpResp, nil
+}
+
+// requestTimeout returns the timeout requested by req, defaulting to 30s
+func requestTimeout(req *HTTPRequest) time.Duration {
 	timeout := time.Duration(req.Timeout) * time.Second
 	if timeout == 0 {
 		timeout = 30 * time.Second // default 30s timeout
 	}
-	client := &http.Client{
-		Timeout: timeout,
+	return timeout
+}
+
+// newHTTPRequest builds the outgoing request for req
+// body overrides req.Body when non-nil
+func newHTTPRequest(ctx context.Context, req *HTTPRequest, body io.Reader) (*http.Request, error) {
+	// Validate method
+	if req.Method == "" {
+		req.Method = "GET"
 	}
 
 	// Create HTTP request
-	var bodyReader io.Reader
-	if len(req.Body) > 0 {
-		bodyReader = strings.NewReader(string(req.Body))
+	if body == nil && len(req.Body) > 0 {
+		body = bytes.NewReader(req.Body)
 	}
 
-	httpReq, err := http.NewRequestWithContext(ctx, req.Method, req.URL, bodyReader)
+	httpReq, err := http.NewRequestWithContext(ctx, req.Method, req.URL, body)
 	if err != nil {
-		log.Errorf("host_http_request: failed to create request: %v", err)
-		resp := HTTPResponse{
-			Error: "failed to create request: " + err.Error(),
-		}
-		return packHTTPResponse(mod, &resp)
+		return nil, fmt.Errorf("failed to create request: %w", err)
 	}
 
 	// Set headers
 	for key, value := range req.Headers {
 		httpReq.Header.Set(key, value)
 	}
+	if req.IfNoneMatch != "" {
+		httpReq.Header.Set("If-None-Match", req.IfNoneMatch)
+	}
+	if req.IfModifiedSince != 0 {
+		httpReq.Header.Set("If-Modified-Since", time.Unix(req.IfModifiedSince, 0).UTC().Format(http.TimeFormat))
+	}
+	httpReq.Close = req.DisableKeepAlive
+	return httpReq, nil
+}
 
-	// Perform request
-	httpResp, err := client.Do(httpReq)
-	if err != nil {
-		log.Errorf("host_http_request: request failed: %v", err)
-		resp := HTTPResponse{
-			Error: "request failed: " + err.Error(),
+// Connection pools shared by plugin HTTP requests, one per (pool key, HTTP/2 mode)
+const (
+	// maxHTTPTransports bounds the number of pools; further keys share the default one
+	maxHTTPTransports = 64
+	// idle connections kept per host, so repeated requests to one API skip the handshake
+	httpMaxIdleConnsPerHost = 32
+)
+
+type httpTransportKey struct {
+	pool  string
+	http2 int
+}
+
+var httpTransports = struct {
+	sync.Mutex
+	m map[httpTransportKey]*http.Transport
+}{m: make(map[httpTransportKey]*http.Transport)}
+
+// httpTransportFor returns the pooled transport for req
+func httpTransportFor(req *HTTPRequest) *http.Transport {
+	key := httpTransportKey{pool: req.PoolKey, http2: req.HTTP2}
+
+	httpTransports.Lock()
+	defer httpTransports.Unlock()
+	if t, ok := httpTransports.m[key]; ok {
+		return t
+	}
+	if len(httpTransports.m) >= maxHTTPTransports {
+		key.pool = ""
+		if t, ok := httpTransports.m[key]; ok {
+			return t
 		}
-		return packHTTPResponse(mod, &resp)
 	}
-	defer httpResp.Body.Close()
 
-	// Read response body
-	respBody, err := io.ReadAll(httpResp.Body)
-	if err != nil {
-		log.Errorf("host_http_request: failed to read response body: %v", err)
-		resp := HTTPResponse{
-			StatusCode: httpResp.StatusCode,
-			Error:      "failed to read response body: " + err.Error(),
-		}
-		return packHTTPResponse(mod, &resp)
+	t := http.DefaultTransport.(*http.Transport).Clone()
+	t.MaxIdleConnsPerHost = httpMaxIdleConnsPerHost
+	switch req.HTTP2 {
+	case HTTP2Prefer:
+		t.ForceAttemptHTTP2 = true
+	case HTTP2Disable:
+		t.ForceAttemptHTTP2 = false
+		// A non-nil empty map turns off HTTP/2 negotiation
+		t.TLSNextProto = make(map[string]func(string, *tls.Conn) http.RoundTripper)
 	}
+	httpTransports.m[key] = t
+	return t
+}
 
-	// Build response headers map
-	respHeaders := make(map[string]string)
-	for key, values := range httpResp.Header {
-		if len(values) > 0 {
-			respHeaders[key] = values[0] // Take first value
-		}
+// errResponseTooLarge is returned once a body exceeds MaxResponseBytes
+type errResponseTooLarge struct {
+	limit int64
+}
+
+func (e errResponseTooLarge) Error() string {
+	return fmt.Sprintf("response body exceeds %d bytes", e.limit)
+}
+
+// limitedBody fails, rather than truncates, past its limit
+type limitedBody struct {
+	r      io.Reader
+	remain int64
+	limit  int64
+}
+
+func (l *limitedBody) Read(p []byte) (int, error) {
+	if l.remain < 0 {
+		return 0, errResponseTooLarge{l.limit}
 	}
+	// Read one byte past the limit to tell "exactly limit" from "more"
+	if int64(len(p)) > l.remain+1 {
+		p = p[:l.remain+1]
+	}
+	n, err := l.r.Read(p)
+	l.remain -= int64(n)
+	if l.remain < 0 {
+		return n + int(l.remain), errResponseTooLarge{l.limit}
+	}
+	return n, err
+}
 
-	// Create response
-	resp := HTTPResponse{
-		StatusCode: httpResp.StatusCode,
-		Headers:    respHeaders,
-		Body:       respBody,
+// limitResponseBody applies a MaxResponseBytes cap to resp.Body
+func limitResponseBody(resp *http.Response, limit int64) io.Reader {
+	if limit <= 0 {
+		return resp.Body
+	}
+	if resp.ContentLength > limit {
+		return &limitedBody{remain: -1, limit: limit}
 	}
+	return &limitedBody{r: resp.Body, remain: limit, limit: limit}
+}
 
-	log.Debugf("host_http_request: status=%d, bodyLen=%d", resp.StatusCode, len(resp.Body))
-	return packHTTPResponse(mod, &resp)
+// responseHeaders flattens h to the first value of each header
+func responseHeaders(h http.Header) map[string]string {
+	respHeaders := make(map[string]string, len(h))
+	for key, values := range h {
+		if len(values) > 0 {
+			respHeaders[key] = values[0] // Take first value
+		}
+	}
+	return respHeaders
 }
 
 // packHTTPResponse serializes and writes HTTPResponse to WASM memory
@@ -0,0 +1,414 @@
+package api
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"fmt"
+	"io"
+	"net/http"
+	"reflect"
+	"sync"
+	"time"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Streaming HTTP requests (host_http_open / _write / _response / _read / _close)
+//
+// A stream is an HTTP request whose bodies move in chunks instead of whole
+// buffers. host_http_open describes the request with the host_http_request_v2
+// header block and starts it; with HTTPStreamUpload the request body is fed
+// by host_http_write calls until host_http_response. The response body is
+// pulled with host_http_read straight into plugin memory, so neither side
+// ever holds a whole object.
+//
+// Streams run concurrently in Go from the moment they are opened; a plugin
+// can open several and use host_http_wait_any to take them as they finish.
+const (
+	// HTTPStreamUpload: the request body is streamed with host_http_write
+	HTTPStreamUpload uint32 = 1 << 0
+
+	// maxHTTPStreams bounds the streams open at once across all plugins,
+	// so a plugin that never closes its streams cannot exhaust connections
+	maxHTTPStreams = 1024
+)
+
+type httpStream struct {
+	owner    wazeroapi.Module
+	timeout  time.Duration
+	maxBytes int64
+	cancel   context.CancelFunc
+	upload   *io.PipeWriter
+	uploadR  *io.PipeReader // Read by the transport; closed once Do returns
+
+	mu          sync.Mutex
+	timer       *time.Timer
+	headersDone bool
+
+	done chan struct{} // closed once resp or err is set
+	resp *http.Response
+	body io.Reader // resp.Body with the MaxResponseBytes cap
+	err  error
+}
+
+// armTimeout bounds the upload and the wait for response headers, from the
+// moment the stream is opened; the response body may take as long as the
+// plugin keeps reading
+func (s *httpStream) armTimeout() {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if s.timer == nil && !s.headersDone {
+		s.timer = time.AfterFunc(s.timeout, s.cancel)
+	}
+}
+
+// finish records the outcome of Do and disarms the header timeout
+func (s *httpStream) finish(resp *http.Response, err error) {
+	s.mu.Lock()
+	s.headersDone = true
+	if s.timer != nil {
+		s.timer.Stop()
+	}
+	s.mu.Unlock()
+
+	// Nothing reads the upload any more: fail pending and later writes
+	// instead of blocking them forever
+	if s.uploadR != nil {
+		if err != nil {
+			s.uploadR.CloseWithError(err)
+		} else {
+			s.uploadR.CloseWithError(fmt.Errorf("http stream already has its response"))
+		}
+	}
+
+	s.resp, s.err = resp, err
+	if resp != nil {
+		s.body = limitResponseBody(resp, s.maxBytes)
+	}
+	close(s.done)
+}
+
+func (s *httpStream) wait() (*http.Response, error) {
+	<-s.done
+	return s.resp, s.err
+}
+
+var httpStreams = struct {
+	sync.Mutex
+	next    uint32
+	streams map[uint32]*httpStream
+}{streams: make(map[uint32]*httpStream)}
+
+func lookupHTTPStream(mod wazeroapi.Module, id uint32) (*httpStream, error) {
+	httpStreams.Lock()
+	defer httpStreams.Unlock()
+	s, ok := httpStreams.streams[id]
+	if !ok || s.owner != mod {
+		return nil, fmt.Errorf("invalid http stream %d", id)
+	}
+	return s, nil
+}
+
+func registerHTTPStream(s *httpStream) (uint32, error) {
+	httpStreams.Lock()
+	defer httpStreams.Unlock()
+	if len(httpStreams.streams) >= maxHTTPStreams {
+		return 0, fmt.Errorf("too many open http streams")
+	}
+	for {
+		httpStreams.next++
+		if _, used := httpStreams.streams[httpStreams.next]; httpStreams.next != 0 && !used {
+			break
+		}
+	}
+	httpStreams.streams[httpStreams.next] = s
+	return httpStreams.next, nil
+}
+
+// closeModuleHTTPStreams closes every stream a module left open, so a
+// destroyed instance does not keep counting toward maxHTTPStreams
+func closeModuleHTTPStreams(mod wazeroapi.Module) {
+	var owned []*httpStream
+	httpStreams.Lock()
+	for id, s := range httpStreams.streams {
+		if s.owner == mod {
+			owned = append(owned, s)
+			delete(httpStreams.streams, id)
+		}
+	}
+	httpStreams.Unlock()
+
+	for _, s := range owned {
+		closeHTTPStream(s)
+	}
+}
+
+// closeHTTPStream aborts the request and releases its connection
+func closeHTTPStream(s *httpStream) {
+	s.cancel()
+	if s.upload != nil {
+		s.upload.CloseWithError(fmt.Errorf("http stream closed"))
+	}
+	go func() {
+		if resp, _ := s.wait(); resp != nil {
+			resp.Body.Close()
+		}
+	}()
+}
+
+// HostHTTPOpen starts a streaming HTTP request
+// Parameters:
+//   - params[0], params[1]: request header block pointer and length (host_http_request_v2 format)
+//   - params[2], params[3]: request body pointer and length (the first chunk when uploading)
+//   - params[4]: flags (HTTPStreamUpload)
+//
+// Returns: packed u64 (lower 32 bits = stream id, upper 32 bits = error pointer)
+func HostHTTPOpen(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	headerPtr := uint32(params[0])
+	headerLen := uint32(params[1])
+	bodyPtr := uint32(params[2])
+	bodyLen := uint32(params[3])
+	flags := uint32(params[4])
+
+	header, ok := mod.Memory().Read(headerPtr, headerLen)
+	if !ok {
+		log.Errorf("host_http_open: failed to read request from memory")
+		return hostHTTPStreamError(mod, fmt.Errorf("failed to read request from memory"))
+	}
+	req, err := decodeHTTPRequestV2(header)
+	if err != nil {
+		log.Errorf("host_http_open: %v", err)
+		return hostHTTPStreamError(mod, err)
+	}
+	if bodyLen > 0 {
+		body, ok := mod.Memory().Read(bodyPtr, bodyLen)
+		if !ok {
+			return hostHTTPStreamError(mod, fmt.Errorf("failed to read request body"))
+		}
+		req.Body = append([]byte(nil), body...)
+	}
+
+	id, err := openHTTPStream(mod, req, flags&HTTPStreamUpload != 0)
+	if err != nil {
+		return hostHTTPStreamError(mod, err)
+	}
+	return []uint64{uint64(id)}
+}
+
+// openHTTPStream registers a stream for mod and starts its request
+func openHTTPStream(mod wazeroapi.Module, req *HTTPRequest, upload bool) (uint32, error) {
+	// The stream outlives this call, so it must not use the call's context
+	streamCtx, cancel := context.WithCancel(context.Background())
+	s := &httpStream{
+		owner:    mod,
+		timeout:  requestTimeout(req),
+		maxBytes: req.MaxResponseBytes,
+		cancel:   cancel,
+		done:     make(chan struct{}),
+	}
+
+	var body io.Reader
+	if upload {
+		pr, pw := io.Pipe()
+		s.upload, s.uploadR = pw, pr
+		body = io.MultiReader(bytes.NewReader(req.Body), pr)
+	}
+
+	httpReq, err := newHTTPRequest(streamCtx, req, body)
+	if err != nil {
+		cancel()
+		return 0, err
+	}
+
+	id, err := registerHTTPStream(s)
+	if err != nil {
+		cancel()
+		return 0, err
+	}
+	s.armTimeout()
+
+	log.Debugf("host_http_open: stream %d %s %s upload=%v", id, req.Method, req.URL, s.upload != nil)
+
+	go func() {
+		// No overall client timeout: a stream lives as long as the plugin
+		// keeps reading, and armTimeout covers the upload and the headers
+		client := &http.Client{Transport: httpTransportFor(req)}
+		resp, err := client.Do(httpReq)
+		if err != nil {
+			err = fmt.Errorf("request failed: %w", err)
+		}
+		s.finish(resp, err)
+	}()
+
+	return id, nil
+}
+
+// HostHTTPWrite appends a chunk to the request body of an upload stream
+// Blocks until the transport has consumed the chunk
+// Returns: error pointer (0 = success)
+func HostHTTPWrite(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+	dataPtr := uint32(params[1])
+	dataLen := uint32(params[2])
+
+	s, err := lookupHTTPStream(mod, id)
+	if err != nil {
+		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		return []uint64{uint64(errPtr)}
+	}
+
+	data, ok := mod.Memory().Read(dataPtr, dataLen)
+	if !ok {
+		errPtr, _, _ := writeStringToMemory(mod, "failed to read data from memory")
+		return []uint64{uint64(errPtr)}
+	}
+	if err := s.write(id, data); err != nil {
+		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		return []uint64{uint64(errPtr)}
+	}
+	return []uint64{0}
+}
+
+// write hands data to the transport; it fails once the request is over
+func (s *httpStream) write(id uint32, data []byte) error {
+	if s.upload == nil {
+		return fmt.Errorf("http stream %d was not opened for upload", id)
+	}
+	// The pipe hands data to the transport before Write returns, so the
+	// memory view is not retained past this call
+	if _, err := s.upload.Write(data); err != nil {
+		return fmt.Errorf("upload failed: %w", err)
+	}
+	return nil
+}
+
+// HostHTTPResponse finishes the upload (if any) and waits for the response headers
+// Returns: packed u64 (lower 32 bits = response pointer, upper 32 bits = response size)
+// The response uses the host_http_request_v2 layout with an empty body.
+func HostHTTPResponse(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+
+	s, err := lookupHTTPStream(mod, id)
+	if err != nil {
+		return packHTTPResponseV2(mod, 0, nil, err.Error(), nil)
+	}
+	if s.upload != nil {
+		s.upload.Close()
+	}
+
+	resp, err := s.wait()
+	if err != nil {
+		return packHTTPResponseV2(mod, 0, nil, err.Error(), nil)
+	}
+	return packHTTPResponseV2(mod, resp.StatusCode, responseHeaders(resp.Header), "", nil)
+}
+
+// HostHTTPRead reads the next chunk of the response body into dst
+// Fills dst completely unless the body ends first
+// Returns: packed u64 (lower 32 bits = bytes read, 0 at end of body; upper 32 bits = error pointer)
+func HostHTTPRead(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	id := uint32(params[0])
+	dstPtr := uint32(params[1])
+	capacity := uint32(params[2])
+
+	s, err := lookupHTTPStream(mod, id)
+	if err == nil {
+		if s.upload != nil {
+			s.upload.Close()
+		}
+		_, err = s.wait()
+	}
+	if err != nil {
+		errPtr, _, _ := writeStringToMemory(mod, err.Error())
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	dst, ok := mod.Memory().Read(dstPtr, capacity)
+	if !ok {
+		errPtr, _, _ := writeStringToMemory(mod, "invalid destination buffer")
+		return []uint64{uint64(errPtr) << 32}
+	}
+
+	// Read straight into linear memory; the view is only used during this call
+	n, err := io.ReadFull(s.body, dst)
+	if err != nil && err != io.EOF && err != io.ErrUnexpectedEOF {
+		log.Errorf("host_http_read: stream %d: %v", id, err)
+		errPtr, _, _ := writeStringToMemory(mod, "failed to read response body: "+err.Error())
+		return []uint64{uint64(errPtr) << 32}
+	}
+	return []uint64{uint64(uint32(n))}
+}
+
+// HostHTTPClose aborts the stream if still running and releases it
+func HostHTTPClose(ctx context.Context, mod wazeroapi.Module, params []uint64) {
+	id := uint32(params[0])
+
+	httpStreams.Lock()
+	s, ok := httpStreams.streams[id]
+	if ok && s.owner == mod {
+		delete(httpStreams.streams, id)
+	}
+	httpStreams.Unlock()
+
+	if ok && s.owner == mod {
+		closeHTTPStream(s)
+	}
+}
+
+func hostHTTPStreamError(mod wazeroapi.Module, err error) []uint64 {
+	errPtr, _, _ := writeStringToMemory(mod, err.Error())
+	return []uint64{uint64(errPtr) << 32}
+}
+
+// HostHTTPWaitAny blocks until one of the given streams has its response
+// headers (or failed), so a plugin can overlap many requests in one instance
+// Parameters:
+//   - params[0], params[1]: pointer to and count of u32 stream ids
+//   - params[2]: timeout in milliseconds (negative = wait indefinitely)
+//
+// Returns: packed u64 (lower 32 bits = index of the ready stream, 0xFFFFFFFF on timeout;
+// upper 32 bits = error pointer)
+func HostHTTPWaitAny(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	idsPtr := uint32(params[0])
+	count := uint32(params[1])
+	timeoutMs := int32(params[2])
+
+	if count == 0 || count > maxHTTPStreams {
+		return hostHTTPStreamError(mod, fmt.Errorf("invalid stream count %d", count))
+	}
+	raw, ok := mod.Memory().Read(idsPtr, count*4)
+	if !ok {
+		return hostHTTPStreamError(mod, fmt.Errorf("invalid stream id list"))
+	}
+
+	cases := make([]reflect.SelectCase, 0, count+2)
+	for i := uint32(0); i < count; i++ {
+		id := binary.LittleEndian.Uint32(raw[i*4:])
+		s, err := lookupHTTPStream(mod, id)
+		if err != nil {
+			return hostHTTPStreamError(mod, err)
+		}
+		if s.upload != nil {
+			s.upload.Close()
+		}
+		cases = append(cases, reflect.SelectCase{Dir: reflect.SelectRecv, Chan: reflect.ValueOf(s.done)})
+	}
+	cases = append(cases, reflect.SelectCase{Dir: reflect.SelectRecv, Chan: reflect.ValueOf(ctx.Done())})
+	if timeoutMs >= 0 {
+		timer := time.NewTimer(time.Duration(timeoutMs) * time.Millisecond)
+		defer timer.Stop()
+		cases = append(cases, reflect.SelectCase{Dir: reflect.SelectRecv, Chan: reflect.ValueOf(timer.C)})
+	}
+
+	chosen, _, _ := reflect.Select(cases)
+	switch {
+	case chosen < int(count):
+		return []uint64{uint64(chosen)}
+	case chosen == int(count):
+		return hostHTTPStreamError(mod, ctx.Err())
+	default:
+		return []uint64{0xFFFFFFFF}
+	}
+}
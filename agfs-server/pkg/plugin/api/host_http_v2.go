@@ -0,0 +1,235 @@
+package api
+
+import (
+	"bytes"
+	"context"
+	"encoding/binary"
+	"fmt"
+	"io"
+
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Length-prefixed HTTP wire format (host_http_request_v2)
+//
+// The request body is passed as a separate pointer+length and the response
+// body is the raw tail of the response buffer, so neither is ever encoded.
+//
+// Request header block (little-endian; version 1 blocks end before the options):
+//
+//	header: u32 total_len, u16 version, u16 reserved, u32 timeout_secs, u32 header_count
+//	        u16 method_len, method, u32 url_len, url
+//	        per header: u16 key_len, key, u32 value_len, value
+//	options (version 2):
+//	        u32 flags (bits 0-1 = HTTP2 mode, bit 2 = disable keep-alive),
+//	        i64 max_response_bytes, i64 if_modified_since,
+//	        u16 pool_key_len, pool_key, u16 if_none_match_len, if_none_match
+//
+// Response:
+//
+//	header: u32 total_len, u16 version, u16 reserved, u32 status_code,
+//	        u32 header_count, u32 error_len, u32 body_len
+//	        error, then per header: u16 key_len, key, u32 value_len, value
+//	        body (the last body_len bytes)
+const (
+	httpWireRequestVersion     = 2
+	httpWireResponseVersion    = 1
+	httpWireRequestHeaderSize  = 16
+	httpWireResponseHeaderSize = 24
+)
+
+// httpWireReader walks a length-prefixed buffer, failing on the first short read
+type httpWireReader struct {
+	data []byte
+	off  int
+	err  error
+}
+
+func (r *httpWireReader) bytes(n int) []byte {
+	if r.err != nil {
+		return nil
+	}
+	if n < 0 || r.off+n > len(r.data) {
+		r.err = fmt.Errorf("http wire: truncated buffer")
+		return nil
+	}
+	b := r.data[r.off : r.off+n]
+	r.off += n
+	return b
+}
+
+func (r *httpWireReader) u16() int {
+	b := r.bytes(2)
+	if b == nil {
+		return 0
+	}
+	return int(binary.LittleEndian.Uint16(b))
+}
+
+func (r *httpWireReader) u32() int {
+	b := r.bytes(4)
+	if b == nil {
+		return 0
+	}
+	return int(binary.LittleEndian.Uint32(b))
+}
+
+func (r *httpWireReader) i64() int64 {
+	b := r.bytes(8)
+	if b == nil {
+		return 0
+	}
+	return int64(binary.LittleEndian.Uint64(b))
+}
+
+func (r *httpWireReader) string16() string { return string(r.bytes(r.u16())) }
+func (r *httpWireReader) string32() string { return string(r.bytes(r.u32())) }
+
+// decodeHTTPRequestV2 parses a request header block; the body is attached separately
+func decodeHTTPRequestV2(data []byte) (*HTTPRequest, error) {
+	if len(data) < httpWireRequestHeaderSize {
+		return nil, fmt.Errorf("http wire: short header")
+	}
+	le := binary.LittleEndian
+	version := le.Uint16(data[4:])
+	if version < 1 || version > httpWireRequestVersion {
+		return nil, fmt.Errorf("http wire: unsupported version %d", version)
+	}
+	total := le.Uint32(data[0:])
+	if uint64(total) > uint64(len(data)) {
+		return nil, fmt.Errorf("http wire: truncated buffer")
+	}
+
+	r := &httpWireReader{data: data[:total], off: httpWireRequestHeaderSize}
+	req := &HTTPRequest{Timeout: int(le.Uint32(data[8:]))}
+	headerCount := int(le.Uint32(data[12:]))
+	req.Method = r.string16()
+	req.URL = r.string32()
+	// Each header takes at least 6 bytes, so a corrupt count cannot force a huge allocation
+	if headerCount*6 > len(r.data)-r.off {
+		return nil, fmt.Errorf("http wire: invalid header count %d", headerCount)
+	}
+	req.Headers = make(map[string]string, headerCount)
+	for i := 0; i < headerCount; i++ {
+		key := r.string16()
+		req.Headers[key] = r.string32()
+	}
+	if version >= 2 {
+		flags := r.u32()
+		req.HTTP2 = flags & 3
+		req.DisableKeepAlive = flags&4 != 0
+		req.MaxResponseBytes = r.i64()
+		req.IfModifiedSince = r.i64()
+		req.PoolKey = r.string16()
+		req.IfNoneMatch = r.string16()
+	}
+	if r.err != nil {
+		return nil, r.err
+	}
+	return req, nil
+}
+
+func putHTTPWireHeaders(buf *bytes.Buffer, headers map[string]string) {
+	var n [4]byte
+	for key, value := range headers {
+		binary.LittleEndian.PutUint16(n[:], uint16(len(key)))
+		buf.Write(n[:2])
+		buf.WriteString(key)
+		binary.LittleEndian.PutUint32(n[:], uint32(len(value)))
+		buf.Write(n[:])
+		buf.WriteString(value)
+	}
+}
+
+// encodeHTTPResponseV2 lays out the response, copying body straight after
+// the metadata so the body is read exactly once
+func encodeHTTPResponseV2(status int, headers map[string]string, errMsg string, body io.Reader) ([]byte, error) {
+	var buf bytes.Buffer
+	buf.Grow(httpWireResponseHeaderSize + len(errMsg) + 64*len(headers))
+	buf.Write(make([]byte, httpWireResponseHeaderSize))
+	buf.WriteString(errMsg)
+	putHTTPWireHeaders(&buf, headers)
+
+	metaLen := buf.Len()
+	var readErr error
+	if body != nil {
+		_, readErr = buf.ReadFrom(body)
+	}
+
+	data := buf.Bytes()
+	le := binary.LittleEndian
+	le.PutUint32(data[0:], uint32(len(data)))
+	le.PutUint16(data[4:], httpWireResponseVersion)
+	le.PutUint32(data[8:], uint32(status))
+	le.PutUint32(data[12:], uint32(len(headers)))
+	le.PutUint32(data[16:], uint32(len(errMsg)))
+	le.PutUint32(data[20:], uint32(len(data)-metaLen))
+	return data, readErr
+}
+
+// HostHTTPRequestV2 performs an HTTP request described in the length-prefixed wire format
+// Parameters:
+//   - params[0], params[1]: request header block pointer and length
+//   - params[2], params[3]: request body pointer and length
+//
+// Returns: packed u64 (lower 32 bits = response pointer, upper 32 bits = response size)
+func HostHTTPRequestV2(ctx context.Context, mod wazeroapi.Module, params []uint64) []uint64 {
+	headerPtr := uint32(params[0])
+	headerLen := uint32(params[1])
+	bodyPtr := uint32(params[2])
+	bodyLen := uint32(params[3])
+
+	header, ok := mod.Memory().Read(headerPtr, headerLen)
+	if !ok {
+		log.Errorf("host_http_request_v2: failed to read request from memory")
+		return []uint64{0}
+	}
+
+	req, err := decodeHTTPRequestV2(header)
+	if err != nil {
+		log.Errorf("host_http_request_v2: %v", err)
+		return packHTTPResponseV2(mod, 0, nil, "failed to parse request: "+err.Error(), nil)
+	}
+
+	if bodyLen > 0 {
+		body, ok := mod.Memory().Read(bodyPtr, bodyLen)
+		if !ok {
+			log.Errorf("host_http_request_v2: failed to read body from memory")
+			return packHTTPResponseV2(mod, 0, nil, "failed to read request body", nil)
+		}
+		// The transport may still read the body after Do returns (e.g. when
+		// the server answers early), so it must not alias linear memory
+		req.Body = append([]byte(nil), body...)
+	}
+
+	log.Debugf("host_http_request_v2: %s %s bodyLen=%d", req.Method, req.URL, len(req.Body))
+
+	httpResp, err := performHTTPRequest(ctx, req)
+	if err != nil {
+		log.Errorf("host_http_request_v2: %v", err)
+		return packHTTPResponseV2(mod, 0, nil, err.Error(), nil)
+	}
+	defer httpResp.Body.Close()
+
+	body := limitResponseBody(httpResp, req.MaxResponseBytes)
+	return packHTTPResponseV2(mod, httpResp.StatusCode, responseHeaders(httpResp.Header), "", body)
+}
+
+// packHTTPResponseV2 encodes a response and writes it to WASM memory
+func packHTTPResponseV2(mod wazeroapi.Module, status int, headers map[string]string, errMsg string, body io.Reader) []uint64 {
+	data, err := encodeHTTPResponseV2(status, headers, errMsg, body)
+	if err != nil {
+		log.Errorf("host_http_request_v2: failed to read response body: %v", err)
+		data, _ = encodeHTTPResponseV2(status, nil, "failed to read response body: "+err.Error(), nil)
+	}
+
+	respPtr, _, err := writeBytesToMemory(mod, data)
+	if err != nil {
+		log.Errorf("host_http_request_v2: failed to write response to memory: %v", err)
+		return []uint64{0}
+	}
+
+	log.Debugf("host_http_request_v2: status=%d, respLen=%d", status, len(data))
+	return []uint64{uint64(respPtr) | (uint64(len(data)) << 32)}
+}
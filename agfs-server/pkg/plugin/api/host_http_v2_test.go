@@ -0,0 +1,239 @@
+package api
+
+import (
+	"bytes"
+	"encoding/binary"
+	"io"
+	"net/http"
+	"strings"
+	"testing"
+	"time"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+func encodeHTTPRequestV2(req *HTTPRequest) []byte {
+	var buf bytes.Buffer
+	var n [4]byte
+	le := binary.LittleEndian
+	buf.Write(make([]byte, httpWireRequestHeaderSize))
+	le.PutUint16(n[:], uint16(len(req.Method)))
+	buf.Write(n[:2])
+	buf.WriteString(req.Method)
+	le.PutUint32(n[:], uint32(len(req.URL)))
+	buf.Write(n[:])
+	buf.WriteString(req.URL)
+	putHTTPWireHeaders(&buf, req.Headers)
+
+	flags := uint32(req.HTTP2)
+	if req.DisableKeepAlive {
+		flags |= 4
+	}
+	var opts [20]byte
+	le.PutUint32(opts[0:], flags)
+	le.PutUint64(opts[4:], uint64(req.MaxResponseBytes))
+	le.PutUint64(opts[12:], uint64(req.IfModifiedSince))
+	buf.Write(opts[:])
+	for _, s := range []string{req.PoolKey, req.IfNoneMatch} {
+		le.PutUint16(n[:], uint16(len(s)))
+		buf.Write(n[:2])
+		buf.WriteString(s)
+	}
+
+	data := buf.Bytes()
+	le.PutUint32(data[0:], uint32(len(data)))
+	le.PutUint16(data[4:], httpWireRequestVersion)
+	le.PutUint32(data[8:], uint32(req.Timeout))
+	le.PutUint32(data[12:], uint32(len(req.Headers)))
+	return data
+}
+
+func TestHTTPWireRequestRoundTrip(t *testing.T) {
+	want := &HTTPRequest{
+		Method:  "PUT",
+		URL:     "https://example.com/bucket/key",
+		Headers: map[string]string{"Content-Type": "application/octet-stream", "X-Empty": ""},
+		Timeout: 12,
+
+		PoolKey:          "api",
+		HTTP2:            HTTP2Disable,
+		DisableKeepAlive: true,
+		IfNoneMatch:      `"v1"`,
+		IfModifiedSince:  1700000000,
+		MaxResponseBytes: 1 << 20,
+	}
+
+	got, err := decodeHTTPRequestV2(encodeHTTPRequestV2(want))
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if got.Method != want.Method || got.URL != want.URL || got.Timeout != want.Timeout ||
+		got.PoolKey != want.PoolKey || got.HTTP2 != want.HTTP2 || got.DisableKeepAlive != want.DisableKeepAlive ||
+		got.IfNoneMatch != want.IfNoneMatch || got.IfModifiedSince != want.IfModifiedSince ||
+		got.MaxResponseBytes != want.MaxResponseBytes {
+		t.Errorf("expected %+v, got %+v", want, got)
+	}
+	if len(got.Headers) != len(want.Headers) {
+		t.Fatalf("expected %d headers, got %d", len(want.Headers), len(got.Headers))
+	}
+	for k, v := range want.Headers {
+		if got.Headers[k] != v {
+			t.Errorf("expected header %q = %q, got %q", k, v, got.Headers[k])
+		}
+	}
+}
+
+func TestHTTPWireRequestMalformed(t *testing.T) {
+	data := encodeHTTPRequestV2(&HTTPRequest{Method: "GET", URL: "http://a/", Headers: map[string]string{"k": "v"}})
+
+	if _, err := decodeHTTPRequestV2(data[:len(data)-1]); err == nil {
+		t.Error("expected error for truncated request")
+	}
+
+	hugeCount := append([]byte{}, data...)
+	binary.LittleEndian.PutUint32(hugeCount[12:], 1<<30)
+	if _, err := decodeHTTPRequestV2(hugeCount); err == nil {
+		t.Error("expected error for huge header count")
+	}
+
+	badVersion := append([]byte{}, data...)
+	badVersion[4] = 9
+	if _, err := decodeHTTPRequestV2(badVersion); err == nil {
+		t.Error("expected error for bad version")
+	}
+}
+
+func TestHTTPWireRequestVersion1(t *testing.T) {
+	data := encodeHTTPRequestV2(&HTTPRequest{Method: "GET", URL: "http://a/"})
+	// A version 1 block is the version 2 block without the options
+	v1 := append([]byte{}, data[:len(data)-24]...)
+	binary.LittleEndian.PutUint32(v1[0:], uint32(len(v1)))
+	binary.LittleEndian.PutUint16(v1[4:], 1)
+
+	got, err := decodeHTTPRequestV2(v1)
+	if err != nil || got.URL != "http://a/" || got.PoolKey != "" {
+		t.Errorf("expected version 1 request to decode, got %+v (%v)", got, err)
+	}
+}
+
+func TestLimitResponseBody(t *testing.T) {
+	tests := []struct {
+		name    string
+		body    string
+		limit   int64
+		wantErr bool
+	}{
+		{name: "Unlimited", body: "hello", limit: 0},
+		{name: "Under", body: "hello", limit: 6},
+		{name: "Exact", body: "hello", limit: 5},
+		{name: "Over", body: "hello!", limit: 5, wantErr: true},
+	}
+	for _, tt := range tests {
+		t.Run(tt.name, func(t *testing.T) {
+			resp := &http.Response{Body: io.NopCloser(strings.NewReader(tt.body)), ContentLength: -1}
+			data, err := io.ReadAll(limitResponseBody(resp, tt.limit))
+			if (err != nil) != tt.wantErr {
+				t.Fatalf("expected error %v, got %v", tt.wantErr, err)
+			}
+			if !tt.wantErr && string(data) != tt.body {
+				t.Errorf("expected %q, got %q", tt.body, data)
+			}
+		})
+	}
+
+	resp := &http.Response{Body: io.NopCloser(strings.NewReader("hello")), ContentLength: 5}
+	if _, err := io.ReadAll(limitResponseBody(resp, 4)); err == nil {
+		t.Error("expected Content-Length over the limit to fail without reading")
+	}
+}
+
+func TestHTTPWireResponseLayout(t *testing.T) {
+	body := strings.Repeat("x", 100000)
+	data, err := encodeHTTPResponseV2(200, map[string]string{"Etag": "abc"}, "", strings.NewReader(body))
+	if err != nil {
+		t.Fatalf("encode failed: %v", err)
+	}
+
+	le := binary.LittleEndian
+	if int(le.Uint32(data[0:])) != len(data) {
+		t.Errorf("expected total_len %d, got %d", len(data), le.Uint32(data[0:]))
+	}
+	if le.Uint32(data[8:]) != 200 || le.Uint32(data[12:]) != 1 || le.Uint32(data[16:]) != 0 {
+		t.Errorf("bad response header %v", data[:httpWireResponseHeaderSize])
+	}
+	bodyLen := int(le.Uint32(data[20:]))
+	if bodyLen != len(body) || string(data[len(data)-bodyLen:]) != body {
+		t.Errorf("expected body of %d bytes at the tail, got %d", len(body), bodyLen)
+	}
+
+	r := &httpWireReader{data: data, off: httpWireResponseHeaderSize}
+	if key, value := r.string16(), r.string32(); key != "Etag" || value != "abc" || r.err != nil {
+		t.Errorf("expected Etag: abc, got %q: %q (%v)", key, value, r.err)
+	}
+
+	data, _ = encodeHTTPResponseV2(0, nil, "request failed", nil)
+	if errLen := int(le.Uint32(data[16:])); string(data[httpWireResponseHeaderSize:httpWireResponseHeaderSize+errLen]) != "request failed" {
+		t.Errorf("expected error message in response, got %q", data[httpWireResponseHeaderSize:])
+	}
+}
+
+// streamOwner stands in for a plugin instance; streams only compare owners
+type streamOwner struct {
+	wazeroapi.Module
+	id int
+}
+
+func TestHTTPStreamWriteFailsAfterRequestEnds(t *testing.T) {
+	owner := &streamOwner{id: 1}
+	defer closeModuleHTTPStreams(owner)
+
+	// Nothing listens on the port, so Do fails while the upload is open
+	id, err := openHTTPStream(owner, &HTTPRequest{Method: "PUT", URL: "http://127.0.0.1:1/upload", Timeout: 5}, true)
+	if err != nil {
+		t.Fatalf("open failed: %v", err)
+	}
+	s, err := lookupHTTPStream(owner, id)
+	if err != nil {
+		t.Fatalf("lookup failed: %v", err)
+	}
+	if _, err := s.wait(); err == nil {
+		t.Fatalf("expected the request to fail")
+	}
+
+	done := make(chan error, 1)
+	go func() { done <- s.write(id, []byte("chunk")) }()
+	select {
+	case err := <-done:
+		if err == nil {
+			t.Errorf("write after a failed request succeeded")
+		}
+	case <-time.After(2 * time.Second):
+		t.Fatal("write blocked after the request ended")
+	}
+}
+
+func TestHTTPStreamsReleasedWithModule(t *testing.T) {
+	leaky := &streamOwner{id: 2}
+	other := &streamOwner{id: 3}
+
+	for i := 0; i < maxHTTPStreams; i++ {
+		s := &httpStream{owner: leaky, cancel: func() {}, done: make(chan struct{})}
+		close(s.done)
+		if _, err := registerHTTPStream(s); err != nil {
+			t.Fatalf("register %d failed: %v", i, err)
+		}
+	}
+	if _, err := registerHTTPStream(&httpStream{owner: other}); err == nil {
+		t.Fatalf("expected the stream cap to be reached")
+	}
+
+	// What destroyInstance does for a destroyed instance
+	closeModuleHTTPStreams(leaky)
+
+	s := &httpStream{owner: other, cancel: func() {}, done: make(chan struct{})}
+	close(s.done)
+	if _, err := registerHTTPStream(s); err != nil {
+		t.Errorf("stream cap not released after closing the module's streams: %v", err)
+	}
+	closeModuleHTTPStreams(other)
+}
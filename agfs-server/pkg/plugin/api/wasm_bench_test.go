@@ -0,0 +1,142 @@
+package api_test
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/api"
+	"github.com/c4pt0r/agfs/agfs-server/pkg/plugin/loader"
+	"github.com/tetratelabs/wazero"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+	"github.com/tetratelabs/wazero/experimental"
+)
+
+// The FFI benchmarks drive a synthetic plugin (examples/hellofs-wasm-cpp/bench)
+// through the same loader and instance pool the server uses. They are skipped
+// unless AGFS_BENCH_WASM points at the built plugin; run them with
+//
+//	make -C examples/hellofs-wasm-cpp bench
+//
+// Any plugin implementing the BenchFS paths (/bytes/<n>, /dir/<n>, /sink)
+// can be compared by pointing AGFS_BENCH_WASM at it.
+
+var benchPayloadSizes = []int{64, 1 << 10, 16 << 10, 64 << 10, 256 << 10, 1 << 20, 4 << 20}
+
+var benchDirSizes = []int{10, 1000, 10000, 100000}
+
+func loadBenchFS(b *testing.B) filesystem.FileSystem {
+	b.Helper()
+	wasmPath := os.Getenv("AGFS_BENCH_WASM")
+	if wasmPath == "" {
+		b.Skip("AGFS_BENCH_WASM not set; run make bench in examples/hellofs-wasm-cpp")
+	}
+
+	wl := loader.NewWASMPluginLoader()
+	p, err := wl.LoadWASMPlugin(wasmPath, api.PoolConfig{MaxInstances: 1})
+	if err != nil {
+		b.Fatalf("failed to load %s: %v", wasmPath, err)
+	}
+	b.Cleanup(func() { wl.UnloadWASMPlugin(wasmPath) })
+
+	if err := p.Initialize(map[string]interface{}{}); err != nil {
+		b.Fatalf("failed to initialize %s: %v", wasmPath, err)
+	}
+	return p.GetFileSystem()
+}
+
+// BenchmarkCppSDKCompile measures what loading the module costs the host
+// before any instance exists: wazero compiling AGFS_BENCH_WASM with the
+// loader's runtime config. It takes any plugin, not only BenchFS, and
+// reports the module size alongside (make size).
+func BenchmarkCppSDKCompile(b *testing.B) {
+	wasmPath := os.Getenv("AGFS_BENCH_WASM")
+	if wasmPath == "" {
+		b.Skip("AGFS_BENCH_WASM not set; run make size in examples/hellofs-wasm-cpp")
+	}
+	wasmBytes, err := os.ReadFile(wasmPath)
+	if err != nil {
+		b.Fatalf("failed to read %s: %v", wasmPath, err)
+	}
+
+	ctx := context.Background()
+	config := wazero.NewRuntimeConfig().
+		WithCoreFeatures(wazeroapi.CoreFeaturesV2 | experimental.CoreFeaturesThreads)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		r := wazero.NewRuntimeWithConfig(ctx, config)
+		if _, err := r.CompileModule(ctx, wasmBytes); err != nil {
+			b.Fatalf("compile %s: %v", wasmPath, err)
+		}
+		r.Close(ctx)
+	}
+	b.ReportMetric(float64(len(wasmBytes)), "module-bytes")
+}
+
+func BenchmarkCppSDKRead(b *testing.B) {
+	fs := loadBenchFS(b)
+	for _, size := range benchPayloadSizes {
+		b.Run(fmt.Sprintf("size=%d", size), func(b *testing.B) {
+			path := fmt.Sprintf("/bytes/%d", size)
+			b.SetBytes(int64(size))
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				data, err := fs.Read(path, 0, int64(size))
+				if err != nil || len(data) != size {
+					b.Fatalf("read %s: got %d bytes, err %v", path, len(data), err)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkCppSDKWrite(b *testing.B) {
+	fs := loadBenchFS(b)
+	for _, size := range benchPayloadSizes {
+		b.Run(fmt.Sprintf("size=%d", size), func(b *testing.B) {
+			data := make([]byte, size)
+			b.SetBytes(int64(size))
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				n, err := fs.Write("/sink", data, 0, filesystem.WriteFlagNone)
+				if err != nil || n != int64(size) {
+					b.Fatalf("write: got %d bytes, err %v", n, err)
+				}
+			}
+		})
+	}
+}
+
+func BenchmarkCppSDKStat(b *testing.B) {
+	fs := loadBenchFS(b)
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := fs.Stat("/bytes/1024"); err != nil {
+			b.Fatalf("stat: %v", err)
+		}
+	}
+}
+
+func BenchmarkCppSDKReadDir(b *testing.B) {
+	fs := loadBenchFS(b)
+	for _, size := range benchDirSizes {
+		b.Run(fmt.Sprintf("entries=%d", size), func(b *testing.B) {
+			path := fmt.Sprintf("/dir/%d", size)
+			b.ReportAllocs()
+			b.ResetTimer()
+			for i := 0; i < b.N; i++ {
+				infos, err := fs.ReadDir(path)
+				if err != nil || len(infos) != size {
+					b.Fatalf("readdir %s: got %d entries, err %v", path, len(infos), err)
+				}
+			}
+			b.ReportMetric(float64(b.Elapsed().Nanoseconds())/float64(b.N)/float64(size), "ns/entry")
+		})
+	}
+}
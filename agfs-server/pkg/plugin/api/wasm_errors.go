@@ -0,0 +1,149 @@
+package api
+
+import (
+	"errors"
+	"fmt"
+	"io/fs"
+	"syscall"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+// PluginErrorKind mirrors agfs::ErrorKind in the C++ SDK (agfs_types.h)
+type PluginErrorKind uint8
+
+const (
+	PluginErrNotFound PluginErrorKind = iota
+	PluginErrPermissionDenied
+	PluginErrAlreadyExists
+	PluginErrIsDirectory
+	PluginErrNotDirectory
+	PluginErrReadOnly
+	PluginErrInvalidInput
+	PluginErrIo
+	PluginErrOther
+	pluginErrKindCount
+)
+
+// Error slots of plugins with ABICapErrorCodes (agfs::ffi::export_error):
+// 0 is success, values below pluginErrorCodeLimit are the code kind+1 with
+// the kind's default message, and anything else points to a malloc'd
+// string of the code byte followed by the message. The first 1KB of linear
+// memory holds no data, so codes never collide with pointers.
+const pluginErrorCodeLimit = 256
+
+// PluginError is an error returned by a plugin that reports its kind
+// errors.Is matches it against the filesystem package's sentinel errors,
+// so callers such as the HTTP handlers map it to the right status.
+type PluginError struct {
+	Kind    PluginErrorKind
+	Message string
+}
+
+func (e *PluginError) Error() string {
+	return e.Message
+}
+
+func (e *PluginError) Is(target error) bool {
+	switch e.Kind {
+	case PluginErrNotFound:
+		return target == filesystem.ErrNotFound
+	case PluginErrPermissionDenied, PluginErrReadOnly:
+		return target == filesystem.ErrPermissionDenied
+	case PluginErrAlreadyExists:
+		return target == filesystem.ErrAlreadyExists
+	case PluginErrNotDirectory:
+		return target == filesystem.ErrNotDirectory
+	case PluginErrInvalidInput:
+		return target == filesystem.ErrInvalidArgument
+	}
+	return false
+}
+
+// Errors for bare codes, shared so that negative lookups allocate nothing;
+// messages match agfs::Error::default_message
+var pluginCodeErrors = [pluginErrKindCount]*PluginError{
+	{PluginErrNotFound, "file not found"},
+	{PluginErrPermissionDenied, "permission denied"},
+	{PluginErrAlreadyExists, "file already exists"},
+	{PluginErrIsDirectory, "is a directory"},
+	{PluginErrNotDirectory, "not a directory"},
+	{PluginErrReadOnly, "read-only filesystem"},
+	{PluginErrInvalidInput, "unknown error"},
+	{PluginErrIo, "unknown error"},
+	{PluginErrOther, "unknown error"},
+}
+
+// pluginErrorFromCode returns the error of a bare code, or nil if code is
+// not one
+func pluginErrorFromCode(code uint32) *PluginError {
+	if code == 0 || code > uint32(pluginErrKindCount) {
+		return nil
+	}
+	return pluginCodeErrors[code-1]
+}
+
+// pluginErrorFromString decodes a code-prefixed error string; a string
+// without a valid code byte is kept whole as PluginErrOther
+func pluginErrorFromString(s string) *PluginError {
+	if len(s) > 0 {
+		if code := pluginErrorFromCode(uint32(s[0])); code != nil {
+			return &PluginError{Kind: code.Kind, Message: s[1:]}
+		}
+	}
+	return &PluginError{Kind: PluginErrOther, Message: s}
+}
+
+// pluginError turns a non-zero error slot of an fs_* / handle_* export
+// into an error, freeing the plugin's string if there is one. Plugins
+// without ABICapErrorCodes return plain message pointers; fallback is used
+// when no message can be read.
+func (wfs *WASMFileSystem) pluginError(errVal uint32, fallback string) error {
+	codes := wfs.abiCaps&ABICapErrorCodes != 0
+	if codes && errVal < pluginErrorCodeLimit {
+		if err := pluginErrorFromCode(errVal); err != nil {
+			return err
+		}
+		return fmt.Errorf("%s", fallback)
+	}
+	errMsg, ok := readStringFromMemory(wfs.module, errVal)
+	freeWASMMemory(wfs.module, errVal, 0)
+	if !ok || errMsg == "" {
+		return fmt.Errorf("%s", fallback)
+	}
+	if codes {
+		return pluginErrorFromString(errMsg)
+	}
+	return fmt.Errorf("%s", errMsg)
+}
+
+// hostErrorKind classifies an error of the host filesystem for a plugin
+func hostErrorKind(err error) PluginErrorKind {
+	var pluginErr *PluginError
+	switch {
+	case errors.As(err, &pluginErr):
+		return pluginErr.Kind
+	case errors.Is(err, filesystem.ErrNotFound), errors.Is(err, fs.ErrNotExist):
+		return PluginErrNotFound
+	case errors.Is(err, syscall.EROFS):
+		return PluginErrReadOnly
+	case errors.Is(err, filesystem.ErrPermissionDenied), errors.Is(err, fs.ErrPermission):
+		return PluginErrPermissionDenied
+	case errors.Is(err, filesystem.ErrAlreadyExists), errors.Is(err, fs.ErrExist):
+		return PluginErrAlreadyExists
+	case errors.Is(err, syscall.EISDIR):
+		return PluginErrIsDirectory
+	case errors.Is(err, filesystem.ErrNotDirectory), errors.Is(err, syscall.ENOTDIR):
+		return PluginErrNotDirectory
+	case errors.Is(err, filesystem.ErrInvalidArgument), errors.Is(err, fs.ErrInvalid):
+		return PluginErrInvalidInput
+	}
+	return PluginErrOther
+}
+
+// hostErrorString is the error string host_fs_* calls hand to the plugin:
+// the code byte of the error's kind followed by its message, the layout of
+// plugin error strings (agfs::internal::host_error decodes it)
+func hostErrorString(err error) string {
+	return string([]byte{byte(hostErrorKind(err)) + 1}) + err.Error()
+}
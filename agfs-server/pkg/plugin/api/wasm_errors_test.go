@@ -0,0 +1,67 @@
+package api
+
+import (
+	"errors"
+	"fmt"
+	"os"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+func TestPluginErrorFromCode(t *testing.T) {
+	err := pluginErrorFromCode(uint32(PluginErrNotFound) + 1)
+	if err == nil || err.Message != "file not found" {
+		t.Fatalf("expected not found error, got %v", err)
+	}
+	if !errors.Is(err, filesystem.ErrNotFound) {
+		t.Errorf("expected errors.Is(%v, ErrNotFound)", err)
+	}
+	if pluginErrorFromCode(uint32(PluginErrNotFound)+1) != err {
+		t.Errorf("expected bare codes to share one error value")
+	}
+	if errors.Is(pluginErrorFromCode(uint32(PluginErrIo)+1), filesystem.ErrNotFound) {
+		t.Errorf("io error matched ErrNotFound")
+	}
+	for _, code := range []uint32{0, uint32(pluginErrKindCount) + 1, 255} {
+		if err := pluginErrorFromCode(code); err != nil {
+			t.Errorf("code %d: expected nil, got %v", code, err)
+		}
+	}
+}
+
+func TestPluginErrorFromString(t *testing.T) {
+	err := pluginErrorFromString(string([]byte{byte(PluginErrReadOnly) + 1}) + "mount is read-only")
+	if err.Kind != PluginErrReadOnly || err.Message != "mount is read-only" {
+		t.Fatalf("unexpected error %+v", err)
+	}
+	if !errors.Is(err, filesystem.ErrPermissionDenied) {
+		t.Errorf("expected read-only error to match ErrPermissionDenied")
+	}
+
+	plain := pluginErrorFromString("disk on fire")
+	if plain.Kind != PluginErrOther || plain.Message != "disk on fire" {
+		t.Errorf("unexpected error %+v", plain)
+	}
+}
+
+func TestHostErrorString(t *testing.T) {
+	cases := []struct {
+		err  error
+		kind PluginErrorKind
+	}{
+		{filesystem.NewNotFoundError("stat", "/a"), PluginErrNotFound},
+		{&os.PathError{Op: "open", Path: "/a", Err: os.ErrNotExist}, PluginErrNotFound},
+		{fmt.Errorf("wrapped: %w", filesystem.ErrPermissionDenied), PluginErrPermissionDenied},
+		{filesystem.NewAlreadyExistsError("file", "/a"), PluginErrAlreadyExists},
+		{filesystem.NewNotDirectoryError("/a"), PluginErrNotDirectory},
+		{errors.New("disk on fire"), PluginErrOther},
+	}
+	for _, c := range cases {
+		s := hostErrorString(c.err)
+		decoded := pluginErrorFromString(s)
+		if decoded.Kind != c.kind || decoded.Message != c.err.Error() {
+			t.Errorf("%v: decoded %+v, want kind %d", c.err, decoded, c.kind)
+		}
+	}
+}
@@ -0,0 +1,259 @@
+package api
+
+import (
+	"context"
+	"encoding/binary"
+	"fmt"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+	log "github.com/sirupsen/logrus"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// Change notification (C++ SDK notify_changed, see agfs::ChangeQueue)
+//
+// The host calls fs_watch(path) on each instance for every watched path.
+// A plugin then queues its change events and calls host_fs_notify once;
+// the pool fetches the queue with fs_poll_events when the instance is
+// released, so events cost one extra call per request that produced any.
+//
+// fs_poll_events batch (little-endian, version 1):
+//
+//	header: u32 total_len, u16 version, u16 flags (1 = overflow), u32 count
+//	event:  u8 kind, u8 reserved, u16 path_len, path
+const (
+	changeBatchVersion    = 1
+	changeBatchHeaderSize = 12
+	changeEventFixedSize  = 4
+	changeFlagOverflow    = 1 << 0
+
+	// Polls per release; the plugin rings again while events are left
+	maxEventPolls = 8
+
+	// Retry delays after a failed fs_watch, doubling up to the maximum
+	minWatchRetry = time.Second
+	maxWatchRetry = time.Minute
+)
+
+// notifyBells maps each plugin instance's module to the flag its
+// host_fs_notify calls set
+var notifyBells sync.Map // wazeroapi.Module -> *atomic.Bool
+
+func registerNotifyBell(module wazeroapi.Module) *atomic.Bool {
+	bell := &atomic.Bool{}
+	notifyBells.Store(module, bell)
+	return bell
+}
+
+func unregisterNotifyBell(module wazeroapi.Module) {
+	notifyBells.Delete(module)
+}
+
+// HostFSNotify implements host_fs_notify(pending): the calling instance has
+// change events queued
+func HostFSNotify(ctx context.Context, mod wazeroapi.Module, params []uint64) {
+	if bell, ok := notifyBells.Load(mod); ok {
+		bell.(*atomic.Bool).Store(true)
+	}
+}
+
+// decodeChangeEvents parses an fs_poll_events batch
+func decodeChangeEvents(data []byte) ([]filesystem.ChangeEvent, bool, error) {
+	if len(data) < changeBatchHeaderSize {
+		return nil, false, fmt.Errorf("change batch too short: %d bytes", len(data))
+	}
+	total := binary.LittleEndian.Uint32(data[0:])
+	version := binary.LittleEndian.Uint16(data[4:])
+	flags := binary.LittleEndian.Uint16(data[6:])
+	count := binary.LittleEndian.Uint32(data[8:])
+	if version != changeBatchVersion {
+		return nil, false, fmt.Errorf("unsupported change batch version %d", version)
+	}
+	if int(total) > len(data) || total < changeBatchHeaderSize {
+		return nil, false, fmt.Errorf("change batch length %d out of range", total)
+	}
+
+	events := make([]filesystem.ChangeEvent, 0, count)
+	p := data[changeBatchHeaderSize:total]
+	for i := uint32(0); i < count; i++ {
+		if len(p) < changeEventFixedSize {
+			return nil, false, fmt.Errorf("change event %d truncated", i)
+		}
+		kind := filesystem.ChangeKind(p[0])
+		n := int(binary.LittleEndian.Uint16(p[2:]))
+		if len(p) < changeEventFixedSize+n {
+			return nil, false, fmt.Errorf("change event %d truncated", i)
+		}
+		events = append(events, filesystem.ChangeEvent{
+			Path: string(p[changeEventFixedSize : changeEventFixedSize+n]),
+			Kind: kind,
+		})
+		p = p[changeEventFixedSize+n:]
+	}
+	return events, flags&changeFlagOverflow != 0, nil
+}
+
+// pathCovers reports whether path is watch or below it
+func pathCovers(watch, path string) bool {
+	if watch == "/" || watch == "" {
+		return true
+	}
+	return path == watch || strings.HasPrefix(path, watch+"/")
+}
+
+// watch calls fs_watch
+func (wfs *WASMFileSystem) watch(path string) error {
+	watchFunc := wfs.module.ExportedFunction("fs_watch")
+	if watchFunc == nil {
+		return filesystem.ErrNotSupported
+	}
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	results, err := watchFunc.Call(wfs.ctx, uint64(pathPtr))
+	if err != nil {
+		return fmt.Errorf("fs_watch failed: %w", err)
+	}
+	if len(results) > 0 && results[0] != 0 {
+		return wfs.pluginError(uint32(results[0]), "watch failed")
+	}
+	return nil
+}
+
+// pollEvents calls fs_poll_events; no events and no error means the queue
+// was empty
+func (wfs *WASMFileSystem) pollEvents() ([]filesystem.ChangeEvent, bool, error) {
+	pollFunc := wfs.module.ExportedFunction("fs_poll_events")
+	if pollFunc == nil {
+		return nil, false, nil
+	}
+
+	results, err := pollFunc.Call(wfs.ctx, 0)
+	if err != nil {
+		return nil, false, fmt.Errorf("fs_poll_events failed: %w", err)
+	}
+	if len(results) < 1 || results[0] == 0 {
+		return nil, false, nil
+	}
+
+	dataPtr := uint32(results[0] & 0xFFFFFFFF)
+	dataSize := uint32((results[0] >> 32) & 0xFFFFFFFF)
+	view, ok := wfs.module.Memory().Read(dataPtr, dataSize)
+	if !ok {
+		freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
+		return nil, false, fmt.Errorf("failed to read change events from memory")
+	}
+	events, overflow, err := decodeChangeEvents(view)
+	freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
+	return events, overflow, err
+}
+
+// poolWatch is one Watch registered on a pool
+type poolWatch struct {
+	path string
+	fn   filesystem.ChangeFunc
+}
+
+// Watch registers fn for change events at or below path. Every instance,
+// including those created later, is told to watch path before its next
+// use. Plugins without fs_watch return filesystem.ErrNotSupported.
+func (p *WASMInstancePool) Watch(path string, fn filesystem.ChangeFunc) error {
+	if _, ok := p.compiledModule.ExportedFunctions()["fs_watch"]; !ok {
+		return filesystem.ErrNotSupported
+	}
+
+	p.watchMu.Lock()
+	p.watches = append(p.watches, poolWatch{path: filesystem.NormalizePath(path), fn: fn})
+	p.watchGen++
+	p.watchMu.Unlock()
+	return nil
+}
+
+// applyWatches calls fs_watch on instance for the watches added since it
+// last did. After a failure the pool waits (with backoff) before any
+// instance tries again, so a plugin whose fs_watch keeps failing costs one
+// warning per retry instead of one per Acquire.
+func (p *WASMInstancePool) applyWatches(instance *WASMModuleInstance) {
+	p.watchMu.Lock()
+	watches, gen := p.watches, p.watchGen
+	retryAt := p.watchRetryAt
+	p.watchMu.Unlock()
+
+	instance.mu.Lock()
+	defer instance.mu.Unlock()
+	if instance.watchGen == gen || time.Now().Before(retryAt) {
+		return
+	}
+	for _, w := range watches {
+		if err := instance.fileSystem.watch(w.path); err != nil {
+			p.watchMu.Lock()
+			p.watchRetry = min(max(2*p.watchRetry, minWatchRetry), maxWatchRetry)
+			p.watchRetryAt = time.Now().Add(p.watchRetry)
+			retry := p.watchRetry
+			p.watchMu.Unlock()
+			log.Warnf("[Pool %s] fs_watch %s failed, retrying in %v: %v", p.pluginName, w.path, retry, err)
+			return
+		}
+	}
+	instance.watchGen = gen
+
+	p.watchMu.Lock()
+	p.watchRetry = 0
+	p.watchMu.Unlock()
+}
+
+// drainEvents fetches the events of an instance that rang host_fs_notify
+// and hands them to the watchers
+func (p *WASMInstancePool) drainEvents(instance *WASMModuleInstance) {
+	if instance.bell == nil || !instance.bell.Swap(false) {
+		return
+	}
+
+	for i := 0; i < maxEventPolls; i++ {
+		events, overflow, err := instance.fileSystem.pollEvents()
+		if err != nil {
+			log.Warnf("[Pool %s] fs_poll_events failed: %v", p.pluginName, err)
+			return
+		}
+		if len(events) == 0 && !overflow {
+			break
+		}
+		p.deliverEvents(events, overflow)
+		if !instance.bell.Swap(false) {
+			break
+		}
+	}
+}
+
+func (p *WASMInstancePool) deliverEvents(events []filesystem.ChangeEvent, overflow bool) {
+	p.watchMu.Lock()
+	watches := p.watches
+	p.watchMu.Unlock()
+
+	for _, w := range watches {
+		var matched []filesystem.ChangeEvent
+		for _, e := range events {
+			if pathCovers(w.path, e.Path) {
+				matched = append(matched, e)
+			}
+		}
+		if len(matched) > 0 || overflow {
+			w.fn(matched, overflow)
+		}
+	}
+}
+
+// Watch implements filesystem.ChangeNotifier
+func (pfs *PooledWASMFileSystem) Watch(path string, fn filesystem.ChangeFunc) error {
+	return pfs.pool.Watch(path, fn)
+}
+
+var _ filesystem.ChangeNotifier = (*PooledWASMFileSystem)(nil)
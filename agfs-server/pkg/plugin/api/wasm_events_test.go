@@ -0,0 +1,96 @@
+package api
+
+import (
+	"encoding/binary"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+func encodeChangeBatch(flags uint16, events []filesystem.ChangeEvent) []byte {
+	buf := make([]byte, changeBatchHeaderSize)
+	for _, e := range events {
+		ev := make([]byte, changeEventFixedSize)
+		ev[0] = byte(e.Kind)
+		binary.LittleEndian.PutUint16(ev[2:], uint16(len(e.Path)))
+		buf = append(buf, ev...)
+		buf = append(buf, e.Path...)
+	}
+	binary.LittleEndian.PutUint32(buf[0:], uint32(len(buf)))
+	binary.LittleEndian.PutUint16(buf[4:], changeBatchVersion)
+	binary.LittleEndian.PutUint16(buf[6:], flags)
+	binary.LittleEndian.PutUint32(buf[8:], uint32(len(events)))
+	return buf
+}
+
+func TestDecodeChangeEvents(t *testing.T) {
+	in := []filesystem.ChangeEvent{
+		{Path: "/a/b", Kind: filesystem.ChangeModified},
+		{Path: "/", Kind: filesystem.ChangeAttrib},
+		{Path: "/c", Kind: filesystem.ChangeRemoved},
+	}
+	events, overflow, err := decodeChangeEvents(encodeChangeBatch(0, in))
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if overflow {
+		t.Errorf("unexpected overflow")
+	}
+	if len(events) != len(in) {
+		t.Fatalf("expected %d events, got %d", len(in), len(events))
+	}
+	for i := range in {
+		if events[i] != in[i] {
+			t.Errorf("event %d: expected %+v, got %+v", i, in[i], events[i])
+		}
+	}
+
+	events, overflow, err = decodeChangeEvents(encodeChangeBatch(changeFlagOverflow, nil))
+	if err != nil || !overflow || len(events) != 0 {
+		t.Errorf("overflow batch: events=%v overflow=%v err=%v", events, overflow, err)
+	}
+}
+
+func TestDecodeChangeEventsMalformed(t *testing.T) {
+	good := encodeChangeBatch(0, []filesystem.ChangeEvent{{Path: "/file", Kind: filesystem.ChangeCreated}})
+
+	if _, _, err := decodeChangeEvents(good[:changeBatchHeaderSize-1]); err == nil {
+		t.Errorf("short header accepted")
+	}
+
+	truncated := append([]byte(nil), good[:len(good)-2]...)
+	binary.LittleEndian.PutUint32(truncated[0:], uint32(len(truncated)))
+	if _, _, err := decodeChangeEvents(truncated); err == nil {
+		t.Errorf("truncated path accepted")
+	}
+
+	badVersion := append([]byte(nil), good...)
+	binary.LittleEndian.PutUint16(badVersion[4:], 2)
+	if _, _, err := decodeChangeEvents(badVersion); err == nil {
+		t.Errorf("unknown version accepted")
+	}
+
+	badLength := append([]byte(nil), good...)
+	binary.LittleEndian.PutUint32(badLength[0:], uint32(len(good)+1))
+	if _, _, err := decodeChangeEvents(badLength); err == nil {
+		t.Errorf("overlong total_len accepted")
+	}
+}
+
+func TestPathCovers(t *testing.T) {
+	cases := []struct {
+		watch, path string
+		want        bool
+	}{
+		{"/", "/anything", true},
+		{"/a", "/a", true},
+		{"/a", "/a/b", true},
+		{"/a", "/ab", false},
+		{"/a/b", "/a", false},
+	}
+	for _, c := range cases {
+		if got := pathCovers(c.watch, c.path); got != c.want {
+			t.Errorf("pathCovers(%q, %q) = %v, want %v", c.watch, c.path, got, c.want)
+		}
+	}
+}
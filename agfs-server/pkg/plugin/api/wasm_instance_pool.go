@@ -4,6 +4,7 @@ import (
 	"context"
 	"fmt"
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
@@ -20,6 +21,9 @@ type PoolConfig struct {
 	HealthCheckInterval time.Duration // Health check interval (0 = disabled)
 	AcquireTimeout      time.Duration // Timeout for acquiring instance (0 = unlimited, default 30s)
 	EnableStatistics    bool          // Enable statistics collection
+	InstanceMaxMemory   uint64        // Recycle instances whose linear memory exceeds this many bytes (0 = unlimited)
+	TrimMemoryGrowth    uint64        // Call plugin_trim on release after linear memory grew this many bytes since the last trim (0 = disabled)
+	InstanceMaxThreads  int           // Threads each instance of a wasi-threads build may spawn (0 = number of CPUs)
 }
 
 // WASMInstancePool manages a pool of WASM module instances for concurrent access
@@ -35,16 +39,39 @@ type WASMInstancePool struct {
 	mu               sync.Mutex
 	stats            PoolStats
 	closed           bool
+
+	// Config JSON from WASMPlugin.Initialize, applied to every instance
+	// before its first use; initGen changes each time it is set
+	initConfig []byte
+	initGen    uint64
+
+	// Plugin-side counters (plugin_get_metrics): the last snapshot of each
+	// live instance plus the final counts of destroyed ones
+	metricsMu      sync.Mutex
+	live           map[*WASMModuleInstance]struct{}
+	retiredMetrics PluginMetrics
+
+	// Change watches (fs_watch), applied to every instance before its
+	// next use; watchGen changes each time one is added
+	watchMu      sync.Mutex
+	watches      []poolWatch
+	watchGen     uint64
+	watchRetry   time.Duration // Backoff after a failed fs_watch (0 = none)
+	watchRetryAt time.Time     // No fs_watch before this
 }
 
 // PoolStats tracks pool usage statistics
 type PoolStats struct {
 	TotalCreated   int64
+	WarmCreated    int64 // Of TotalCreated, instances started from a pre-initialized snapshot
 	TotalDestroyed int64
 	CurrentActive  int64
 	TotalWaits     int64
 	TotalRequests  int64
 	FailedRequests int64
+	MemoryRecycled int64  // Instances recycled for exceeding InstanceMaxMemory
+	TotalTrims     int64  // plugin_trim calls
+	TrimmedBytes   uint64 // Bytes those calls reported released
 	mu             sync.Mutex
 }
 
@@ -62,8 +89,16 @@ type WASMModuleInstance struct {
 	fileSystem   *WASMFileSystem
 	sharedBuffer SharedBufferInfo
 	createdAt    time.Time
-	requestCount int64 // Number of requests handled by this instance
+	requestCount int64  // Number of requests handled by this instance
+	warm         bool   // Started from a pre-initialized snapshot (plugin_snapshot_ready)
+	initGen      uint64 // Pool initGen last applied to this instance
+	trimmedAt    uint64 // Linear memory size at the last plugin_trim (or creation)
+	trimmedReqs  int64  // requestCount at the last plugin_trim
+	watchGen     uint64 // Pool watchGen last applied to this instance (fs_watch)
+	lastUsed     time.Time
 	mu           sync.Mutex
+	metrics      PluginMetrics // Last plugin_get_metrics snapshot, guarded by the pool's metricsMu
+	bell         *atomic.Bool  // Set by host_fs_notify: change events are queued
 }
 
 // NewWASMInstancePool creates a new WASM instance pool with configuration
@@ -86,6 +121,7 @@ func NewWASMInstancePool(ctx context.Context, runtime wazero.Runtime, compiledMo
 		pluginName:     pluginName,
 		config:         config,
 		instances:      make(chan *WASMModuleInstance, config.MaxInstances),
+		live:           make(map[*WASMModuleInstance]struct{}),
 	}
 
 	log.Infof("Created WASM instance pool for %s (max_instances=%d, max_lifetime=%v, max_requests=%d)",
@@ -126,10 +162,50 @@ func (p *WASMInstancePool) performHealthCheck() {
 
 	log.Debugf("[Pool %s] Health check: active instances=%d/%d",
 		p.pluginName, p.currentInstances, p.config.MaxInstances)
+
+	// Trim instances that served requests but then sat idle for a whole
+	// interval; busy instances keep their caches
+	p.forEachIdle(func(instance *WASMModuleInstance) {
+		instance.mu.Lock()
+		idle := instance.requestCount != instance.trimmedReqs &&
+			time.Since(instance.lastUsed) >= p.config.HealthCheckInterval
+		instance.mu.Unlock()
+		if idle {
+			p.trimInstance(instance)
+		}
+	})
 }
 
-// Acquire gets an instance from the pool or creates a new one if available
+// Acquire gets an instance from the pool or creates a new one if available,
+// initialized with the config of the last SetInitConfig
 func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
+	instance, err := p.acquire()
+	if err != nil {
+		return nil, err
+	}
+
+	if err := p.applyInitConfig(instance); err != nil {
+		p.destroyInstance(instance)
+
+		p.mu.Lock()
+		p.currentInstances--
+		p.mu.Unlock()
+
+		if p.config.EnableStatistics {
+			p.stats.mu.Lock()
+			p.stats.TotalDestroyed++
+			p.stats.CurrentActive--
+			p.stats.FailedRequests++
+			p.stats.mu.Unlock()
+		}
+		return nil, err
+	}
+	p.applyWatches(instance)
+
+	return instance, nil
+}
+
+func (p *WASMInstancePool) acquire() (*WASMModuleInstance, error) {
 	// Check if pool is closed
 	p.mu.Lock()
 	if p.closed {
@@ -165,7 +241,7 @@ func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
 			}
 
 			// Create a new instance to replace the recycled one
-			return p.Acquire()
+			return p.acquire()
 		}
 
 		log.Debugf("Reusing WASM instance from pool for %s", p.pluginName)
@@ -203,6 +279,9 @@ func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
 			if p.config.EnableStatistics {
 				p.stats.mu.Lock()
 				p.stats.TotalCreated++
+				if instance.warm {
+					p.stats.WarmCreated++
+				}
 				p.stats.CurrentActive++
 				p.stats.mu.Unlock()
 			}
@@ -257,7 +336,7 @@ func (p *WASMInstancePool) Acquire() (*WASMModuleInstance, error) {
 			}
 
 			// Create a new instance to replace the recycled one
-			return p.Acquire()
+			return p.acquire()
 		}
 
 		// Increment request count for this instance
@@ -289,6 +368,20 @@ func (p *WASMInstancePool) shouldRecycleInstance(instance *WASMModuleInstance) b
 		return true
 	}
 
+	// Check linear memory, which never shrinks; recycle before the next
+	// request rather than letting the module trap on a failed grow
+	if p.config.InstanceMaxMemory > 0 {
+		if size := linearMemorySize(instance.module); size > p.config.InstanceMaxMemory {
+			log.Debugf("Instance exceeded max memory: %d > %d", size, p.config.InstanceMaxMemory)
+			if p.config.EnableStatistics {
+				p.stats.mu.Lock()
+				p.stats.MemoryRecycled++
+				p.stats.mu.Unlock()
+			}
+			return true
+		}
+	}
+
 	return false
 }
 
@@ -298,6 +391,21 @@ func (p *WASMInstancePool) Release(instance *WASMModuleInstance) {
 		return
 	}
 
+	instance.mu.Lock()
+	instance.lastUsed = time.Now()
+	grown := p.config.TrimMemoryGrowth > 0 &&
+		linearMemorySize(instance.module) >= instance.trimmedAt+p.config.TrimMemoryGrowth
+	instance.mu.Unlock()
+	if grown {
+		p.trimInstance(instance)
+	}
+	p.drainEvents(instance)
+
+	p.putBack(instance)
+}
+
+// putBack returns an idle instance to the pool without counting it as used
+func (p *WASMInstancePool) putBack(instance *WASMModuleInstance) {
 	// Try to return to pool, if pool is full, destroy the instance
 	select {
 	case p.instances <- instance:
@@ -320,16 +428,22 @@ func (p *WASMInstancePool) Release(instance *WASMModuleInstance) {
 
 // createInstance creates a new WASM module instance
 func (p *WASMInstancePool) createInstance() (*WASMModuleInstance, error) {
-	// Instantiate the compiled module
-	module, err := p.runtime.InstantiateModule(p.ctx, p.compiledModule, wazero.NewModuleConfig())
+	// Instantiate the compiled module; the real monotonic clock lets
+	// plugin-side TTL caches expire
+	module, err := InstantiateWASMModule(p.ctx, p.runtime, p.compiledModule,
+		wazero.NewModuleConfig().WithSysNanotime(), p.config.InstanceMaxThreads)
 	if err != nil {
 		return nil, fmt.Errorf("failed to instantiate WASM module: %w", err)
 	}
+	bell := registerNotifyBell(module)
 
-	// Call plugin_new to initialize
-	if newFunc := module.ExportedFunction("plugin_new"); newFunc != nil {
+	// A pre-initialized snapshot already holds the constructed plugin;
+	// otherwise call plugin_new to create it
+	warm := isSnapshotReady(module, p.ctx)
+	if newFunc := module.ExportedFunction("plugin_new"); newFunc != nil && !warm {
 		if _, err := newFunc.Call(p.ctx); err != nil {
-			module.Close(p.ctx)
+			unregisterNotifyBell(module)
+			CloseWASMModule(p.ctx, module)
 			return nil, fmt.Errorf("failed to call plugin_new: %w", err)
 		}
 	}
@@ -340,12 +454,16 @@ func (p *WASMInstancePool) createInstance() (*WASMModuleInstance, error) {
 	instance := &WASMModuleInstance{
 		module:       module,
 		createdAt:    time.Now(),
+		trimmedAt:    linearMemorySize(module),
+		warm:         warm,
+		bell:         bell,
 		sharedBuffer: sharedBuffer,
 		fileSystem: &WASMFileSystem{
 			ctx:          p.ctx,
 			module:       module,
 			sharedBuffer: &sharedBuffer,
 			mu:           nil, // No mutex needed - each instance is single-threaded
+			abiCaps:      queryABICapabilities(module, p.ctx),
 		},
 	}
 
@@ -354,9 +472,112 @@ func (p *WASMInstancePool) createInstance() (*WASMModuleInstance, error) {
 			p.pluginName, sharedBuffer.InputBufferPtr, sharedBuffer.OutputBufferPtr, sharedBuffer.BufferSize)
 	}
 
+	p.metricsMu.Lock()
+	p.live[instance] = struct{}{}
+	p.metricsMu.Unlock()
+
 	return instance, nil
 }
 
+// trimInstance calls plugin_trim on an instance that is not in use
+func (p *WASMInstancePool) trimInstance(instance *WASMModuleInstance) {
+	released, ok := trimPluginMemory(p.ctx, instance.module)
+
+	instance.mu.Lock()
+	instance.trimmedAt = linearMemorySize(instance.module)
+	instance.trimmedReqs = instance.requestCount
+	instance.mu.Unlock()
+
+	if !ok {
+		return
+	}
+	log.Debugf("Trimmed WASM instance for %s: %d bytes released", p.pluginName, released)
+	if p.config.EnableStatistics {
+		p.stats.mu.Lock()
+		p.stats.TotalTrims++
+		p.stats.TrimmedBytes += released
+		p.stats.mu.Unlock()
+	}
+}
+
+// isSnapshotReady reports whether the instance's memory came from a
+// pre-initialized snapshot (C++ SDK AGFS_SDK_SNAPSHOT builds)
+func isSnapshotReady(module wazeroapi.Module, ctx context.Context) bool {
+	fn := module.ExportedFunction("plugin_snapshot_ready")
+	if fn == nil {
+		return false
+	}
+	results, err := fn.Call(ctx)
+	return err == nil && len(results) > 0 && results[0] != 0
+}
+
+// SetInitConfig sets the config JSON passed to plugin_initialize on each
+// instance before its next use. Instances already initialized with an
+// older config are initialized again; nil stops initializing.
+func (p *WASMInstancePool) SetInitConfig(configJSON []byte) {
+	p.mu.Lock()
+	p.initConfig = configJSON
+	p.initGen++
+	p.mu.Unlock()
+}
+
+// applyInitConfig initializes instance with the current init config unless
+// it already was. Snapshot instances are initialized too: the SDK skips the
+// work when the config equals the one baked into the snapshot.
+func (p *WASMInstancePool) applyInitConfig(instance *WASMModuleInstance) error {
+	p.mu.Lock()
+	configJSON, gen := p.initConfig, p.initGen
+	p.mu.Unlock()
+
+	instance.mu.Lock()
+	defer instance.mu.Unlock()
+	if instance.initGen == gen {
+		return nil
+	}
+	if configJSON != nil {
+		if err := callPluginInitialize(p.ctx, instance.module, configJSON); err != nil {
+			return err
+		}
+	}
+	instance.initGen = gen
+	return nil
+}
+
+// callPluginInitialize passes configJSON to the instance's plugin_initialize
+func callPluginInitialize(ctx context.Context, module wazeroapi.Module, configJSON []byte) error {
+	initFunc := module.ExportedFunction("plugin_initialize")
+	if initFunc == nil {
+		// If initialize function is not exported, assume initialization succeeds
+		return nil
+	}
+
+	// Write config to WASM memory
+	configPtr, configPtrSize, err := writeStringToMemory(module, string(configJSON))
+	if err != nil {
+		return fmt.Errorf("failed to write config to memory: %w", err)
+	}
+	defer freeWASMMemory(module, configPtr, configPtrSize)
+
+	// Call initialize function
+	results, err := initFunc.Call(ctx, uint64(configPtr))
+	if err != nil {
+		return fmt.Errorf("initialize call failed: %w", err)
+	}
+
+	// Check for error return
+	if len(results) > 0 && results[0] != 0 {
+		errPtr := uint32(results[0])
+		if errMsg, ok := readStringFromMemory(module, errPtr); ok {
+			freeWASMMemory(module, errPtr, 0)
+			return fmt.Errorf("initialization failed: %s", errMsg)
+		}
+		freeWASMMemory(module, errPtr, 0)
+		return fmt.Errorf("initialization failed")
+	}
+
+	return nil
+}
+
 // initializeSharedBuffer detects and initializes shared memory buffers
 func initializeSharedBuffer(module wazeroapi.Module, ctx context.Context) SharedBufferInfo {
 	info := SharedBufferInfo{Enabled: false}
@@ -405,13 +626,28 @@ func (p *WASMInstancePool) destroyInstance(instance *WASMModuleInstance) {
 		return
 	}
 
+	// Keep the instance's counters; it is not in use, so ask it directly
+	final, ok := readPluginMetrics(p.ctx, instance.module)
+	p.metricsMu.Lock()
+	if ok {
+		p.retiredMetrics.add(final)
+	} else {
+		p.retiredMetrics.add(instance.metrics)
+	}
+	delete(p.live, instance)
+	p.metricsMu.Unlock()
+
 	// Call plugin shutdown if available
 	if shutdownFunc := instance.module.ExportedFunction("plugin_shutdown"); shutdownFunc != nil {
 		shutdownFunc.Call(p.ctx)
 	}
 
-	// Close the module
-	instance.module.Close(p.ctx)
+	// Streams the instance left open would count toward maxHTTPStreams
+	closeModuleHTTPStreams(instance.module)
+
+	// Close the module (and the threads of a wasi-threads build)
+	unregisterNotifyBell(instance.module)
+	CloseWASMModule(p.ctx, instance.module)
 }
 
 // Close closes the pool and destroys all instances
@@ -443,6 +679,70 @@ func (p *WASMInstancePool) GetStats() PoolStats {
 	return p.stats
 }
 
+// GetPluginMetrics returns the plugin_get_metrics counters summed over all
+// instances the pool has run. Idle instances are queried; instances busy
+// with a request contribute their last snapshot. Plugins that do not export
+// plugin_get_metrics report no exports.
+func (p *WASMInstancePool) GetPluginMetrics() PluginMetrics {
+	p.forEachIdle(func(instance *WASMModuleInstance) {
+		if snapshot, ok := readPluginMetrics(p.ctx, instance.module); ok {
+			p.metricsMu.Lock()
+			instance.metrics = snapshot
+			p.metricsMu.Unlock()
+		}
+	})
+
+	p.metricsMu.Lock()
+	defer p.metricsMu.Unlock()
+	var total PluginMetrics
+	total.add(p.retiredMetrics)
+	for instance := range p.live {
+		total.add(instance.metrics)
+	}
+	return total
+}
+
+// GetPluginMemory returns the plugin_memory_stats of the idle instances
+// summed; instances busy with a request are skipped. Plugins that do not
+// export plugin_memory_stats report zero instances.
+func (p *WASMInstancePool) GetPluginMemory() PluginMemoryStats {
+	var total PluginMemoryStats
+	p.forEachIdle(func(instance *WASMModuleInstance) {
+		if stats, ok := readPluginMemoryStats(p.ctx, instance.module); ok {
+			total.add(stats)
+		}
+	})
+	return total
+}
+
+// forEachIdle calls fn on every instance idle in the pool, holding them
+// until all are visited so none is visited twice
+func (p *WASMInstancePool) forEachIdle(fn func(*WASMModuleInstance)) {
+	p.mu.Lock()
+	closed := p.closed
+	p.mu.Unlock()
+	if closed {
+		return
+	}
+
+	var idle []*WASMModuleInstance
+	for n := len(p.instances); n > 0; n-- {
+		var instance *WASMModuleInstance
+		select {
+		case instance = <-p.instances:
+		default:
+		}
+		if instance == nil {
+			break
+		}
+		idle = append(idle, instance)
+		fn(instance)
+	}
+	for _, instance := range idle {
+		p.putBack(instance)
+	}
+}
+
 // Execute executes a function with an instance from the pool
 // This is a convenience method that handles acquire/release automatically
 func (p *WASMInstancePool) Execute(fn func(*WASMModuleInstance) error) error {
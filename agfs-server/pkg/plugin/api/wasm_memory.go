@@ -0,0 +1,113 @@
+package api
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// PluginMemoryStats is the heap usage of one or more instances, reported by
+// plugins built with the C++ SDK through the optional plugin_memory_stats
+// export (see agfs_memory.h). Summed over a pool, the byte counts add up
+// and Fragmentation is the largest of the instances.
+type PluginMemoryStats struct {
+	MemoryBytes      uint64  `json:"memory_bytes"`
+	HeapBytes        uint64  `json:"heap_bytes"`
+	AllocBytes       uint64  `json:"alloc_bytes"`
+	AllocCount       uint64  `json:"alloc_count"`
+	AllocHighWater   uint64  `json:"alloc_high_water"`
+	ScratchBytes     uint64  `json:"scratch_bytes"`
+	ScratchHighWater uint64  `json:"scratch_high_water"`
+	PoolBytes        uint64  `json:"pool_bytes"`
+	PoolFreeBytes    uint64  `json:"pool_free_bytes"`
+	Fragmentation    float64 `json:"fragmentation"`
+	Instances        int     `json:"instances"`
+}
+
+// pluginMemoryStatsVersion is the plugin_memory_stats format this host reads
+const pluginMemoryStatsVersion = 1
+
+func parsePluginMemoryStats(data []byte) (PluginMemoryStats, error) {
+	var wire struct {
+		Version int `json:"version"`
+		PluginMemoryStats
+	}
+	if err := json.Unmarshal(data, &wire); err != nil {
+		return PluginMemoryStats{}, err
+	}
+	if wire.Version != pluginMemoryStatsVersion {
+		return PluginMemoryStats{}, fmt.Errorf("unsupported plugin memory stats version %d", wire.Version)
+	}
+	stats := wire.PluginMemoryStats
+	stats.Instances = 1
+	return stats, nil
+}
+
+// add accumulates other into s
+func (s *PluginMemoryStats) add(other PluginMemoryStats) {
+	s.MemoryBytes += other.MemoryBytes
+	s.HeapBytes += other.HeapBytes
+	s.AllocBytes += other.AllocBytes
+	s.AllocCount += other.AllocCount
+	s.AllocHighWater += other.AllocHighWater
+	s.ScratchBytes += other.ScratchBytes
+	s.ScratchHighWater += other.ScratchHighWater
+	s.PoolBytes += other.PoolBytes
+	s.PoolFreeBytes += other.PoolFreeBytes
+	if other.Fragmentation > s.Fragmentation {
+		s.Fragmentation = other.Fragmentation
+	}
+	s.Instances += other.Instances
+}
+
+// readPluginMemoryStats calls plugin_memory_stats on an instance that is
+// not in use. ok is false when the module does not export it.
+func readPluginMemoryStats(ctx context.Context, module wazeroapi.Module) (stats PluginMemoryStats, ok bool) {
+	fn := module.ExportedFunction("plugin_memory_stats")
+	if fn == nil {
+		return PluginMemoryStats{}, false
+	}
+	results, err := fn.Call(ctx)
+	if err != nil || len(results) == 0 || results[0] == 0 {
+		return PluginMemoryStats{}, false
+	}
+	ptr := uint32(results[0])
+	defer freeWASMMemory(module, ptr, 0)
+
+	jsonStr, found := readStringFromMemory(module, ptr)
+	if !found {
+		return PluginMemoryStats{}, false
+	}
+	stats, err = parsePluginMemoryStats([]byte(jsonStr))
+	if err != nil {
+		return PluginMemoryStats{}, false
+	}
+	return stats, true
+}
+
+// trimPluginMemory calls plugin_trim on an instance that is not in use and
+// returns the bytes the plugin released. ok is false when the module does
+// not export it.
+func trimPluginMemory(ctx context.Context, module wazeroapi.Module) (released uint64, ok bool) {
+	fn := module.ExportedFunction("plugin_trim")
+	if fn == nil {
+		return 0, false
+	}
+	results, err := fn.Call(ctx)
+	if err != nil || len(results) == 0 {
+		return 0, false
+	}
+	return results[0], true
+}
+
+// linearMemorySize is the instance's linear memory size in bytes; linear
+// memory never shrinks, so this is what the instance costs the host
+func linearMemorySize(module wazeroapi.Module) uint64 {
+	mem := module.Memory()
+	if mem == nil {
+		return 0
+	}
+	return uint64(mem.Size())
+}
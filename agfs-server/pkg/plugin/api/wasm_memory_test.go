@@ -0,0 +1,39 @@
+package api
+
+import "testing"
+
+func TestParsePluginMemoryStats(t *testing.T) {
+	data := []byte(`{"version":1,"memory_bytes":4194304,"heap_bytes":3145728,"alloc_bytes":1048576,"alloc_count":12,"alloc_high_water":2097152,"scratch_bytes":16400,"scratch_high_water":9000,"pool_bytes":32768,"pool_free_bytes":1024,"fragmentation":0.65}`)
+	s, err := parsePluginMemoryStats(data)
+	if err != nil {
+		t.Fatal(err)
+	}
+	want := PluginMemoryStats{
+		MemoryBytes: 4194304, HeapBytes: 3145728, AllocBytes: 1048576, AllocCount: 12,
+		AllocHighWater: 2097152, ScratchBytes: 16400, ScratchHighWater: 9000,
+		PoolBytes: 32768, PoolFreeBytes: 1024, Fragmentation: 0.65, Instances: 1,
+	}
+	if s != want {
+		t.Fatalf("stats = %+v, want %+v", s, want)
+	}
+
+	if _, err := parsePluginMemoryStats([]byte(`{"version":2}`)); err == nil {
+		t.Fatal("expected an error for an unknown version")
+	}
+	if _, err := parsePluginMemoryStats([]byte(`not json`)); err == nil {
+		t.Fatal("expected an error for malformed input")
+	}
+}
+
+func TestPluginMemoryStatsAdd(t *testing.T) {
+	var total PluginMemoryStats
+	total.add(PluginMemoryStats{MemoryBytes: 100, AllocBytes: 10, Fragmentation: 0.5, Instances: 1})
+	total.add(PluginMemoryStats{MemoryBytes: 50, AllocBytes: 5, Fragmentation: 0.2, Instances: 1})
+
+	if total.MemoryBytes != 150 || total.AllocBytes != 15 || total.Instances != 2 {
+		t.Fatalf("total = %+v", total)
+	}
+	if total.Fragmentation != 0.5 {
+		t.Fatalf("fragmentation = %v, want the largest instance's 0.5", total.Fragmentation)
+	}
+}
@@ -0,0 +1,117 @@
+package api
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+
+	wazeroapi "github.com/tetratelabs/wazero/api"
+)
+
+// PluginOpMetrics are the counters of one export, reported by plugins
+// built with the C++ SDK through the optional plugin_get_metrics export
+// (see agfs_metrics.h).
+//
+// TotalNs covers the whole export, UserNs the plugin method inside it and
+// HostNs the host imports the method made, so TotalNs-UserNs is SDK
+// overhead (JSON, encoding, copies) and UserNs-HostNs the plugin's own work.
+type PluginOpMetrics struct {
+	Calls     uint64 `json:"calls"`
+	Errors    uint64 `json:"errors"`
+	TotalNs   uint64 `json:"total_ns"`
+	UserNs    uint64 `json:"user_ns"`
+	HostNs    uint64 `json:"host_ns"`
+	HostCalls uint64 `json:"host_calls"`
+	BytesIn   uint64 `json:"bytes_in"`
+	BytesOut  uint64 `json:"bytes_out"`
+}
+
+// PluginMetrics holds the counters of one or more instances, keyed by export name
+type PluginMetrics struct {
+	Exports map[string]PluginOpMetrics `json:"exports"`
+}
+
+// pluginMetricsVersion is the plugin_get_metrics format this host reads
+const pluginMetricsVersion = 1
+
+func parsePluginMetrics(data []byte) (PluginMetrics, error) {
+	var wire struct {
+		Version int                        `json:"version"`
+		Exports map[string]PluginOpMetrics `json:"exports"`
+	}
+	if err := json.Unmarshal(data, &wire); err != nil {
+		return PluginMetrics{}, err
+	}
+	if wire.Version != pluginMetricsVersion {
+		return PluginMetrics{}, fmt.Errorf("unsupported plugin metrics version %d", wire.Version)
+	}
+	return PluginMetrics{Exports: wire.Exports}, nil
+}
+
+// add accumulates other into m
+func (m *PluginMetrics) add(other PluginMetrics) {
+	if len(other.Exports) == 0 {
+		return
+	}
+	if m.Exports == nil {
+		m.Exports = make(map[string]PluginOpMetrics, len(other.Exports))
+	}
+	for name, o := range other.Exports {
+		s := m.Exports[name]
+		s.Calls += o.Calls
+		s.Errors += o.Errors
+		s.TotalNs += o.TotalNs
+		s.UserNs += o.UserNs
+		s.HostNs += o.HostNs
+		s.HostCalls += o.HostCalls
+		s.BytesIn += o.BytesIn
+		s.BytesOut += o.BytesOut
+		m.Exports[name] = s
+	}
+}
+
+// readPluginMetrics calls plugin_get_metrics on an instance that is not
+// in use. ok is false when the module does not export it.
+func readPluginMetrics(ctx context.Context, module wazeroapi.Module) (metrics PluginMetrics, ok bool) {
+	fn := module.ExportedFunction("plugin_get_metrics")
+	if fn == nil {
+		return PluginMetrics{}, false
+	}
+	results, err := fn.Call(ctx)
+	if err != nil || len(results) == 0 || results[0] == 0 {
+		return PluginMetrics{}, false
+	}
+	ptr := uint32(results[0])
+	defer freeWASMMemory(module, ptr, 0)
+
+	jsonStr, found := readStringFromMemory(module, ptr)
+	if !found {
+		return PluginMetrics{}, false
+	}
+	metrics, err = parsePluginMetrics([]byte(jsonStr))
+	if err != nil {
+		return PluginMetrics{}, false
+	}
+	return metrics, true
+}
+
+// WASMRuntimeStats describes a WASM plugin's instance pool and the
+// counters and heap usage its instances report
+type WASMRuntimeStats struct {
+	Plugin  string            `json:"plugin"`
+	Pool    *PoolStats        `json:"pool"`
+	Metrics PluginMetrics     `json:"metrics"`
+	Memory  PluginMemoryStats `json:"memory"`
+}
+
+// GetRuntimeStats returns the pool statistics, plugin metrics and heap
+// usage of wp
+func (wp *WASMPlugin) GetRuntimeStats() WASMRuntimeStats {
+	pool := wp.instancePool.GetStats()
+	return WASMRuntimeStats{
+		Plugin:  wp.name,
+		Pool:    &pool,
+		Metrics: wp.instancePool.GetPluginMetrics(),
+		Memory:  wp.instancePool.GetPluginMemory(),
+	}
+}
@@ -0,0 +1,50 @@
+package api
+
+import "testing"
+
+func TestParsePluginMetrics(t *testing.T) {
+	data := []byte(`{"version":1,"exports":{"fs_read":{"calls":3,"errors":1,"total_ns":900,"user_ns":700,"host_ns":500,"host_calls":3,"bytes_in":0,"bytes_out":20}}}`)
+	m, err := parsePluginMetrics(data)
+	if err != nil {
+		t.Fatal(err)
+	}
+	want := PluginOpMetrics{Calls: 3, Errors: 1, TotalNs: 900, UserNs: 700, HostNs: 500, HostCalls: 3, BytesOut: 20}
+	if got := m.Exports["fs_read"]; got != want {
+		t.Fatalf("fs_read = %+v, want %+v", got, want)
+	}
+
+	if _, err := parsePluginMetrics([]byte(`{"version":2,"exports":{}}`)); err == nil {
+		t.Fatal("expected an error for an unknown version")
+	}
+	if _, err := parsePluginMetrics([]byte(`not json`)); err == nil {
+		t.Fatal("expected an error for malformed input")
+	}
+}
+
+func TestPluginMetricsAdd(t *testing.T) {
+	var total PluginMetrics
+	total.add(PluginMetrics{})
+	if total.Exports != nil {
+		t.Fatal("adding empty metrics should not allocate")
+	}
+
+	a := PluginMetrics{Exports: map[string]PluginOpMetrics{
+		"fs_read": {Calls: 2, TotalNs: 10, BytesOut: 100},
+	}}
+	b := PluginMetrics{Exports: map[string]PluginOpMetrics{
+		"fs_read":  {Calls: 1, Errors: 1, TotalNs: 5},
+		"fs_write": {Calls: 4, BytesIn: 40},
+	}}
+	total.add(a)
+	total.add(b)
+
+	if got := total.Exports["fs_read"]; got.Calls != 3 || got.Errors != 1 || got.TotalNs != 15 || got.BytesOut != 100 {
+		t.Fatalf("fs_read = %+v", got)
+	}
+	if got := total.Exports["fs_write"]; got.Calls != 4 || got.BytesIn != 40 {
+		t.Fatalf("fs_write = %+v", got)
+	}
+	if a.Exports["fs_read"].Calls != 2 {
+		t.Fatal("add modified its argument")
+	}
+}
@@ -39,6 +39,7 @@ type WASMFileSystem struct {
 	module       wazeroapi.Module
 	sharedBuffer *SharedBufferInfo // Shared memory buffer info (can be nil)
 	mu           *sync.Mutex       // Mutex for single instance (can be nil if instance is not shared)
+	abiCaps      uint32            // Capabilities reported by plugin_abi_caps
 }
 
 // NewWASMPluginWithPool creates a new WASM plugin wrapper with an instance pool
@@ -118,45 +119,21 @@ func (wp *WASMPlugin) Validate(config map[string]interface{}) error {
 
 // Initialize initializes the plugin with configuration
 func (wp *WASMPlugin) Initialize(config map[string]interface{}) error {
-	return wp.instancePool.Execute(func(instance *WASMModuleInstance) error {
-		initFunc := instance.module.ExportedFunction("plugin_initialize")
-		if initFunc == nil {
-			// If initialize function is not exported, assume initialization succeeds
-			return nil
-		}
-
-		// Convert config to JSON
-		configJSON, err := json.Marshal(config)
-		if err != nil {
-			return fmt.Errorf("failed to marshal config: %w", err)
-		}
-
-		// Write config to WASM memory
-		configPtr, configPtrSize, err := writeStringToMemory(instance.module, string(configJSON))
-		if err != nil {
-			return fmt.Errorf("failed to write config to memory: %w", err)
-		}
-		defer freeWASMMemory(instance.module, configPtr, configPtrSize)
-
-		// Call initialize function
-		results, err := initFunc.Call(wp.instancePool.ctx, uint64(configPtr))
-		if err != nil {
-			return fmt.Errorf("initialize call failed: %w", err)
-		}
-
-		// Check for error return
-		if len(results) > 0 && results[0] != 0 {
-			errPtr := uint32(results[0])
-			if errMsg, ok := readStringFromMemory(instance.module, errPtr); ok {
-				freeWASMMemory(instance.module, errPtr, 0)
-				return fmt.Errorf("initialization failed: %s", errMsg)
-			}
-			freeWASMMemory(instance.module, errPtr, 0)
-			return fmt.Errorf("initialization failed")
-		}
+	// Convert config to JSON
+	configJSON, err := json.Marshal(config)
+	if err != nil {
+		return fmt.Errorf("failed to marshal config: %w", err)
+	}
 
-		return nil
-	})
+	// Every instance, including those the pool creates later, is
+	// initialized with the config before its first use; acquiring one now
+	// surfaces initialization errors at mount time
+	wp.instancePool.SetInitConfig(configJSON)
+	if err := wp.instancePool.Execute(func(*WASMModuleInstance) error { return nil }); err != nil {
+		wp.instancePool.SetInitConfig(nil)
+		return err
+	}
+	return nil
 }
 
 // GetFileSystem returns the file system implementation
@@ -550,13 +527,7 @@ func (wfs *WASMFileSystem) Create(path string) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("create failed")
+		return wfs.pluginError(uint32(results[0]), "create failed")
 	}
 
 	return nil
@@ -580,13 +551,7 @@ func (wfs *WASMFileSystem) Mkdir(path string, perm uint32) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("mkdir failed")
+		return wfs.pluginError(uint32(results[0]), "mkdir failed")
 	}
 
 	return nil
@@ -610,13 +575,7 @@ func (wfs *WASMFileSystem) Remove(path string) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("remove failed")
+		return wfs.pluginError(uint32(results[0]), "remove failed")
 	}
 
 	return nil
@@ -641,13 +600,7 @@ func (wfs *WASMFileSystem) RemoveAll(path string) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("remove_all failed")
+		return wfs.pluginError(uint32(results[0]), "remove_all failed")
 	}
 
 	return nil
@@ -681,23 +634,32 @@ func (wfs *WASMFileSystem) Read(path string, offset int64, size int64) ([]byte,
 		return nil, fmt.Errorf("fs_read returned invalid results")
 	}
 
-	// Unpack u64: lower 32 bits = pointer, upper 32 bits = size
+	// Unpack u64: lower 32 bits = pointer, upper 32 bits = size; a null
+	// pointer is an error, whose slot is the upper half (ABICapErrorCodes)
 	packed := results[0]
 	dataPtr := uint32(packed & 0xFFFFFFFF)
 	dataSize := uint32((packed >> 32) & 0xFFFFFFFF)
 
 	if dataPtr == 0 {
+		if wfs.abiCaps&ABICapErrorCodes != 0 && dataSize != 0 {
+			return nil, wfs.pluginError(dataSize, "read failed")
+		}
 		return nil, fmt.Errorf("read failed")
 	}
 
-	data, ok := wfs.module.Memory().Read(dataPtr, dataSize)
+	view, ok := wfs.module.Memory().Read(dataPtr, dataSize)
 	if !ok {
-		freeWASMMemory(wfs.module, dataPtr, 0)
+		freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
 		return nil, fmt.Errorf("failed to read data from memory")
 	}
 
-	// Free WASM memory after copying data
-	freeWASMMemory(wfs.module, dataPtr, 0)
+	// Copy out of WASM memory: the view aliases linear memory, and small reads
+	// are returned in the plugin's output buffer, which the next call reuses
+	data := make([]byte, dataSize)
+	copy(data, view)
+
+	// Free WASM memory after copying data (no-op for the shared output buffer)
+	freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
 
 	return data, nil
 }
@@ -708,11 +670,13 @@ func (wfs *WASMFileSystem) Write(path string, data []byte, offset int64, flags f
 		return 0, fmt.Errorf("fs_write not implemented")
 	}
 
-	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	// The input buffer is reserved for the payload, so the path always goes
+	// through malloc; otherwise the data would overwrite it
+	pathPtr, pathPtrSize, err := writeStringToMemory(wfs.module, path)
 	if err != nil {
 		return 0, err
 	}
-	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+	defer freeWASMMemory(wfs.module, pathPtr, pathPtrSize)
 
 	dataPtr, dataPtrSize, err := writeBytesToMemoryWithBuffer(wfs.module, data, wfs.sharedBuffer)
 	if err != nil {
@@ -737,18 +701,139 @@ func (wfs *WASMFileSystem) Write(path string, data []byte, offset int64, flags f
 
 	if errPtr != 0 {
 		// Read error message from WASM memory
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("write failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("write failed")
+		return 0, wfs.pluginError(errPtr, "write failed")
 	}
 
 	return int64(bytesWritten), nil
 }
 
+// callFileInfoBinary calls fs_stat_bin / fs_readdir_bin and decodes the binary FileInfo result
+func (wfs *WASMFileSystem) callFileInfoBinary(funcName string, path string) ([]filesystem.FileInfo, error) {
+	fn := wfs.module.ExportedFunction(funcName)
+	if fn == nil {
+		return nil, fmt.Errorf("%s not implemented", funcName)
+	}
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	results, err := fn.Call(wfs.ctx, uint64(pathPtr))
+	if err != nil {
+		return nil, fmt.Errorf("%s failed: %w", funcName, err)
+	}
+	if len(results) < 1 {
+		return nil, fmt.Errorf("%s returned invalid results", funcName)
+	}
+
+	// Unpack u64: lower 32 bits = buffer pointer, upper 32 bits = error pointer
+	packed := results[0]
+	bufPtr := uint32(packed & 0xFFFFFFFF)
+	errPtr := uint32((packed >> 32) & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		return nil, wfs.pluginError(errPtr, funcName+" failed")
+	}
+	if bufPtr == 0 {
+		return nil, fmt.Errorf("%s returned null", funcName)
+	}
+
+	// Small results come back in the shared output buffer, which is never freed
+	data, ok := readBinaryFromMemory(wfs.module, bufPtr)
+	freeWASMMemoryWithBuffer(wfs.module, bufPtr, 0, wfs.sharedBuffer)
+	if !ok {
+		return nil, fmt.Errorf("failed to read %s result", funcName)
+	}
+
+	return decodeFileInfos(data)
+}
+
+// defaultReadDirPageSize is the number of entries requested per fs_readdir_page call
+const defaultReadDirPageSize = 1024
+
+// readDirPage calls fs_readdir_page: up to maxEntries entries of path from
+// cursor, and the cursor of the next page ("" when done)
+func (wfs *WASMFileSystem) readDirPage(path string, cursor string, maxEntries int) ([]filesystem.FileInfo, string, error) {
+	pageFunc := wfs.module.ExportedFunction("fs_readdir_page")
+	if pageFunc == nil {
+		return nil, "", fmt.Errorf("fs_readdir_page not implemented")
+	}
+	if maxEntries < 0 {
+		maxEntries = 0
+	}
+
+	pathPtr, pathPtrSize, err := writeStringToMemoryWithBuffer(wfs.module, path, wfs.sharedBuffer)
+	if err != nil {
+		return nil, "", err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, pathPtr, pathPtrSize, wfs.sharedBuffer)
+
+	// The cursor is allocated separately since the path occupies the input buffer
+	var cursorPtr, cursorPtrSize uint32
+	if cursor != "" {
+		cursorPtr, cursorPtrSize, err = writeStringToMemory(wfs.module, cursor)
+		if err != nil {
+			return nil, "", err
+		}
+		defer freeWASMMemory(wfs.module, cursorPtr, cursorPtrSize)
+	}
+
+	results, err := pageFunc.Call(wfs.ctx, uint64(pathPtr), uint64(cursorPtr), uint64(maxEntries))
+	if err != nil {
+		return nil, "", fmt.Errorf("fs_readdir_page failed: %w", err)
+	}
+	if len(results) < 1 {
+		return nil, "", fmt.Errorf("fs_readdir_page returned invalid results")
+	}
+
+	// Unpack u64: lower 32 bits = page pointer, upper 32 bits = error pointer
+	packed := results[0]
+	pagePtr := uint32(packed & 0xFFFFFFFF)
+	errPtr := uint32((packed >> 32) & 0xFFFFFFFF)
+
+	if errPtr != 0 {
+		return nil, "", wfs.pluginError(errPtr, "readdir page failed")
+	}
+	if pagePtr == 0 {
+		return nil, "", fmt.Errorf("fs_readdir_page returned null")
+	}
+
+	infos, next, err := readDirPageFromMemory(wfs.module, pagePtr)
+	freeWASMMemoryWithBuffer(wfs.module, pagePtr, 0, wfs.sharedBuffer)
+	if err != nil {
+		return nil, "", err
+	}
+	return infos, next, nil
+}
+
 func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
+	// Lazy plugins are listed page by page so their memory stays bounded
+	if wfs.abiCaps&ABICapReadDirPage != 0 {
+		var all []filesystem.FileInfo
+		cursor := ""
+		for {
+			infos, next, err := wfs.readDirPage(path, cursor, defaultReadDirPageSize)
+			if err != nil {
+				return nil, err
+			}
+			all = append(all, infos...)
+			if next == "" || next == cursor {
+				break
+			}
+			cursor = next
+		}
+		if all == nil {
+			all = []filesystem.FileInfo{}
+		}
+		return all, nil
+	}
+
+	if wfs.abiCaps&ABICapBinaryFileInfo != 0 {
+		return wfs.callFileInfoBinary("fs_readdir_bin", path)
+	}
+
 	readDirFunc := wfs.module.ExportedFunction("fs_readdir")
 	if readDirFunc == nil {
 		return nil, fmt.Errorf("fs_readdir not implemented")
@@ -776,12 +861,7 @@ func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
 
 	// Check for error
 	if errPtr != 0 {
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return nil, fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return nil, fmt.Errorf("readdir failed")
+		return nil, wfs.pluginError(errPtr, "readdir failed")
 	}
 
 	if jsonPtr == 0 {
@@ -790,12 +870,12 @@ func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
 
 	jsonStr, ok := readStringFromMemory(wfs.module, jsonPtr)
 	if !ok {
-		freeWASMMemory(wfs.module, jsonPtr, 0)
+		freeWASMMemoryWithBuffer(wfs.module, jsonPtr, 0, wfs.sharedBuffer)
 		return nil, fmt.Errorf("failed to read readdir result")
 	}
 
-	// Free WASM memory after reading
-	freeWASMMemory(wfs.module, jsonPtr, 0)
+	// Free WASM memory after reading (unless it is the shared output buffer)
+	freeWASMMemoryWithBuffer(wfs.module, jsonPtr, 0, wfs.sharedBuffer)
 
 	var fileInfos []filesystem.FileInfo
 	if err := json.Unmarshal([]byte(jsonStr), &fileInfos); err != nil {
@@ -807,6 +887,17 @@ func (wfs *WASMFileSystem) ReadDir(path string) ([]filesystem.FileInfo, error) {
 
 func (wfs *WASMFileSystem) Stat(path string) (*filesystem.FileInfo, error) {
 	log.Debugf("WASM Stat called with path: %s", path)
+	if wfs.abiCaps&ABICapBinaryFileInfo != 0 {
+		infos, err := wfs.callFileInfoBinary("fs_stat_bin", path)
+		if err != nil {
+			return nil, err
+		}
+		if len(infos) != 1 {
+			return nil, fmt.Errorf("fs_stat_bin returned %d entries", len(infos))
+		}
+		return &infos[0], nil
+	}
+
 	statFunc := wfs.module.ExportedFunction("fs_stat")
 	if statFunc == nil {
 		return nil, fmt.Errorf("fs_stat not implemented")
@@ -838,12 +929,7 @@ func (wfs *WASMFileSystem) Stat(path string) (*filesystem.FileInfo, error) {
 
 	// Check for error
 	if errPtr != 0 {
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return nil, fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return nil, fmt.Errorf("stat failed")
+		return nil, wfs.pluginError(errPtr, "stat failed")
 	}
 
 	if jsonPtr == 0 {
@@ -852,12 +938,12 @@ func (wfs *WASMFileSystem) Stat(path string) (*filesystem.FileInfo, error) {
 
 	jsonStr, ok := readStringFromMemory(wfs.module, jsonPtr)
 	if !ok {
-		freeWASMMemory(wfs.module, jsonPtr, 0)
+		freeWASMMemoryWithBuffer(wfs.module, jsonPtr, 0, wfs.sharedBuffer)
 		return nil, fmt.Errorf("failed to read stat result")
 	}
 
-	// Free WASM memory after reading
-	freeWASMMemory(wfs.module, jsonPtr, 0)
+	// Free WASM memory after reading (unless it is the shared output buffer)
+	freeWASMMemoryWithBuffer(wfs.module, jsonPtr, 0, wfs.sharedBuffer)
 
 	var fileInfo filesystem.FileInfo
 	if err := json.Unmarshal([]byte(jsonStr), &fileInfo); err != nil {
@@ -891,13 +977,7 @@ func (wfs *WASMFileSystem) Rename(oldPath, newPath string) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("rename failed")
+		return wfs.pluginError(uint32(results[0]), "rename failed")
 	}
 
 	return nil
@@ -922,13 +1002,7 @@ func (wfs *WASMFileSystem) Chmod(path string, mode uint32) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		if errMsg, ok := readStringFromMemory(wfs.module, errPtr); ok {
-			freeWASMMemory(wfs.module, errPtr, 0)
-			return fmt.Errorf("%s", errMsg)
-		}
-		freeWASMMemory(wfs.module, errPtr, 0)
-		return fmt.Errorf("chmod failed")
+		return wfs.pluginError(uint32(results[0]), "chmod failed")
 	}
 
 	return nil
@@ -993,12 +1067,7 @@ func (wfs *WASMFileSystem) OpenHandle(path string, flags filesystem.OpenFlag, mo
 	handleID := int64(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return nil, fmt.Errorf("open handle failed: %s", errMsg)
-		}
-		return nil, fmt.Errorf("open handle failed")
+		return nil, wfs.pluginError(errPtr, "open handle failed")
 	}
 
 	if handleID == 0 {
@@ -1056,12 +1125,7 @@ func (wfs *WASMFileSystem) handleRead(id int64, buf []byte) (int, error) {
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("read failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("read failed")
+		return 0, wfs.pluginError(errPtr, "read failed")
 	}
 
 	// Copy data from WASM memory to buf
@@ -1103,12 +1167,7 @@ func (wfs *WASMFileSystem) handleReadAt(id int64, buf []byte, offset int64) (int
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("read at failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("read at failed")
+		return 0, wfs.pluginError(errPtr, "read at failed")
 	}
 
 	if bytesRead > 0 {
@@ -1149,12 +1208,7 @@ func (wfs *WASMFileSystem) handleWrite(id int64, data []byte) (int, error) {
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("write failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("write failed")
+		return 0, wfs.pluginError(errPtr, "write failed")
 	}
 
 	return int(bytesWritten), nil
@@ -1187,12 +1241,7 @@ func (wfs *WASMFileSystem) handleWriteAt(id int64, data []byte, offset int64) (i
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("write at failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("write at failed")
+		return 0, wfs.pluginError(errPtr, "write at failed")
 	}
 
 	return int(bytesWritten), nil
@@ -1219,12 +1268,7 @@ func (wfs *WASMFileSystem) handleSeek(id int64, offset int64, whence int) (int64
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return 0, fmt.Errorf("seek failed: %s", errMsg)
-		}
-		return 0, fmt.Errorf("seek failed")
+		return 0, wfs.pluginError(errPtr, "seek failed")
 	}
 
 	return int64(newPos), nil
@@ -1242,13 +1286,7 @@ func (wfs *WASMFileSystem) handleSync(id int64) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return fmt.Errorf("sync failed: %s", errMsg)
-		}
-		return fmt.Errorf("sync failed")
+		return wfs.pluginError(uint32(results[0]), "sync failed")
 	}
 
 	return nil
@@ -1266,13 +1304,7 @@ func (wfs *WASMFileSystem) handleClose(id int64) error {
 	}
 
 	if len(results) > 0 && results[0] != 0 {
-		errPtr := uint32(results[0])
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return fmt.Errorf("close failed: %s", errMsg)
-		}
-		return fmt.Errorf("close failed")
+		return wfs.pluginError(uint32(results[0]), "close failed")
 	}
 
 	return nil
@@ -1299,12 +1331,7 @@ func (wfs *WASMFileSystem) handleStat(id int64) (*filesystem.FileInfo, error) {
 	errPtr := uint32(packed >> 32)
 
 	if errPtr != 0 {
-		errMsg, ok := readStringFromMemory(wfs.module, errPtr)
-		freeWASMMemory(wfs.module, errPtr, 0)
-		if ok && errMsg != "" {
-			return nil, fmt.Errorf("stat failed: %s", errMsg)
-		}
-		return nil, fmt.Errorf("stat failed")
+		return nil, wfs.pluginError(errPtr, "stat failed")
 	}
 
 	if jsonPtr == 0 {
@@ -1312,7 +1339,7 @@ func (wfs *WASMFileSystem) handleStat(id int64) (*filesystem.FileInfo, error) {
 	}
 
 	jsonStr, ok := readStringFromMemory(wfs.module, jsonPtr)
-	freeWASMMemory(wfs.module, jsonPtr, 0)
+	freeWASMMemoryWithBuffer(wfs.module, jsonPtr, 0, wfs.sharedBuffer)
 	if !ok {
 		return nil, fmt.Errorf("failed to read stat result")
 	}
@@ -0,0 +1,118 @@
+package api
+
+import (
+	"encoding/binary"
+	"fmt"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+// fs_readv wire format (little-endian), see readv_export in the C++ SDK:
+//
+//	request: count x (i64 offset, i64 size)
+//	result:  count x u32 length, then the ranges' bytes back to back
+const readRangeSize = 16
+
+func encodeReadRanges(ranges []filesystem.ReadRange) []byte {
+	buf := make([]byte, len(ranges)*readRangeSize)
+	for i, r := range ranges {
+		binary.LittleEndian.PutUint64(buf[i*readRangeSize:], uint64(r.Offset))
+		binary.LittleEndian.PutUint64(buf[i*readRangeSize+8:], uint64(r.Size))
+	}
+	return buf
+}
+
+// decodeReadvResult splits an fs_readv result into count ranges; they
+// share one copy of the data, so data may alias WASM memory
+func decodeReadvResult(data []byte, count int) ([][]byte, error) {
+	header := count * 4
+	if len(data) < header {
+		return nil, fmt.Errorf("fs_readv result too short: %d bytes for %d ranges", len(data), count)
+	}
+	body := make([]byte, len(data)-header)
+	copy(body, data[header:])
+
+	out := make([][]byte, count)
+	pos := 0
+	for i := range out {
+		n := int(binary.LittleEndian.Uint32(data[i*4:]))
+		if n > len(body)-pos {
+			return nil, fmt.Errorf("fs_readv range %d overruns the result", i)
+		}
+		out[i] = body[pos : pos+n : pos+n]
+		pos += n
+	}
+	return out, nil
+}
+
+// ReadV implements filesystem.VectorReader with one fs_readv call, or one
+// fs_read per range for plugins without the export
+func (wfs *WASMFileSystem) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	readvFunc := wfs.module.ExportedFunction("fs_readv")
+	if readvFunc == nil {
+		return filesystem.NewBaseFileSystem(wfs).ReadV(path, ranges)
+	}
+
+	if wfs.mu != nil {
+		wfs.mu.Lock()
+		defer wfs.mu.Unlock()
+	}
+
+	// The ranges take the input buffer, so the path goes through malloc
+	pathPtr, pathPtrSize, err := writeStringToMemory(wfs.module, path)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemory(wfs.module, pathPtr, pathPtrSize)
+
+	rangesPtr, rangesPtrSize, err := writeBytesToMemoryWithBuffer(wfs.module, encodeReadRanges(ranges), wfs.sharedBuffer)
+	if err != nil {
+		return nil, err
+	}
+	defer freeWASMMemoryWithBuffer(wfs.module, rangesPtr, rangesPtrSize, wfs.sharedBuffer)
+
+	results, err := readvFunc.Call(wfs.ctx, uint64(pathPtr), uint64(rangesPtr), uint64(len(ranges)))
+	if err != nil {
+		return nil, fmt.Errorf("fs_readv failed: %w", err)
+	}
+	if len(results) < 1 {
+		return nil, fmt.Errorf("fs_readv returned invalid results")
+	}
+
+	// Unpack u64 like fs_read: lower 32 bits = pointer, upper 32 bits = size,
+	// or a null pointer and the error slot
+	packed := results[0]
+	dataPtr := uint32(packed & 0xFFFFFFFF)
+	dataSize := uint32((packed >> 32) & 0xFFFFFFFF)
+	if dataPtr == 0 {
+		if dataSize != 0 {
+			return nil, wfs.pluginError(dataSize, "readv failed")
+		}
+		return nil, fmt.Errorf("readv failed")
+	}
+
+	// Results that fit come back in the shared output buffer, which is never freed
+	view, ok := wfs.module.Memory().Read(dataPtr, dataSize)
+	if !ok {
+		freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
+		return nil, fmt.Errorf("failed to read data from memory")
+	}
+	out, err := decodeReadvResult(view, len(ranges))
+	freeWASMMemoryWithBuffer(wfs.module, dataPtr, 0, wfs.sharedBuffer)
+	return out, err
+}
+
+// ReadV implements filesystem.VectorReader on one pooled instance
+func (pfs *PooledWASMFileSystem) ReadV(path string, ranges []filesystem.ReadRange) ([][]byte, error) {
+	var out [][]byte
+	err := pfs.pool.ExecuteFS(func(fs filesystem.FileSystem) error {
+		var readErr error
+		if reader, ok := fs.(filesystem.VectorReader); ok {
+			out, readErr = reader.ReadV(path, ranges)
+		} else {
+			out, readErr = filesystem.NewBaseFileSystem(fs).ReadV(path, ranges)
+		}
+		return readErr
+	})
+	return out, err
+}
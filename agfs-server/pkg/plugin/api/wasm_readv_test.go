@@ -0,0 +1,47 @@
+package api
+
+import (
+	"encoding/binary"
+	"testing"
+
+	"github.com/c4pt0r/agfs/agfs-server/pkg/filesystem"
+)
+
+func TestEncodeReadRanges(t *testing.T) {
+	buf := encodeReadRanges([]filesystem.ReadRange{{Offset: 7, Size: 3}, {Offset: -1, Size: 0}})
+	if len(buf) != 2*readRangeSize {
+		t.Fatalf("expected %d bytes, got %d", 2*readRangeSize, len(buf))
+	}
+	if binary.LittleEndian.Uint64(buf[0:]) != 7 || binary.LittleEndian.Uint64(buf[8:]) != 3 {
+		t.Errorf("unexpected first range %v", buf[:16])
+	}
+	if int64(binary.LittleEndian.Uint64(buf[16:])) != -1 {
+		t.Errorf("unexpected second offset %v", buf[16:24])
+	}
+}
+
+func TestDecodeReadvResult(t *testing.T) {
+	data := []byte{3, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0}
+	data = append(data, "abcde"...)
+
+	out, err := decodeReadvResult(data, 3)
+	if err != nil {
+		t.Fatalf("decode failed: %v", err)
+	}
+	if len(out) != 3 || string(out[0]) != "abc" || len(out[1]) != 0 || string(out[2]) != "de" {
+		t.Fatalf("unexpected ranges %q", out)
+	}
+
+	// Ranges are copied out of the (WASM) buffer
+	data[12] = 'x'
+	if string(out[0]) != "abc" {
+		t.Errorf("range aliases the input")
+	}
+
+	if _, err := decodeReadvResult(data[:8], 3); err == nil {
+		t.Errorf("expected an error for a truncated header")
+	}
+	if _, err := decodeReadvResult(data[:14], 3); err == nil {
+		t.Errorf("expected an error for truncated data")
+	}
+}
@@ -0,0 +1,222 @@
+package api
+
+import (
+	"context"
+	"fmt"
+	"runtime"
+	"strconv"
+	"sync"
+
+	log "github.com/sirupsen/logrus"
+	"github.com/tetratelabs/wazero"
+	wazeroapi "github.com/tetratelabs/wazero/api"
+	"github.com/tetratelabs/wazero/experimental"
+)
+
+// wasi-threads (the C++ SDK's make build-threads)
+//
+// A threaded module imports a shared memory instead of defining its own
+// and imports wasi.thread-spawn. Each instance gets a fresh memory from a
+// small generated module; thread-spawn instantiates the plugin again on
+// that same memory and runs wasi_thread_start(tid, arg) in a goroutine.
+// Thread instances live until their start function returns; the SDK's
+// workers return after a second without work.
+const (
+	// ThreadsImportModule and ThreadsImportMemory name the shared memory
+	// import of threaded builds (-Wl,--import-memory=agfs_threads,memory)
+	ThreadsImportModule = "agfs_threads"
+	ThreadsImportMemory = "memory"
+
+	// maxThreadID keeps thread IDs in the range wasi-threads allows
+	maxThreadID = 0x1FFFFFFF
+)
+
+// threadGroup is one threaded instance: its memory and spawned threads
+type threadGroup struct {
+	ctx        context.Context // resolves the memory import to memory
+	runtime    wazero.Runtime
+	compiled   wazero.CompiledModule
+	memory     wazeroapi.Module
+	maxThreads int
+
+	mu      sync.Mutex
+	nextTID int32
+	threads map[int32]wazeroapi.Module
+	closed  bool
+}
+
+// threadGroups maps the main and thread instances of threaded modules to
+// their group, for HostThreadSpawn and CloseWASMModule
+var threadGroups sync.Map // wazeroapi.Module -> *threadGroup
+
+// sharedMemoryImport returns the limits of compiled's shared memory
+// import; ok is false for modules that are not threaded builds
+func sharedMemoryImport(compiled wazero.CompiledModule) (minPages, maxPages uint32, ok bool) {
+	for _, mem := range compiled.ImportedMemories() {
+		moduleName, name, _ := mem.Import()
+		if moduleName != ThreadsImportModule || name != ThreadsImportMemory {
+			continue
+		}
+		limit, hasMax := mem.Max()
+		if !hasMax {
+			// Shared memories always have a maximum
+			return 0, 0, false
+		}
+		return mem.Min(), limit, true
+	}
+	return 0, 0, false
+}
+
+// sharedMemoryModule is the binary of a module exporting one shared
+// memory of min..max pages as "memory"
+func sharedMemoryModule(minPages, maxPages uint32) []byte {
+	// limits: flag 0x03 (shared, has max), min, max
+	limits := append([]byte{0x03}, appendULEB128(appendULEB128(nil, minPages), maxPages)...)
+	memSection := append([]byte{0x01}, limits...)
+	exportSection := append([]byte{0x01, byte(len(ThreadsImportMemory))}, ThreadsImportMemory...)
+	exportSection = append(exportSection, 0x02, 0x00) // memory 0
+
+	out := []byte{0x00, 'a', 's', 'm', 0x01, 0x00, 0x00, 0x00}
+	out = append(out, 0x05)
+	out = appendULEB128(out, uint32(len(memSection)))
+	out = append(out, memSection...)
+	out = append(out, 0x07)
+	out = appendULEB128(out, uint32(len(exportSection)))
+	return append(out, exportSection...)
+}
+
+func appendULEB128(b []byte, v uint32) []byte {
+	for {
+		c := byte(v & 0x7F)
+		v >>= 7
+		if v != 0 {
+			b = append(b, c|0x80)
+			continue
+		}
+		return append(b, c)
+	}
+}
+
+// InstantiateWASMModule instantiates compiled with config. A threaded
+// build gets a shared memory of its own, may spawn up to maxThreads
+// threads (0 = runtime.NumCPU()) and sees that limit as AGFS_MAX_THREADS.
+// Close the module with CloseWASMModule.
+func InstantiateWASMModule(ctx context.Context, r wazero.Runtime, compiled wazero.CompiledModule,
+	config wazero.ModuleConfig, maxThreads int) (wazeroapi.Module, error) {
+	minPages, maxPages, threaded := sharedMemoryImport(compiled)
+	if !threaded {
+		return r.InstantiateModule(ctx, compiled, config)
+	}
+	if maxThreads <= 0 {
+		maxThreads = runtime.NumCPU()
+	}
+
+	memCompiled, err := r.CompileModule(ctx, sharedMemoryModule(minPages, maxPages))
+	if err != nil {
+		return nil, fmt.Errorf("failed to compile shared memory: %w", err)
+	}
+	memory, err := r.InstantiateModule(ctx, memCompiled, wazero.NewModuleConfig().WithName(""))
+	memCompiled.Close(ctx)
+	if err != nil {
+		return nil, fmt.Errorf("failed to create shared memory: %w", err)
+	}
+
+	g := &threadGroup{
+		runtime:    r,
+		compiled:   compiled,
+		memory:     memory,
+		maxThreads: maxThreads,
+		threads:    make(map[int32]wazeroapi.Module),
+	}
+	g.ctx = experimental.WithImportResolver(ctx, func(name string) wazeroapi.Module {
+		if name == ThreadsImportModule {
+			return memory
+		}
+		return nil
+	})
+
+	module, err := r.InstantiateModule(g.ctx, compiled,
+		config.WithEnv("AGFS_MAX_THREADS", strconv.Itoa(maxThreads)))
+	if err != nil {
+		memory.Close(ctx)
+		return nil, err
+	}
+	threadGroups.Store(module, g)
+	return module, nil
+}
+
+// CloseWASMModule closes a module from InstantiateWASMModule, and for
+// threaded builds its threads and shared memory
+func CloseWASMModule(ctx context.Context, module wazeroapi.Module) {
+	if v, ok := threadGroups.LoadAndDelete(module); ok {
+		v.(*threadGroup).close(ctx)
+	}
+	module.Close(ctx)
+}
+
+// HostThreadSpawn implements wasi.thread-spawn: it starts a thread of the
+// calling instance and returns its ID, or -1 when the instance is not a
+// threaded build, is closing or has maxThreads threads running
+func HostThreadSpawn(ctx context.Context, mod wazeroapi.Module, startArg uint32) int32 {
+	v, ok := threadGroups.Load(mod)
+	if !ok {
+		return -1
+	}
+	return v.(*threadGroup).spawn(startArg)
+}
+
+func (g *threadGroup) spawn(startArg uint32) int32 {
+	g.mu.Lock()
+	if g.closed || len(g.threads) >= g.maxThreads {
+		g.mu.Unlock()
+		return -1
+	}
+	g.nextTID = g.nextTID%maxThreadID + 1
+
+	// No start functions: the main instance already ran the initializers
+	thread, err := g.runtime.InstantiateModule(g.ctx, g.compiled,
+		wazero.NewModuleConfig().WithName("").WithStartFunctions().WithSysNanotime())
+	if err != nil {
+		g.mu.Unlock()
+		log.Warnf("wasi-threads: failed to instantiate thread: %v", err)
+		return -1
+	}
+	start := thread.ExportedFunction("wasi_thread_start")
+	if start == nil {
+		g.mu.Unlock()
+		thread.Close(g.ctx)
+		log.Warnf("wasi-threads: module has no wasi_thread_start export")
+		return -1
+	}
+	tid := g.nextTID
+	g.threads[tid] = thread
+	threadGroups.Store(thread, g)
+	g.mu.Unlock()
+
+	go func() {
+		if _, err := start.Call(g.ctx, uint64(tid), uint64(startArg)); err != nil {
+			log.Debugf("wasi-threads: thread %d exited: %v", tid, err)
+		}
+		g.mu.Lock()
+		delete(g.threads, tid)
+		g.mu.Unlock()
+		threadGroups.Delete(thread)
+		thread.Close(g.ctx)
+	}()
+	return tid
+}
+
+func (g *threadGroup) close(ctx context.Context) {
+	g.mu.Lock()
+	g.closed = true
+	threads := make([]wazeroapi.Module, 0, len(g.threads))
+	for _, thread := range g.threads {
+		threads = append(threads, thread)
+	}
+	g.mu.Unlock()
+
+	for _, thread := range threads {
+		thread.Close(ctx)
+	}
+	g.memory.Close(ctx)
+}
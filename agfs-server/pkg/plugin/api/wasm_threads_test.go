@@ -0,0 +1,32 @@
+package api
+
+import (
+	"bytes"
+	"testing"
+)
+
+func TestSharedMemoryModule(t *testing.T) {
+	want := []byte{
+		0x00, 'a', 's', 'm', 0x01, 0x00, 0x00, 0x00,
+		0x05, 0x05, 0x01, 0x03, 0x11, 0x80, 0x20, // memory: shared, 17..4096 pages
+		0x07, 0x0a, 0x01, 0x06, 'm', 'e', 'm', 'o', 'r', 'y', 0x02, 0x00, // export "memory"
+	}
+	if got := sharedMemoryModule(17, 4096); !bytes.Equal(got, want) {
+		t.Fatalf("module = % x, want % x", got, want)
+	}
+}
+
+func TestAppendULEB128(t *testing.T) {
+	cases := map[uint32][]byte{
+		0:          {0x00},
+		127:        {0x7f},
+		128:        {0x80, 0x01},
+		65536:      {0x80, 0x80, 0x04},
+		0xFFFFFFFF: {0xff, 0xff, 0xff, 0xff, 0x0f},
+	}
+	for v, want := range cases {
+		if got := appendULEB128(nil, v); !bytes.Equal(got, want) {
+			t.Errorf("appendULEB128(%d) = % x, want % x", v, got, want)
+		}
+	}
+}
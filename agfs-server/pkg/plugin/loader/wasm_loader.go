@@ -13,6 +13,7 @@ import (
 	log "github.com/sirupsen/logrus"
 	"github.com/tetratelabs/wazero"
 	wazeroapi "github.com/tetratelabs/wazero/api"
+	"github.com/tetratelabs/wazero/experimental"
 	"github.com/tetratelabs/wazero/imports/wasi_snapshot_preview1"
 )
 
@@ -76,9 +77,11 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 		return nil, fmt.Errorf("failed to read WASM file %s: %w", wasmPath, err)
 	}
 
-	// Create a new WASM runtime
+	// Create a new WASM runtime; the threads feature (shared memory,
+	// atomics) lets wasi-threads builds load
 	ctx := context.Background()
-	r := wazero.NewRuntime(ctx)
+	r := wazero.NewRuntimeWithConfig(ctx, wazero.NewRuntimeConfig().
+		WithCoreFeatures(wazeroapi.CoreFeaturesV2|experimental.CoreFeaturesThreads))
 
 	// Instantiate WASI
 	if _, err := wasi_snapshot_preview1.Instantiate(ctx, r); err != nil {
@@ -86,6 +89,20 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 		return nil, fmt.Errorf("failed to instantiate WASI: %w", err)
 	}
 
+	// wasi-threads: thread-spawn starts threads of threaded builds
+	// (see api.InstantiateWASMModule); other modules never import it
+	_, err = r.NewHostModuleBuilder("wasi").
+		NewFunctionBuilder().
+		WithFunc(func(ctx context.Context, mod wazeroapi.Module, startArg uint32) int32 {
+			return api.HostThreadSpawn(ctx, mod, startArg)
+		}).
+		Export("thread-spawn").
+		Instantiate(ctx)
+	if err != nil {
+		r.Close(ctx)
+		return nil, fmt.Errorf("failed to instantiate wasi-threads module: %w", err)
+	}
+
 	// Always instantiate host filesystem module (required by WASM modules that import these functions)
 	// If no hostFS is provided, use stub functions that return errors
 	var fs filesystem.FileSystem
@@ -115,6 +132,16 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 			}).
 			Export("host_fs_write").
 			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr, dataPtr, dataLen uint32, offset int64, flags uint32) uint64 {
+				return api.HostFSWriteAt(ctx, mod, []uint64{uint64(pathPtr), uint64(dataPtr), uint64(dataLen), uint64(offset), uint64(flags)}, fs)[0]
+			}).
+			Export("host_fs_write_at").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32, offset int64, dstPtr, capacity uint32) uint64 {
+				return api.HostFSReadInto(ctx, mod, []uint64{uint64(pathPtr), uint64(offset), uint64(dstPtr), uint64(capacity)}, fs)[0]
+			}).
+			Export("host_fs_read_into").
+			NewFunctionBuilder().
 			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32) uint64 {
 				return api.HostFSStat(ctx, mod, []uint64{uint64(pathPtr)}, fs)[0]
 			}).
@@ -125,6 +152,21 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 			}).
 			Export("host_fs_readdir").
 			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32) uint64 {
+				return api.HostFSStatBinary(ctx, mod, []uint64{uint64(pathPtr)}, fs)[0]
+			}).
+			Export("host_fs_stat_bin").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32) uint64 {
+				return api.HostFSReadDirBinary(ctx, mod, []uint64{uint64(pathPtr)}, fs)[0]
+			}).
+			Export("host_fs_readdir_bin").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, requestPtr, requestLen uint32) uint64 {
+				return api.HostFSBatch(ctx, mod, []uint64{uint64(requestPtr), uint64(requestLen)}, fs)[0]
+			}).
+			Export("host_fs_batch").
+			NewFunctionBuilder().
 			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pathPtr uint32) uint32 {
 				return uint32(api.HostFSCreate(ctx, mod, []uint64{uint64(pathPtr)}, fs)[0])
 			}).
@@ -159,6 +201,46 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 				return api.HostHTTPRequest(ctx, mod, []uint64{uint64(requestPtr)})[0]
 			}).
 			Export("host_http_request").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, headerPtr, headerLen, bodyPtr, bodyLen uint32) uint64 {
+				return api.HostHTTPRequestV2(ctx, mod, []uint64{uint64(headerPtr), uint64(headerLen), uint64(bodyPtr), uint64(bodyLen)})[0]
+			}).
+			Export("host_http_request_v2").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, headerPtr, headerLen, bodyPtr, bodyLen, flags uint32) uint64 {
+				return api.HostHTTPOpen(ctx, mod, []uint64{uint64(headerPtr), uint64(headerLen), uint64(bodyPtr), uint64(bodyLen), uint64(flags)})[0]
+			}).
+			Export("host_http_open").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID, dataPtr, dataLen uint32) uint32 {
+				return uint32(api.HostHTTPWrite(ctx, mod, []uint64{uint64(streamID), uint64(dataPtr), uint64(dataLen)})[0])
+			}).
+			Export("host_http_write").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID uint32) uint64 {
+				return api.HostHTTPResponse(ctx, mod, []uint64{uint64(streamID)})[0]
+			}).
+			Export("host_http_response").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID, dstPtr, capacity uint32) uint64 {
+				return api.HostHTTPRead(ctx, mod, []uint64{uint64(streamID), uint64(dstPtr), uint64(capacity)})[0]
+			}).
+			Export("host_http_read").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, streamID uint32) {
+				api.HostHTTPClose(ctx, mod, []uint64{uint64(streamID)})
+			}).
+			Export("host_http_close").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, idsPtr, count uint32, timeoutMs int32) uint64 {
+				return api.HostHTTPWaitAny(ctx, mod, []uint64{uint64(idsPtr), uint64(count), uint64(timeoutMs)})[0]
+			}).
+			Export("host_http_wait_any").
+			NewFunctionBuilder().
+			WithFunc(func(ctx context.Context, mod wazeroapi.Module, pending uint32) {
+				api.HostFSNotify(ctx, mod, []uint64{uint64(pending)})
+			}).
+			Export("host_fs_notify").
 			Instantiate(ctx)
 	if err != nil {
 		r.Close(ctx)
@@ -177,9 +259,10 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 	config := wazero.NewModuleConfig().
 		WithName("plugin").
 		WithStdout(os.Stdout). // Enable stdout
-		WithStderr(os.Stderr)  // Enable stderr
+		WithStderr(os.Stderr). // Enable stderr
+		WithSysNanotime()      // Real monotonic clock for plugin-side TTL caches
 
-	module, err := r.InstantiateModule(ctx, compiledModule, config)
+	module, err := api.InstantiateWASMModule(ctx, r, compiledModule, config, poolConfig.InstanceMaxThreads)
 	if err != nil {
 		r.Close(ctx)
 		return nil, fmt.Errorf("failed to instantiate WASM module: %w", err)
@@ -193,7 +276,7 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 	// First call plugin_new
 	if newFunc := module.ExportedFunction("plugin_new"); newFunc != nil {
 		if _, err := newFunc.Call(ctx); err != nil {
-			module.Close(ctx)
+			api.CloseWASMModule(ctx, module)
 			r.Close(ctx)
 			return nil, fmt.Errorf("failed to call plugin_new: %w", err)
 		}
@@ -210,7 +293,7 @@ func (wl *WASMPluginLoader) LoadWASMPlugin(wasmPath string, poolConfig api.PoolC
 	}
 
 	// Close the initial module as we'll use the instance pool instead
-	module.Close(ctx)
+	api.CloseWASMModule(ctx, module)
 
 	// Create instance pool with provided configuration
 	instancePool := api.NewWASMInstancePool(ctx, r, compiledModule, pluginName, poolConfig, fs)
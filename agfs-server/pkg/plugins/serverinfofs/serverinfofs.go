@@ -18,6 +18,7 @@ type ServerInfoFSPlugin struct {
 	startTime      time.Time
 	version        string
 	trafficMonitor TrafficStatsProvider
+	pluginStats    PluginStatsProvider
 }
 
 // TrafficStatsProvider provides traffic statistics
@@ -25,6 +26,11 @@ type TrafficStatsProvider interface {
 	GetStats() interface{}
 }
 
+// PluginStatsProvider provides runtime statistics of mounted plugins
+type PluginStatsProvider interface {
+	GetPluginStats() interface{}
+}
+
 // NewServerInfoFSPlugin creates a new ServerInfoFS plugin
 func NewServerInfoFSPlugin() *ServerInfoFSPlugin {
 	return &ServerInfoFSPlugin{
@@ -38,6 +44,11 @@ func (p *ServerInfoFSPlugin) SetTrafficMonitor(tm TrafficStatsProvider) {
 	p.trafficMonitor = tm
 }
 
+// SetPluginStatsProvider sets the source of /plugin_stats
+func (p *ServerInfoFSPlugin) SetPluginStatsProvider(ps PluginStatsProvider) {
+	p.pluginStats = ps
+}
+
 func (p *ServerInfoFSPlugin) Name() string {
 	return "serverinfofs"
 }
@@ -87,12 +98,16 @@ USAGE:
   View real-time traffic:
     cat /traffic
 
+  View WASM plugin pools and per-export timings:
+    cat /plugin_stats
+
 FILES:
   /version  - Server version information
   /uptime   - Server uptime since start
   /info     - Complete server information (JSON)
   /stats    - Runtime statistics (goroutines, memory)
   /traffic  - Real-time network traffic statistics
+  /plugin_stats - WASM instance pools, export metrics and heap usage per mount (JSON)
   /README   - This file
 
 EXAMPLES:
@@ -124,6 +139,25 @@ EXAMPLES:
     "total_upload_bytes": 536870912,
     "uptime_seconds": 3600
   }
+
+  # See where a C++ WASM plugin spends its time
+  # (total_ns - user_ns: SDK encoding, user_ns - host_ns: plugin code)
+  agfs:/> cat /serverinfofs/plugin_stats
+  {
+    "/hellofs": {
+      "plugin": "hellofs-wasm-cpp",
+      "pool": { "TotalCreated": 2, "CurrentActive": 2, ... },
+      "metrics": {
+        "exports": {
+          "fs_read": { "calls": 120, "errors": 0, "total_ns": 9100000,
+                       "user_ns": 8600000, "host_ns": 7900000, "host_calls": 120,
+                       "bytes_in": 0, "bytes_out": 2516582 }
+        }
+      },
+      "memory": { "memory_bytes": 4194304, "alloc_bytes": 1048576,
+                  "fragmentation": 0.4, "instances": 2, ... }
+    }
+  }
 `
 }
 
@@ -147,12 +181,13 @@ const (
 	fileVersion    = "/version"
 	fileStats      = "/stats"
 	fileTraffic    = "/traffic"
+	filePluginStat = "/plugin_stats"
 	fileReadme     = "/README"
 )
 
 func (fs *serverInfoFS) isValidPath(path string) bool {
 	switch path {
-	case "/", fileServerInfo, fileUptime, fileVersion, fileStats, fileTraffic, fileReadme:
+	case "/", fileServerInfo, fileUptime, fileVersion, fileStats, fileTraffic, filePluginStat, fileReadme:
 		return true
 	default:
 		return false
@@ -235,6 +270,17 @@ func (fs *serverInfoFS) Read(path string, offset int64, size int64) ([]byte, err
 			}
 		}
 
+	case filePluginStat:
+		if fs.plugin.pluginStats == nil {
+			data = []byte("Plugin statistics not available")
+		} else {
+			stats := fs.plugin.pluginStats.GetPluginStats()
+			data, err = json.MarshalIndent(stats, "", "  ")
+			if err != nil {
+				return nil, err
+			}
+		}
+
 	case fileReadme:
 		data = []byte(fs.plugin.GetReadme())
 
@@ -284,6 +330,7 @@ func (fs *serverInfoFS) ReadDir(path string) ([]filesystem.FileInfo, error) {
 	versionData, _ := fs.Read(fileVersion, 0, -1)
 	statsData, _ := fs.Read(fileStats, 0, -1)
 	trafficData, _ := fs.Read(fileTraffic, 0, -1)
+	pluginStatsData, _ := fs.Read(filePluginStat, 0, -1)
 
 	return []filesystem.FileInfo{
 		{
@@ -334,6 +381,14 @@ func (fs *serverInfoFS) ReadDir(path string) ([]filesystem.FileInfo, error) {
 			IsDir:   false,
 			Meta:    filesystem.MetaData{Name: "serverinfofs", Type: "traffic"},
 		},
+		{
+			Name:    "plugin_stats",
+			Size:    int64(len(pluginStatsData)),
+			Mode:    0444,
+			ModTime: now,
+			IsDir:   false,
+			Meta:    filesystem.MetaData{Name: "serverinfofs", Type: "info"},
+		},
 	}, nil
 }
 